@@ -65,7 +65,7 @@ struct FrameBufferData
 
     float2 resolution_environment;
     float luminance_max_nits;
-    float padding;
+    float shadow_resolution_local;
 };
 
 struct PassBufferData
@@ -90,6 +90,16 @@ struct PassBufferData
 
     uint reflection_probe_available;
     float3 position;
+
+    uint instance_offset;
+    uint indirect_draw_count;
+    uint indirect_stats_index;
+    uint material_index;
+
+    uint light_count;
+    uint view_offset;
+    uint face_mask;
+    float padding;
 };
 
 struct LightBufferData
@@ -102,7 +112,8 @@ struct LightBufferData
 
     float normal_bias;
     uint options;
-    float2 padding;
+    uint shadow_slice;
+    float padding;
 };
 
 struct MaterialBufferData
@@ -128,6 +139,12 @@ struct MaterialBufferData
     float padding;
 };
 
+struct InstanceBufferData
+{
+    matrix transform;
+    matrix transform_previous;
+};
+
 struct ImGuiBufferData
 {
     matrix transform;
@@ -137,11 +154,74 @@ struct ImGuiBufferData
     float2 padding;
 };
 
-cbuffer BufferFrame    : register(b0) { FrameBufferData buffer_frame;       }; // Low frequency            - Updates once per frame
-cbuffer BufferPass     : register(b1) { PassBufferData buffer_pass;         }; // Medium frequency         - Updates per render pass
-cbuffer BufferLight    : register(b2) { LightBufferData buffer_light;       }; // Medium frequency         - Updates per light
-cbuffer BufferMaterial : register(b3) { MaterialBufferData buffer_material; }; // Medium to high frequency - Updates per material during the g-buffer pass
-cbuffer BufferImGui    : register(b4) { ImGuiBufferData buffer_imgui;       }; // High frequency           - Update multiply times per frame
+cbuffer BufferFrame : register(b0) { FrameBufferData buffer_frame; }; // Low frequency            - Updates once per frame
+cbuffer BufferPass  : register(b1) { PassBufferData buffer_pass;   }; // Medium frequency         - Updates per render pass
+cbuffer BufferImGui : register(b4) { ImGuiBufferData buffer_imgui; }; // High frequency           - Update multiply times per frame
+
+#ifdef LIGHTS_CLUSTERED
+// lights - the light pass goes through the lights of a pixel's cluster, loading each one into buffer_light
+static LightBufferData buffer_light;
+StructuredBuffer<LightBufferData> buffer_lights : register(t41);
+
+// clusters - 16x9 screen tiles by 24 exponential depth slices, and a slice per tile which spans the whole depth (for volumetric lighting)
+static const uint g_light_cluster_count_x  = 16;
+static const uint g_light_cluster_count_y  = 9;
+static const uint g_light_cluster_count_z  = 24;
+static const uint g_light_cluster_capacity = 64; // the most lights a cluster holds
+
+float get_light_cluster_slice_depth(float slice)
+{
+    return buffer_frame.camera_near * pow(buffer_frame.camera_far / buffer_frame.camera_near, slice / (float)g_light_cluster_count_z);
+}
+
+uint get_light_cluster_index(uint3 cluster)
+{
+    return (cluster.z * g_light_cluster_count_y + cluster.y) * g_light_cluster_count_x + cluster.x;
+}
+
+uint get_light_cluster(float2 uv, float depth_view)
+{
+    uint2 tile  = min(uint2(uv * float2(g_light_cluster_count_x, g_light_cluster_count_y)), uint2(g_light_cluster_count_x - 1, g_light_cluster_count_y - 1));
+    float slice = log(max(depth_view, buffer_frame.camera_near) / buffer_frame.camera_near) / log(buffer_frame.camera_far / buffer_frame.camera_near);
+    return get_light_cluster_index(uint3(tile, min(uint(slice * g_light_cluster_count_z), g_light_cluster_count_z - 1)));
+}
+
+uint get_light_cluster_column(float2 uv)
+{
+    uint2 tile = min(uint2(uv * float2(g_light_cluster_count_x, g_light_cluster_count_y)), uint2(g_light_cluster_count_x - 1, g_light_cluster_count_y - 1));
+    return get_light_cluster_index(uint3(tile, g_light_cluster_count_z));
+}
+#else
+cbuffer BufferLight : register(b2) { LightBufferData buffer_light; }; // Medium frequency         - Updates per light
+#endif
+
+// instancing - a draw's instances are read through the index list, starting at buffer_pass.instance_offset
+StructuredBuffer<InstanceBufferData> buffer_instances : register(t37);
+StructuredBuffer<uint> buffer_instance_indices        : register(t38);
+
+// materials - every material has an entry in the table, a draw picks its own through buffer_pass.material_index
+StructuredBuffer<MaterialBufferData> buffer_materials : register(t40);
+#define buffer_material buffer_materials[buffer_pass.material_index]
+
+// multiview - the view projections of cube faces, a pass renders all of them at once, starting at buffer_pass.view_offset
+StructuredBuffer<matrix> buffer_views : register(t42);
+
+// a face which doesn't see the draw gets a position outside of the clip volume, so the triangle is dropped
+bool is_view_visible(uint view_id)
+{
+    return buffer_pass.face_mask & (1U << view_id);
+}
+
+float4 transform_to_view(float4 position, uint view_id)
+{
+    return is_view_visible(view_id) ? mul(position, buffer_views[buffer_pass.view_offset + view_id]) : float4(2.0f, 2.0f, 2.0f, 1.0f);
+}
+
+// SV_InstanceID includes the first instance of the draw (vulkan), indirect draws point it at the instance directly
+InstanceBufferData get_instance(uint instance_id)
+{
+    return buffer_instances[buffer_instance_indices[buffer_pass.instance_offset + instance_id]];
+}
 
 // g-buffer texture properties
 bool has_single_texture_roughness_metalness() { return buffer_material.properties & uint(1U << 0); }
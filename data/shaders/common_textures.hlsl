@@ -44,13 +44,11 @@ Texture2D tex_light_specular             : register(t17);
 Texture2D tex_light_specular_transparent : register(t18);
 Texture2D tex_light_volumetric           : register(t19);
 
-// Light depth/color maps
+// Light depth/color maps, the point and spot lights share an array (six slices for a point light, one for a spot light)
 Texture2DArray tex_light_directional_depth : register(t20);
 Texture2DArray tex_light_directional_color : register(t21);
-TextureCube tex_light_point_depth          : register(t22);
-TextureCube tex_light_point_color          : register(t23);
-Texture2D tex_light_spot_depth             : register(t24);
-Texture2D tex_light_spot_color             : register(t25);
+Texture2DArray tex_light_local_depth       : register(t22);
+Texture2DArray tex_light_local_color       : register(t23);
 
 // Noise
 Texture2D tex_noise_normal    : register(t26);
@@ -0,0 +1,105 @@
+/*
+Copyright(c) 2016-2023 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES =========
+#include "common.hlsl"
+//====================
+
+struct IndirectDraw
+{
+    float3 aabb_min;
+    uint index_count;
+    float3 aabb_max;
+    uint index_offset;
+    int vertex_offset;
+    uint instance;
+    uint batch;
+    uint args_offset;
+};
+
+struct IndirectArgs
+{
+    uint index_count;
+    uint instance_count;
+    uint first_index;
+    int vertex_offset;
+    uint first_instance;
+};
+
+StructuredBuffer<IndirectDraw> buffer_indirect_draws   : register(t39);
+RWStructuredBuffer<IndirectArgs> buffer_indirect_args   : register(u16);
+RWStructuredBuffer<uint> buffer_indirect_counts         : register(u17); // one per batch, cleared by the cpu
+RWStructuredBuffer<uint> buffer_indirect_stats          : register(u18); // emitted and culled, per command list
+
+// the planes of the frustum come straight from the view projection (buffer_pass.transform), a box
+// is outside if its corner which is furthest along a plane's normal is still behind it
+bool is_visible(float3 aabb_min, float3 aabb_max)
+{
+    float4x4 m = transpose(buffer_pass.transform);
+    float4 planes[6] =
+    {
+        m[3] + m[0], // left
+        m[3] - m[0], // right
+        m[3] + m[1], // bottom
+        m[3] - m[1], // top
+        m[2],        // far (reverse-z), culls nothing with an infinite far plane
+        m[3] - m[2]  // near
+    };
+
+    [unroll]
+    for (uint i = 0; i < 6; i++)
+    {
+        float3 corner = float3(planes[i].x >= 0.0f ? aabb_max.x : aabb_min.x, planes[i].y >= 0.0f ? aabb_max.y : aabb_min.y, planes[i].z >= 0.0f ? aabb_max.z : aabb_min.z);
+        if (dot(planes[i].xyz, corner) + planes[i].w < 0.0f)
+            return false;
+    }
+
+    return true;
+}
+
+[numthreads(THREAD_GROUP_COUNT, 1, 1)]
+void mainCS(uint3 thread_id : SV_DispatchThreadID)
+{
+    if (thread_id.x >= buffer_pass.indirect_draw_count)
+        return;
+
+    IndirectDraw draw = buffer_indirect_draws[thread_id.x];
+
+    if (!is_visible(draw.aabb_min, draw.aabb_max))
+    {
+        InterlockedAdd(buffer_indirect_stats[buffer_pass.indirect_stats_index * 2 + 1], 1);
+        return;
+    }
+
+    // append to the region of the batch, the draw count of the batch is what gets drawn
+    uint slot;
+    InterlockedAdd(buffer_indirect_counts[draw.batch], 1, slot);
+
+    IndirectArgs args;
+    args.index_count    = draw.index_count;
+    args.instance_count = 1;
+    args.first_index    = draw.index_offset;
+    args.vertex_offset  = draw.vertex_offset;
+    args.first_instance = draw.instance; // SV_InstanceID includes the first instance in vulkan, see get_instance()
+    buffer_indirect_args[draw.args_offset + slot] = args;
+
+    InterlockedAdd(buffer_indirect_stats[buffer_pass.indirect_stats_index * 2 + 0], 1);
+}
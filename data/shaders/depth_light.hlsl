@@ -23,12 +23,14 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "common.hlsl"
 //====================
 
-Pixel_PosUv mainVS(Vertex_PosUv input)
+Pixel_PosUv mainVS(Vertex_PosUv input, uint instance_id : SV_InstanceID, uint view_id : SV_ViewID)
 {
     Pixel_PosUv output;
 
+    // the pass transform is the view projection of the shadow slice, unless the pass renders all faces of a cube
     input.position.w = 1.0f;
-    output.position = mul(input.position, buffer_pass.transform);
+    output.position  = mul(input.position, get_instance(instance_id).transform);
+    output.position  = buffer_pass.face_mask != 0 ? transform_to_view(output.position, view_id) : mul(output.position, buffer_pass.transform);
     output.uv        = input.uv;
 
     return output;
@@ -91,35 +91,25 @@ float3 vl_raymarch(Light light, float3 ray_pos, float3 ray_step, float3 ray_dir,
         }
 
         float3 pos_ndc = 0.0f;
+        float3 pos_uv  = 0.0f;
         if (light_has_shadows() || light_has_shadows_transparent())
         {
-            pos_ndc = world_to_ndc(ray_pos, buffer_light.view_projection[cascade_index]);
+            // The ray can cross the faces of a point light, so the face is picked per step
+            uint slice_index = light_is_point() ? direction_to_cube_face_index(ray_pos - light.position) : cascade_index;
+            pos_ndc          = world_to_ndc(ray_pos, buffer_light.view_projection[slice_index]);
+            pos_uv           = float3(ndc_to_uv(pos_ndc), buffer_light.shadow_slice + slice_index);
         }
 
         // Shadows - Opaque
         if (light_has_shadows())
         {
-            if (light_is_point())
-            {
-                fog *= shadow_compare_depth(normalize(ray_pos - light.position), pos_ndc.z);
-            }
-            else // directional & spot
-            {
-                fog *= shadow_compare_depth(float3(ndc_to_uv(pos_ndc), cascade_index), pos_ndc.z);
-            }
+            fog *= shadow_compare_depth(pos_uv, pos_ndc.z);
         }
 
         // Shadows - Transparent
         if (light_has_shadows_transparent())
         {
-            if (light_is_point())
-            {
-                fog *= shadow_sample_color(normalize(ray_pos - light.position));
-            }
-            else // directional & spot
-            {
-                fog *= shadow_sample_color(float3(ndc_to_uv(pos_ndc), cascade_index));
-            }
+            fog *= shadow_sample_color(pos_uv);
         }
 
         // Accumulate
@@ -141,7 +131,7 @@ float3 VolumetricLighting(Surface surface, Light light)
     float3 ray_step   = ray_dir * step_length;
     
     // Offset ray to get away with way less steps and great detail
-    float offset = get_noise_interleaved_gradient(surface.uv * buffer_frame.shadow_resolution);
+    float offset = get_noise_interleaved_gradient(surface.uv * get_shadow_resolution());
     ray_pos += ray_step * offset;
 
     if (light_is_directional())
@@ -176,14 +166,7 @@ float3 VolumetricLighting(Surface surface, Light light)
     }
     else // POINT/SPOT
     {
-        uint projection_index = 0;
-
-        if (light_is_point())
-        {
-            projection_index = direction_to_cube_face_index(light.to_pixel);
-        }
-    
-        fog = vl_raymarch(light, ray_pos, ray_step, ray_dir, projection_index);
+        fog = vl_raymarch(light, ray_pos, ray_step, ray_dir, 0);
     }
 
     float fog_regular     = get_fog_factor(surface);
@@ -41,20 +41,22 @@ struct PixelOutputType
     float fsr2_transparency_mask : SV_Target5;
 };
 
-PixelInputType mainVS(Vertex_PosUvNorTan input)
+PixelInputType mainVS(Vertex_PosUvNorTan input, uint instance_id : SV_InstanceID)
 {
     PixelInputType output;
 
+    InstanceBufferData instance = get_instance(instance_id);
+
     // position computation has to be an exact match to depth_prepass.hlsl
     input.position.w      = 1.0f;
-    output.position_world = mul(input.position, buffer_pass.transform);
+    output.position_world = mul(input.position, instance.transform);
     output.position       = mul(output.position_world, buffer_frame.view_projection);
 
     output.position_ss_current  = output.position;
-    output.position_ss_previous = mul(input.position, buffer_pass.transform_previous);
+    output.position_ss_previous = mul(input.position, instance.transform_previous);
     output.position_ss_previous = mul(output.position_ss_previous, buffer_frame.view_projection_previous);
-    output.normal_world         = normalize(mul(input.normal, (float3x3)buffer_pass.transform)).xyz;
-    output.tangent_world        = normalize(mul(input.tangent, (float3x3)buffer_pass.transform)).xyz;
+    output.normal_world         = normalize(mul(input.normal, (float3x3)instance.transform)).xyz;
+    output.tangent_world        = normalize(mul(input.tangent, (float3x3)instance.transform)).xyz;
     output.uv                   = input.uv;
     
     return output;
@@ -21,6 +21,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #define FOG_REGULAR 1
 #define FOG_VOLUMETRIC 1
+#define LIGHTS_CLUSTERED 1
 
 //= INCLUDES =================
 #include "common.hlsl"
@@ -29,6 +30,35 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "fog.hlsl"
 //============================
 
+// written by the light culling pass, see light_cull.hlsl
+StructuredBuffer<uint> buffer_light_cluster_counts  : register(t24);
+StructuredBuffer<uint> buffer_light_cluster_indices : register(t25);
+
+float4 compute_shadow(Surface surface, Light light)
+{
+    float4 shadow = 1.0f;
+
+    // Shadow mapping
+    if (light_has_shadows())
+    {
+        shadow = Shadow_Map(surface, light);
+    }
+
+    // Screen space shadows
+    if (is_screen_space_shadows_enabled() && light_has_shadows_screen_space())
+    {
+        shadow.a = min(shadow.a, ScreenSpaceShadows(surface, light));
+    }
+
+    // Ensure that the shadow is as transparent as the material
+    if (buffer_pass.is_transparent_pass)
+    {
+        shadow.a = clamp(shadow.a, surface.alpha, 1.0f);
+    }
+
+    return shadow;
+}
+
 [numthreads(THREAD_GROUP_COUNT_X, THREAD_GROUP_COUNT_Y, 1)]
 void mainCS(uint3 thread_id : SV_DispatchThreadID)
 {
@@ -46,84 +76,93 @@ void mainCS(uint3 thread_id : SV_DispatchThreadID)
     if (early_exit_1 || early_exit_2)
         return;
 
-    // Create light
-    Light light;
-    light.Build(surface);
-
-    // Shadows
-    float4 shadow = 1.0f;
-    {
-        // Shadow mapping
-        if (light_has_shadows())
-        {
-            shadow = Shadow_Map(surface, light);
-        }
-        
-        // Screen space shadows
-        if (is_screen_space_shadows_enabled() && light_has_shadows_screen_space())
-        {
-            shadow.a = min(shadow.a, ScreenSpaceShadows(surface, light));
-        }
-
-        // Ensure that the shadow is as transparent as the material
-        if (buffer_pass.is_transparent_pass)
-        {
-            shadow.a = clamp(shadow.a, surface.alpha, 1.0f);
-        }
-    }
-
-    // Compute final radiance
-    light.radiance *= shadow.rgb * shadow.a;
-    
     float3 light_diffuse    = 0.0f;
     float3 light_specular   = 0.0f;
     float3 light_volumetric = 0.0f;
 
-    // Reflectance equation
+    // Reflectance equation, for the lights of the cluster which the pixel is in
     if (!surface.is_sky())
     {
-        AngularInfo angular_info;
-        angular_info.Build(light, surface);
+        uint cluster     = get_light_cluster(surface.uv, world_to_view(surface.position).z);
+        uint light_count = buffer_light_cluster_counts[cluster];
 
-        // Specular
-        if (surface.anisotropic == 0.0f)
+        for (uint i = 0; i < light_count; i++)
         {
-            light_specular += BRDF_Specular_Isotropic(surface, angular_info);
-        }
-        else
-        {
-            light_specular += BRDF_Specular_Anisotropic(surface, angular_info);
+            buffer_light = buffer_lights[buffer_light_cluster_indices[cluster * g_light_cluster_capacity + i]];
+
+            // Create light
+            Light light;
+            light.Build(surface);
+
+            // Out of range or facing away, skip the shadows
+            if (!any(light.radiance))
+                continue;
+
+            // Compute final radiance
+            float4 shadow = compute_shadow(surface, light);
+            light.radiance *= shadow.rgb * shadow.a;
+
+            AngularInfo angular_info;
+            angular_info.Build(light, surface);
+
+            // Specular
+            float3 specular = 0.0f;
+            if (surface.anisotropic == 0.0f)
+            {
+                specular += BRDF_Specular_Isotropic(surface, angular_info);
+            }
+            else
+            {
+                specular += BRDF_Specular_Anisotropic(surface, angular_info);
+            }
+
+            // Specular clearcoat
+            if (surface.clearcoat != 0.0f)
+            {
+                specular += BRDF_Specular_Clearcoat(surface, angular_info);
+            }
+
+            // Sheen
+            if (surface.sheen != 0.0f)
+            {
+                specular += BRDF_Specular_Sheen(surface, angular_info);
+            }
+
+            // Diffuse, toned down such as that only non metals have it
+            float3 diffuse = BRDF_Diffuse(surface, angular_info) * surface.diffuse_energy;
+
+            light_diffuse  += diffuse * light.radiance;
+            light_specular += specular * light.radiance;
         }
+    }
 
-        // Specular clearcoat
-        if (surface.clearcoat != 0.0f)
-        {
-            light_specular += BRDF_Specular_Clearcoat(surface, angular_info);
-        }
+    // Volumetric, for the lights of the whole depth of the pixel's tile since they can be anywhere along the ray
+    if (is_volumetric_fog_enabled())
+    {
+        uint cluster     = get_light_cluster_column(surface.uv);
+        uint light_count = buffer_light_cluster_counts[cluster];
 
-        // Sheen
-        if (surface.sheen != 0.0f)
+        for (uint i = 0; i < light_count; i++)
         {
-            light_specular += BRDF_Specular_Sheen(surface, angular_info);
-        }
-        
-        // Diffuse
-        light_diffuse += BRDF_Diffuse(surface, angular_info);
+            buffer_light = buffer_lights[buffer_light_cluster_indices[cluster * g_light_cluster_capacity + i]];
+            if (!light_is_volumetric())
+                continue;
 
-        // Tone down diffuse such as that only non metals have it
-        light_diffuse *= surface.diffuse_energy;
+            Light light;
+            light.Build(surface);
+            light_volumetric += VolumetricLighting(surface, light);
+        }
     }
 
     float3 emissive = surface.emissive * surface.albedo;
-    
-     // Diffuse and specular
-    tex_uav[thread_id.xy]  += float4(saturate_11(light_diffuse * light.radiance + surface.gi + emissive), 1.0f);
-    tex_uav2[thread_id.xy] += float4(saturate_11(light_specular * light.radiance), 1.0f);
+
+    // Diffuse and specular, the targets are cleared before the pass
+    tex_uav[thread_id.xy]  = float4(saturate_11(light_diffuse + surface.gi + emissive), 1.0f);
+    tex_uav2[thread_id.xy] = float4(saturate_11(light_specular), 1.0f);
 
     // Volumetric
-    if (light_is_volumetric() && is_volumetric_fog_enabled())
+    if (is_volumetric_fog_enabled())
     {
-        light_volumetric       += VolumetricLighting(surface, light);
-        tex_uav3[thread_id.xy] += float4(saturate_11(light_volumetric), 1.0f);
+        tex_uav3[thread_id.xy] = float4(saturate_11(light_volumetric), 1.0f);
     }
 }
@@ -0,0 +1,99 @@
+/*
+Copyright(c) 2016-2023 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#define LIGHTS_CLUSTERED 1
+
+//= INCLUDES =========
+#include "common.hlsl"
+//====================
+
+RWStructuredBuffer<uint> buffer_light_cluster_counts  : register(u19);
+RWStructuredBuffer<uint> buffer_light_cluster_indices : register(u20); // g_light_cluster_capacity per cluster
+
+// the view space ray through a point of the screen, scaled so that its depth is one
+float3 get_view_ray(float2 uv)
+{
+    float2 ndc      = float2(uv.x * 2.0f - 1.0f, 1.0f - uv.y * 2.0f);
+    float4 position = mul(float4(ndc, 1.0f, 1.0f), buffer_frame.projection_inverted); // on the near plane (reverse-z)
+    return position.xyz / position.z;
+}
+
+// a cluster is the box which bounds the tile's frustum between the depths of its slice
+void get_cluster_aabb(uint3 cluster, out float3 aabb_min, out float3 aabb_max)
+{
+    bool is_column    = cluster.z == g_light_cluster_count_z;
+    float depth_near  = is_column ? buffer_frame.camera_near : get_light_cluster_slice_depth(cluster.z);
+    float depth_far   = is_column ? buffer_frame.camera_far  : get_light_cluster_slice_depth(cluster.z + 1);
+    float2 tile_size  = 1.0f / float2(g_light_cluster_count_x, g_light_cluster_count_y);
+    float2 uv_min     = cluster.xy * tile_size;
+
+    float3 ray = get_view_ray(uv_min);
+    aabb_min   = min(ray * depth_near, ray * depth_far);
+    aabb_max   = max(ray * depth_near, ray * depth_far);
+
+    [unroll]
+    for (uint i = 1; i < 4; i++)
+    {
+        ray      = get_view_ray(uv_min + float2(i & 1, i >> 1) * tile_size);
+        aabb_min = min(aabb_min, min(ray * depth_near, ray * depth_far));
+        aabb_max = max(aabb_max, max(ray * depth_near, ray * depth_far));
+    }
+}
+
+// spot lights are tested as spheres too, which is conservative
+bool intersects(LightBufferData light, float3 aabb_min, float3 aabb_max)
+{
+    if (light.options & uint(1U << 0)) // directional
+        return true;
+
+    float3 center   = mul(float4(light.position.xyz, 1.0f), buffer_frame.view).xyz;
+    float range     = light.intensity_range_angle_bias.y;
+    float3 closest  = clamp(center, aabb_min, aabb_max);
+    float3 distance = closest - center;
+
+    return dot(distance, distance) <= range * range;
+}
+
+[numthreads(THREAD_GROUP_COUNT, 1, 1)]
+void mainCS(uint3 thread_id : SV_DispatchThreadID)
+{
+    uint tile_count = g_light_cluster_count_x * g_light_cluster_count_y;
+    if (thread_id.x >= tile_count * (g_light_cluster_count_z + 1))
+        return;
+
+    uint3 cluster = uint3(thread_id.x % g_light_cluster_count_x, (thread_id.x / g_light_cluster_count_x) % g_light_cluster_count_y, thread_id.x / tile_count);
+
+    float3 aabb_min, aabb_max;
+    get_cluster_aabb(cluster, aabb_min, aabb_max);
+
+    // the lights past the capacity of the cluster are dropped
+    uint count = 0;
+    for (uint i = 0; i < buffer_pass.light_count && count < g_light_cluster_capacity; i++)
+    {
+        if (intersects(buffer_lights[i], aabb_min, aabb_max))
+        {
+            buffer_light_cluster_indices[thread_id.x * g_light_cluster_capacity + count] = i;
+            count++;
+        }
+    }
+
+    buffer_light_cluster_counts[thread_id.x] = count;
+}
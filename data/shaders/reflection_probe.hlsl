@@ -32,13 +32,15 @@ struct Pixel_Input
     float3 normal      : NORMAL;
 };
 
-Pixel_Input mainVS(Vertex_PosUvNorTan input)
+// the pass transform is the entity's, the faces of the probe are rendered at once
+Pixel_Input mainVS(Vertex_PosUvNorTan input, uint view_id : SV_ViewID)
 {
     Pixel_Input output;
 
     input.position.w   = 1.0f;
     output.position    = mul(input.position, buffer_pass.transform);
     output.position_ws = output.position.xyz;
+    output.position    = transform_to_view(output.position, view_id);
     output.normal      = normalize(mul(input.normal, (float3x3)buffer_pass.transform)).xyz;
     output.uv          = input.uv;
 
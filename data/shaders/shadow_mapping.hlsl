@@ -44,79 +44,35 @@ static const float g_shadow_samples_rpc = 1.0f / (float) g_shadow_samples;
     LIGHT SHADOW MAP SAMPLING
 ------------------------------------------------------------------------------*/
 
+// float3 -> uv, slice
 float shadow_compare_depth(float3 uv, float compare)
 {
     if (light_is_directional())
     {
-        // float3 -> uv, slice
         return tex_light_directional_depth.SampleCmpLevelZero(samplers_comparison[sampler_compare_depth], uv, compare).r;
     }
-    else if (light_is_point())
-    {
-        // float3 -> direction
-        return tex_light_point_depth.SampleCmpLevelZero(samplers_comparison[sampler_compare_depth], uv, compare).r;
-    }
-    else if (light_is_spot())
-    {
-        // float3 -> uv, 0
-        return tex_light_spot_depth.SampleCmpLevelZero(samplers_comparison[sampler_compare_depth], uv.xy, compare).r;
-    }
-    else
-    {
-        // Return within an else statement in order to avoid a warning.
-        // Warning X4000: use of potentially uninitialized variable.
-        return 0.0f;
-    }
+
+    return tex_light_local_depth.SampleCmpLevelZero(samplers_comparison[sampler_compare_depth], uv, compare).r;
 }
 
 float shadow_sample_depth(float3 uv)
 {
     if (light_is_directional())
     {
-        // float3 -> uv, slice
         return tex_light_directional_depth.SampleLevel(samplers[sampler_point_clamp], uv, 0).r;
     }
-    else if (light_is_point())
-    {
-        // float3 -> direction
-        return tex_light_point_depth.SampleLevel(samplers[sampler_point_clamp], uv, 0).r;
-    }
-    else if (light_is_spot())
-    {
-        // float3 -> uv, 0
-        return tex_light_spot_depth.SampleLevel(samplers[sampler_point_clamp], uv.xy, 0).r;
-    }
-    else
-    {
-        // Return within an else statement in order to avoid a warning.
-        // Warning X4000: use of potentially uninitialized variable.
-        return 0.0f;
-    }
+
+    return tex_light_local_depth.SampleLevel(samplers[sampler_point_clamp], uv, 0).r;
 }
 
 float3 shadow_sample_color(float3 uv)
 {
     if (light_is_directional())
     {
-        // float3 -> uv, slice
         return tex_light_directional_color.SampleLevel(samplers[sampler_point_clamp], uv, 0).rgb;
     }
-    else if (light_is_point())
-    {
-        // float3 -> direction
-        return tex_light_point_color.SampleLevel(samplers[sampler_point_clamp], uv, 0).rgb;
-    }
-    else if (light_is_spot())
-    {
-        // float3 -> uv, 0
-        return tex_light_spot_color.SampleLevel(samplers[sampler_point_clamp], uv.xy, 0).rgb;
-    }
-    else
-    {
-        // Return within an else statement in order to avoid a warning.
-        // Warning X4000: use of potentially uninitialized variable.
-        return 0.0f;
-    }
+
+    return tex_light_local_color.SampleLevel(samplers[sampler_point_clamp], uv, 0).rgb;
 }
 
 /*------------------------------------------------------------------------------
@@ -174,8 +130,6 @@ float Technique_Vogel(Surface surface, float3 uv, float compare)
     float temporal_angle  = temporal_offset * PI2;
     float penumbra        = light_is_directional() ? 1.0f : compute_penumbra(temporal_angle, uv, compare);
 
-    // todo: in the case of the point light, the uv is the direction, filtering works ok but I could improved it.
-
     for (uint i = 0; i < g_shadow_samples; i++)
     {
         float2 offset = vogel_disk_sample(i, g_shadow_samples, temporal_angle) * get_shadow_texel_size() * g_shadow_filter_size * penumbra;
@@ -190,8 +144,6 @@ float3 Technique_Vogel_Color(Surface surface, float3 uv)
     float3 shadow     = 0.0f;
     float vogel_angle = get_noise_interleaved_gradient(surface.uv * buffer_pass.resolution_rt) * PI2;
 
-    // todo: in the case of the point light, the uv is the direction, filtering works ok but I could improved it.
-    
     for (uint i = 0; i < g_shadow_samples; i++)
     {
         float2 offset = vogel_disk_sample(i, g_shadow_samples, vogel_angle) * get_shadow_texel_size() * g_shadow_filter_size;
@@ -275,7 +227,7 @@ static const float2 poisson_disk[64] =
 float Technique_Poisson(Surface surface, float3 uv, float compare)
 {
     float shadow          = 0.0f;
-    float temporal_offset = get_noise_interleaved_gradient(uv.xy * buffer_frame.shadow_resolution); // helps with noise if TAA is active
+    float temporal_offset = get_noise_interleaved_gradient(uv.xy * get_shadow_resolution()); // helps with noise if TAA is active
 
     for (uint i = 0; i < g_shadow_samples; i++)
     {
@@ -355,13 +307,13 @@ float4 Shadow_Map(Surface surface, Light light)
             {
                 // Sample primary cascade
                 auto_bias(surface, pos_ndc, light, cascade_index);
-                shadow.a = SampleShadowMap(surface, float3(pos_uv, cascade_index), pos_ndc.z);
+                shadow.a = SampleShadowMap(surface, float3(pos_uv, buffer_light.shadow_slice + cascade_index), pos_ndc.z);
 
                 if (light_has_shadows_transparent())
                 {
                     if (shadow.a > 0.0f && surface.is_opaque())
                     {
-                        shadow.rgb *= Technique_Vogel_Color(surface, float3(pos_uv, cascade_index));
+                        shadow.rgb *= Technique_Vogel_Color(surface, float3(pos_uv, buffer_light.shadow_slice + cascade_index));
                     }
                 }
 
@@ -377,7 +329,7 @@ float4 Shadow_Map(Surface surface, Light light)
 
                     // Sample secondary cascade
                     auto_bias(surface, pos_ndc, light, cascade_index_next);
-                    float shadow_secondary = SampleShadowMap(surface, float3(pos_uv, cascade_index_next), pos_ndc.z);
+                    float shadow_secondary = SampleShadowMap(surface, float3(pos_uv, buffer_light.shadow_slice + cascade_index_next), pos_ndc.z);
 
                     // Blend cascades
                     shadow.a = lerp(shadow.a, shadow_secondary, cascade_fade);
@@ -386,7 +338,7 @@ float4 Shadow_Map(Surface surface, Light light)
                     {
                         if (shadow.a > 0.0f && surface.is_opaque())
                         {
-                            shadow.rgb = min(shadow.rgb, Technique_Vogel_Color(surface, float3(pos_uv, cascade_index_next)));
+                            shadow.rgb = min(shadow.rgb, Technique_Vogel_Color(surface, float3(pos_uv, buffer_light.shadow_slice + cascade_index_next)));
                         }
                     }
                 }
@@ -399,18 +351,19 @@ float4 Shadow_Map(Surface surface, Light light)
     {
         if (light.distance_to_pixel < light.far)
         {
-            // Project into light space
-            uint slice_index  = direction_to_cube_face_index(light.to_pixel);
-            float3 pos_ndc    = world_to_ndc(position_world, buffer_light.view_projection[slice_index]);
+            // Project into the light space of the cube face
+            uint face_index = direction_to_cube_face_index(light.to_pixel);
+            float3 pos_ndc  = world_to_ndc(position_world, buffer_light.view_projection[face_index]);
+            float3 pos_uv   = float3(ndc_to_uv(pos_ndc), buffer_light.shadow_slice + face_index);
 
             auto_bias(surface, pos_ndc, light);
-            shadow.a = SampleShadowMap(surface, light.to_pixel, pos_ndc.z);
+            shadow.a = SampleShadowMap(surface, pos_uv, pos_ndc.z);
             
             if (light_has_shadows_transparent())
             {
                 if (shadow.a > 0.0f && surface.is_opaque())
                 {
-                    shadow.rgb *= Technique_Vogel_Color(surface, light.to_pixel);
+                    shadow.rgb *= Technique_Vogel_Color(surface, pos_uv);
                 }
             }
         }
@@ -421,7 +374,7 @@ float4 Shadow_Map(Surface surface, Light light)
         {
             // Project into light space
             float3 pos_ndc  = world_to_ndc(position_world, buffer_light.view_projection[0]);
-            float3 pos_uv   = float3(ndc_to_uv(pos_ndc), 0);
+            float3 pos_uv   = float3(ndc_to_uv(pos_ndc), buffer_light.shadow_slice);
 
             // Ensure not out of bound
             if (is_saturated(pos_uv.xy))
@@ -70,7 +70,7 @@ namespace
     MenuBar* widget_menu_bar = nullptr;
     Widget* widget_world     = nullptr;
 
-    static void process_event(Spartan::sp_variant data)
+    static void process_event(const Spartan::sp_variant& data)
     {
         SDL_Event* event_sdl = static_cast<SDL_Event*>(get<void*>(data));
         ImGui_ImplSDL2_ProcessEvent(event_sdl);
@@ -199,6 +199,9 @@ namespace ImGui::RHI
         if (draw_data->DisplaySize.x == 0 || draw_data->DisplaySize.y == 0)
             return;
 
+        // The renderer might be recording a frame on its own thread, the resources and queues are shared with it
+        std::lock_guard<std::recursive_mutex> lock(Renderer::GetFrameMutex());
+
         // Get swap chain and cmd list
         bool is_child_window         = window_data != nullptr;
         RHI_SwapChain* swap_chain    = is_child_window ? window_data->swapchain.get() : Renderer::GetSwapChain();
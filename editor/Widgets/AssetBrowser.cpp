@@ -89,6 +89,14 @@ static void mesh_import_dialog()
 
             mesh_import_dialog_checkbox(MeshProcessingOptions::ImportLights, "Import lights");
 
+            mesh_import_dialog_checkbox(MeshProcessingOptions::GenerateLods,
+                "Generate LODs",
+                "Simplified versions of every mesh, distant meshes draw the ones which look the same at their size on screen.");
+
+            mesh_import_dialog_checkbox(MeshProcessingOptions::GenerateClusters,
+                "Generate clusters",
+                "Splits large meshes into small clusters of triangles, the ones which are off-screen or facing away aren't drawn.");
+
             // Ok button
             if (ImGuiSp::button_centered_on_line("Ok", 0.5f))
             {
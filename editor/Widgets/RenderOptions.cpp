@@ -233,6 +233,10 @@ void RenderOptions::TickVisible()
     bool performance_metrics     = Renderer::GetOption<bool>(Renderer_Option::Debug_PerformanceMetrics);
     bool debug_wireframe         = Renderer::GetOption<bool>(Renderer_Option::Debug_Wireframe);
     bool do_depth_prepass        = Renderer::GetOption<bool>(Renderer_Option::DepthPrepass);
+    bool do_occlusion_culling    = Renderer::GetOption<bool>(Renderer_Option::OcclusionCulling);
+    bool do_parallel_recording   = Renderer::GetOption<bool>(Renderer_Option::ParallelRecording);
+    bool do_indirect_drawing     = Renderer::GetOption<bool>(Renderer_Option::IndirectDrawing);
+    bool do_cluster_culling      = Renderer::GetOption<bool>(Renderer_Option::ClusterCulling);
     int resolution_shadow        = Renderer::GetOption<int>(Renderer_Option::ShadowResolution);
 
     // Present options (with a table)
@@ -365,6 +369,13 @@ void RenderOptions::TickVisible()
 
             // Shadow resolution
             option_int("Shadow resolution", resolution_shadow);
+            option_value("Point/spot shadow resolution", Renderer_Option::ShadowResolutionLocal, "The resolution of each point light face and spot light", 256.0f, 128.0f, 8192.0f, "%.0f");
+
+            // Point and spot light shadow budget
+            option_value("Point/spot shadow slices", Renderer_Option::ShadowSlicesLocal, "The most slices point and spot lights get (six per point light, one per spot light), the lights furthest from the camera lose their shadows past it", 6.0f, 6.0f, 2048.0f, "%.0f");
+
+            // Point light faces per frame
+            option_value("Point light faces per frame", Renderer_Option::ShadowFacesPerFrame, "How many point light faces update their moving shadow casters per frame, faces of moved lights always update", 1.0f, 1.0f, 24.0f, "%.0f");
         }
 
         if (option("Misc"))
@@ -398,6 +409,9 @@ void RenderOptions::TickVisible()
             // VSync
             option_check_box("VSync", do_vsync, "Vertical Synchronization");
 
+            // Frames in flight
+            option_value("Frames in flight", Renderer_Option::FramesInFlight, "0 records frames on the main thread, otherwise a render thread records them while the simulation runs ahead", 1.0f, 0.0f, 3.0f, "%.0f");
+
             // FPS Limit
             {
                 option_first_column();
@@ -418,6 +432,18 @@ void RenderOptions::TickVisible()
             // Depth-PrePass
             option_check_box("Depth PrePass", do_depth_prepass);
 
+            // Occlusion culling
+            option_check_box("Occlusion culling", do_occlusion_culling);
+
+            // Parallel command recording
+            option_check_box("Parallel recording", do_parallel_recording, "Record geometry passes with many draws on worker threads");
+
+            // Indirect drawing
+            option_check_box("Indirect drawing", do_indirect_drawing, "Cull the camera's opaques on the GPU and draw them with indirect arguments");
+
+            // Cluster culling
+            option_check_box("Cluster culling", do_cluster_culling, "Skip the clusters of large meshes which are off-screen or facing away from the camera");
+
             // Performance metrics
             {
                 bool performance_metrics_previous = performance_metrics;
@@ -471,4 +497,8 @@ void RenderOptions::TickVisible()
     Renderer::SetOption(Renderer_Option::Debug_PerformanceMetrics, performance_metrics);
     Renderer::SetOption(Renderer_Option::Debug_Wireframe,          debug_wireframe);
     Renderer::SetOption(Renderer_Option::DepthPrepass,             do_depth_prepass);
+    Renderer::SetOption(Renderer_Option::OcclusionCulling,         do_occlusion_culling);
+    Renderer::SetOption(Renderer_Option::ParallelRecording,        do_parallel_recording);
+    Renderer::SetOption(Renderer_Option::IndirectDrawing,          do_indirect_drawing);
+    Renderer::SetOption(Renderer_Option::ClusterCulling,           do_cluster_culling);
 }
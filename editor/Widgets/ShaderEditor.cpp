@@ -201,7 +201,7 @@ void ShaderEditor::ShowControls()
 
 void ShaderEditor::GetShaderInstances()
 {
-    array<shared_ptr<RHI_Shader>, 44> shaders = Renderer::GetShaders();
+    array<shared_ptr<RHI_Shader>, 46> shaders = Renderer::GetShaders();
     m_shaders.clear();
 
     for (const shared_ptr<RHI_Shader>& shader : shaders)
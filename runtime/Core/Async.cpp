@@ -0,0 +1,78 @@
+/*
+Copyright(c) 2016-2023 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ======
+#include "pch.h"
+#include "Async.h"
+//=================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace Spartan::Async
+{
+    namespace
+    {
+        static mutex mutex_main_thread;
+        static vector<coroutine_handle<>> main_thread_queue;
+        static atomic<thread::id> main_thread_id;
+    }
+
+    void QueueForMainThread(coroutine_handle<> handle)
+    {
+        lock_guard<mutex> lock(mutex_main_thread);
+        main_thread_queue.emplace_back(handle);
+    }
+
+    void Tick()
+    {
+        main_thread_id.store(this_thread::get_id(), memory_order_relaxed);
+
+        // Swap so that coroutines which queue themselves again are resumed next frame
+        vector<coroutine_handle<>> handles;
+        {
+            lock_guard<mutex> lock(mutex_main_thread);
+            handles.swap(main_thread_queue);
+        }
+
+        for (coroutine_handle<>& handle : handles)
+        {
+            handle.resume();
+        }
+    }
+
+    void WaitFor(const TaskPromiseBase& promise)
+    {
+        const bool is_main_thread = main_thread_id.load(memory_order_relaxed) == this_thread::get_id();
+
+        while (!promise.IsDone())
+        {
+            // The task may be queued for the main thread, so keep resuming the queue instead of blocking it
+            if (is_main_thread)
+            {
+                Tick();
+            }
+
+            this_thread::yield();
+        }
+    }
+}
@@ -0,0 +1,377 @@
+/*
+Copyright(c) 2016-2023 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ===========
+#include "Definitions.h"
+#include "ThreadPool.h"
+#include <atomic>
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+//======================
+
+/*
+HOW TO USE
+=====================================================================================
+A coroutine returning Async::Task<T> doesn't run until it's awaited or started.
+
+Async::Task<void> LoadStuff()
+{
+    co_await Async::RunOnWorker();         // continue on a thread pool worker
+    ...                                    // heavy lifting
+    co_await Async::ResumeOnMainThread();  // continue on the main thread, at frame start
+    ...                                    // touch the world, the renderer etc.
+}
+
+From regular code  -> LoadStuff().Detach(); or task.Start(); and poll task.IsDone() or task.Wait()
+From coroutines    -> co_await LoadStuff(); or co_await Async::WhenAll(std::move(tasks));
+
+Note: Destroying a task which has started but isn't done blocks until it's done, since
+its frame may still be queued on a worker or the main thread. Tasks which touch their
+owner should be told to bail out (e.g. with a flag) before the owner waits for them.
+=====================================================================================
+*/
+
+namespace Spartan::Async
+{
+    template<typename T = void>
+    class Task;
+
+    class TaskPromiseBase;
+
+    // Blocks until the promise is done, on the main thread coroutines waiting for it are resumed meanwhile
+    void WaitFor(const TaskPromiseBase& promise);
+
+    class TaskPromiseBase
+    {
+    public:
+        struct FinalAwaiter
+        {
+            bool await_ready() const noexcept { return false; }
+
+            template<typename Promise>
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept
+            {
+                TaskPromiseBase& promise = handle.promise();
+
+                // Detached tasks have no owner, so they clean up after themselves
+                if (promise.m_detached)
+                {
+                    handle.destroy();
+                    return std::noop_coroutine();
+                }
+
+                // The owner is free to destroy the frame as soon as it sees that the task is done, so don't touch it after that
+                std::coroutine_handle<> continuation = promise.m_continuation;
+                promise.m_done.store(true, std::memory_order_release);
+
+                return continuation ? continuation : std::noop_coroutine();
+            }
+
+            void await_resume() const noexcept {}
+        };
+
+        std::suspend_always initial_suspend() const noexcept { return {}; }
+        FinalAwaiter final_suspend()          const noexcept { return {}; }
+        void unhandled_exception()                  noexcept { m_exception = std::current_exception(); }
+
+        bool IsDone() const { return m_done.load(std::memory_order_acquire); }
+
+        std::coroutine_handle<> m_continuation;
+        std::exception_ptr m_exception;
+        std::atomic<bool> m_done = false;
+        bool m_detached          = false;
+    };
+
+    template<typename T>
+    class TaskPromise : public TaskPromiseBase
+    {
+    public:
+        Task<T> get_return_object() noexcept;
+
+        template<typename U>
+        void return_value(U&& value) { m_value.emplace(std::forward<U>(value)); }
+
+        T GetResult()
+        {
+            if (m_exception)
+            {
+                std::rethrow_exception(m_exception);
+            }
+
+            return std::move(*m_value);
+        }
+
+    private:
+        std::optional<T> m_value;
+    };
+
+    template<>
+    class TaskPromise<void> : public TaskPromiseBase
+    {
+    public:
+        Task<void> get_return_object() noexcept;
+
+        void return_void() noexcept {}
+
+        void GetResult()
+        {
+            if (m_exception)
+            {
+                std::rethrow_exception(m_exception);
+            }
+        }
+    };
+
+    template<typename T>
+    class Task
+    {
+    public:
+        using promise_type = TaskPromise<T>;
+        using handle_type  = std::coroutine_handle<promise_type>;
+
+        Task() = default;
+        explicit Task(handle_type handle) : m_handle(handle) {}
+        Task(Task&& other) noexcept : m_handle(std::exchange(other.m_handle, nullptr)), m_started(std::exchange(other.m_started, false)) {}
+        Task& operator=(Task&& other) noexcept
+        {
+            if (this != &other)
+            {
+                Destroy();
+                m_handle  = std::exchange(other.m_handle, nullptr);
+                m_started = std::exchange(other.m_started, false);
+            }
+
+            return *this;
+        }
+        Task(const Task&)            = delete;
+        Task& operator=(const Task&) = delete;
+        ~Task() { Destroy(); }
+
+        // Runs on the calling thread until the first suspension point, the task can then be polled with IsDone()
+        void Start()
+        {
+            SP_ASSERT_MSG(m_handle && !m_started, "The task is empty or has already started");
+
+            m_started = true;
+            m_handle.resume();
+        }
+
+        // Same as Start() but ownership is given up, the coroutine frees itself once it completes
+        void Detach()
+        {
+            SP_ASSERT_MSG(m_handle && !m_started, "The task is empty or has already started");
+
+            m_handle.promise().m_detached = true;
+            std::exchange(m_handle, nullptr).resume();
+        }
+
+        bool IsValid() const { return m_handle != nullptr; }
+        bool IsDone()  const { return !m_handle || m_handle.promise().IsDone(); }
+
+        // Blocks until a started task is done, it must not be waiting on a coroutine which only the caller can resume
+        void Wait()
+        {
+            if (m_handle && m_started)
+            {
+                WaitFor(m_handle.promise());
+            }
+        }
+
+        // Only valid once the task is done
+        T GetResult()
+        {
+            SP_ASSERT_MSG(IsDone(), "The task hasn't finished yet");
+            return m_handle.promise().GetResult();
+        }
+
+        // Awaiting a task starts it, the awaiting coroutine resumes (on whichever thread the task finished) with its result
+        auto operator co_await() noexcept
+        {
+            struct Awaiter
+            {
+                handle_type handle;
+
+                bool await_ready() const noexcept { return !handle; }
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+                {
+                    handle.promise().m_continuation = awaiting;
+                    return handle;
+                }
+                T await_resume() { return handle.promise().GetResult(); }
+            };
+
+            SP_ASSERT_MSG(!m_started, "Can't await a task which has already started");
+            m_started = true;
+
+            return Awaiter{ m_handle };
+        }
+
+        // Same as co_await but the result (or exception) is left in the task
+        auto WhenReady() noexcept
+        {
+            struct Awaiter
+            {
+                handle_type handle;
+
+                bool await_ready() const noexcept { return !handle; }
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+                {
+                    handle.promise().m_continuation = awaiting;
+                    return handle;
+                }
+                void await_resume() const noexcept {}
+            };
+
+            SP_ASSERT_MSG(!m_started, "Can't await a task which has already started");
+            m_started = true;
+
+            return Awaiter{ m_handle };
+        }
+
+    private:
+        void Destroy()
+        {
+            if (m_handle)
+            {
+                // The frame of a running task may be queued somewhere, destroying it would have it resumed after it's freed
+                Wait();
+
+                m_handle.destroy();
+                m_handle  = nullptr;
+                m_started = false;
+            }
+        }
+
+        handle_type m_handle = nullptr;
+        bool m_started       = false;
+    };
+
+    template<typename T>
+    Task<T> TaskPromise<T>::get_return_object() noexcept { return Task<T>(std::coroutine_handle<TaskPromise<T>>::from_promise(*this)); }
+    inline Task<void> TaskPromise<void>::get_return_object() noexcept { return Task<void>(std::coroutine_handle<TaskPromise<void>>::from_promise(*this)); }
+
+    // Resumes the coroutine on a thread pool worker
+    struct RunOnWorker
+    {
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> handle) const { ThreadPool::AddTask([handle]() { handle.resume(); }); }
+        void await_resume() const noexcept {}
+    };
+
+    // Queues a coroutine to be resumed on the main thread, at the start of the next frame
+    void QueueForMainThread(std::coroutine_handle<> handle);
+
+    // Resumes the coroutine on the main thread, at the start of the next frame
+    struct ResumeOnMainThread
+    {
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> handle) const { QueueForMainThread(handle); }
+        void await_resume() const noexcept {}
+    };
+
+    // Resumes any coroutines which are waiting for the main thread, called by the engine at the start of every frame
+    void Tick();
+
+    class WhenAllCounter
+    {
+    public:
+        void Arrive()
+        {
+            if (m_count.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            {
+                m_awaiting.resume();
+            }
+        }
+
+        std::atomic<uint32_t> m_count = 0;
+        std::coroutine_handle<> m_awaiting;
+    };
+
+    template<typename T>
+    Task<void> when_all_wrapper(Task<T>& task, WhenAllCounter& counter)
+    {
+        co_await task.WhenReady();
+        counter.Arrive();
+    }
+
+    template<typename T>
+    class WhenAllAwaiter
+    {
+    public:
+        WhenAllAwaiter(std::vector<Task<T>>& tasks) : m_tasks(tasks) {}
+
+        bool await_ready() const noexcept { return m_tasks.empty(); }
+
+        bool await_suspend(std::coroutine_handle<> awaiting)
+        {
+            // One extra count so that the awaiting coroutine can't be resumed while the tasks are still being started
+            m_counter.m_count    = static_cast<uint32_t>(m_tasks.size()) + 1;
+            m_counter.m_awaiting = awaiting;
+
+            for (Task<T>& task : m_tasks)
+            {
+                when_all_wrapper(task, m_counter).Detach();
+            }
+
+            // If everything finished already, don't suspend at all
+            return m_counter.m_count.fetch_sub(1, std::memory_order_acq_rel) != 1;
+        }
+
+        void await_resume() const noexcept {}
+
+    private:
+        std::vector<Task<T>>& m_tasks;
+        WhenAllCounter m_counter;
+    };
+
+    // Starts all the tasks and resumes once all of them are done, the results are returned in the same order
+    template<typename T> requires (!std::is_void_v<T>)
+    Task<std::vector<T>> WhenAll(std::vector<Task<T>> tasks)
+    {
+        co_await WhenAllAwaiter<T>(tasks);
+
+        std::vector<T> results;
+        results.reserve(tasks.size());
+        for (Task<T>& task : tasks)
+        {
+            results.emplace_back(task.GetResult());
+        }
+
+        co_return results;
+    }
+
+    inline Task<void> WhenAll(std::vector<Task<void>> tasks)
+    {
+        co_await WhenAllAwaiter<void>(tasks);
+
+        // Propagate any exceptions
+        for (Task<void>& task : tasks)
+        {
+            task.GetResult();
+        }
+    }
+}
@@ -21,6 +21,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 //= INCLUDES ================================
 #include "pch.h"
+#include "Async.h"
 #include "Window.h"
 #include "ThreadPool.h"
 #include "../Audio/Audio.h"
@@ -93,6 +94,7 @@ namespace Spartan
     {
         // Pre-tick
         Profiler::PreTick();
+        Async::Tick();
         World::PreTick();
 
         // Tick
@@ -100,6 +102,7 @@ namespace Spartan
         Input::Tick();
         Physics::Tick();
         Audio::Tick();
+        Event::Tick(); // deferred events, before the world resolves
         World::Tick();
         Renderer::Tick();
 
@@ -33,6 +33,63 @@ namespace Spartan
     namespace
     {
         static array<vector<subscriber>, 16> event_subscribers;
+
+        struct QueuedEvent
+        {
+            EventType type;
+            sp_variant data;
+            QueuedEvent* next = nullptr;
+        };
+
+        // Multi-producer single-consumer, producers push onto the head and the consumer takes the whole list at once
+        static atomic<QueuedEvent*> queue_head = nullptr;
+        static vector<QueuedEvent*> queue_batch;
+
+        // Identifies an event by its type and data, for coalescing
+        struct EventKey
+        {
+            uint32_t type       = 0;
+            uint32_t data_index = 0;
+            uintptr_t data      = 0;
+
+            bool operator==(const EventKey& other) const { return type == other.type && data_index == other.data_index && data == other.data; }
+        };
+
+        struct EventKeyHash
+        {
+            size_t operator()(const EventKey& key) const
+            {
+                return hash<uintptr_t>()(key.data) ^ (static_cast<size_t>(key.type) << 8 | key.data_index);
+            }
+        };
+        static unordered_set<EventKey, EventKeyHash> queue_keys;
+
+        static EventKey get_key(const QueuedEvent* event)
+        {
+            EventKey key;
+            key.type       = static_cast<uint32_t>(event->type);
+            key.data_index = static_cast<uint32_t>(event->data.index());
+
+            if (const int* value = get_if<int>(&event->data))
+            {
+                key.data = static_cast<uintptr_t>(*value);
+            }
+            else if (void* const* value = get_if<void*>(&event->data))
+            {
+                key.data = reinterpret_cast<uintptr_t>(*value);
+            }
+            else if (const weak_ptr<Entity>* value = get_if<weak_ptr<Entity>>(&event->data))
+            {
+                key.data = reinterpret_cast<uintptr_t>(value->lock().get());
+            }
+
+            return key;
+        }
+
+        static QueuedEvent* queue_take_all()
+        {
+            return queue_head.exchange(nullptr, memory_order_acquire);
+        }
     }
 
     void Event::Shutdown()
@@ -41,6 +98,15 @@ namespace Spartan
         {
             subscribers.clear();
         }
+
+        // Drop anything that was never dispatched
+        QueuedEvent* event = queue_take_all();
+        while (event)
+        {
+            QueuedEvent* next = event->next;
+            delete event;
+            event = next;
+        }
     }
 
     void Event::Subscribe(const EventType event_type, subscriber&& function)
@@ -48,11 +114,50 @@ namespace Spartan
         event_subscribers[static_cast<uint32_t>(event_type)].push_back(forward<subscriber>(function));
     }
 
-    void Event::Fire(const EventType event_type, sp_variant data /*= 0*/)
+    void Event::Fire(const EventType event_type, const sp_variant& data /*= 0*/)
     {
         for (const auto& subscriber : event_subscribers[static_cast<uint32_t>(event_type)])
         {
             subscriber(data);
         }
     }
+
+    void Event::Enqueue(const EventType event_type, const sp_variant& data /*= 0*/)
+    {
+        QueuedEvent* event = new QueuedEvent();
+        event->type        = event_type;
+        event->data        = data;
+        event->next        = queue_head.load(memory_order_relaxed);
+
+        while (!queue_head.compare_exchange_weak(event->next, event, memory_order_release, memory_order_relaxed));
+    }
+
+    void Event::Tick()
+    {
+        // Events enqueued by subscribers from here on go to the next batch
+        QueuedEvent* event = queue_take_all();
+        if (!event)
+            return;
+
+        // The list is newest first, dispatch in the order the events were enqueued
+        queue_batch.clear();
+        for (; event; event = event->next)
+        {
+            queue_batch.emplace_back(event);
+        }
+        reverse(queue_batch.begin(), queue_batch.end());
+
+        queue_keys.clear();
+        for (QueuedEvent* queued : queue_batch)
+        {
+            // Only the first of identical events is dispatched
+            if (queue_keys.insert(get_key(queued)).second)
+            {
+                Fire(queued->type, queued->data);
+            }
+
+            delete queued;
+        }
+        queue_batch.clear();
+    }
 }
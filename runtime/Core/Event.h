@@ -23,6 +23,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 //= INCLUDES ========
 #include <functional>
+#include <memory>
 #include <variant>
 //===================
 
@@ -32,23 +33,31 @@ HOW TO USE
 To subscribe a function to an event -> SP_SUBSCRIBE_TO_EVENT(EVENT_ID, Handler);
 To fire an event                    -> SP_FIRE_EVENT(EVENT_ID);
 To fire an event with data          -> SP_FIRE_EVENT_DATA(EVENT_ID, Variant);
+To enqueue an event                 -> SP_ENQUEUE_EVENT(EVENT_ID);
+To enqueue an event with data       -> SP_ENQUEUE_EVENT_DATA(EVENT_ID, Variant);
 
-Note: This is a blocking event system
+Note: Firing is blocking, subscribers run on the calling thread.
+Enqueuing can be done from any thread, queued events are dispatched on
+the main thread once per frame, and identical ones (same event and data)
+are coalesced into one.
 ================================================================================
 */
 
 //= MACROS ===============================================================================================
-#define SP_EVENT_HANDLER_EXPRESSION(expression)        [this](Spartan::sp_variant var)  { expression }
-#define SP_EVENT_HANDLER_EXPRESSION_STATIC(expression) [](Spartan::sp_variant var)      { expression }
+#define SP_EVENT_HANDLER_EXPRESSION(expression)        [this](const Spartan::sp_variant& var)  { expression }
+#define SP_EVENT_HANDLER_EXPRESSION_STATIC(expression) [](const Spartan::sp_variant& var)      { expression }
 
-#define SP_EVENT_HANDLER(function)                     [this](Spartan::sp_variant var)  { function(); }
-#define SP_EVENT_HANDLER_STATIC(function)              [](Spartan::sp_variant var)      { function(); }
+#define SP_EVENT_HANDLER(function)                     [this](const Spartan::sp_variant& var)  { function(); }
+#define SP_EVENT_HANDLER_STATIC(function)              [](const Spartan::sp_variant& var)      { function(); }
                                                                                      
-#define SP_EVENT_HANDLER_VARIANT(function)             [this](Spartan::sp_variant var)  { function(var); }
-#define SP_EVENT_HANDLER_VARIANT_STATIC(function)      [](Spartan::sp_variant var)      { function(var); }
+#define SP_EVENT_HANDLER_VARIANT(function)             [this](const Spartan::sp_variant& var)  { function(var); }
+#define SP_EVENT_HANDLER_VARIANT_STATIC(function)      [](const Spartan::sp_variant& var)      { function(var); }
                                                        
 #define SP_FIRE_EVENT(event_enum)                      Spartan::Event::Fire(event_enum)
 #define SP_FIRE_EVENT_DATA(event_enum, data)           Spartan::Event::Fire(event_enum, data)
+
+#define SP_ENQUEUE_EVENT(event_enum)                   Spartan::Event::Enqueue(event_enum)
+#define SP_ENQUEUE_EVENT_DATA(event_enum, data)        Spartan::Event::Enqueue(event_enum, data)
                                                        
 #define SP_SUBSCRIBE_TO_EVENT(event_enum, function)    Spartan::Event::Subscribe(event_enum, function);
 //========================================================================================================
@@ -82,11 +91,11 @@ namespace Spartan
 
     class Entity;
 
+    // Payloads are small, large data is passed by pointer or handle
     using sp_variant = std::variant<
         int,
         void*,
-        std::vector<std::shared_ptr<Entity>>
-
+        std::weak_ptr<Entity>
     >;
     using subscriber = std::function<void(const sp_variant&)>;
 
@@ -95,6 +104,12 @@ namespace Spartan
     public:
         static void Shutdown();
         static void Subscribe(const EventType event_type, subscriber&& function);
-        static void Fire(const EventType event_type, sp_variant data = 0);
+        static void Fire(const EventType event_type, const sp_variant& data = 0);
+
+        // Lock-free, can be called from any thread, the event is dispatched by the next Tick()
+        static void Enqueue(const EventType event_type, const sp_variant& data = 0);
+
+        // Dispatches (on the calling thread) the events enqueued so far, called by the engine once per frame
+        static void Tick();
     };
 }
@@ -39,15 +39,16 @@ namespace Spartan
     {
     public:
         Object();
+        virtual ~Object() = default;
         
-        // Name
-        const std::string& GetObjectName()    const { return m_object_name; }
-        void SetObjectName(const std::string& name) { m_object_name = name; }
-
-        // Id
-        const uint64_t GetObjectId()        const { return m_object_id; }
-        void SetObjectId(const uint64_t id)       { m_object_id = id; }
-        static uint64_t GenerateObjectId()        { return ++g_id; }
+        // Name, virtual since entities are indexed by it
+        const std::string& GetObjectName()            const { return m_object_name; }
+        virtual void SetObjectName(const std::string& name) { m_object_name = name; }
+
+        // Id, virtual since entities are indexed by it
+        const uint64_t GetObjectId()                const { return m_object_id; }
+        virtual void SetObjectId(const uint64_t id)       { m_object_id = id; }
+        static uint64_t GenerateObjectId()                { return ++g_id; }
 
         // CPU & GPU sizes
         const uint64_t GetObjectSizeCpu() const { return m_object_size_cpu; }
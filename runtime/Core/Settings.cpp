@@ -43,7 +43,7 @@ namespace Spartan
     string file_path                       = "spartan.ini";
     ofstream fout;
     ifstream fin;
-    static std::array<float, 34> m_render_options;
+    static std::array<float, 41> m_render_options;
     static std::vector<third_party_lib> m_third_party_libs;
 
     template <class T>
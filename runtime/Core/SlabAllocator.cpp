@@ -0,0 +1,146 @@
+/*
+Copyright(c) 2016-2023 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES =============
+#include "pch.h"
+#include "SlabAllocator.h"
+//========================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace Spartan
+{
+    namespace
+    {
+        mutex registry_mutex;
+        vector<SlabAllocator*>* registry = nullptr;
+    }
+
+    SlabAllocator::SlabAllocator(const char* name, const uint32_t blocks_per_chunk)
+    {
+        SP_ASSERT(blocks_per_chunk != 0);
+
+        m_name             = name;
+        m_blocks_per_chunk = blocks_per_chunk;
+
+        lock_guard<mutex> lock(registry_mutex);
+        if (!registry)
+        {
+            // Never freed, allocators can register from static initialization
+            registry = new vector<SlabAllocator*>();
+        }
+        registry->emplace_back(this);
+    }
+
+    SlabAllocator::~SlabAllocator()
+    {
+        {
+            lock_guard<mutex> lock(registry_mutex);
+            registry->erase(remove(registry->begin(), registry->end(), this), registry->end());
+        }
+
+        for (byte* chunk : m_chunks)
+        {
+            ::operator delete(chunk, align_val_t(m_block_alignment));
+        }
+    }
+
+    void* SlabAllocator::Allocate(const size_t size, const size_t alignment)
+    {
+        lock_guard<mutex> lock(m_mutex);
+
+        // The block size is only known once the first allocation asks for it
+        if (m_block_size == 0)
+        {
+            m_block_alignment = max(alignment, alignof(FreeBlock));
+            m_block_size      = (max(size, sizeof(FreeBlock)) + m_block_alignment - 1) & ~(m_block_alignment - 1);
+        }
+        SP_ASSERT_MSG(size <= m_block_size && alignment <= m_block_alignment, "All allocations must fit the first one");
+
+        if (!m_free)
+        {
+            byte* chunk = static_cast<byte*>(::operator new(m_block_size * m_blocks_per_chunk, align_val_t(m_block_alignment)));
+            m_chunks.emplace_back(chunk);
+
+            // Thread the new blocks into the free list, in address order
+            for (uint32_t i = m_blocks_per_chunk; i > 0; i--)
+            {
+                FreeBlock* block = new (chunk + (i - 1) * m_block_size) FreeBlock();
+                block->next      = m_free;
+                m_free           = block;
+            }
+        }
+
+        FreeBlock* block = m_free;
+        m_free           = block->next;
+        m_blocks_used++;
+
+        return block;
+    }
+
+    void SlabAllocator::Deallocate(void* block)
+    {
+        if (!block)
+            return;
+
+        lock_guard<mutex> lock(m_mutex);
+
+        FreeBlock* free_block = new (block) FreeBlock();
+        free_block->next      = m_free;
+        m_free                = free_block;
+        m_blocks_used--;
+    }
+
+    SlabStats SlabAllocator::GetStats()
+    {
+        lock_guard<mutex> lock(m_mutex);
+
+        SlabStats stats;
+        stats.name           = m_name;
+        stats.block_size     = m_block_size;
+        stats.chunk_count    = static_cast<uint32_t>(m_chunks.size());
+        stats.blocks_used    = m_blocks_used;
+        stats.blocks_total   = stats.chunk_count * m_blocks_per_chunk;
+        stats.bytes_reserved = static_cast<uint64_t>(stats.blocks_total) * m_block_size;
+        stats.fragmentation  = stats.blocks_total != 0 ? 1.0f - static_cast<float>(m_blocks_used) / static_cast<float>(stats.blocks_total) : 0.0f;
+
+        return stats;
+    }
+
+    vector<SlabStats> SlabAllocator::GetStatsAll()
+    {
+        lock_guard<mutex> lock(registry_mutex);
+
+        vector<SlabStats> stats;
+        if (registry)
+        {
+            stats.reserve(registry->size());
+            for (SlabAllocator* allocator : *registry)
+            {
+                stats.emplace_back(allocator->GetStats());
+            }
+        }
+
+        return stats;
+    }
+}
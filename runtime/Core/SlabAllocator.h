@@ -0,0 +1,102 @@
+/*
+Copyright(c) 2016-2023 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ===========
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "Definitions.h"
+//======================
+
+namespace Spartan
+{
+    struct SlabStats
+    {
+        std::string name;
+        uint64_t block_size     = 0;
+        uint32_t chunk_count    = 0;
+        uint32_t blocks_used    = 0;
+        uint32_t blocks_total   = 0;
+        uint64_t bytes_reserved = 0;
+        float fragmentation     = 0.0f; // fraction of reserved blocks which are free
+    };
+
+    // Fixed size block allocator. Memory is reserved in chunks of blocks_per_chunk blocks and
+    // released blocks go into a free list, so objects of the same type recycle each other's memory.
+    // The block size is fixed by the first allocation. Chunks are only freed when the allocator is destroyed.
+    class SP_CLASS SlabAllocator
+    {
+    public:
+        SlabAllocator(const char* name, const uint32_t blocks_per_chunk = 64);
+        ~SlabAllocator();
+
+        void* Allocate(const std::size_t size, const std::size_t alignment);
+        void Deallocate(void* block);
+        SlabStats GetStats();
+
+        // Stats of every allocator alive
+        static std::vector<SlabStats> GetStatsAll();
+
+    private:
+        struct FreeBlock
+        {
+            FreeBlock* next = nullptr;
+        };
+
+        std::string m_name;
+        uint32_t m_blocks_per_chunk   = 0;
+        std::size_t m_block_size      = 0;
+        std::size_t m_block_alignment = 0;
+        uint32_t m_blocks_used        = 0;
+        FreeBlock* m_free             = nullptr;
+        std::vector<std::byte*> m_chunks;
+        std::mutex m_mutex;
+    };
+
+    // Adapter for std::allocate_shared, so the object and its control block live in one slab block
+    template <class T>
+    struct SlabAllocatorStl
+    {
+        using value_type = T;
+
+        SlabAllocatorStl(SlabAllocator* slab) : slab(slab) {}
+        template <class U> SlabAllocatorStl(const SlabAllocatorStl<U>& other) : slab(other.slab) {}
+
+        T* allocate(std::size_t count)
+        {
+            SP_ASSERT(count == 1);
+            return static_cast<T*>(slab->Allocate(sizeof(T), alignof(T)));
+        }
+
+        void deallocate(T* ptr, std::size_t)
+        {
+            slab->Deallocate(ptr);
+        }
+
+        template <class U> bool operator==(const SlabAllocatorStl<U>& other) const { return slab == other.slab; }
+        template <class U> bool operator!=(const SlabAllocatorStl<U>& other) const { return slab != other.slab; }
+
+        SlabAllocator* slab = nullptr;
+    };
+}
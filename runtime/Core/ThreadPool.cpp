@@ -30,65 +30,364 @@ using namespace std;
 
 namespace Spartan
 {
+    struct alignas(64) Job
+    {
+        Task task;
+        Job* parent = nullptr;
+        atomic<uint32_t> unfinished_jobs = 0; // the job itself plus any children which haven't finished yet
+        atomic<uint32_t> generation      = 0; // incremented every time the job slot is recycled
+    };
+
     namespace
     {
+        // Chase-Lev work stealing deque.
+        // The owning thread pushes and pops from the bottom (LIFO), other threads steal from the top (FIFO).
+        class WorkStealingQueue
+        {
+        public:
+            bool Push(Job* job)
+            {
+                int64_t bottom = m_bottom.load(memory_order_relaxed);
+                int64_t top    = m_top.load(memory_order_acquire);
+
+                if (bottom - top >= static_cast<int64_t>(capacity))
+                    return false;
+
+                m_jobs[bottom & mask].store(job, memory_order_relaxed);
+                atomic_thread_fence(memory_order_release);
+                m_bottom.store(bottom + 1, memory_order_relaxed);
+
+                return true;
+            }
+
+            Job* Pop()
+            {
+                int64_t bottom = m_bottom.load(memory_order_relaxed) - 1;
+                m_bottom.store(bottom, memory_order_relaxed);
+                atomic_thread_fence(memory_order_seq_cst);
+                int64_t top = m_top.load(memory_order_relaxed);
+
+                if (top > bottom) // empty
+                {
+                    m_bottom.store(bottom + 1, memory_order_relaxed);
+                    return nullptr;
+                }
+
+                Job* job = m_jobs[bottom & mask].load(memory_order_relaxed);
+
+                // Last job in the queue, race against any thieves
+                if (top == bottom)
+                {
+                    if (!m_top.compare_exchange_strong(top, top + 1, memory_order_seq_cst, memory_order_relaxed))
+                    {
+                        job = nullptr;
+                    }
+
+                    m_bottom.store(bottom + 1, memory_order_relaxed);
+                }
+
+                return job;
+            }
+
+            Job* Steal()
+            {
+                int64_t top = m_top.load(memory_order_acquire);
+                atomic_thread_fence(memory_order_seq_cst);
+                int64_t bottom = m_bottom.load(memory_order_acquire);
+
+                if (top >= bottom) // empty
+                    return nullptr;
+
+                Job* job = m_jobs[top & mask].load(memory_order_relaxed);
+                if (!m_top.compare_exchange_strong(top, top + 1, memory_order_seq_cst, memory_order_relaxed))
+                    return nullptr; // lost the race against another thief or the owner
+
+                return job;
+            }
+
+        private:
+            static const uint32_t capacity = 4096; // must be a power of two
+            static const uint32_t mask     = capacity - 1;
+
+            alignas(64) atomic<int64_t> m_top    = 0;
+            alignas(64) atomic<int64_t> m_bottom = 0;
+            array<atomic<Job*>, capacity> m_jobs;
+        };
+
+        // A ring of recycled jobs, every thread which submits jobs gets its own.
+        class JobPool
+        {
+        public:
+            JobPool() : m_jobs(capacity) {}
+
+            Job* Allocate()
+            {
+                // A slot can be recycled once the job (and any children it had) has finished
+                for (uint32_t i = 0; i < capacity; i++)
+                {
+                    Job* job = &m_jobs[m_index++ & mask];
+                    if (job->unfinished_jobs.load(memory_order_acquire) == 0)
+                        return job;
+                }
+
+                return nullptr;
+            }
+
+        private:
+            static const uint32_t capacity = 2048; // must be a power of two
+            static const uint32_t mask     = capacity - 1;
+
+            vector<Job> m_jobs;
+            uint32_t m_index = 0;
+        };
+
         // Stats
         static uint32_t thread_count                 = 0;
         static atomic<uint32_t> working_thread_count = 0;
 
-        // Sync objects
-        static mutex mutex_tasks;
+        // Jobs
+        static atomic<uint32_t> jobs_in_flight = 0; // submitted but not finished
+        static atomic<uint32_t> jobs_queued    = 0; // submitted but not picked up by any thread yet
+
+        // Queues, index 0 belongs to the thread which initialized the pool, the rest belong to the worker threads
+        static vector<unique_ptr<WorkStealingQueue>> queues;
+        static thread_local int32_t queue_index = -1;
+
+        // Jobs submitted by threads which don't own a queue
+        static mutex mutex_jobs_external;
+        static deque<Job*> jobs_external;
+
+        // Job pools
+        static mutex mutex_job_pools;
+        static vector<unique_ptr<JobPool>> job_pools;
+        static thread_local JobPool* job_pool = nullptr;
+
+        // Sleeping
+        static mutex mutex_sleep;
         static condition_variable condition_var;
+        static atomic<uint32_t> sleeping_thread_count = 0;
 
         // Threads
         static vector<thread> threads;
 
-        // Tasks
-        static deque<Task> tasks;
-
         // Misc
-        static bool is_stopping;
+        static atomic<bool> is_stopping   = false;
+        static atomic<bool> is_discarding = false;
+    }
+
+    static Job* get_job()
+    {
+        Job* job = nullptr;
+
+        // Own queue first
+        if (queue_index >= 0)
+        {
+            job = queues[queue_index]->Pop();
+        }
+
+        // Then jobs from external threads
+        if (!job)
+        {
+            lock_guard<mutex> lock(mutex_jobs_external);
+            if (!jobs_external.empty())
+            {
+                job = jobs_external.front();
+                jobs_external.pop_front();
+            }
+        }
+
+        // Then try to steal from the rest
+        if (!job)
+        {
+            const uint32_t queue_count = static_cast<uint32_t>(queues.size());
+            const uint32_t offset      = static_cast<uint32_t>(queue_index + 1);
+            for (uint32_t i = 0; i < queue_count && !job; i++)
+            {
+                uint32_t victim = (offset + i) % queue_count;
+                if (static_cast<int32_t>(victim) != queue_index)
+                {
+                    job = queues[victim]->Steal();
+                }
+            }
+        }
+
+        if (job)
+        {
+            jobs_queued--;
+        }
+
+        return job;
+    }
+
+    static void finish_job(Job* job)
+    {
+        // Read the parent before decrementing, as the job can be recycled right after
+        Job* parent = job->parent;
+
+        if (job->unfinished_jobs.fetch_sub(1, memory_order_acq_rel) == 1)
+        {
+            if (parent)
+            {
+                finish_job(parent);
+            }
+
+            jobs_in_flight--;
+        }
+    }
+
+    static void execute_job(Job* job)
+    {
+        if (!is_discarding)
+        {
+            job->task();
+        }
+
+        // Release anything the task has captured
+        job->task.Reset();
+
+        finish_job(job);
+    }
+
+    static bool execute_next_job()
+    {
+        if (Job* job = get_job())
+        {
+            execute_job(job);
+            return true;
+        }
+
+        return false;
     }
 
-    static void thread_loop()
+    static Job* allocate_job(Task&& task, Job* parent)
     {
-        while (true)
+        if (!job_pool)
+        {
+            lock_guard<mutex> lock(mutex_job_pools);
+            job_pools.emplace_back(make_unique<JobPool>());
+            job_pool = job_pools.back().get();
+        }
+
+        // If all the slots are in use, help out until one frees up
+        Job* job = job_pool->Allocate();
+        while (!job)
+        {
+            if (!execute_next_job())
+            {
+                this_thread::yield();
+            }
+
+            job = job_pool->Allocate();
+        }
+
+        job->task   = move(task);
+        job->parent = parent;
+        job->generation.fetch_add(1, memory_order_relaxed);
+        job->unfinished_jobs.store(1, memory_order_release);
+
+        if (parent)
         {
-            // Lock tasks mutex
-            unique_lock<mutex> lock(mutex_tasks);
+            parent->unfinished_jobs.fetch_add(1, memory_order_acq_rel);
+        }
+
+        jobs_in_flight++;
 
-            // Check condition on notification
-            condition_var.wait(lock, [] { return !tasks.empty() || is_stopping; });
+        return job;
+    }
 
-            // If m_stopping is true, it's time to shut everything down
-            if (is_stopping && tasks.empty())
+    static void submit_job(Job* job)
+    {
+        jobs_queued++;
+
+        bool pushed = queue_index >= 0 && queues[queue_index]->Push(job);
+        if (!pushed)
+        {
+            if (queue_index >= 0)
+            {
+                // The queue is full, no point in queuing more, just do the work
+                jobs_queued--;
+                execute_job(job);
                 return;
+            }
 
-            // Get next task in the queue.
-            Task task = tasks.front();
+            lock_guard<mutex> lock(mutex_jobs_external);
+            jobs_external.emplace_back(job);
+        }
 
-            // Remove it from the queue.
-            tasks.pop_front();
+        // Wake up a thread, locking ensures that the notification can't slip in between a thread's check and its wait
+        if (sleeping_thread_count.load() > 0)
+        {
+            lock_guard<mutex> lock(mutex_sleep);
+        }
+        condition_var.notify_one();
+    }
+
+    static void thread_loop(const int32_t index)
+    {
+        queue_index = index;
+
+        const uint32_t spin_count_max = 64;
+        uint32_t spin_count           = 0;
+
+        while (!is_stopping)
+        {
+            if (Job* job = get_job())
+            {
+                working_thread_count++;
+                execute_job(job);
+                working_thread_count--;
+
+                spin_count = 0;
+                continue;
+            }
 
-            // Unlock the mutex
-            lock.unlock();
+            // Spin for a bit, work often arrives in bursts
+            if (spin_count++ < spin_count_max)
+            {
+                this_thread::yield();
+                continue;
+            }
 
-            // Execute the task.
-            working_thread_count++;
-            task();
-            working_thread_count--;
+            // Sleep until there is work
+            unique_lock<mutex> lock(mutex_sleep);
+            sleeping_thread_count++;
+            condition_var.wait(lock, [] { return jobs_queued.load() > 0 || is_stopping; });
+            sleeping_thread_count--;
+            spin_count = 0;
         }
     }
 
+    bool JobHandle::IsDone() const
+    {
+        if (!m_job)
+            return true;
+
+        // If the slot has been recycled, the job we are referring to is long done
+        if (m_job->generation.load(memory_order_acquire) != m_generation)
+            return true;
+
+        bool done = m_job->unfinished_jobs.load(memory_order_acquire) == 0;
+
+        // Check again, in case the slot was recycled while reading
+        return done || m_job->generation.load(memory_order_acquire) != m_generation;
+    }
+
     void ThreadPool::Initialize()
     {
         is_stopping                      = false;
         uint32_t concurrent_thread_count = thread::hardware_concurrency();
-        thread_count                     = concurrent_thread_count - 1; // exclude the calling thread
+        thread_count                     = concurrent_thread_count > 1 ? concurrent_thread_count - 1 : 1; // exclude the calling thread
+
+        // One queue for the calling thread and one for each worker
+        for (uint32_t i = 0; i < thread_count + 1; i++)
+        {
+            queues.emplace_back(make_unique<WorkStealingQueue>());
+        }
+        queue_index = 0;
 
         for (uint32_t i = 0; i < thread_count; i++)
         {
-            threads.emplace_back(thread(&thread_loop));
+            threads.emplace_back(thread(&thread_loop, static_cast<int32_t>(i + 1)));
         }
 
         SP_LOG_INFO("%d threads have been created", thread_count);
@@ -98,14 +397,11 @@ namespace Spartan
     {
         Flush(true);
 
-        // Put unique lock on task mutex.
-        unique_lock<mutex> lock(mutex_tasks);
-
         // Set termination flag to true.
-        is_stopping = true;
-
-        // Unlock the mutex
-        lock.unlock();
+        {
+            lock_guard<mutex> lock(mutex_sleep);
+            is_stopping = true;
+        }
 
         // Wake up all threads.
         condition_var.notify_all();
@@ -120,80 +416,107 @@ namespace Spartan
         threads.clear();
     }
 
-    void ThreadPool::AddTask(Task&& task)
+    JobHandle ThreadPool::AddTask(Task&& task)
     {
-        // Lock tasks mutex
-        unique_lock<mutex> lock(mutex_tasks);
+        Job* job              = allocate_job(move(task), nullptr);
+        const JobHandle handle = JobHandle(job, job->generation.load(memory_order_relaxed));
+        submit_job(job);
 
-        // Save the task
-        tasks.emplace_back(bind(forward<Task>(task)));
+        return handle;
+    }
 
-        // Unlock the mutex
-        lock.unlock();
+    JobHandle ThreadPool::AddTask(Task&& task, const JobHandle& parent)
+    {
+        SP_ASSERT_MSG(!parent.IsDone(), "Can't add a child to a job which has already finished");
 
-        // Wake up a thread
-        condition_var.notify_one();
+        Job* job               = allocate_job(move(task), parent.GetJob());
+        const JobHandle handle = JobHandle(job, job->generation.load(memory_order_relaxed));
+        submit_job(job);
+
+        return handle;
     }
 
-    void ThreadPool::ParallelLoop(function<void(uint32_t work_index_start, uint32_t work_index_end)>&& function, uint32_t loop_range)
+    void ThreadPool::Wait(const JobHandle& handle)
     {
-        SP_ASSERT_MSG(loop_range > 1, "A parallel loop can't have a range of 1 or smaller");
+        while (!handle.IsDone())
+        {
+            if (!execute_next_job())
+            {
+                this_thread::yield();
+            }
+        }
+    }
+
+    void ThreadPool::ParallelFor(const function<void(uint32_t work_index_start, uint32_t work_index_end)>& function, uint32_t work_count)
+    {
+        if (work_count == 0)
+            return;
 
-        uint32_t available_threads = GetIdleThreadCount();
-        uint32_t work_total        = loop_range;
-        uint32_t work_per_thread   = work_total / available_threads;
-        uint32_t work_remainder    = work_total % available_threads;
-        uint32_t work_index        = 0;
-        atomic<uint32_t> work_done = 0;
-        condition_variable cv;
-        mutex cv_m;
+        // Split into more batches than threads, so that threads which finish early can steal the rest
+        const uint32_t batch_count = min(work_count, (thread_count + 1) * 4);
+        const uint32_t batch_size  = work_count / batch_count;
+        uint32_t work_remainder    = work_count % batch_count;
 
-        // Split work into multiple tasks
-        while (work_index < work_total)
+        if (batch_count == 1)
         {
-            uint32_t work_to_do = work_per_thread;
+            function(0, work_count);
+            return;
+        }
 
-            // If the work doesn't divide evenly across threads, add the remainder work to the first thread.
+        // An empty parent job which all the batches are children of
+        Job* parent                   = allocate_job(Task(), nullptr);
+        const JobHandle handle_parent = JobHandle(parent, parent->generation.load(memory_order_relaxed));
+
+        uint32_t work_index = 0;
+        for (uint32_t i = 0; i < batch_count; i++)
+        {
+            // Spread the remainder over the first batches
+            uint32_t work_to_do = batch_size;
             if (work_remainder != 0)
             {
-                work_to_do     += work_remainder;
-                work_remainder = 0;
+                work_to_do++;
+                work_remainder--;
             }
 
-            AddTask([&function, &work_done, &cv, work_index, work_to_do]()
+            const uint32_t work_index_start = work_index;
+            const uint32_t work_index_end   = work_index + work_to_do;
+            submit_job(allocate_job([&function, work_index_start, work_index_end]()
             {
-                function(work_index, work_index + work_to_do);
-                work_done += work_to_do;
+                function(work_index_start, work_index_end);
+            }, parent));
 
-                cv.notify_one(); // notify that a thread has finished its work
-            });
-
-            work_index += work_to_do;
+            work_index = work_index_end;
         }
 
-        // Wait for threads to finish work
-        unique_lock<mutex> lk(cv_m);
-        cv.wait(lk, [&]() { return work_done == work_total; });
-    }
+        // The parent has no work of its own, so it's done as soon as its children are
+        finish_job(parent);
 
+        // Help out instead of sleeping
+        Wait(handle_parent);
+    }
 
     void ThreadPool::Flush(bool remove_queued /*= false*/)
     {
-        // Clear any queued tasks
+        // Queued jobs are still dequeued, but they are completed without executing their task
         if (remove_queued)
         {
-            tasks.clear();
+            is_discarding = true;
         }
 
-        // If so, wait for them
+        // Help out until everything is done
         while (AreTasksRunning())
         {
-            this_thread::sleep_for(chrono::milliseconds(16));
+            if (!execute_next_job())
+            {
+                this_thread::yield();
+            }
         }
+
+        is_discarding = false;
     }
 
     uint32_t ThreadPool::GetThreadCount()        { return thread_count; }
     uint32_t ThreadPool::GetWorkingThreadCount() { return working_thread_count; }
     uint32_t ThreadPool::GetIdleThreadCount()    { return thread_count - working_thread_count; }
-    bool ThreadPool::AreTasksRunning()           { return GetIdleThreadCount() != GetThreadCount(); }
+    bool ThreadPool::AreTasksRunning()           { return jobs_in_flight > 0; }
 }
@@ -24,11 +24,125 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //= INCLUDES ===========
 #include "Definitions.h"
 #include <functional>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
 //======================
 
 namespace Spartan
 {
-    using Task = std::function<void()>;
+    // A type-erased callable which stores small callables (most lambdas) inline,
+    // so unlike std::function, submitting a task doesn't hit the heap.
+    class SP_CLASS Task
+    {
+    public:
+        Task() = default;
+
+        template<typename F, typename = std::enable_if_t<!std::is_same_v<std::decay_t<F>, Task>>>
+        Task(F&& function)
+        {
+            using T = std::decay_t<F>;
+
+            if constexpr (sizeof(T) <= storage_size && alignof(T) <= alignof(std::max_align_t) && std::is_nothrow_move_constructible_v<T>)
+            {
+                new (m_storage) T(std::forward<F>(function));
+                m_ops = &ops_inline<T>;
+            }
+            else // too big, fall back to the heap
+            {
+                *reinterpret_cast<T**>(m_storage) = new T(std::forward<F>(function));
+                m_ops = &ops_heap<T>;
+            }
+        }
+
+        Task(Task&& other) noexcept { MoveFrom(other); }
+        Task& operator=(Task&& other) noexcept
+        {
+            if (this != &other)
+            {
+                Reset();
+                MoveFrom(other);
+            }
+
+            return *this;
+        }
+        Task(const Task&)            = delete;
+        Task& operator=(const Task&) = delete;
+        ~Task() { Reset(); }
+
+        void operator()()              { m_ops->invoke(m_storage); }
+        explicit operator bool() const { return m_ops != nullptr; }
+
+        void Reset()
+        {
+            if (m_ops)
+            {
+                m_ops->destroy(m_storage);
+                m_ops = nullptr;
+            }
+        }
+
+    private:
+        struct Ops
+        {
+            void (*invoke)(void* storage);
+            void (*move)(void* storage_dst, void* storage_src);
+            void (*destroy)(void* storage);
+        };
+
+        template<typename T>
+        static constexpr Ops ops_inline =
+        {
+            [](void* storage)                         { (*static_cast<T*>(storage))(); },
+            [](void* storage_dst, void* storage_src)  { new (storage_dst) T(std::move(*static_cast<T*>(storage_src))); static_cast<T*>(storage_src)->~T(); },
+            [](void* storage)                         { static_cast<T*>(storage)->~T(); }
+        };
+
+        template<typename T>
+        static constexpr Ops ops_heap =
+        {
+            [](void* storage)                        { (**static_cast<T**>(storage))(); },
+            [](void* storage_dst, void* storage_src) { *static_cast<T**>(storage_dst) = *static_cast<T**>(storage_src); },
+            [](void* storage)                        { delete *static_cast<T**>(storage); }
+        };
+
+        void MoveFrom(Task& other)
+        {
+            if (other.m_ops)
+            {
+                other.m_ops->move(m_storage, other.m_storage);
+                m_ops       = other.m_ops;
+                other.m_ops = nullptr;
+            }
+        }
+
+        static constexpr size_t storage_size = 48;
+        alignas(std::max_align_t) std::byte m_storage[storage_size];
+        const Ops* m_ops = nullptr;
+    };
+
+    struct Job;
+
+    // A reference to a job that was submitted to the thread pool.
+    // Jobs are recycled, so the handle also carries the generation of the job it refers to.
+    class SP_CLASS JobHandle
+    {
+    public:
+        JobHandle() = default;
+        JobHandle(Job* job, uint32_t generation) : m_job(job), m_generation(generation) {}
+
+        // A job is done once its own task and the tasks of all its children have executed
+        bool IsDone() const;
+        bool IsValid() const { return m_job != nullptr; }
+
+        Job* GetJob()            const { return m_job; }
+        uint32_t GetGeneration() const { return m_generation; }
+
+    private:
+        Job* m_job            = nullptr;
+        uint32_t m_generation = 0;
+    };
 
     class SP_CLASS ThreadPool
     {
@@ -37,10 +151,17 @@ namespace Spartan
         static void Shutdown();
 
         // Add a task.
-        static void AddTask(Task&& task);
+        static JobHandle AddTask(Task&& task);
+
+        // Add a task as a child of another job, the parent won't be done until all of its children are done.
+        // The parent must still be running, so this is typically called from within the parent's task.
+        static JobHandle AddTask(Task&& task, const JobHandle& parent);
+
+        // Wait for a job (and its children) to finish, the calling thread executes pending jobs while waiting.
+        static void Wait(const JobHandle& handle);
 
-        // Adds multiple tasks to spread execution of a given function across all available threads.
-        static void ParallelLoop(std::function<void(uint32_t work_index_start, uint32_t work_index_end)>&& function, uint32_t work_count);
+        // Spreads execution of a given function across all available threads, the calling thread participates as well.
+        static void ParallelFor(const std::function<void(uint32_t work_index_start, uint32_t work_index_end)>& function, uint32_t work_count);
 
         // Wait for all threads to finish work
         static void Flush(bool remove_queued = false);
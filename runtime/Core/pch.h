@@ -35,6 +35,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <atomic>
 #include <map>
 #include <unordered_map>
+#include <unordered_set>
 #include <cstdio>
 #include <filesystem>
 #include <regex>
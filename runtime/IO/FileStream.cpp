@@ -63,6 +63,16 @@ namespace Spartan
         m_is_open = true;
     }
 
+    FileStream::FileStream(vector<byte>* buffer, uint32_t flags)
+    {
+        SP_ASSERT(buffer != nullptr);
+
+        m_flags           = flags;
+        m_memory          = buffer;
+        m_memory_position = (flags & FileStream_Read) ? 0 : static_cast<uint64_t>(buffer->size());
+        m_is_open         = true;
+    }
+
     FileStream::~FileStream()
     {
         Close();
@@ -70,7 +80,11 @@ namespace Spartan
 
     void FileStream::Close()
     {
-        if (m_flags & FileStream_Write)
+        if (m_memory)
+        {
+            m_is_open = false;
+        }
+        else if (m_flags & FileStream_Write)
         {
             out.flush();
             out.close();
@@ -82,12 +96,75 @@ namespace Spartan
         }
     }
 
+    uint64_t FileStream::GetPosition()
+    {
+        if (m_memory)
+            return m_memory_position;
+
+        return static_cast<uint64_t>((m_flags & FileStream_Write) ? out.tellp() : in.tellg());
+    }
+
+    void FileStream::SetPosition(const uint64_t position)
+    {
+        if (m_memory)
+        {
+            SP_ASSERT(position <= m_memory->size());
+            m_memory_position = position;
+        }
+        else if (m_flags & FileStream_Write)
+        {
+            out.seekp(position, ios::beg);
+        }
+        else if (m_flags & FileStream_Read)
+        {
+            in.seekg(position, ios::beg);
+        }
+    }
+
+    void FileStream::WriteBytes(const void* data, const uint64_t size)
+    {
+        if (size == 0)
+            return;
+
+        if (m_memory)
+        {
+            if (m_memory_position + size > m_memory->size())
+            {
+                m_memory->resize(m_memory_position + size);
+            }
+
+            memcpy(m_memory->data() + m_memory_position, data, size);
+            m_memory_position += size;
+        }
+        else
+        {
+            out.write(reinterpret_cast<const char*>(data), size);
+        }
+    }
+
+    void FileStream::ReadBytes(void* data, const uint64_t size)
+    {
+        if (size == 0)
+            return;
+
+        if (m_memory)
+        {
+            SP_ASSERT_MSG(m_memory_position + size <= m_memory->size(), "Reading past the end of the stream");
+            memcpy(data, m_memory->data() + m_memory_position, size);
+            m_memory_position += size;
+        }
+        else
+        {
+            in.read(reinterpret_cast<char*>(data), size);
+        }
+    }
+
     void FileStream::Write(const string& value)
     {
         const auto length = static_cast<uint32_t>(value.length());
         Write(length);
 
-        out.write(const_cast<char*>(value.c_str()), length);
+        WriteBytes(value.c_str(), length);
     }
 
     void FileStream::Write(const vector<string>& value)
@@ -105,39 +182,49 @@ namespace Spartan
     {
         const auto length = static_cast<uint32_t>(value.size());
         Write(length);
-        out.write(reinterpret_cast<const char*>(&value[0]), sizeof(RHI_Vertex_PosTexNorTan) * length);
+        WriteBytes(value.data(), sizeof(RHI_Vertex_PosTexNorTan) * length);
     }
 
     void FileStream::Write(const vector<uint32_t>& value)
     {
         const auto length = static_cast<uint32_t>(value.size());
         Write(length);
-        out.write(reinterpret_cast<const char*>(&value[0]), sizeof(uint32_t) * length);
+        WriteBytes(value.data(), sizeof(uint32_t) * length);
     }
 
     void FileStream::Write(const vector<unsigned char>& value)
     {
         const auto size = static_cast<uint32_t>(value.size());
         Write(size);
-        out.write(reinterpret_cast<const char*>(&value[0]), sizeof(unsigned char) * size);
+        WriteBytes(value.data(), sizeof(unsigned char) * size);
     }
 
     void FileStream::Write(const vector<byte>& value)
     {
         const auto size = static_cast<uint32_t>(value.size());
         Write(size);
-        out.write(reinterpret_cast<const char*>(&value[0]), sizeof(std::byte) * size);
+        WriteBytes(value.data(), sizeof(std::byte) * size);
     }
 
     void FileStream::Write(const atomic<bool>& value)
     {
-        out.write(reinterpret_cast<const char*>(&value), sizeof(bool));
+        const bool value_bool = value.load();
+        WriteBytes(&value_bool, sizeof(bool));
     }
 
     void FileStream::Skip(uint64_t n)
     {
         // Set the seek cursor to offset n from the current position
-        if (m_flags & FileStream_Write)
+        if (m_memory)
+        {
+            if (m_flags & FileStream_Write)
+            {
+                m_memory->resize(max(static_cast<uint64_t>(m_memory->size()), m_memory_position + n));
+            }
+
+            m_memory_position = min(m_memory_position + n, static_cast<uint64_t>(m_memory->size()));
+        }
+        else if (m_flags & FileStream_Write)
         {
             out.seekp(n, ios::cur);
         }
@@ -153,7 +240,7 @@ namespace Spartan
         Read(&length);
 
         value->resize(length);
-        in.read(const_cast<char*>(value->c_str()), length);
+        ReadBytes(value->data(), length);
     }
 
     void FileStream::Read(vector<string>* vec)
@@ -186,7 +273,7 @@ namespace Spartan
         vec->reserve(length);
         vec->resize(length);
 
-        in.read(reinterpret_cast<char*>(vec->data()), sizeof(RHI_Vertex_PosTexNorTan) * length);
+        ReadBytes(vec->data(), sizeof(RHI_Vertex_PosTexNorTan) * length);
     }
 
     void FileStream::Read(vector<uint32_t>* vec)
@@ -201,7 +288,7 @@ namespace Spartan
         vec->reserve(length);
         vec->resize(length);
 
-        in.read(reinterpret_cast<char*>(vec->data()), sizeof(uint32_t) * length);
+        ReadBytes(vec->data(), sizeof(uint32_t) * length);
     }
 
     void FileStream::Read(vector<unsigned char>* vec)
@@ -216,7 +303,7 @@ namespace Spartan
         vec->reserve(length);
         vec->resize(length);
 
-        in.read(reinterpret_cast<char*>(vec->data()), sizeof(unsigned char) * length);
+        ReadBytes(vec->data(), sizeof(unsigned char) * length);
     }
 
     void FileStream::Read(vector<std::byte>* vec)
@@ -231,11 +318,13 @@ namespace Spartan
         vec->reserve(length);
         vec->resize(length);
 
-        in.read(reinterpret_cast<char*>(vec->data()), sizeof(std::byte) * length);
+        ReadBytes(vec->data(), sizeof(std::byte) * length);
     }
 
     void FileStream::Read(std::atomic<bool>* value)
     {
-        in.read(reinterpret_cast<char*>(value), sizeof(bool));
+        bool value_bool = false;
+        ReadBytes(&value_bool, sizeof(bool));
+        value->store(value_bool);
     }
 }
@@ -45,11 +45,22 @@ namespace Spartan
     {
     public:
         FileStream(const std::string& path, uint32_t flags);
+
+        // Memory stream, writing appends to the buffer, reading starts at the beginning of it
+        FileStream(std::vector<std::byte>* buffer, uint32_t flags);
         ~FileStream();
 
         auto IsOpen() const { return m_is_open; }
         void Close();
 
+        // Position, in bytes from the beginning of the stream
+        uint64_t GetPosition();
+        void SetPosition(uint64_t position);
+
+        // Raw bytes, no size is written or read
+        void WriteBytes(const void* data, uint64_t size);
+        void ReadBytes(void* data, uint64_t size);
+
         //= WRITING ==================================================
         template <class T, class = typename std::enable_if<
             std::is_same<T, bool>::value                ||
@@ -76,7 +87,7 @@ namespace Spartan
         >::type>
         void Write(T value)
         {
-            out.write(reinterpret_cast<char*>(&value), sizeof(value));
+            WriteBytes(&value, sizeof(value));
         }
 
         void Write(const std::string& value);
@@ -116,7 +127,7 @@ namespace Spartan
         >::type>
         void Read(T* value)
         {
-            in.read(reinterpret_cast<char*>(value), sizeof(T));
+            ReadBytes(value, sizeof(T));
         }
         void Read(std::string* value);
         void Read(std::vector<std::string>* vec);
@@ -159,5 +170,9 @@ namespace Spartan
         std::ifstream in;
         uint32_t m_flags;
         bool m_is_open;
+
+        // memory stream
+        std::vector<std::byte>* m_memory = nullptr;
+        uint64_t m_memory_position      = 0;
     };
 }
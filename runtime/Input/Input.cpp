@@ -82,7 +82,7 @@ namespace Spartan
         PollController();
     }
 
-    void Input::OnEvent(sp_variant data)
+    void Input::OnEvent(const sp_variant& data)
     {
         SDL_Event* event_sdl = static_cast<SDL_Event*>(get<void*>(data));
         Uint32 event_type    = event_sdl->type;
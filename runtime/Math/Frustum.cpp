@@ -23,12 +23,68 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "pch.h"
 //==================
 
+//= SIMD ==================================================================================
+#if defined(__AVX2__)
+    #include <immintrin.h>
+    #define SP_FRUSTUM_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define SP_FRUSTUM_SSE
+#endif
+//==========================================================================================
+
 //= NAMESPACES =====
 using namespace std;
 //==================
 
 namespace Spartan::Math
 {
+    namespace
+    {
+        // The planes a box is tested against, with the absolute normals precomputed
+        struct CullPlanes
+        {
+            float nx[6], ny[6], nz[6], d[6];
+            float ax[6], ay[6], az[6];
+            uint32_t count = 0;
+        };
+
+        static CullPlanes get_cull_planes(const Plane* planes, const bool ignore_near_plane)
+        {
+            // Planes 0 and 1 are the depth planes
+            CullPlanes result;
+            for (uint32_t i = ignore_near_plane ? 2 : 0; i < 6; i++)
+            {
+                const Plane& plane = planes[i];
+
+                result.nx[result.count] = plane.normal.x;
+                result.ny[result.count] = plane.normal.y;
+                result.nz[result.count] = plane.normal.z;
+                result.d[result.count]  = plane.d;
+                result.ax[result.count] = Helper::Abs(plane.normal.x);
+                result.ay[result.count] = Helper::Abs(plane.normal.y);
+                result.az[result.count] = Helper::Abs(plane.normal.z);
+                result.count++;
+            }
+
+            return result;
+        }
+
+        // A box is outside if it's fully behind any of the planes
+        static bool is_visible(const CullPlanes& planes, const float cx, const float cy, const float cz, const float ex, const float ey, const float ez)
+        {
+            for (uint32_t i = 0; i < planes.count; i++)
+            {
+                const float distance = planes.nx[i] * cx + planes.ny[i] * cy + planes.nz[i] * cz + planes.d[i];
+                const float radius   = planes.ax[i] * ex + planes.ay[i] * ey + planes.az[i] * ez;
+                if (distance + radius < 0.0f)
+                    return false;
+            }
+
+            return true;
+        }
+    }
+
     Frustum::Frustum(const Matrix& view, const Matrix& projection, float screen_depth)
     {
         // Calculate the minimum Z distance in the frustum.
@@ -86,79 +142,97 @@ namespace Spartan::Math
 
     bool Frustum::IsVisible(const Vector3& center, const Vector3& extent, bool ignore_near_plane /*= false*/) const
     {
-        float radius = 0.0f;
-
-        if (!ignore_near_plane)
-        {
-            radius = Helper::Max3(extent.x, extent.y, extent.z);
-        }
-        else
-        {
-            constexpr float z = numeric_limits<float>::infinity(); // reverse-z only (but I must read form Renderer)
-            radius = Helper::Max3(extent.x, extent.y, z);
-        }
-
-        // Check sphere first as it's cheaper
-        if (CheckSphere(center, radius) != Intersection::Outside)
-            return true;
-
-        if (CheckCube(center, radius) != Intersection::Outside)
-            return true;
-
-        return false;
+        return is_visible(get_cull_planes(m_planes, ignore_near_plane), center.x, center.y, center.z, extent.x, extent.y, extent.z);
     }
 
-    Intersection Frustum::CheckCube(const Vector3& center, const Vector3& extent) const
+    void Frustum::CullBoxes(const FrustumCullBoxes& boxes, const FrustumCullView* views, const uint32_t view_count, const uint32_t word_start, const uint32_t word_end)
     {
-        Intersection result = Intersection::Inside;
-        Plane plane_abs;
+        vector<CullPlanes> planes(view_count);
+        for (uint32_t v = 0; v < view_count; v++)
+        {
+            planes[v] = get_cull_planes(views[v].frustum->m_planes, views[v].ignore_near_plane);
+        }
 
-        // Check if any one point of the cube is in the view frustum.
-        
-        for (const Plane& plane : m_planes)
+        const uint32_t box_count = boxes.GetCount();
+        for (uint32_t word = word_start; word < word_end; word++)
         {
-            plane_abs.normal    = plane.normal.Abs();
-            plane_abs.d         = plane.d;
+            const uint32_t box_start = word * 64;
+            const uint32_t box_end   = Helper::Min(box_start + 64, box_count);
 
-            const float d   = center.x * plane.normal.x + center.y * plane.normal.y + center.z * plane.normal.z;
-            const float r   = extent.x * plane_abs.normal.x + extent.y * plane_abs.normal.y + extent.z * plane_abs.normal.z;
+            for (uint32_t v = 0; v < view_count; v++)
+            {
+                views[v].mask[word] = 0;
+            }
 
-            const float d_p_r = d + r;
-            const float d_m_r = d - r;
+            uint32_t i = box_start;
 
-            if (d_p_r < -plane.d)
+        #if defined(SP_FRUSTUM_AVX2)
+            for (; i + 8 <= box_end; i += 8)
             {
-                result = Intersection::Outside;
-                break;
+                const __m256 cx = _mm256_loadu_ps(&boxes.center_x[i]);
+                const __m256 cy = _mm256_loadu_ps(&boxes.center_y[i]);
+                const __m256 cz = _mm256_loadu_ps(&boxes.center_z[i]);
+                const __m256 ex = _mm256_loadu_ps(&boxes.extent_x[i]);
+                const __m256 ey = _mm256_loadu_ps(&boxes.extent_y[i]);
+                const __m256 ez = _mm256_loadu_ps(&boxes.extent_z[i]);
+
+                for (uint32_t v = 0; v < view_count; v++)
+                {
+                    const CullPlanes& p = planes[v];
+                    __m256 inside       = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+
+                    for (uint32_t k = 0; k < p.count; k++)
+                    {
+                        __m256 distance = _mm256_add_ps(_mm256_mul_ps(cx, _mm256_set1_ps(p.nx[k])), _mm256_mul_ps(cy, _mm256_set1_ps(p.ny[k])));
+                        distance        = _mm256_add_ps(distance, _mm256_add_ps(_mm256_mul_ps(cz, _mm256_set1_ps(p.nz[k])), _mm256_set1_ps(p.d[k])));
+                        __m256 radius   = _mm256_add_ps(_mm256_mul_ps(ex, _mm256_set1_ps(p.ax[k])), _mm256_mul_ps(ey, _mm256_set1_ps(p.ay[k])));
+                        radius          = _mm256_add_ps(radius, _mm256_mul_ps(ez, _mm256_set1_ps(p.az[k])));
+                        inside          = _mm256_and_ps(inside, _mm256_cmp_ps(_mm256_add_ps(distance, radius), _mm256_setzero_ps(), _CMP_GE_OQ));
+                    }
+
+                    views[v].mask[word] |= static_cast<uint64_t>(_mm256_movemask_ps(inside)) << (i - box_start);
+                }
             }
-
-            if (d_m_r < -plane.d)
+        #elif defined(SP_FRUSTUM_SSE)
+            for (; i + 4 <= box_end; i += 4)
             {
-                result = Intersection::Intersects;
+                const __m128 cx = _mm_loadu_ps(&boxes.center_x[i]);
+                const __m128 cy = _mm_loadu_ps(&boxes.center_y[i]);
+                const __m128 cz = _mm_loadu_ps(&boxes.center_z[i]);
+                const __m128 ex = _mm_loadu_ps(&boxes.extent_x[i]);
+                const __m128 ey = _mm_loadu_ps(&boxes.extent_y[i]);
+                const __m128 ez = _mm_loadu_ps(&boxes.extent_z[i]);
+
+                for (uint32_t v = 0; v < view_count; v++)
+                {
+                    const CullPlanes& p = planes[v];
+                    __m128 inside       = _mm_castsi128_ps(_mm_set1_epi32(-1));
+
+                    for (uint32_t k = 0; k < p.count; k++)
+                    {
+                        __m128 distance = _mm_add_ps(_mm_mul_ps(cx, _mm_set1_ps(p.nx[k])), _mm_mul_ps(cy, _mm_set1_ps(p.ny[k])));
+                        distance        = _mm_add_ps(distance, _mm_add_ps(_mm_mul_ps(cz, _mm_set1_ps(p.nz[k])), _mm_set1_ps(p.d[k])));
+                        __m128 radius   = _mm_add_ps(_mm_mul_ps(ex, _mm_set1_ps(p.ax[k])), _mm_mul_ps(ey, _mm_set1_ps(p.ay[k])));
+                        radius          = _mm_add_ps(radius, _mm_mul_ps(ez, _mm_set1_ps(p.az[k])));
+                        inside          = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(distance, radius), _mm_setzero_ps()));
+                    }
+
+                    views[v].mask[word] |= static_cast<uint64_t>(_mm_movemask_ps(inside)) << (i - box_start);
+                }
             }
-        }
-
-        return result;
-    }
-
-    Intersection Frustum::CheckSphere(const Vector3& center, float radius) const
-    {
-        // calculate our distances to each of the planes
-        for (const auto& plane : m_planes)
-        {
-            // find the distance to this plane
-            const float distance = Vector3::Dot(plane.normal, center) + plane.d;
-
-            // if this distance is < -sphere.radius, we are outside
-            if (distance < -radius)
-                return Intersection::Outside;
+        #endif
 
-            // else if the distance is between +- radius, then we intersect
-            if (static_cast<float>(Helper::Abs(distance)) < radius)
-                return Intersection::Intersects;
+            // Whatever is left over
+            for (; i < box_end; i++)
+            {
+                for (uint32_t v = 0; v < view_count; v++)
+                {
+                    if (is_visible(planes[v], boxes.center_x[i], boxes.center_y[i], boxes.center_z[i], boxes.extent_x[i], boxes.extent_y[i], boxes.extent_z[i]))
+                    {
+                        views[v].mask[word] |= 1ull << (i - box_start);
+                    }
+                }
+            }
         }
-
-        // otherwise we are fully in view
-        return Intersection::Inside;
     }
 }
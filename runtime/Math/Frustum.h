@@ -22,13 +22,48 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #pragma once
 
 //= INCLUDES =============
+#include <vector>
 #include "../Math/Plane.h"
+#include "BoundingBox.h"
 #include "Matrix.h"
 #include "Vector3.h"
 //========================
 
 namespace Spartan::Math
 {
+    class Frustum;
+
+    // Boxes as separate arrays of centers and extents, so they can be culled several at a time
+    struct FrustumCullBoxes
+    {
+        void Clear()
+        {
+            center_x.clear(); center_y.clear(); center_z.clear();
+            extent_x.clear(); extent_y.clear(); extent_z.clear();
+        }
+
+        void Add(const BoundingBox& box)
+        {
+            const Vector3 center = box.GetCenter();
+            const Vector3 extent = box.GetExtents();
+            center_x.emplace_back(center.x); center_y.emplace_back(center.y); center_z.emplace_back(center.z);
+            extent_x.emplace_back(extent.x); extent_y.emplace_back(extent.y); extent_z.emplace_back(extent.z);
+        }
+
+        uint32_t GetCount() const     { return static_cast<uint32_t>(center_x.size()); }
+        uint32_t GetWordCount() const { return (GetCount() + 63) / 64; }
+
+        std::vector<float> center_x, center_y, center_z;
+        std::vector<float> extent_x, extent_y, extent_z;
+    };
+
+    struct FrustumCullView
+    {
+        const Frustum* frustum = nullptr;
+        bool ignore_near_plane = false;
+        uint64_t* mask         = nullptr; // one bit per box, FrustumCullBoxes::GetWordCount() words
+    };
+
     class Frustum
     {
     public:
@@ -36,12 +71,14 @@ namespace Spartan::Math
         Frustum(const Matrix& mView, const Matrix& mProjection, float screenDepth);
         ~Frustum() = default;
 
+        // Exact box test. When ignoring the near plane, both depth planes are skipped.
         bool IsVisible(const Vector3& center, const Vector3& extent, bool ignore_near_plane = false) const;
 
-    private:
-        Intersection CheckCube(const Vector3& center, const Vector3& extent) const;
-        Intersection CheckSphere(const Vector3& center, float radius) const;
+        // Tests the boxes covered by mask words [word_start, word_end) against every view, each box is loaded once for all views.
+        // Same result as IsVisible(), but 8 (AVX2) or 4 (SSE) boxes are tested at a time, with a scalar fallback.
+        static void CullBoxes(const FrustumCullBoxes& boxes, const FrustumCullView* views, const uint32_t view_count, const uint32_t word_start, const uint32_t word_end);
 
+    private:
         Plane m_planes[6];
     };
 }
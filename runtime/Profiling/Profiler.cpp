@@ -27,6 +27,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../RHI/RHI_CommandList.h"
 #include "../RHI/RHI_Implementation.h"
 #include "../Core/ThreadPool.h"
+#include "../Core/SlabAllocator.h"
 #include "../RHI/RHI_SwapChain.h"
 //====================================
 
@@ -37,10 +38,10 @@ using namespace std;
 namespace Spartan
 {
     // Metrics - RHI
-    uint32_t Profiler::m_rhi_draw                       = 0;
+    atomic<uint32_t> Profiler::m_rhi_draw                       = 0;
     uint32_t Profiler::m_rhi_dispatch                   = 0;
-    uint32_t Profiler::m_rhi_bindings_buffer_index      = 0;
-    uint32_t Profiler::m_rhi_bindings_buffer_vertex     = 0;
+    atomic<uint32_t> Profiler::m_rhi_bindings_buffer_index      = 0;
+    atomic<uint32_t> Profiler::m_rhi_bindings_buffer_vertex     = 0;
     uint32_t Profiler::m_rhi_bindings_buffer_constant   = 0;
     uint32_t Profiler::m_rhi_bindings_buffer_structured = 0;
     uint32_t Profiler::m_rhi_bindings_sampler           = 0;
@@ -50,13 +51,17 @@ namespace Spartan
     uint32_t Profiler::m_rhi_bindings_shader_compute    = 0;
     uint32_t Profiler::m_rhi_bindings_render_target     = 0;
     uint32_t Profiler::m_rhi_bindings_texture_storage   = 0;
-    uint32_t Profiler::m_rhi_bindings_descriptor_set    = 0;
-    uint32_t Profiler::m_rhi_bindings_pipeline          = 0;
+    atomic<uint32_t> Profiler::m_rhi_bindings_descriptor_set    = 0;
+    atomic<uint32_t> Profiler::m_rhi_bindings_pipeline          = 0;
     uint32_t Profiler::m_rhi_pipeline_barriers          = 0;
     uint32_t Profiler::m_rhi_timeblock_count            = 0;
 
     // Metrics - Renderer
-    uint32_t Profiler::m_renderer_meshes_rendered = 0;
+    atomic<uint32_t> Profiler::m_renderer_meshes_rendered = 0;
+    uint32_t Profiler::m_renderer_meshes_occluded = 0;
+    uint32_t Profiler::m_renderer_draws_indirect_emitted = 0;
+    uint32_t Profiler::m_renderer_draws_indirect_culled  = 0;
+    uint32_t Profiler::m_renderer_shadows_dropped        = 0;
 
     // Metrics - Time
     float Profiler::m_time_frame_avg  = 0.0f;
@@ -91,7 +96,8 @@ namespace Spartan
         static const float weight_delta            = 1.0f / static_cast<float>(frames_to_accumulate);
         static const float weight_history          = (1.0f - weight_delta);
 
-        // Time blocks (double buffered)
+        // Time blocks (double buffered), they can be written by the render thread
+        static recursive_mutex m_mutex_time_blocks;
         static int m_time_block_index = -1;
         static vector<TimeBlock> m_time_blocks_write;
         static vector<TimeBlock> m_time_blocks_read;
@@ -151,6 +157,8 @@ namespace Spartan
         if (!RHI_Context::gpu_profiling)
             return;
 
+        lock_guard<recursive_mutex> lock(m_mutex_time_blocks);
+
         if (query_disjoint == nullptr)
         {
             RHI_Device::QueryCreate(&query_disjoint, RHI_Query_Type::Timestamp_Disjoint);
@@ -181,6 +189,8 @@ namespace Spartan
 
     void Profiler::PostTick()
     {
+        lock_guard<recursive_mutex> lock(m_mutex_time_blocks);
+
         // Compute timings
         {
             is_stuttering_cpu = m_time_cpu_last > (m_time_cpu_avg + stutter_delta_ms);
@@ -307,6 +317,8 @@ namespace Spartan
         if (!can_profile_cpu && !can_profile_gpu)
             return;
 
+        lock_guard<recursive_mutex> lock(m_mutex_time_blocks);
+
         // Last incomplete block of the same type, is the parent
         TimeBlock* time_block_parent = GetLastIncompleteTimeBlock(type);
 
@@ -318,6 +330,8 @@ namespace Spartan
 
     void Profiler::TimeBlockEnd()
     {
+        lock_guard<recursive_mutex> lock(m_mutex_time_blocks);
+
         if (TimeBlock* time_block = GetLastIncompleteTimeBlock())
         {
             time_block->End();
@@ -544,8 +558,25 @@ namespace Spartan
         // Resources
         oss_metrics << "\nResources\n"
             << "Meshes rendered:\t\t\t\t"   << m_renderer_meshes_rendered << endl
+            << "Meshes occluded:\t\t\t\t"   << m_renderer_meshes_occluded << endl
+            << "Indirect draws emitted:\t\t" << m_renderer_draws_indirect_emitted << endl
+            << "Indirect draws culled:\t\t"  << m_renderer_draws_indirect_culled  << endl
+            << "Shadows dropped:\t\t\t\t"  << m_renderer_shadows_dropped        << endl
             << "Textures:\t\t\t\t\t\t\t"    << texture_count              << endl
             << "Materials:\t\t\t\t\t\t\t"   << material_count             << endl
-            << "Descriptor set capacity:\t" << m_descriptor_set_count << "/" << m_descriptor_set_capacity;
+            << "Descriptor set capacity:\t" << m_descriptor_set_count << "/" << m_descriptor_set_capacity << endl;
+
+        // Memory pools, fragmentation is the fraction of reserved blocks which are free
+        oss_metrics << "\nMemory pools";
+        for (const SlabStats& stats : SlabAllocator::GetStatsAll())
+        {
+            if (stats.chunk_count == 0)
+                continue;
+
+            oss_metrics << endl
+                << stats.name << ":\t" << stats.blocks_used << "/" << stats.blocks_total << " blocks, "
+                << static_cast<float>(stats.bytes_reserved) / 1024.0f << " KB, "
+                << stats.fragmentation * 100.0f << "% free";
+        }
     }
 }
@@ -24,6 +24,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //= INCLUDES ===================
 #include <string>
 #include <vector>
+#include <atomic>
 #include "TimeBlock.h"
 #include "../Core/Definitions.h"
 //==============================
@@ -69,11 +70,11 @@ namespace Spartan
         static bool IsCpuStuttering();
         static bool IsGpuStuttering();
         
-        // Metrics - RHI
-        static uint32_t m_rhi_draw;
+        // Metrics - RHI (the atomic ones are also written by threads recording secondary command lists)
+        static std::atomic<uint32_t> m_rhi_draw;
         static uint32_t m_rhi_dispatch;
-        static uint32_t m_rhi_bindings_buffer_index;
-        static uint32_t m_rhi_bindings_buffer_vertex;
+        static std::atomic<uint32_t> m_rhi_bindings_buffer_index;
+        static std::atomic<uint32_t> m_rhi_bindings_buffer_vertex;
         static uint32_t m_rhi_bindings_buffer_constant;
         static uint32_t m_rhi_bindings_buffer_structured;
         static uint32_t m_rhi_bindings_sampler;
@@ -83,13 +84,17 @@ namespace Spartan
         static uint32_t m_rhi_bindings_shader_compute;
         static uint32_t m_rhi_bindings_render_target;
         static uint32_t m_rhi_bindings_texture_storage;
-        static uint32_t m_rhi_bindings_descriptor_set;
-        static uint32_t m_rhi_bindings_pipeline;
+        static std::atomic<uint32_t> m_rhi_bindings_descriptor_set;
+        static std::atomic<uint32_t> m_rhi_bindings_pipeline;
         static uint32_t m_rhi_pipeline_barriers;
         static uint32_t m_rhi_timeblock_count;
 
         // Metrics - Renderer
-        static uint32_t m_renderer_meshes_rendered;
+        static std::atomic<uint32_t> m_renderer_meshes_rendered;
+        static uint32_t m_renderer_meshes_occluded;
+        static uint32_t m_renderer_draws_indirect_emitted; // read back from the GPU a few frames late
+        static uint32_t m_renderer_draws_indirect_culled;
+        static uint32_t m_renderer_shadows_dropped; // point and spot lights which didn't fit in the shadow slice budget
 
         // Metrics - Time
         static float m_time_frame_avg ;
@@ -117,24 +122,28 @@ namespace Spartan
 
         static void ClearRhiMetrics()
         {
-            m_rhi_draw                       = 0;
-            m_rhi_dispatch                   = 0;
-            m_renderer_meshes_rendered       = 0;
-            m_rhi_bindings_buffer_index      = 0;
-            m_rhi_bindings_buffer_vertex     = 0;
-            m_rhi_bindings_buffer_constant   = 0;
-            m_rhi_bindings_buffer_structured = 0;
-            m_rhi_bindings_sampler           = 0;
-            m_rhi_bindings_texture_sampled   = 0;
-            m_rhi_bindings_shader_vertex     = 0;
-            m_rhi_bindings_shader_pixel      = 0;
-            m_rhi_bindings_shader_compute    = 0;
-            m_rhi_bindings_render_target     = 0;
-            m_rhi_bindings_texture_storage   = 0;
-            m_rhi_bindings_descriptor_set    = 0;
-            m_rhi_bindings_pipeline          = 0;
-            m_rhi_pipeline_barriers          = 0;
-            m_rhi_timeblock_count            = 0;
+            m_rhi_draw                        = 0;
+            m_rhi_dispatch                    = 0;
+            m_renderer_meshes_rendered        = 0;
+            m_renderer_meshes_occluded        = 0;
+            m_renderer_draws_indirect_emitted = 0;
+            m_renderer_draws_indirect_culled  = 0;
+            m_renderer_shadows_dropped        = 0;
+            m_rhi_bindings_buffer_index       = 0;
+            m_rhi_bindings_buffer_vertex      = 0;
+            m_rhi_bindings_buffer_constant    = 0;
+            m_rhi_bindings_buffer_structured  = 0;
+            m_rhi_bindings_sampler            = 0;
+            m_rhi_bindings_texture_sampled    = 0;
+            m_rhi_bindings_shader_vertex      = 0;
+            m_rhi_bindings_shader_pixel       = 0;
+            m_rhi_bindings_shader_compute     = 0;
+            m_rhi_bindings_render_target      = 0;
+            m_rhi_bindings_texture_storage    = 0;
+            m_rhi_bindings_descriptor_set     = 0;
+            m_rhi_bindings_pipeline           = 0;
+            m_rhi_pipeline_barriers           = 0;
+            m_rhi_timeblock_count             = 0;
         }
 
         static TimeBlock* GetNewTimeBlock();
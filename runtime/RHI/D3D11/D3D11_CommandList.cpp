@@ -50,10 +50,11 @@ namespace Spartan
 {
     bool RHI_CommandList::m_memory_query_support = true;
 
-    RHI_CommandList::RHI_CommandList(const RHI_Queue_Type queue_type, const uint32_t index, void* cmd_pool, const char* name) : Object()
+    RHI_CommandList::RHI_CommandList(const RHI_Queue_Type queue_type, const uint32_t index, void* cmd_pool, const char* name, const bool is_secondary /*= false*/) : Object()
     {
-        m_queue_type  = queue_type;
-        m_object_name = name;
+        m_queue_type   = queue_type;
+        m_object_name  = name;
+        m_is_secondary = is_secondary;
 
         m_timestamps.fill(0);
     }
@@ -75,6 +76,16 @@ namespace Spartan
         m_state = RHI_CommandListState::Submitted;
     }
 
+    void RHI_CommandList::BeginSecondary(const RHI_PipelineState& pso)
+    {
+        SP_ASSERT_MSG(false, "Secondary command lists are not supported by D3D11");
+    }
+
+    void RHI_CommandList::ExecuteCommands(RHI_CommandList* const* cmd_lists, const uint32_t cmd_list_count)
+    {
+        SP_ASSERT_MSG(false, "Secondary command lists are not supported by D3D11");
+    }
+
     void RHI_CommandList::SetPipelineState(RHI_PipelineState& pso)
     {
         SP_ASSERT(pso.IsValid() && "Pipeline state is invalid");
@@ -310,7 +321,7 @@ namespace Spartan
         Profiler::m_rhi_bindings_pipeline++;
     }
 
-    void RHI_CommandList::BeginRenderPass()
+    void RHI_CommandList::BeginRenderPass(const bool contents_secondary /*= false*/)
     {
 
     }
@@ -431,18 +442,35 @@ namespace Spartan
         Profiler::m_rhi_draw++;
     }
 
-    void RHI_CommandList::DrawIndexed(const uint32_t index_count, const uint32_t index_offset, const uint32_t vertex_offset)
+    void RHI_CommandList::DrawIndexed(const uint32_t index_count, const uint32_t index_offset, const uint32_t vertex_offset, const uint32_t instance_count)
     {
-        RHI_Context::device_context->DrawIndexed
+        RHI_Context::device_context->DrawIndexedInstanced
         (
             static_cast<UINT>(index_count),
+            static_cast<UINT>(instance_count),
             static_cast<UINT>(index_offset),
-            static_cast<INT>(vertex_offset)
+            static_cast<INT>(vertex_offset),
+            0
         );
 
         Profiler::m_rhi_draw++;
     }
 
+    void RHI_CommandList::DrawIndexedIndirect(RHI_StructuredBuffer* args_buffer, const uint32_t args_offset, const uint32_t draw_count)
+    {
+        SP_ASSERT_MSG(false, "Function is not implemented");
+    }
+
+    void RHI_CommandList::DrawIndexedIndirectCount(RHI_StructuredBuffer* args_buffer, const uint32_t args_offset, RHI_StructuredBuffer* count_buffer, const uint32_t count_offset, const uint32_t draw_count_max)
+    {
+        SP_ASSERT_MSG(false, "Function is not implemented");
+    }
+
+    void RHI_CommandList::InsertBarrierStructuredBuffer(RHI_StructuredBuffer* structured_buffer)
+    {
+        SP_ASSERT_MSG(false, "Function is not implemented");
+    }
+
     void RHI_CommandList::Dispatch(uint32_t x, uint32_t y, uint32_t z, bool async /*= false*/)
     {
         RHI_Context::device_context->Dispatch(x, y, z);
@@ -470,6 +498,11 @@ namespace Spartan
         RHI_Context::device_context->CopyResource(static_cast<ID3D11Resource*>(destination->GetRhiResource()), static_cast<ID3D11Resource*>(source->GetRhiResource()));
     }
 
+    void RHI_CommandList::Copy(RHI_Texture* source, RHI_Texture* destination, const uint32_t array_index, const uint32_t array_length /*= 1*/)
+    {
+        SP_ASSERT_MSG(false, "Function is not implemented");
+    }
+
     void RHI_CommandList::SetViewport(const RHI_Viewport& viewport) const
     {
         // Validate command list state
@@ -728,8 +761,10 @@ namespace Spartan
         }
     }
 
-    void RHI_CommandList::SetStructuredBuffer(const uint32_t slot, RHI_StructuredBuffer* structured_buffer) const
+    void RHI_CommandList::SetStructuredBuffer(const uint32_t slot, RHI_StructuredBuffer* structured_buffer, const bool uav) const
     {
+        SP_ASSERT_MSG(uav, "Read only structured buffers are not implemented");
+
         array<void*, 1> view_array          = { structured_buffer ? structured_buffer->GetRhiUav() : nullptr };
         const UINT range                    = 1;
         ID3D11DeviceContext* device_context = RHI_Context::device_context;
@@ -72,7 +72,7 @@ namespace Spartan
         d3d11_utility::release<ID3D11UnorderedAccessView>(m_rhi_uav);
     }
 
-    void RHI_StructuredBuffer::Update(void* data_cpu)
+    void RHI_StructuredBuffer::Update(void* data_cpu, const uint32_t size)
     {
         RHI_Context::device_context->UpdateSubresource(static_cast<ID3D11Buffer*>(m_rhi_resource), 0, nullptr, data_cpu, 0, 0);
     }
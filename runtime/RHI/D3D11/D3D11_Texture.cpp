@@ -151,7 +151,7 @@ namespace Spartan
         return d3d11_utility::error_check(RHI_Context::device->CreateTexture2D(&texture_desc, texture_data.data(), &texture));
     }
 
-    static bool create_render_target_view(void* texture, array<void*, rhi_max_render_target_count>& views, const ResourceType resource_type, const DXGI_FORMAT format, const uint32_t array_size)
+    static bool create_render_target_view(void* texture, vector<void*>& views, const ResourceType resource_type, const DXGI_FORMAT format, const uint32_t array_size)
     {
         SP_ASSERT(texture != nullptr);
 
@@ -162,7 +162,8 @@ namespace Spartan
         desc.Texture2DArray.MipSlice       = 0;
         desc.Texture2DArray.ArraySize      = 1;
 
-        // Create
+        // Create, a view per slice
+        views.assign(array_size, nullptr);
         for (uint32_t i = 0; i < array_size; i++)
         {
             desc.Texture2DArray.FirstArraySlice = i;
@@ -174,7 +175,7 @@ namespace Spartan
         return true;
     }
 
-    static bool create_depth_stencil_view(void* texture, array<void*, rhi_max_render_target_count>& views, const ResourceType resource_type, const DXGI_FORMAT format, const uint32_t array_size, const bool has_stencil, const bool read_only)
+    static bool create_depth_stencil_view(void* texture, vector<void*>& views, const ResourceType resource_type, const DXGI_FORMAT format, const uint32_t array_size, const bool has_stencil, const bool read_only)
     {
         SP_ASSERT(texture != nullptr);
 
@@ -196,7 +197,8 @@ namespace Spartan
             }
         }
 
-        // Create
+        // Create, a view per slice
+        views.assign(array_size, nullptr);
         for (uint32_t i = 0; i < array_size; i++)
         {
             desc.Texture2DArray.FirstArraySlice = i;
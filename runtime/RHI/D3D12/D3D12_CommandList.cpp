@@ -48,7 +48,7 @@ using namespace Spartan::Math;
 
 namespace Spartan
 {
-    RHI_CommandList::RHI_CommandList(const RHI_Queue_Type queue_type, const uint32_t index, void* cmd_pool, const char* name)
+    RHI_CommandList::RHI_CommandList(const RHI_Queue_Type queue_type, const uint32_t index, void* cmd_pool, const char* name, const bool is_secondary /*= false*/)
     {
         SP_ASSERT(cmd_pool != nullptr);
 
@@ -116,6 +116,16 @@ namespace Spartan
 
     }
 
+    void RHI_CommandList::BeginSecondary(const RHI_PipelineState& pso)
+    {
+        SP_ASSERT_MSG(false, "Function is not implemented");
+    }
+
+    void RHI_CommandList::ExecuteCommands(RHI_CommandList* const* cmd_lists, const uint32_t cmd_list_count)
+    {
+        SP_ASSERT_MSG(false, "Function is not implemented");
+    }
+
     void RHI_CommandList::SetPipelineState(RHI_PipelineState& pso)
     {
         SP_ASSERT(pso.IsValid() && "Pipeline state is invalid");
@@ -124,7 +134,7 @@ namespace Spartan
         SP_ASSERT_MSG(false, "Function is not implemented");
     }
 
-    void RHI_CommandList::BeginRenderPass()
+    void RHI_CommandList::BeginRenderPass(const bool contents_secondary /*= false*/)
     {
         SP_ASSERT_MSG(false, "Function is not implemented");
     }
@@ -171,7 +181,7 @@ namespace Spartan
         Profiler::m_rhi_draw++;
     }
     
-    void RHI_CommandList::DrawIndexed(const uint32_t index_count, const uint32_t index_offset, const uint32_t vertex_offset)
+    void RHI_CommandList::DrawIndexed(const uint32_t index_count, const uint32_t index_offset, const uint32_t vertex_offset, const uint32_t instance_count)
     {
         // Validate command list state
         SP_ASSERT(m_state == RHI_CommandListState::Recording);
@@ -181,17 +191,32 @@ namespace Spartan
 
         // Draw
         static_cast<ID3D12GraphicsCommandList*>(m_rhi_resource)->DrawIndexedInstanced(
-            index_count,   // IndexCountPerInstance
-            1,             // InstanceCount
-            index_offset,  // StartIndexLocation
-            vertex_offset, // BaseVertexLocation
-            0              // StartInstanceLocation
+            index_count,    // IndexCountPerInstance
+            instance_count, // InstanceCount
+            index_offset,   // StartIndexLocation
+            vertex_offset,  // BaseVertexLocation
+            0               // StartInstanceLocation
         );
 
         // Profile
         Profiler::m_rhi_draw++;
     }
   
+    void RHI_CommandList::DrawIndexedIndirect(RHI_StructuredBuffer* args_buffer, const uint32_t args_offset, const uint32_t draw_count)
+    {
+        SP_ASSERT_MSG(false, "Function is not implemented");
+    }
+
+    void RHI_CommandList::DrawIndexedIndirectCount(RHI_StructuredBuffer* args_buffer, const uint32_t args_offset, RHI_StructuredBuffer* count_buffer, const uint32_t count_offset, const uint32_t draw_count_max)
+    {
+        SP_ASSERT_MSG(false, "Function is not implemented");
+    }
+
+    void RHI_CommandList::InsertBarrierStructuredBuffer(RHI_StructuredBuffer* structured_buffer)
+    {
+        SP_ASSERT_MSG(false, "Function is not implemented");
+    }
+
     void RHI_CommandList::Dispatch(uint32_t x, uint32_t y, uint32_t z, bool async /*= false*/)
     {
         // Validate command list state
@@ -217,6 +242,11 @@ namespace Spartan
         SP_ASSERT_MSG(false, "Function is not implemented");
     }
 
+    void RHI_CommandList::Copy(RHI_Texture* source, RHI_Texture* destination, const uint32_t array_index, const uint32_t array_length /*= 1*/)
+    {
+        SP_ASSERT_MSG(false, "Function is not implemented");
+    }
+
     void RHI_CommandList::SetViewport(const RHI_Viewport& viewport) const
     {
         // Validate command list state
@@ -302,7 +332,7 @@ namespace Spartan
         SP_ASSERT_MSG(false, "Function is not implemented");
     }
 
-    void RHI_CommandList::SetStructuredBuffer(const uint32_t slot, RHI_StructuredBuffer* structured_buffer) const
+    void RHI_CommandList::SetStructuredBuffer(const uint32_t slot, RHI_StructuredBuffer* structured_buffer, const bool uav) const
     {
         SP_ASSERT_MSG(false, "Function is not implemented");
     }
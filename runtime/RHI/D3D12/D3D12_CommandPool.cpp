@@ -53,6 +53,17 @@ namespace Spartan
 
     }
 
+    void RHI_CommandPool::AllocateSecondaryCommandLists(const uint32_t slot_count)
+    {
+
+    }
+
+    RHI_CommandList* RHI_CommandPool::GetSecondaryCommandList(const uint32_t slot_index)
+    {
+        SP_ASSERT_MSG(false, "Function is not implemented");
+        return nullptr;
+    }
+
     void RHI_CommandPool::Reset(const uint32_t pool_index)
     {
 
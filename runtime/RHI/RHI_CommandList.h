@@ -47,7 +47,7 @@ namespace Spartan
     class SP_CLASS RHI_CommandList : public Object
     {
     public:
-        RHI_CommandList(const RHI_Queue_Type queue_type, const uint32_t index, void* cmd_pool_resource, const char* name);
+        RHI_CommandList(const RHI_Queue_Type queue_type, const uint32_t index, void* cmd_pool_resource, const char* name, const bool is_secondary = false);
         ~RHI_CommandList();
 
         void Begin();
@@ -56,9 +56,14 @@ namespace Spartan
         // Waits for the command list to finish being processed.
         void Wait(const bool log_on_wait = true);
 
+        // Secondary command lists are recorded in parallel and executed within a render pass of a primary command list.
+        // Nothing is inherited from the primary, so BeginSecondary() binds the pipeline and sets the viewport.
+        void BeginSecondary(const RHI_PipelineState& pso);
+        void ExecuteCommands(RHI_CommandList* const* cmd_lists, const uint32_t cmd_list_count);
+
         // Render pass
         void SetPipelineState(RHI_PipelineState& pso);
-        void BeginRenderPass();
+        void BeginRenderPass(const bool contents_secondary = false); // when true, only ExecuteCommands() can be recorded until EndRenderPass()
         void EndRenderPass();
 
         // Clear
@@ -75,15 +80,24 @@ namespace Spartan
 
         // Draw
         void Draw(uint32_t vertex_count, uint32_t vertex_start_index = 0);
-        void DrawIndexed(uint32_t index_count, uint32_t index_offset = 0, uint32_t vertex_offset = 0);
+        void DrawIndexed(uint32_t index_count, uint32_t index_offset = 0, uint32_t vertex_offset = 0, uint32_t instance_count = 1);
+        void DrawIndexedIndirect(RHI_StructuredBuffer* args_buffer, const uint32_t args_offset, const uint32_t draw_count);
+        void DrawIndexedIndirectCount(RHI_StructuredBuffer* args_buffer, const uint32_t args_offset, RHI_StructuredBuffer* count_buffer, const uint32_t count_offset, const uint32_t draw_count_max);
 
         // Dispatch
         void Dispatch(uint32_t x, uint32_t y, uint32_t z = 1, bool async = false);
 
+        // Barrier, makes the writes to a structured buffer visible to any later use (shader, indirect arguments or host)
+        // and orders them after any earlier use, has to be called outside of a render pass
+        void InsertBarrierStructuredBuffer(RHI_StructuredBuffer* structured_buffer);
+
         // Blit
         void Blit(RHI_Texture* source, RHI_Texture* destination, const RHI_Filter filter, const bool blit_mips);
         void Blit(RHI_Texture* source, RHI_SwapChain* destination, const RHI_Filter filter);
 
+        // Copy, slices of the first mip into the same slices of a texture with the same dimensions and format
+        void Copy(RHI_Texture* source, RHI_Texture* destination, const uint32_t array_index, const uint32_t array_length = 1);
+
         // Viewport
         void SetViewport(const RHI_Viewport& viewport) const;
         
@@ -112,8 +126,9 @@ namespace Spartan
         inline void SetTexture(const Renderer_BindingsSrv slot, const std::shared_ptr<RHI_Texture>& texture, const uint32_t mip_index = rhi_all_mips, uint32_t mip_range = 0) { SetTexture(static_cast<uint32_t>(slot), texture.get(), mip_index, mip_range, false); }
 
         // Structured buffer
-        void SetStructuredBuffer(const uint32_t slot, RHI_StructuredBuffer* structured_buffer) const;
-        inline void SetStructuredBuffer(const Renderer_BindingsUav slot, const std::shared_ptr<RHI_StructuredBuffer>& structured_buffer) const { SetStructuredBuffer(static_cast<uint32_t>(slot), structured_buffer.get()); }
+        void SetStructuredBuffer(const uint32_t slot, RHI_StructuredBuffer* structured_buffer, const bool uav = true) const;
+        inline void SetStructuredBuffer(const Renderer_BindingsUav slot, const std::shared_ptr<RHI_StructuredBuffer>& structured_buffer) const { SetStructuredBuffer(static_cast<uint32_t>(slot), structured_buffer.get(), true); }
+        inline void SetStructuredBuffer(const Renderer_BindingsSrv slot, const std::shared_ptr<RHI_StructuredBuffer>& structured_buffer) const { SetStructuredBuffer(static_cast<uint32_t>(slot), structured_buffer.get(), false); }
 
         // Markers
         void BeginMarker(const char* name);
@@ -138,6 +153,7 @@ namespace Spartan
         // Misc
         void* GetRhiResource() const { return m_rhi_resource; }
         uint32_t GetIndex()    const { return m_index; }
+        bool IsSecondary()     const { return m_is_secondary; }
 
     private:
         void OnDraw();
@@ -149,6 +165,7 @@ namespace Spartan
         RHI_Pipeline* m_pipeline                         = nullptr;
         bool m_is_rendering                              = false;
         bool m_pipeline_dirty                            = false;
+        bool m_is_secondary                              = false;
         std::atomic<RHI_CommandListState> m_state        = RHI_CommandListState::Idle;
         static const uint8_t m_resource_array_length_max = 16;
         static bool m_memory_query_support;
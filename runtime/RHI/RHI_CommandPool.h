@@ -39,6 +39,12 @@ namespace Spartan
         void AllocateCommandLists(const RHI_Queue_Type queue_type, const uint32_t cmd_list_count = 2, const uint32_t cmd_pool_count = 2);
         bool Step();
 
+        // Secondary command lists, every slot has its own command pool (per pool index) so that each slot can be recorded on a different thread.
+        // The lists are handed out in order and recycled when the pool they belong to is reset.
+        void AllocateSecondaryCommandLists(const uint32_t slot_count);
+        RHI_CommandList* GetSecondaryCommandList(const uint32_t slot_index);
+        uint32_t GetSecondarySlotCount() const { return m_secondary_slot_count; }
+
         RHI_CommandList* GetCurrentCommandList()       { return m_cmd_lists[m_cmd_list_index].get(); }
         uint32_t GetCommandListIndex()           const { return m_cmd_list_index; }
         void*& GetResource()                           { return m_rhi_resources[GetPoolIndex()]; }
@@ -58,6 +64,16 @@ namespace Spartan
         std::vector<void*> m_rhi_resources;
         uint32_t m_cmd_pool_count = 0;
 
+        // Secondary command lists, indexed by pool index * slot count + slot index
+        struct SecondarySlot
+        {
+            void* rhi_resource = nullptr;
+            std::vector<std::shared_ptr<RHI_CommandList>> cmd_lists;
+            uint32_t cmd_list_index = 0;
+        };
+        std::vector<SecondarySlot> m_secondary_slots;
+        uint32_t m_secondary_slot_count = 0;
+
         // The swapchain for which this thread pool's command lists will be presenting to.
         uint64_t m_swap_chain_id = 0;
 
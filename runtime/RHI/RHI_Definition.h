@@ -311,6 +311,9 @@ namespace Spartan
     const uint32_t rhi_shader_shift_register_t = 200;
     const uint32_t rhi_shader_shift_register_s = 300;
 
+    // Indexed indirect draw arguments are five uint32s: index count, instance count, first index, vertex offset, first instance
+    const uint32_t rhi_draw_indexed_indirect_stride = 20;
+
     const Color    rhi_color_dont_care           = Color(std::numeric_limits<float>::max(), 0.0f, 0.0f, 0.0f);
     const Color    rhi_color_load                = Color(std::numeric_limits<float>::infinity(), 0.0f, 0.0f, 0.0f);
     const float    rhi_depth_dont_care           = std::numeric_limits<float>::max();
@@ -318,6 +321,7 @@ namespace Spartan
     const uint32_t rhi_stencil_dont_care         = std::numeric_limits<uint32_t>::max();
     const uint32_t rhi_stencil_load              = std::numeric_limits<uint32_t>::infinity();
     const uint8_t  rhi_max_render_target_count   = 8;
+    const uint8_t  rhi_max_view_count            = 6;  // multiview, the slices rendered by a single pass (the faces of a cube)
     const uint8_t  rhi_max_constant_buffer_count = 8;
     const uint32_t rhi_dynamic_offset_empty      = std::numeric_limits<uint32_t>::max();
     const uint8_t  rhi_max_mip_count             = 13;
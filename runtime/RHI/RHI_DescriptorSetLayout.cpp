@@ -37,6 +37,9 @@ using namespace std;
 
 namespace Spartan
 {
+    // The descriptor set cache is shared by all command lists, including secondary ones which record in parallel
+    static mutex mutex_descriptor_sets;
+
     RHI_DescriptorSetLayout::RHI_DescriptorSetLayout(const vector<RHI_Descriptor>& descriptors, const string& name)
     {
         m_descriptors = descriptors;
@@ -70,11 +73,14 @@ namespace Spartan
         }
     }
 
-    void RHI_DescriptorSetLayout::SetStructuredBuffer(const uint32_t slot, RHI_StructuredBuffer* structured_buffer)
+    void RHI_DescriptorSetLayout::SetStructuredBuffer(const uint32_t slot, RHI_StructuredBuffer* structured_buffer, const bool uav)
     {
+        // Read only structured buffers are declared with t registers
+        uint32_t shift = uav ? rhi_shader_shift_register_u : rhi_shader_shift_register_t;
+
         for (RHI_Descriptor& descriptor : m_descriptors)
         {
-            if ((descriptor.type == RHI_Descriptor_Type::StructuredBuffer) && descriptor.slot == slot + rhi_shader_shift_register_u)
+            if ((descriptor.type == RHI_Descriptor_Type::StructuredBuffer) && descriptor.slot == slot + shift)
             {
                 // Determine if the descriptor set needs to bind (affects vkUpdateDescriptorSets)
                 m_needs_to_bind = descriptor.data           != structured_buffer              ? true : m_needs_to_bind;
@@ -167,6 +173,7 @@ namespace Spartan
         }
 
         // If we don't have a descriptor set to match that state, create one
+        lock_guard<mutex> lock(mutex_descriptor_sets);
         unordered_map<uint64_t, RHI_DescriptorSet>& descriptor_sets = RHI_Device::GetDescriptorSets();
         const auto it = descriptor_sets.find(hash);
         if (it == descriptor_sets.end())
@@ -43,6 +43,7 @@ namespace Spartan
 
     // Misc
     bool RHI_Device::m_wide_lines                          = false;
+    bool RHI_Device::m_draw_indirect_count                 = false;
     uint32_t  RHI_Device::m_physical_device_index          = 0;
     uint32_t  RHI_Device::m_enabled_graphics_shader_stages = 0;
     static vector<PhysicalDevice> physical_devices;
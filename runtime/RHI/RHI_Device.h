@@ -91,6 +91,7 @@ namespace Spartan
         static void MapMemory(void* resource, void*& mapped_data);
         static void UnmapMemory(void* resource, void*& mapped_data);
         static void FlushAllocation(void* resource, uint64_t offset, uint64_t size);
+        static void InvalidateAllocation(void* resource, uint64_t offset, uint64_t size);
 
         // Immediate execution
         static RHI_CommandList* ImmediateBegin(const RHI_Queue_Type queue_type);
@@ -118,6 +119,7 @@ namespace Spartan
         static uint64_t GetMinUniformBufferOffsetAllignment() { return m_min_uniform_buffer_offset_alignment; }
         static uint64_t GetMinStorageBufferOffsetAllignment() { return m_min_storage_buffer_offset_alignment; }
         static float GetTimestampPeriod()                     { return m_timestamp_period; }
+        static bool IsDrawIndirectCountSupported()            { return m_draw_indirect_count; }
 
     private:
         // Physical device
@@ -139,6 +141,7 @@ namespace Spartan
 
         // Misc
         static bool m_wide_lines;
+        static bool m_draw_indirect_count;
         static uint32_t m_physical_device_index;
         static uint32_t m_enabled_graphics_shader_stages;
     };
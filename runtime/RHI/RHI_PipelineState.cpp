@@ -58,6 +58,7 @@ namespace Spartan
         m_hash = rhi_hash_combine(m_hash, static_cast<uint64_t>(primitive_topology));
         m_hash = rhi_hash_combine(m_hash, static_cast<uint64_t>(render_target_color_texture_array_index));
         m_hash = rhi_hash_combine(m_hash, static_cast<uint64_t>(render_target_depth_stencil_texture_array_index));
+        m_hash = rhi_hash_combine(m_hash, static_cast<uint64_t>(render_target_view_mask));
 
         if (render_target_swapchain)
         {
@@ -142,6 +143,9 @@ namespace Spartan
         if (!needs_to_update && m_pso_previous->render_target_depth_stencil_texture_array_index != render_target_depth_stencil_texture_array_index)
             needs_to_update = true;
 
+        if (!needs_to_update && m_pso_previous->render_target_view_mask != render_target_view_mask)
+            needs_to_update = true;
+
         if (!needs_to_update && render_target_swapchain && (!m_pso_previous->render_target_swapchain || m_pso_previous->render_target_swapchain->GetFormat() != render_target_swapchain->GetFormat()))
             needs_to_update = true;
 
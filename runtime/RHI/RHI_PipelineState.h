@@ -62,6 +62,7 @@ namespace Spartan
         std::array<RHI_Texture*, rhi_max_render_target_count> render_target_color_textures;
         uint32_t render_target_color_texture_array_index         = 0;
         uint32_t render_target_depth_stencil_texture_array_index = 0;
+        uint32_t render_target_view_mask                         = 0; // multiview, the slices (from the array indices on) every draw goes to, shaders read SV_ViewID
         //====================================================================================
 
         //= DYNAMIC - Will not cause PSO generation ===============
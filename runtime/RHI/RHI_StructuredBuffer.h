@@ -33,11 +33,12 @@ namespace Spartan
         RHI_StructuredBuffer(const uint32_t stride, const uint32_t element_count, const char* name);
         ~RHI_StructuredBuffer();
 
-        void Update(void* data);
+        void Update(void* data, const uint32_t size = 0); // size defaults to the stride
         void ResetOffset() { m_reset_offset = true; }
 
         uint32_t GetStride()   const { return m_stride; }
         uint32_t GetOffset()   const { return m_offset; }
+        void* GetMappedData()  const { return m_mapped_data; } // for buffers which the GPU writes and the CPU reads back
         void* GetRhiResource() const { return m_rhi_resource; }
         void* GetRhiUav()      const { return m_rhi_uav; }
 
@@ -70,9 +70,6 @@ namespace Spartan
         m_layout.fill(RHI_Image_Layout::Undefined);
         m_rhi_srv_mips.fill(nullptr);
         m_rhi_uav_mips.fill(nullptr);
-        m_rhi_rtv.fill(nullptr);
-        m_rhi_dsv.fill(nullptr);
-        m_rhi_dsv_read_only.fill(nullptr);
     }
 
     RHI_Texture::~RHI_Texture()
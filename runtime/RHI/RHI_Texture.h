@@ -136,6 +136,8 @@ namespace Spartan
         void* GetRhiDsv(const uint32_t i = 0)         const { return i < m_rhi_dsv.size()           ? m_rhi_dsv[i]           : nullptr; }
         void* GetRhiDsvReadOnly(const uint32_t i = 0) const { return i < m_rhi_dsv_read_only.size() ? m_rhi_dsv_read_only[i] : nullptr; }
         void* GetRhiRtv(const uint32_t i = 0)         const { return i < m_rhi_rtv.size()           ? m_rhi_rtv[i]           : nullptr; }
+        void* GetRhiDsvMultiview(const uint32_t i)    const { return i < m_rhi_dsv_multiview.size() ? m_rhi_dsv_multiview[i] : nullptr; }
+        void* GetRhiRtvMultiview(const uint32_t i)    const { return i < m_rhi_rtv_multiview.size() ? m_rhi_rtv_multiview[i] : nullptr; }
         void RHI_DestroyResource(const bool destroy_main, const bool destroy_per_view);
 
     protected:
@@ -160,9 +162,11 @@ namespace Spartan
         void* m_rhi_uav      = nullptr;
         std::array<void*, rhi_max_mip_count> m_rhi_srv_mips;
         std::array<void*, rhi_max_mip_count> m_rhi_uav_mips;
-        std::array<void*, rhi_max_render_target_count> m_rhi_rtv;
-        std::array<void*, rhi_max_render_target_count> m_rhi_dsv;
-        std::array<void*, rhi_max_render_target_count> m_rhi_dsv_read_only;
+        std::vector<void*> m_rhi_rtv; // one per slice
+        std::vector<void*> m_rhi_dsv;
+        std::vector<void*> m_rhi_dsv_read_only;
+        std::vector<void*> m_rhi_rtv_multiview; // rhi_max_view_count slices, starting from the index
+        std::vector<void*> m_rhi_dsv_multiview;
 
     private:
         void ComputeMemoryUsage();
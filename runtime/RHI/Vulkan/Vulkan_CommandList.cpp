@@ -46,6 +46,9 @@ using namespace Spartan::Math;
 
 namespace Spartan
 {
+    // Secondary command lists can look up (and create) pipelines from multiple threads
+    static mutex mutex_pipelines;
+
     static VkAttachmentLoadOp get_color_load_op(const Color& color)
     {
         if (color == rhi_color_dont_care)
@@ -68,18 +71,19 @@ namespace Spartan
         return VK_ATTACHMENT_LOAD_OP_CLEAR;
     };
 
-    RHI_CommandList::RHI_CommandList(const RHI_Queue_Type queue_type, const uint32_t index, void* cmd_pool, const char* name) : Object()
+    RHI_CommandList::RHI_CommandList(const RHI_Queue_Type queue_type, const uint32_t index, void* cmd_pool, const char* name, const bool is_secondary /*= false*/) : Object()
     {
-        m_queue_type = queue_type;
-        m_object_name       = name;
-        m_index      = index;
+        m_queue_type   = queue_type;
+        m_object_name  = name;
+        m_index        = index;
+        m_is_secondary = is_secondary;
 
         // Command buffer
         {
             VkCommandBufferAllocateInfo allocate_info = {};
             allocate_info.sType                       = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
             allocate_info.commandPool                 = static_cast<VkCommandPool>(cmd_pool);
-            allocate_info.level                       = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+            allocate_info.level                       = is_secondary ? VK_COMMAND_BUFFER_LEVEL_SECONDARY : VK_COMMAND_BUFFER_LEVEL_PRIMARY;
             allocate_info.commandBufferCount          = 1;
 
             // Allocate
@@ -90,6 +94,10 @@ namespace Spartan
             RHI_Device::SetResourceName(static_cast<void*>(m_rhi_resource), RHI_Resource_Type::CommandList, name);
         }
 
+        // Secondary command lists are never submitted, the primary that executes them does the timing and the syncing
+        if (is_secondary)
+            return;
+
         // Query pool
         if (RHI_Context::gpu_profiling)
         {
@@ -122,6 +130,7 @@ namespace Spartan
     void RHI_CommandList::Begin()
     {
         SP_ASSERT(m_state == RHI_CommandListState::Idle);
+        SP_ASSERT_MSG(!m_is_secondary, "Secondary command lists begin with BeginSecondary()");
 
         // Get queries
         if (m_queue_type != RHI_Queue_Type::Copy)
@@ -170,6 +179,95 @@ namespace Spartan
         m_pipeline_dirty = true;
     }
 
+    void RHI_CommandList::BeginSecondary(const RHI_PipelineState& pso)
+    {
+        SP_ASSERT(m_is_secondary);
+        SP_ASSERT(m_state != RHI_CommandListState::Recording);
+        SP_ASSERT_MSG(pso.IsGraphics() && !pso.render_target_swapchain, "Secondary command lists can only render to textures");
+
+        // The attachment formats have to match the ones of the render pass that the primary is going to execute this in
+        array<VkFormat, rhi_max_render_target_count> attachment_formats_color;
+        uint32_t attachment_count_color = 0;
+        for (uint32_t i = 0; i < rhi_max_render_target_count; i++)
+        {
+            RHI_Texture* rt = pso.render_target_color_textures[i];
+            if (rt == nullptr)
+                break;
+
+            attachment_formats_color[attachment_count_color++] = vulkan_format[rhi_format_to_index(rt->GetFormat())];
+        }
+
+        VkCommandBufferInheritanceRenderingInfo inheritance_rendering_info = {};
+        inheritance_rendering_info.sType                                   = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_RENDERING_INFO;
+        inheritance_rendering_info.colorAttachmentCount                    = attachment_count_color;
+        inheritance_rendering_info.pColorAttachmentFormats                 = attachment_formats_color.data();
+        inheritance_rendering_info.rasterizationSamples                    = VK_SAMPLE_COUNT_1_BIT;
+        inheritance_rendering_info.viewMask                                = pso.render_target_view_mask;
+        if (RHI_Texture* rt = pso.render_target_depth_texture)
+        {
+            inheritance_rendering_info.depthAttachmentFormat   = vulkan_format[rhi_format_to_index(rt->GetFormat())];
+            inheritance_rendering_info.stencilAttachmentFormat = rt->IsStencilFormat() ? inheritance_rendering_info.depthAttachmentFormat : VK_FORMAT_UNDEFINED;
+        }
+
+        VkCommandBufferInheritanceInfo inheritance_info = {};
+        inheritance_info.sType                          = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+        inheritance_info.pNext                          = &inheritance_rendering_info;
+
+        // Begin command buffer
+        VkCommandBufferBeginInfo begin_info = {};
+        begin_info.sType                    = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        begin_info.flags                    = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+        begin_info.pInheritanceInfo         = &inheritance_info;
+        SP_ASSERT_MSG(vkBeginCommandBuffer(static_cast<VkCommandBuffer>(m_rhi_resource), &begin_info) == VK_SUCCESS, "Failed to begin command buffer");
+
+        // Update states
+        m_state            = RHI_CommandListState::Recording;
+        m_pipeline_dirty   = true;
+        m_is_rendering     = true;
+        m_vertex_buffer_id = 0;
+        m_index_buffer_id  = 0;
+
+        // Bind the pipeline, the pso is copied since other threads could be beginning with the same one
+        RHI_PipelineState pso_secondary = pso;
+        SetPipelineState(pso_secondary);
+
+        // Set viewport
+        RHI_Viewport viewport = RHI_Viewport(
+            0.0f, 0.0f,
+            static_cast<float>(m_pso.GetWidth()),
+            static_cast<float>(m_pso.GetHeight())
+        );
+        SetViewport(viewport);
+    }
+
+    void RHI_CommandList::ExecuteCommands(RHI_CommandList* const* cmd_lists, const uint32_t cmd_list_count)
+    {
+        SP_ASSERT(m_state == RHI_CommandListState::Recording);
+        SP_ASSERT(!m_is_secondary);
+        SP_ASSERT_MSG(m_is_rendering, "Secondary command lists can only be executed within a render pass");
+
+        static vector<VkCommandBuffer> cmd_buffers;
+        cmd_buffers.clear();
+        for (uint32_t i = 0; i < cmd_list_count; i++)
+        {
+            RHI_CommandList* cmd_list = cmd_lists[i];
+            SP_ASSERT(cmd_list->IsSecondary() && cmd_list->GetState() == RHI_CommandListState::Ended);
+
+            cmd_buffers.emplace_back(static_cast<VkCommandBuffer>(cmd_list->GetRhiResource()));
+            cmd_list->m_state = RHI_CommandListState::Submitted;
+        }
+
+        if (cmd_buffers.empty())
+            return;
+
+        vkCmdExecuteCommands(static_cast<VkCommandBuffer>(m_rhi_resource), static_cast<uint32_t>(cmd_buffers.size()), cmd_buffers.data());
+
+        // The state of this command list is undefined after executing secondary ones, so everything has to bind again
+        m_pipeline_dirty   = true;
+        m_vertex_buffer_id = 0;
+        m_index_buffer_id  = 0;
+    }
+
     void RHI_CommandList::End()
     {
         SP_ASSERT(m_state == RHI_CommandListState::Recording);
@@ -179,6 +277,12 @@ namespace Spartan
             "Failed to end command buffer"
         );
 
+        // A secondary's render pass belongs to the primary
+        if (m_is_secondary)
+        {
+            m_is_rendering = false;
+        }
+
         m_state = RHI_CommandListState::Ended;
     }
 
@@ -214,16 +318,20 @@ namespace Spartan
         // If no pipeline exists for this state, create one
         uint64_t hash_previous = m_pso.GetHash();
         uint64_t hash          = pso.GetHash();
-        auto it = RHI_Device::GetPipelines().find(hash);
-        if (it == RHI_Device::GetPipelines().end())
         {
-            // Create a new pipeline
-            it = RHI_Device::GetPipelines().emplace(make_pair(hash, move(make_shared<RHI_Pipeline>(pso, m_descriptor_layout_current)))).first;
-            SP_LOG_INFO("A new pipeline has been created.");
-        }
+            lock_guard<mutex> lock(mutex_pipelines);
+
+            auto it = RHI_Device::GetPipelines().find(hash);
+            if (it == RHI_Device::GetPipelines().end())
+            {
+                // Create a new pipeline
+                it = RHI_Device::GetPipelines().emplace(make_pair(hash, move(make_shared<RHI_Pipeline>(pso, m_descriptor_layout_current)))).first;
+                SP_LOG_INFO("A new pipeline has been created.");
+            }
 
-        m_pipeline = it->second.get();
-        m_pso      = pso;
+            m_pipeline = it->second.get();
+        }
+        m_pso = pso;
 
         // Determine if the pipeline is dirty
         if (!m_pipeline_dirty)
@@ -254,7 +362,7 @@ namespace Spartan
         }
     }
 
-    void RHI_CommandList::BeginRenderPass()
+    void RHI_CommandList::BeginRenderPass(const bool contents_secondary /*= false*/)
     {
         SP_ASSERT(m_state == RHI_CommandListState::Recording);
         SP_ASSERT_MSG(m_pso.IsGraphics(), "You can't use a render pass with a compute pipeline");
@@ -265,8 +373,10 @@ namespace Spartan
 
         VkRenderingInfo rendering_info      = {};
         rendering_info.sType                = VK_STRUCTURE_TYPE_RENDERING_INFO_KHR;
+        rendering_info.flags                = contents_secondary ? VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT : 0;
         rendering_info.renderArea           = { 0, 0, m_pso.GetWidth(), m_pso.GetHeight() };
         rendering_info.layerCount           = 1;
+        rendering_info.viewMask             = m_pso.render_target_view_mask;
         rendering_info.colorAttachmentCount = 0;
         rendering_info.pColorAttachments    = nullptr;
         rendering_info.pDepthAttachment     = nullptr;
@@ -315,7 +425,7 @@ namespace Spartan
 
                     VkRenderingAttachmentInfo color_attachment = {};
                     color_attachment.sType                     = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR;
-                    color_attachment.imageView                 = static_cast<VkImageView>(rt->GetRhiRtv(m_pso.render_target_color_texture_array_index));
+                    color_attachment.imageView                 = static_cast<VkImageView>(m_pso.render_target_view_mask ? rt->GetRhiRtvMultiview(m_pso.render_target_color_texture_array_index) : rt->GetRhiRtv(m_pso.render_target_color_texture_array_index));
                     color_attachment.imageLayout               = vulkan_image_layout[static_cast<uint8_t>(rt->GetLayout(0))];
                     color_attachment.loadOp                    = get_color_load_op(m_pso.clear_color[i]);
                     color_attachment.storeOp                   = VK_ATTACHMENT_STORE_OP_STORE;
@@ -348,7 +458,7 @@ namespace Spartan
             rt->SetLayout(layout, this);
 
             attachment_depth_stencil.sType                           = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR;
-            attachment_depth_stencil.imageView                       = static_cast<VkImageView>(rt->GetRhiDsv(m_pso.render_target_depth_stencil_texture_array_index));
+            attachment_depth_stencil.imageView                       = static_cast<VkImageView>(m_pso.render_target_view_mask ? rt->GetRhiDsvMultiview(m_pso.render_target_depth_stencil_texture_array_index) : rt->GetRhiDsv(m_pso.render_target_depth_stencil_texture_array_index));
             attachment_depth_stencil.imageLayout                     = vulkan_image_layout[static_cast<uint8_t>(rt->GetLayout(0))];
             attachment_depth_stencil.loadOp                          = get_depth_load_op(m_pso.clear_depth);
             attachment_depth_stencil.storeOp                         = VK_ATTACHMENT_STORE_OP_STORE;
@@ -367,16 +477,18 @@ namespace Spartan
 
         // Begin dynamic render pass instance
         vkCmdBeginRendering(static_cast<VkCommandBuffer>(m_rhi_resource), &rendering_info);
-
-        // Set viewport
-        RHI_Viewport viewport = RHI_Viewport(
-            0.0f, 0.0f,
-            static_cast<float>(m_pso.GetWidth()),
-            static_cast<float>(m_pso.GetHeight())
-        );
-        SetViewport(viewport);
-
         m_is_rendering = true;
+
+        // Set viewport (secondary command lists set their own)
+        if (!contents_secondary)
+        {
+            RHI_Viewport viewport = RHI_Viewport(
+                0.0f, 0.0f,
+                static_cast<float>(m_pso.GetWidth()),
+                static_cast<float>(m_pso.GetHeight())
+            );
+            SetViewport(viewport);
+        }
     }
 
     void RHI_CommandList::EndRenderPass()
@@ -526,7 +638,7 @@ namespace Spartan
         }
     }
 
-    void RHI_CommandList::DrawIndexed(const uint32_t index_count, const uint32_t index_offset, const uint32_t vertex_offset)
+    void RHI_CommandList::DrawIndexed(const uint32_t index_count, const uint32_t index_offset, const uint32_t vertex_offset, const uint32_t instance_count)
     {
         SP_ASSERT(m_state == RHI_CommandListState::Recording);
 
@@ -537,7 +649,7 @@ namespace Spartan
         vkCmdDrawIndexed(
             static_cast<VkCommandBuffer>(m_rhi_resource), // commandBuffer
             index_count,                                  // indexCount
-            1,                                            // instanceCount
+            instance_count,                               // instanceCount
             index_offset,                                 // firstIndex
             vertex_offset,                                // vertexOffset
             0                                             // firstInstance
@@ -550,6 +662,56 @@ namespace Spartan
         }
     }
 
+    void RHI_CommandList::DrawIndexedIndirect(RHI_StructuredBuffer* args_buffer, const uint32_t args_offset, const uint32_t draw_count)
+    {
+        SP_ASSERT(m_state == RHI_CommandListState::Recording);
+        SP_ASSERT_MSG(draw_count <= 1 || RHI_Device::IsDrawIndirectCountSupported(), "Multi draw indirect is not supported");
+
+        // Ensure correct state before attempting to draw
+        OnDraw();
+
+        // Draw
+        vkCmdDrawIndexedIndirect(
+            static_cast<VkCommandBuffer>(m_rhi_resource),         // commandBuffer
+            static_cast<VkBuffer>(args_buffer->GetRhiResource()), // buffer
+            args_offset,                                          // offset
+            draw_count,                                           // drawCount
+            rhi_draw_indexed_indirect_stride                      // stride
+        );
+
+        // Profile
+        if (Profiler::m_granularity == ProfilerGranularity::Full)
+        {
+            Profiler::m_rhi_draw++;
+        }
+    }
+
+    void RHI_CommandList::DrawIndexedIndirectCount(RHI_StructuredBuffer* args_buffer, const uint32_t args_offset, RHI_StructuredBuffer* count_buffer, const uint32_t count_offset, const uint32_t draw_count_max)
+    {
+        SP_ASSERT(m_state == RHI_CommandListState::Recording);
+        SP_ASSERT_MSG(RHI_Device::IsDrawIndirectCountSupported(), "Draw indirect count is not supported");
+
+        // Ensure correct state before attempting to draw
+        OnDraw();
+
+        // Draw
+        vkCmdDrawIndexedIndirectCount(
+            static_cast<VkCommandBuffer>(m_rhi_resource),          // commandBuffer
+            static_cast<VkBuffer>(args_buffer->GetRhiResource()),  // buffer
+            args_offset,                                           // offset
+            static_cast<VkBuffer>(count_buffer->GetRhiResource()), // countBuffer
+            count_offset,                                          // countBufferOffset
+            draw_count_max,                                        // maxDrawCount
+            rhi_draw_indexed_indirect_stride                       // stride
+        );
+
+        // Profile
+        if (Profiler::m_granularity == ProfilerGranularity::Full)
+        {
+            Profiler::m_rhi_draw++;
+        }
+    }
+
     void RHI_CommandList::Dispatch(uint32_t x, uint32_t y, uint32_t z /*= 1*/, bool async /*= false*/)
     {
         SP_ASSERT(m_state == RHI_CommandListState::Recording);
@@ -563,6 +725,38 @@ namespace Spartan
         Profiler::m_rhi_dispatch++;
     }
 
+    void RHI_CommandList::InsertBarrierStructuredBuffer(RHI_StructuredBuffer* structured_buffer)
+    {
+        SP_ASSERT(m_state == RHI_CommandListState::Recording);
+        SP_ASSERT_MSG(!m_is_rendering, "Barriers have to be inserted outside of a render pass");
+
+        VkBufferMemoryBarrier barrier = {};
+        barrier.sType                 = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        barrier.srcAccessMask         = VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_HOST_WRITE_BIT;
+        barrier.dstAccessMask         = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_HOST_READ_BIT;
+        barrier.srcQueueFamilyIndex   = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex   = VK_QUEUE_FAMILY_IGNORED;
+        barrier.buffer                = static_cast<VkBuffer>(structured_buffer->GetRhiResource());
+        barrier.offset                = 0;
+        barrier.size                  = VK_WHOLE_SIZE;
+
+        vkCmdPipelineBarrier
+        (
+            static_cast<VkCommandBuffer>(m_rhi_resource),                    // commandBuffer
+            VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,                              // srcStageMask
+            VK_PIPELINE_STAGE_ALL_COMMANDS_BIT | VK_PIPELINE_STAGE_HOST_BIT, // dstStageMask
+            0,                                                               // dependencyFlags
+            0,                                                               // memoryBarrierCount
+            nullptr,                                                         // pMemoryBarriers
+            1,                                                               // bufferMemoryBarrierCount
+            &barrier,                                                        // pBufferMemoryBarriers
+            0,                                                               // imageMemoryBarrierCount
+            nullptr                                                          // pImageMemoryBarriers
+        );
+
+        Profiler::m_rhi_pipeline_barriers++;
+    }
+
     void RHI_CommandList::Blit(RHI_Texture* source, RHI_Texture* destination, const RHI_Filter filter, const bool blit_mips)
     {
         SP_ASSERT_MSG((source->GetFlags() & RHI_Texture_ClearOrBlit) != 0,      "The texture needs the RHI_Texture_ClearOrBlit flag");
@@ -690,6 +884,43 @@ namespace Spartan
         source->SetLayout(layout_initial_source, this);
     }
 
+    void RHI_CommandList::Copy(RHI_Texture* source, RHI_Texture* destination, const uint32_t array_index, const uint32_t array_length /*= 1*/)
+    {
+        SP_ASSERT_MSG((source->GetFlags() & RHI_Texture_ClearOrBlit) != 0,      "The texture needs the RHI_Texture_ClearOrBlit flag");
+        SP_ASSERT_MSG((destination->GetFlags() & RHI_Texture_ClearOrBlit) != 0, "The texture needs the RHI_Texture_ClearOrBlit flag");
+        SP_ASSERT(source->GetWidth() == destination->GetWidth() && source->GetHeight() == destination->GetHeight());
+        SP_ASSERT(source->GetFormat() == destination->GetFormat());
+        SP_ASSERT(array_index + array_length <= source->GetArrayLength() && array_index + array_length <= destination->GetArrayLength());
+
+        VkImageCopy copy_region                   = {};
+        copy_region.srcSubresource.aspectMask     = vulkan_utility::image::get_aspect_mask(source);
+        copy_region.srcSubresource.mipLevel       = 0;
+        copy_region.srcSubresource.baseArrayLayer = array_index;
+        copy_region.srcSubresource.layerCount     = array_length;
+        copy_region.dstSubresource                = copy_region.srcSubresource;
+        copy_region.extent                        = { source->GetWidth(), source->GetHeight(), 1 };
+
+        // Save the initial layouts
+        const RHI_Image_Layout layout_initial_source      = source->GetLayout(0);
+        const RHI_Image_Layout layout_initial_destination = destination->GetLayout(0);
+
+        // Transition to copy appropriate layouts
+        source->SetLayout(RHI_Image_Layout::Transfer_Src_Optimal,      this);
+        destination->SetLayout(RHI_Image_Layout::Transfer_Dst_Optimal, this);
+
+        // Copy
+        vkCmdCopyImage(
+            static_cast<VkCommandBuffer>(m_rhi_resource),
+            static_cast<VkImage>(source->GetRhiResource()),      VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+            static_cast<VkImage>(destination->GetRhiResource()), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            1, &copy_region
+        );
+
+        // Transition to the initial layouts
+        source->SetLayout(layout_initial_source, this);
+        destination->SetLayout(layout_initial_destination, this);
+    }
+
     void RHI_CommandList::SetViewport(const RHI_Viewport& viewport) const
     {
         SP_ASSERT(m_state == RHI_CommandListState::Recording);
@@ -895,7 +1126,7 @@ namespace Spartan
         m_descriptor_layout_current->SetTexture(slot, texture, mip_index, mip_range);
     }
 
-    void RHI_CommandList::SetStructuredBuffer(const uint32_t slot, RHI_StructuredBuffer* structured_buffer) const
+    void RHI_CommandList::SetStructuredBuffer(const uint32_t slot, RHI_StructuredBuffer* structured_buffer, const bool uav) const
     {
         // Validate command list state
         SP_ASSERT(m_state == RHI_CommandListState::Recording);
@@ -906,7 +1137,7 @@ namespace Spartan
             return;
         }
 
-        m_descriptor_layout_current->SetStructuredBuffer(slot, structured_buffer);
+        m_descriptor_layout_current->SetStructuredBuffer(slot, structured_buffer, uav);
     }
 
     void RHI_CommandList::BeginMarker(const char* name)
@@ -1030,7 +1261,7 @@ namespace Spartan
             };
 
             // Get dynamic offsets
-            static vector<uint32_t> dynamic_offsets;
+            static thread_local vector<uint32_t> dynamic_offsets;
             m_descriptor_layout_current->GetDynamicOffsets(&dynamic_offsets);
 
             VkPipelineBindPoint bind_point = m_pso.IsCompute() ?
@@ -33,6 +33,24 @@ using namespace std;
 
 namespace Spartan
 {
+    static void* create_command_pool(const RHI_Queue_Type queue_type, const string& name)
+    {
+        VkCommandPoolCreateInfo cmd_pool_info = {};
+        cmd_pool_info.sType                   = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        cmd_pool_info.queueFamilyIndex        = RHI_Device::GetQueueIndex(queue_type);
+        cmd_pool_info.flags                   = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT; // specifies that command buffers allocated from the pool will be short-lived
+
+        // Create
+        void* cmd_pool = nullptr;
+        SP_VK_ASSERT_MSG(vkCreateCommandPool(RHI_Context::device, &cmd_pool_info, nullptr, reinterpret_cast<VkCommandPool*>(&cmd_pool)),
+            "Failed to create command pool");
+
+        // Name
+        RHI_Device::SetResourceName(cmd_pool, RHI_Resource_Type::CommandPool, name);
+
+        return cmd_pool;
+    }
+
     RHI_CommandPool::RHI_CommandPool(const char* name, const uint64_t swap_chain_id) : Object()
     {
         m_object_name          = name;
@@ -80,25 +98,57 @@ namespace Spartan
             vkDestroyCommandPool(RHI_Context::device, static_cast<VkCommandPool>(m_rhi_resources[i]), nullptr);
             m_rhi_resources[i] = nullptr;
         }
+
+        // Destroy secondary pools, this also frees their command buffers
+        for (SecondarySlot& slot : m_secondary_slots)
+        {
+            slot.cmd_lists.clear();
+            vkDestroyCommandPool(RHI_Context::device, static_cast<VkCommandPool>(slot.rhi_resource), nullptr);
+            slot.rhi_resource = nullptr;
+        }
     }
 
     void RHI_CommandPool::CreateCommandPool(const RHI_Queue_Type queue_type)
     {
         m_queue_type = queue_type;
 
-        VkCommandPoolCreateInfo cmd_pool_info = {};
-        cmd_pool_info.sType                   = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
-        cmd_pool_info.queueFamilyIndex        = RHI_Device::GetQueueIndex(queue_type);
-        cmd_pool_info.flags                   = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT; // specifies that command buffers allocated from the pool will be short-lived
+        uint32_t cmd_pool_count = static_cast<uint32_t>(m_rhi_resources.size()) + 1;
+        m_rhi_resources.emplace_back(create_command_pool(queue_type, m_object_name + string("_") + to_string(cmd_pool_count)));
+    }
 
-        // Create
-        m_rhi_resources.emplace_back(nullptr);
-        SP_VK_ASSERT_MSG(vkCreateCommandPool(RHI_Context::device, &cmd_pool_info, nullptr, reinterpret_cast<VkCommandPool*>(&m_rhi_resources.back())),
-            "Failed to create command pool");
+    void RHI_CommandPool::AllocateSecondaryCommandLists(const uint32_t slot_count)
+    {
+        SP_ASSERT_MSG(m_cmd_pool_count != 0, "Allocate the primary command lists first");
+        SP_ASSERT_MSG(m_secondary_slots.empty(), "Secondary command lists have already been allocated");
 
-        // Name
-        uint32_t cmd_pool_count = static_cast<uint32_t>(m_rhi_resources.size());
-        RHI_Device::SetResourceName(m_rhi_resources.back(), RHI_Resource_Type::CommandPool, (m_object_name + string("_") + to_string(cmd_pool_count)));
+        m_secondary_slot_count = slot_count;
+        m_secondary_slots.resize(m_cmd_pool_count * slot_count);
+
+        for (uint32_t index_cmd_pool = 0; index_cmd_pool < m_cmd_pool_count; index_cmd_pool++)
+        {
+            for (uint32_t index_slot = 0; index_slot < slot_count; index_slot++)
+            {
+                string name = m_object_name + "_cmd_pool_" + to_string(index_cmd_pool) + "_secondary_" + to_string(index_slot);
+                m_secondary_slots[index_cmd_pool * slot_count + index_slot].rhi_resource = create_command_pool(m_queue_type, name);
+            }
+        }
+    }
+
+    RHI_CommandList* RHI_CommandPool::GetSecondaryCommandList(const uint32_t slot_index)
+    {
+        SP_ASSERT(slot_index < m_secondary_slot_count);
+
+        // Only the thread that records the slot touches it, so no locking is needed
+        SecondarySlot& slot = m_secondary_slots[GetPoolIndex() * m_secondary_slot_count + slot_index];
+
+        // A list can only be recorded once until the pool is reset, so grow as needed
+        if (slot.cmd_list_index == static_cast<uint32_t>(slot.cmd_lists.size()))
+        {
+            string name = m_object_name + "_secondary_" + to_string(slot_index) + "_cmd_list_" + to_string(slot.cmd_list_index);
+            slot.cmd_lists.emplace_back(make_shared<RHI_CommandList>(m_queue_type, slot_index, slot.rhi_resource, name.c_str(), true));
+        }
+
+        return slot.cmd_lists[slot.cmd_list_index++].get();
     }
 
     void RHI_CommandPool::Reset(const uint32_t pool_index)
@@ -107,5 +157,13 @@ namespace Spartan
 
         VkCommandPool pool = static_cast<VkCommandPool>(m_rhi_resources[pool_index]);
         SP_VK_ASSERT_MSG(vkResetCommandPool(RHI_Context::device, pool, 0), "Failed to reset command pool");
+
+        // The secondary command lists were executed by primaries of this pool, so they can be recycled too
+        for (uint32_t index_slot = 0; index_slot < m_secondary_slot_count; index_slot++)
+        {
+            SecondarySlot& slot = m_secondary_slots[pool_index * m_secondary_slot_count + index_slot];
+            SP_VK_ASSERT_MSG(vkResetCommandPool(RHI_Context::device, static_cast<VkCommandPool>(slot.rhi_resource), 0), "Failed to reset command pool");
+            slot.cmd_list_index = 0;
+        }
     }
 }
@@ -582,9 +582,12 @@ namespace Spartan
             VkPhysicalDeviceVulkan12Features device_features_to_enable_1_2 = {};
             device_features_to_enable_1_2.sType                            = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
             device_features_to_enable_1_2.pNext                            = &device_features_to_enable_1_3;
+            VkPhysicalDeviceVulkan11Features device_features_to_enable_1_1 = {};
+            device_features_to_enable_1_1.sType                            = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_1_FEATURES;
+            device_features_to_enable_1_1.pNext                            = &device_features_to_enable_1_2;
             VkPhysicalDeviceFeatures2 device_features_to_enable            = {};
             device_features_to_enable.sType                                = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
-            device_features_to_enable.pNext                                = &device_features_to_enable_1_2;
+            device_features_to_enable.pNext                                = &device_features_to_enable_1_1;
             {
                 // Check feature support
                 VkPhysicalDeviceVulkan13Features features_supported_1_3 = {};
@@ -592,9 +595,12 @@ namespace Spartan
                 VkPhysicalDeviceVulkan12Features features_supported_1_2 = {};
                 features_supported_1_2.sType                            = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
                 features_supported_1_2.pNext                            = &features_supported_1_3;
+                VkPhysicalDeviceVulkan11Features features_supported_1_1 = {};
+                features_supported_1_1.sType                            = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_1_FEATURES;
+                features_supported_1_1.pNext                            = &features_supported_1_2;
                 VkPhysicalDeviceFeatures2 features_supported            = {};
                 features_supported.sType                                = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
-                features_supported.pNext                                = &features_supported_1_2;
+                features_supported.pNext                                = &features_supported_1_1;
                 vkGetPhysicalDeviceFeatures2(RHI_Context::device_physical, &features_supported);
 
                 // Check if certain features are supported and enable them
@@ -627,6 +633,10 @@ namespace Spartan
                     SP_ASSERT(features_supported_1_2.timelineSemaphore == VK_TRUE);
                     device_features_to_enable_1_2.timelineSemaphore = VK_TRUE;
 
+                    // Rendering the faces of a cube in a single pass (required since Vulkan 1.1, software devices included)
+                    SP_ASSERT(features_supported_1_1.multiview == VK_TRUE);
+                    device_features_to_enable_1_1.multiview = VK_TRUE;
+
                     // Rendering without render passes and frame buffer objects
                     SP_ASSERT(features_supported_1_3.dynamicRendering == VK_TRUE);
                     device_features_to_enable_1_3.dynamicRendering = VK_TRUE;
@@ -652,6 +662,14 @@ namespace Spartan
                     {
                         device_features_to_enable.features.shaderInt16 = VK_TRUE;
                     }
+
+                    // Indirect drawing with a GPU written draw count - If supported, the renderer can cull and draw on the GPU, so don't assert.
+                    if (features_supported.features.multiDrawIndirect == VK_TRUE && features_supported_1_2.drawIndirectCount == VK_TRUE)
+                    {
+                        device_features_to_enable.features.multiDrawIndirect = VK_TRUE;
+                        device_features_to_enable_1_2.drawIndirectCount      = VK_TRUE;
+                        m_draw_indirect_count                                = true;
+                    }
                 }
             }
 
@@ -1301,6 +1319,14 @@ namespace Spartan
         }
     }
 
+    void RHI_Device::InvalidateAllocation(void* resource, uint64_t offset, uint64_t size)
+    {
+        if (VmaAllocation allocation = static_cast<VmaAllocation>(vulkan_memory_allocator::get_allocation_from_resource(resource)))
+        {
+            SP_ASSERT_MSG(vmaInvalidateAllocation(vulkan_memory_allocator::allocator, allocation, offset, size) == VK_SUCCESS, "Failed to invalidate");
+        }
+    }
+
     void* RHI_Device::GetQueue(const RHI_Queue_Type type)
     {
         if (type == RHI_Queue_Type::Graphics)
@@ -347,6 +347,7 @@ namespace Spartan
                     }
 
                     pipeline_rendering_create_info.sType                   = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO_KHR;
+                    pipeline_rendering_create_info.viewMask                = m_state.render_target_view_mask;
                     pipeline_rendering_create_info.colorAttachmentCount    = static_cast<uint32_t>(attachment_formats_color.size());
                     pipeline_rendering_create_info.pColorAttachmentFormats = attachment_formats_color.data();
                     pipeline_rendering_create_info.depthAttachmentFormat   = attachment_format_depth;
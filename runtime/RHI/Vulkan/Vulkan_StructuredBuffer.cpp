@@ -49,8 +49,8 @@ namespace Spartan
         // Define memory properties
         VkMemoryPropertyFlags flags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT; // mappable
 
-        // Create buffer
-        RHI_Device::CreateBuffer(m_rhi_resource, m_object_size_gpu, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, flags, nullptr, name);
+        // Create buffer (it can also be the source of indirect draw arguments)
+        RHI_Device::CreateBuffer(m_rhi_resource, m_object_size_gpu, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, flags, nullptr, name);
 
         // Get mapped data pointer
         m_mapped_data = RHI_Device::GetMappedDataFromBuffer(m_rhi_resource);
@@ -65,10 +65,14 @@ namespace Spartan
         m_rhi_resource = nullptr;
     }
 
-    void RHI_StructuredBuffer::Update(void* data_cpu)
+    void RHI_StructuredBuffer::Update(void* data_cpu, const uint32_t size)
     {
+        // Only the part that's used has to be copied, the descriptor still covers the whole stride
+        const uint32_t size_update = size != 0 ? size : m_stride;
+
         SP_ASSERT_MSG(data_cpu != nullptr,                      "Invalid update data");
         SP_ASSERT_MSG(m_mapped_data != nullptr,                 "Invalid mapped data");
+        SP_ASSERT_MSG(size_update <= m_stride,                  "Update is larger than the stride");
         SP_ASSERT_MSG(m_offset + m_stride <= m_object_size_gpu, "Out of memory");
 
         // Advance offset
@@ -80,7 +84,7 @@ namespace Spartan
         }
 
         // Vulkan is using persistent mapping, so we only need to copy and flush
-        memcpy(reinterpret_cast<std::byte*>(m_mapped_data) + m_offset, reinterpret_cast<std::byte*>(data_cpu), m_stride);
-        RHI_Device::FlushAllocation(m_rhi_resource, m_offset, m_stride);
+        memcpy(reinterpret_cast<std::byte*>(m_mapped_data) + m_offset, reinterpret_cast<std::byte*>(data_cpu), size_update);
+        RHI_Device::FlushAllocation(m_rhi_resource, m_offset, size_update);
     }
 }
@@ -335,6 +335,13 @@ namespace Spartan
             }
 
             // Render target views
+            if (IsRenderTarget())
+            {
+                m_rhi_rtv.assign(m_array_length, nullptr);
+                m_rhi_dsv.assign(m_array_length, nullptr);
+                m_rhi_rtv_multiview.assign(m_array_length, nullptr);
+                m_rhi_dsv_multiview.assign(m_array_length, nullptr);
+            }
             for (uint32_t i = 0; i < m_array_length; i++)
             {
                 // Both cube map slices/faces and array length is encoded into m_array_length.
@@ -349,6 +356,20 @@ namespace Spartan
                 {
                     vulkan_utility::image::view::create(m_rhi_resource, m_rhi_dsv[i], this, ResourceType::Texture2d, i, 1, 0, 1, true, false);
                 }
+
+                // Multiview, the faces of a cube (or any six consecutive slices) are rendered in a single pass
+                if (i + rhi_max_view_count <= m_array_length)
+                {
+                    if (IsRenderTargetColor())
+                    {
+                        vulkan_utility::image::view::create(m_rhi_resource, m_rhi_rtv_multiview[i], this, ResourceType::Texture2dArray, i, rhi_max_view_count, 0, 1, false, false);
+                    }
+
+                    if (IsRenderTargetDepthStencil())
+                    {
+                        vulkan_utility::image::view::create(m_rhi_resource, m_rhi_dsv_multiview[i], this, ResourceType::Texture2dArray, i, rhi_max_view_count, 0, 1, true, false);
+                    }
+                }
             }
 
             // Name the image and image view(s)
@@ -366,13 +387,13 @@ namespace Spartan
             RHI_Device::AddToDeletionQueue(RHI_Resource_Type::TextureView, m_rhi_srv);
             m_rhi_srv = nullptr;
 
-            for (uint32_t i = 0; i < rhi_max_render_target_count; i++)
+            for (vector<void*>* views : { &m_rhi_dsv, &m_rhi_rtv, &m_rhi_dsv_multiview, &m_rhi_rtv_multiview })
             {
-                RHI_Device::AddToDeletionQueue(RHI_Resource_Type::TextureView, m_rhi_dsv[i]);
-                m_rhi_dsv[i] = nullptr;
-
-                RHI_Device::AddToDeletionQueue(RHI_Resource_Type::TextureView, m_rhi_rtv[i]);
-                m_rhi_rtv[i] = nullptr;
+                for (void* view : *views)
+                {
+                    RHI_Device::AddToDeletionQueue(RHI_Resource_Type::TextureView, view);
+                }
+                views->clear();
             }
         }
 
@@ -22,6 +22,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //= INCLUDES ================================
 #include "pch.h"
 #include "Mesh.h"
+#include "MeshBvh.h"
 #include "Renderer.h"
 #include "../RHI/RHI_Vertex.h"
 #include "../RHI/RHI_Texture.h"
@@ -34,6 +35,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../IO/FileStream.h"
 #include "../Resource/Import/ModelImporter.h"
 #include "../World/Components/Transform.h"
+#include "../Core/ThreadPool.h"
 SP_WARNINGS_OFF
 #include "meshoptimizer/meshoptimizer.h"
 SP_WARNINGS_ON
@@ -46,6 +48,27 @@ using namespace Spartan::Math;
 
 namespace Spartan
 {
+    namespace
+    {
+        // Marks the BVH section of a .model file, older files end right after the vertices
+        const uint32_t model_bvh_magic = 0x48564253; // "SBVH"
+
+        // Marks the LOD section, which follows the BVHs
+        const uint32_t model_lod_magic = 0x444F4C53; // "SLOD"
+
+        // A level which removes less than this fraction of the previous one isn't worth its memory
+        const float lod_reduction_min = 0.1f;
+
+        // Marks the cluster section, which follows the LODs
+        const uint32_t model_cluster_magic = 0x534C4353; // "SCLS"
+
+        // Clusters, the limits are the ones meshoptimizer recommends, ranges smaller than a few clusters aren't worth culling per cluster
+        const uint32_t cluster_vertex_count_max   = 64;
+        const uint32_t cluster_triangle_count_max = 124;
+        const uint32_t cluster_triangle_count_min = cluster_triangle_count_max * 8;
+        const float cluster_cone_weight           = 0.25f; // favours clusters which face one way, so more of them can be back-face culled
+    }
+
     Mesh::Mesh() : IResource(ResourceType::Mesh)
     {
         m_flags = GetDefaultFlags();
@@ -64,6 +87,19 @@ namespace Spartan
 
         m_vertices.clear();
         m_vertices.shrink_to_fit();
+
+        {
+            lock_guard lock(m_mutex_bvhs);
+            m_bvhs.clear();
+        }
+
+        {
+            lock_guard lock(m_mutex_lods);
+            m_lods.clear();
+        }
+
+        lock_guard lock(m_mutex_clusters);
+        m_clusters.clear();
     }
 
     bool Mesh::LoadFromFile(const string& file_path)
@@ -89,6 +125,65 @@ namespace Spartan
             file->Read(&m_indices);
             file->Read(&m_vertices);
 
+            // BVHs
+            uint32_t bvh_magic = 0;
+            file->Read(&bvh_magic);
+            if (bvh_magic == model_bvh_magic)
+            {
+                const uint32_t bvh_count = file->ReadAs<uint32_t>();
+                for (uint32_t i = 0; i < bvh_count; i++)
+                {
+                    const uint32_t index_offset = file->ReadAs<uint32_t>();
+                    BvhRange& range             = m_bvhs[index_offset];
+                    range.index_count           = file->ReadAs<uint32_t>();
+                    range.vertex_offset         = file->ReadAs<uint32_t>();
+                    range.bvh                   = make_shared<MeshBvh>();
+                    range.bvh->Deserialize(file.get(), &m_vertices[range.vertex_offset], &m_indices[index_offset], range.index_count);
+                }
+
+                // LODs
+                uint32_t lod_magic = 0;
+                file->Read(&lod_magic);
+                if (lod_magic == model_lod_magic)
+                {
+                    const uint32_t range_count = file->ReadAs<uint32_t>();
+                    for (uint32_t i = 0; i < range_count; i++)
+                    {
+                        vector<MeshLod>& lods = m_lods[file->ReadAs<uint32_t>()];
+                        lods.resize(file->ReadAs<uint32_t>());
+                        for (MeshLod& lod : lods)
+                        {
+                            file->Read(&lod.index_offset);
+                            file->Read(&lod.index_count);
+                            file->Read(&lod.error);
+                        }
+                    }
+
+                    // Clusters
+                    uint32_t cluster_magic = 0;
+                    file->Read(&cluster_magic);
+                    if (cluster_magic == model_cluster_magic)
+                    {
+                        const uint32_t cluster_range_count = file->ReadAs<uint32_t>();
+                        for (uint32_t i = 0; i < cluster_range_count; i++)
+                        {
+                            vector<MeshCluster>& clusters = m_clusters[file->ReadAs<uint32_t>()];
+                            clusters.resize(file->ReadAs<uint32_t>());
+                            for (MeshCluster& cluster : clusters)
+                            {
+                                file->Read(&cluster.index_offset);
+                                file->Read(&cluster.index_count);
+                                file->Read(&cluster.center);
+                                file->Read(&cluster.radius);
+                                file->Read(&cluster.cone_apex);
+                                file->Read(&cluster.cone_axis);
+                                file->Read(&cluster.cone_cutoff);
+                            }
+                        }
+                    }
+                }
+            }
+
             //Optimize();
             ComputeAabb();
             ComputeNormalizedScale();
@@ -140,6 +235,52 @@ namespace Spartan
         file->Write(m_indices);
         file->Write(m_vertices);
 
+        // BVHs, so they don't have to be built again on load
+        BuildBvhs();
+        file->Write(model_bvh_magic);
+        file->Write(static_cast<uint32_t>(m_bvhs.size()));
+        for (const auto& [index_offset, range] : m_bvhs)
+        {
+            file->Write(index_offset);
+            file->Write(range.index_count);
+            file->Write(range.vertex_offset);
+            range.bvh->Serialize(file.get());
+        }
+
+        // LODs, their indices are already part of the mesh's indices
+        file->Write(model_lod_magic);
+        file->Write(static_cast<uint32_t>(m_lods.size()));
+        for (const auto& [index_offset, lods] : m_lods)
+        {
+            file->Write(index_offset);
+            file->Write(static_cast<uint32_t>(lods.size()));
+            for (const MeshLod& lod : lods)
+            {
+                file->Write(lod.index_offset);
+                file->Write(lod.index_count);
+                file->Write(lod.error);
+            }
+        }
+
+        // Clusters, they are parts of index ranges which are already saved
+        file->Write(model_cluster_magic);
+        file->Write(static_cast<uint32_t>(m_clusters.size()));
+        for (const auto& [index_offset, clusters] : m_clusters)
+        {
+            file->Write(index_offset);
+            file->Write(static_cast<uint32_t>(clusters.size()));
+            for (const MeshCluster& cluster : clusters)
+            {
+                file->Write(cluster.index_offset);
+                file->Write(cluster.index_count);
+                file->Write(cluster.center);
+                file->Write(cluster.radius);
+                file->Write(cluster.cone_apex);
+                file->Write(cluster.cone_axis);
+                file->Write(cluster.cone_cutoff);
+            }
+        }
+
         file->Close();
 
         return true;
@@ -150,6 +291,10 @@ namespace Spartan
         uint32_t size = 0;
         size += uint32_t(m_indices.size()  * sizeof(uint32_t));
         size += uint32_t(m_vertices.size() * sizeof(RHI_Vertex_PosTexNorTan));
+        for (const auto& [index_offset, range] : m_bvhs)
+        {
+            size += range.bvh ? static_cast<uint32_t>(range.bvh->GetMemoryUsage()) : 0;
+        }
 
         return size;
     }
@@ -221,7 +366,9 @@ namespace Spartan
     uint32_t Mesh::GetDefaultFlags()
     {
         return
-            (1U << static_cast<uint32_t>(MeshProcessingOptions::RemoveRedundantData));
+            (1U << static_cast<uint32_t>(MeshProcessingOptions::RemoveRedundantData)) |
+            (1U << static_cast<uint32_t>(MeshProcessingOptions::GenerateLods))        |
+            (1U << static_cast<uint32_t>(MeshProcessingOptions::GenerateClusters));
     }
     
     float Mesh::ComputeNormalizedScale()
@@ -262,6 +409,185 @@ namespace Spartan
         meshopt_optimizeVertexFetch(&m_vertices[0], &m_indices[0], index_count, &vertices[0], vertex_count, vertex_size);
     }
 
+    void Mesh::AddBvhRange(const uint32_t index_offset, const uint32_t index_count, const uint32_t vertex_offset)
+    {
+        lock_guard lock(m_mutex_bvhs);
+
+        BvhRange& range     = m_bvhs[index_offset];
+        range.index_count   = index_count;
+        range.vertex_offset = vertex_offset;
+        range.bvh           = nullptr;
+    }
+
+    void Mesh::BuildBvhs()
+    {
+        lock_guard lock(m_mutex_bvhs);
+
+        vector<pair<const uint32_t, BvhRange>*> ranges;
+        for (auto& range : m_bvhs)
+        {
+            if (!range.second.bvh)
+            {
+                ranges.push_back(&range);
+            }
+        }
+
+        // Ranges don't share anything, so they are built in parallel
+        ThreadPool::ParallelFor([this, &ranges](uint32_t work_index_start, uint32_t work_index_end)
+        {
+            for (uint32_t i = work_index_start; i < work_index_end; i++)
+            {
+                const uint32_t index_offset = ranges[i]->first;
+                BvhRange& range             = ranges[i]->second;
+
+                range.bvh = make_shared<MeshBvh>();
+                range.bvh->Build(&m_vertices[range.vertex_offset], &m_indices[index_offset], range.index_count);
+            }
+        }, static_cast<uint32_t>(ranges.size()));
+    }
+
+    const MeshBvh* Mesh::GetBvh(const uint32_t index_offset, const uint32_t index_count, const uint32_t vertex_offset)
+    {
+        lock_guard lock(m_mutex_bvhs);
+
+        if (index_count == 0 || index_offset + index_count > m_indices.size() || vertex_offset >= m_vertices.size())
+            return nullptr;
+
+        BvhRange& range = m_bvhs[index_offset];
+        if (!range.bvh || range.index_count != index_count || range.vertex_offset != vertex_offset)
+        {
+            range.index_count   = index_count;
+            range.vertex_offset = vertex_offset;
+            range.bvh           = make_shared<MeshBvh>();
+            range.bvh->Build(&m_vertices[vertex_offset], &m_indices[index_offset], index_count);
+        }
+
+        return range.bvh.get();
+    }
+
+    void Mesh::AddLods(const uint32_t index_offset, const vector<uint32_t>& indices, const vector<RHI_Vertex_PosTexNorTan>& vertices)
+    {
+        if (m_lod_count <= 1 || indices.empty() || vertices.empty())
+            return;
+
+        const float* positions     = &vertices[0].pos[0];
+        const size_t vertex_count  = vertices.size();
+        const size_t vertex_stride = sizeof(RHI_Vertex_PosTexNorTan);
+        const float scale          = meshopt_simplifyScale(positions, vertex_count, vertex_stride); // relative to absolute error
+
+        vector<MeshLod> lods;
+        vector<uint32_t> indices_previous = indices;
+        vector<uint32_t> indices_lod(indices.size());
+        for (uint32_t level = 1; level < m_lod_count; level++)
+        {
+            // Simplify the previous level, so the levels nest and each one is cheap to produce
+            const size_t index_count_target = (indices_previous.size() / 2) / 3 * 3;
+            float error                     = 0.0f;
+            const size_t index_count        = meshopt_simplify(indices_lod.data(), indices_previous.data(), indices_previous.size(), positions, vertex_count, vertex_stride, index_count_target, m_lod_error_threshold, 0, &error);
+
+            // Stop once the error threshold doesn't let the simplifier remove enough
+            if (index_count == 0 || index_count > static_cast<size_t>(indices_previous.size() * (1.0f - lod_reduction_min)))
+                break;
+
+            indices_previous.assign(indices_lod.begin(), indices_lod.begin() + index_count);
+
+            MeshLod& lod    = lods.emplace_back();
+            lod.index_count = static_cast<uint32_t>(index_count);
+            lod.error       = error * scale;
+            AddIndices(indices_previous, &lod.index_offset);
+        }
+
+        if (lods.empty())
+            return;
+
+        lock_guard lock(m_mutex_lods);
+        m_lods[index_offset] = move(lods);
+    }
+
+    const vector<MeshLod>* Mesh::GetLods(const uint32_t index_offset)
+    {
+        lock_guard lock(m_mutex_lods);
+
+        auto it = m_lods.find(index_offset);
+        return it != m_lods.end() ? &it->second : nullptr;
+    }
+
+    vector<MeshCluster> Mesh::BuildClusters(vector<uint32_t>& indices, const vector<RHI_Vertex_PosTexNorTan>& vertices)
+    {
+        vector<MeshCluster> clusters;
+        if (indices.size() / 3 < cluster_triangle_count_min || vertices.empty())
+            return clusters;
+
+        const float* positions     = &vertices[0].pos[0];
+        const size_t vertex_count  = vertices.size();
+        const size_t vertex_stride = sizeof(RHI_Vertex_PosTexNorTan);
+
+        const size_t meshlet_count_max = meshopt_buildMeshletsBound(indices.size(), cluster_vertex_count_max, cluster_triangle_count_max);
+        vector<meshopt_Meshlet> meshlets(meshlet_count_max);
+        vector<uint32_t> meshlet_vertices(meshlet_count_max * cluster_vertex_count_max);
+        vector<unsigned char> meshlet_triangles(meshlet_count_max * cluster_triangle_count_max * 3);
+        const size_t meshlet_count = meshopt_buildMeshlets(
+            meshlets.data(), meshlet_vertices.data(), meshlet_triangles.data(),
+            indices.data(), indices.size(),
+            positions, vertex_count, vertex_stride,
+            cluster_vertex_count_max, cluster_triangle_count_max, cluster_cone_weight
+        );
+
+        // The triangles of each meshlet are written back as regular indices, one meshlet after the other
+        vector<uint32_t> indices_clustered;
+        indices_clustered.reserve(indices.size());
+        clusters.reserve(meshlet_count);
+        for (size_t i = 0; i < meshlet_count; i++)
+        {
+            const meshopt_Meshlet& meshlet = meshlets[i];
+            const meshopt_Bounds bounds    = meshopt_computeMeshletBounds(&meshlet_vertices[meshlet.vertex_offset], &meshlet_triangles[meshlet.triangle_offset], meshlet.triangle_count, positions, vertex_count, vertex_stride);
+
+            MeshCluster& cluster = clusters.emplace_back();
+            cluster.index_offset = static_cast<uint32_t>(indices_clustered.size());
+            cluster.index_count  = meshlet.triangle_count * 3;
+            cluster.center       = Vector3(bounds.center[0], bounds.center[1], bounds.center[2]);
+            cluster.radius       = bounds.radius;
+            cluster.cone_apex    = Vector3(bounds.cone_apex[0], bounds.cone_apex[1], bounds.cone_apex[2]);
+            cluster.cone_axis    = Vector3(bounds.cone_axis[0], bounds.cone_axis[1], bounds.cone_axis[2]);
+            cluster.cone_cutoff  = bounds.cone_cutoff;
+
+            for (uint32_t j = 0; j < cluster.index_count; j++)
+            {
+                indices_clustered.emplace_back(meshlet_vertices[meshlet.vertex_offset + meshlet_triangles[meshlet.triangle_offset + j]]);
+            }
+        }
+
+        // Degenerate triangles are dropped by the builder, the range has to keep its size
+        if (indices_clustered.size() != indices.size())
+            return vector<MeshCluster>();
+
+        indices.swap(indices_clustered);
+
+        return clusters;
+    }
+
+    void Mesh::AddClusters(const uint32_t index_offset, vector<MeshCluster>& clusters)
+    {
+        if (clusters.empty())
+            return;
+
+        for (MeshCluster& cluster : clusters)
+        {
+            cluster.index_offset += index_offset;
+        }
+
+        lock_guard lock(m_mutex_clusters);
+        m_clusters[index_offset] = move(clusters);
+    }
+
+    const vector<MeshCluster>* Mesh::GetClusters(const uint32_t index_offset)
+    {
+        lock_guard lock(m_mutex_clusters);
+
+        auto it = m_clusters.find(index_offset);
+        return it != m_clusters.end() ? &it->second : nullptr;
+    }
+
     void Mesh::CreateGpuBuffers()
     {
         SP_ASSERT_MSG(!m_indices.empty(), "There are no indices");
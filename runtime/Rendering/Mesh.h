@@ -22,6 +22,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #pragma once
 
 //= INCLUDES =====================
+#include <map>
 #include <vector>
 #include "Material.h"
 #include "../Resource/IResource.h"
@@ -31,12 +32,36 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 namespace Spartan
 {
+    class MeshBvh;
+
     enum class MeshProcessingOptions : uint32_t
     {
         CombineMeshes,
         RemoveRedundantData,
         ImportLights,
-        NormalizeScale
+        NormalizeScale,
+        GenerateLods,
+        GenerateClusters
+    };
+
+    // A simplified version of an index range, it draws the same vertices with fewer triangles
+    struct MeshLod
+    {
+        uint32_t index_offset = 0;
+        uint32_t index_count  = 0;
+        float error           = 0.0f; // the largest deviation from the full range, in mesh space
+    };
+
+    // A meshlet, a small part of an index range which is culled on its own, the bounds are in mesh space
+    struct MeshCluster
+    {
+        uint32_t index_offset   = 0;
+        uint32_t index_count    = 0;
+        Math::Vector3 center    = Math::Vector3::Zero; // bounding sphere
+        float radius            = 0.0f;
+        Math::Vector3 cone_apex = Math::Vector3::Zero; // normal cone, every triangle faces away from a viewer inside of it
+        Math::Vector3 cone_axis = Math::Vector3::Forward;
+        float cone_cutoff       = 1.0f;                // cos of half the cone's angle, 1 means the cone can't cull
     };
 
     class Mesh : public IResource
@@ -77,6 +102,27 @@ namespace Spartan
         const Math::BoundingBox& GetAabb() const { return m_aabb; }
         void ComputeAabb();
 
+        // Triangle BVHs, one per index range (what a renderable draws), ranges which were
+        // never added or built are built on demand, the first time they are queried
+        void AddBvhRange(const uint32_t index_offset, const uint32_t index_count, const uint32_t vertex_offset);
+        void BuildBvhs();
+        const MeshBvh* GetBvh(const uint32_t index_offset, const uint32_t index_count, const uint32_t vertex_offset);
+
+        // LODs, simplified versions of an index range (keyed by its index offset), each one has about half the triangles of the previous
+        // one, the chain stops at the lod count or when the simplifier can't get any further without exceeding the error threshold
+        void AddLods(const uint32_t index_offset, const std::vector<uint32_t>& indices, const std::vector<RHI_Vertex_PosTexNorTan>& vertices);
+        const std::vector<MeshLod>* GetLods(const uint32_t index_offset);
+        void SetLodCount(const uint32_t lod_count)   { m_lod_count = lod_count; }
+        uint32_t GetLodCount() const                 { return m_lod_count; }
+        void SetLodErrorThreshold(const float error) { m_lod_error_threshold = error; }
+        float GetLodErrorThreshold() const           { return m_lod_error_threshold; }
+
+        // Clusters, the triangles of an index range are reordered so that every cluster is a contiguous part of it, the
+        // clusters are then added with the range's index offset, ranges with fewer triangles than the minimum don't get any
+        static std::vector<MeshCluster> BuildClusters(std::vector<uint32_t>& indices, const std::vector<RHI_Vertex_PosTexNorTan>& vertices);
+        void AddClusters(const uint32_t index_offset, std::vector<MeshCluster>& clusters);
+        const std::vector<MeshCluster>* GetClusters(const uint32_t index_offset);
+
         // GPU buffers
         void CreateGpuBuffers();
         RHI_IndexBuffer* GetIndexBuffer()   { return m_index_buffer.get(); }
@@ -105,6 +151,26 @@ namespace Spartan
         // AABB
         Math::BoundingBox m_aabb;
 
+        // BVHs, keyed by index offset
+        struct BvhRange
+        {
+            uint32_t index_count   = 0;
+            uint32_t vertex_offset = 0;
+            std::shared_ptr<MeshBvh> bvh;
+        };
+        std::map<uint32_t, BvhRange> m_bvhs;
+        std::mutex m_mutex_bvhs;
+
+        // LODs, keyed by the index offset of the full range, they share its vertices
+        std::map<uint32_t, std::vector<MeshLod>> m_lods;
+        std::mutex m_mutex_lods;
+        uint32_t m_lod_count        = 4;
+        float m_lod_error_threshold = 0.05f; // relative to the range's extent
+
+        // Clusters, keyed by the index offset of the range they are part of
+        std::map<uint32_t, std::vector<MeshCluster>> m_clusters;
+        std::mutex m_mutex_clusters;
+
         // Sync primitives
         std::mutex m_mutex_add_indices;
         std::mutex m_mutex_add_verices;
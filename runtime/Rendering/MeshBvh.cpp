@@ -0,0 +1,530 @@
+/*
+Copyright(c) 2016-2023 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ==================
+#include "pch.h"
+#include "MeshBvh.h"
+#include "../Core/ThreadPool.h"
+#include "../IO/FileStream.h"
+//=============================
+
+//= SIMD ==========================================================================
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define SP_MESH_BVH_SSE
+#endif
+//==================================================================================
+
+//= NAMESPACES ================
+using namespace std;
+using namespace Spartan::Math;
+//=============================
+
+namespace Spartan
+{
+    namespace
+    {
+        const uint32_t bin_count          = 12;
+        const uint32_t sah_depth_max      = 48;  // deeper than this, nodes are split at the median so the depth stays bounded
+        const uint32_t traversal_depth    = 96;
+        const uint32_t batch_parallel_min = 64;  // rays, smaller batches aren't worth waking the workers for
+        const uint32_t triangle_none      = numeric_limits<uint32_t>::max();
+
+        float get_axis(const Vector3& v, const uint32_t axis)
+        {
+            return axis == 0 ? v.x : (axis == 1 ? v.y : v.z);
+        }
+
+        struct Bounds
+        {
+            void Extend(const Vector3& point)
+            {
+                min = Vector3(Helper::Min(min.x, point.x), Helper::Min(min.y, point.y), Helper::Min(min.z, point.z));
+                max = Vector3(Helper::Max(max.x, point.x), Helper::Max(max.y, point.y), Helper::Max(max.z, point.z));
+            }
+
+            void Extend(const Bounds& other)
+            {
+                min = Vector3(Helper::Min(min.x, other.min.x), Helper::Min(min.y, other.min.y), Helper::Min(min.z, other.min.z));
+                max = Vector3(Helper::Max(max.x, other.max.x), Helper::Max(max.y, other.max.y), Helper::Max(max.z, other.max.z));
+            }
+
+            // Half of the surface area, enough for comparisons
+            float GetArea() const
+            {
+                const Vector3 size = max - min;
+                return size.x * size.y + size.y * size.z + size.z * size.x;
+            }
+
+            Vector3 min = Vector3::Infinity;
+            Vector3 max = Vector3::InfinityNeg;
+        };
+
+        struct BuildTriangle
+        {
+            Bounds bounds;
+            Vector3 centroid;
+        };
+
+        struct BuildTask
+        {
+            uint32_t node;
+            uint32_t start;
+            uint32_t count;
+            uint32_t depth;
+        };
+
+        Vector3 get_position(const RHI_Vertex_PosTexNorTan* vertices, const uint32_t index)
+        {
+            return Vector3(vertices[index].pos[0], vertices[index].pos[1], vertices[index].pos[2]);
+        }
+
+        // Returns the entry distance, or infinity if the box is missed or further than distance_max
+        float hit_box(const float* min, const float* max, const Vector3& origin, const Vector3& direction_inv, const float distance_max)
+        {
+            const float t1_x = (min[0] - origin.x) * direction_inv.x;
+            const float t2_x = (max[0] - origin.x) * direction_inv.x;
+            const float t1_y = (min[1] - origin.y) * direction_inv.y;
+            const float t2_y = (max[1] - origin.y) * direction_inv.y;
+            const float t1_z = (min[2] - origin.z) * direction_inv.z;
+            const float t2_z = (max[2] - origin.z) * direction_inv.z;
+
+            const float t_enter = Helper::Max(Helper::Max(Helper::Min(t1_x, t2_x), Helper::Min(t1_y, t2_y)), Helper::Min(t1_z, t2_z));
+            const float t_exit  = Helper::Min(Helper::Min(Helper::Max(t1_x, t2_x), Helper::Max(t1_y, t2_y)), Helper::Max(t1_z, t2_z));
+
+            if (t_exit < 0.0f || t_enter > t_exit || t_enter >= distance_max)
+                return Helper::INFINITY_;
+
+            return Helper::Max(t_enter, 0.0f);
+        }
+
+        // Returns how many triangles go left, order[start, start + count) is partitioned accordingly
+        uint32_t split_sah(const vector<BuildTriangle>& triangles, vector<uint32_t>& order, const BuildTask& task, const Bounds& centroids)
+        {
+            const auto begin = order.begin() + task.start;
+            const auto end   = begin + task.count;
+            const Vector3 extent = centroids.max - centroids.min;
+
+            if (task.depth < sah_depth_max)
+            {
+                float cost_best    = numeric_limits<float>::max();
+                uint32_t axis_best = 3;
+                uint32_t bin_best  = 0;
+
+                for (uint32_t axis = 0; axis < 3; axis++)
+                {
+                    if (get_axis(extent, axis) <= 0.0f)
+                        continue;
+
+                    Bounds bins[bin_count];
+                    uint32_t bin_counts[bin_count] = {};
+                    const float scale = static_cast<float>(bin_count) / get_axis(extent, axis);
+                    for (auto it = begin; it != end; it++)
+                    {
+                        const BuildTriangle& triangle = triangles[*it];
+                        const uint32_t bin = Helper::Min(static_cast<uint32_t>((get_axis(triangle.centroid, axis) - get_axis(centroids.min, axis)) * scale), bin_count - 1);
+                        bins[bin].Extend(triangle.bounds);
+                        bin_counts[bin]++;
+                    }
+
+                    // Sweep from the right, then evaluate every plane while sweeping from the left
+                    float area_right[bin_count - 1];
+                    uint32_t count_right[bin_count - 1];
+                    Bounds bounds_right;
+                    uint32_t count = 0;
+                    for (uint32_t i = bin_count - 1; i > 0; i--)
+                    {
+                        bounds_right.Extend(bins[i]);
+                        count             += bin_counts[i];
+                        area_right[i - 1]  = count != 0 ? bounds_right.GetArea() : 0.0f;
+                        count_right[i - 1] = count;
+                    }
+
+                    Bounds bounds_left;
+                    count = 0;
+                    for (uint32_t i = 0; i < bin_count - 1; i++)
+                    {
+                        bounds_left.Extend(bins[i]);
+                        count += bin_counts[i];
+
+                        if (count == 0 || count_right[i] == 0)
+                            continue;
+
+                        const float cost = bounds_left.GetArea() * count + area_right[i] * count_right[i];
+                        if (cost < cost_best)
+                        {
+                            cost_best = cost;
+                            axis_best = axis;
+                            bin_best  = i;
+                        }
+                    }
+                }
+
+                if (axis_best != 3)
+                {
+                    const float scale = static_cast<float>(bin_count) / get_axis(extent, axis_best);
+                    const auto middle = partition(begin, end, [&](const uint32_t index)
+                    {
+                        const uint32_t bin = Helper::Min(static_cast<uint32_t>((get_axis(triangles[index].centroid, axis_best) - get_axis(centroids.min, axis_best)) * scale), bin_count - 1);
+                        return bin <= bin_best;
+                    });
+
+                    return static_cast<uint32_t>(middle - begin);
+                }
+            }
+
+            // Median of the widest axis, also covers triangles which all share a centroid
+            const uint32_t axis = extent.x >= extent.y && extent.x >= extent.z ? 0 : (extent.y >= extent.z ? 1 : 2);
+            const auto middle   = begin + task.count / 2;
+            nth_element(begin, middle, end, [&](const uint32_t a, const uint32_t b)
+            {
+                return get_axis(triangles[a].centroid, axis) < get_axis(triangles[b].centroid, axis);
+            });
+
+            return task.count / 2;
+        }
+    }
+
+    void MeshBvh::Build(const RHI_Vertex_PosTexNorTan* vertices, const uint32_t* indices, const uint32_t index_count)
+    {
+        m_nodes.clear();
+        m_packets.clear();
+        m_triangle_count = index_count / 3;
+
+        if (m_triangle_count == 0)
+            return;
+
+        vector<BuildTriangle> triangles(m_triangle_count);
+        vector<uint32_t> order(m_triangle_count);
+        for (uint32_t i = 0; i < m_triangle_count; i++)
+        {
+            BuildTriangle& triangle = triangles[i];
+            triangle.bounds.Extend(get_position(vertices, indices[i * 3 + 0]));
+            triangle.bounds.Extend(get_position(vertices, indices[i * 3 + 1]));
+            triangle.bounds.Extend(get_position(vertices, indices[i * 3 + 2]));
+            triangle.centroid = (triangle.bounds.min + triangle.bounds.max) * 0.5f;
+            order[i]          = i;
+        }
+
+        vector<uint32_t> triangle_order; // packet_size entries per packet, padded with triangle_none
+        triangle_order.reserve((m_triangle_count / packet_size + 1) * packet_size * 2);
+        m_nodes.reserve((m_triangle_count / packet_size + 1) * 2);
+        m_nodes.emplace_back();
+
+        vector<BuildTask> tasks;
+        tasks.push_back({ 0, 0, m_triangle_count, 0 });
+        while (!tasks.empty())
+        {
+            const BuildTask task = tasks.back();
+            tasks.pop_back();
+
+            Bounds bounds;
+            Bounds centroids;
+            for (uint32_t i = task.start; i < task.start + task.count; i++)
+            {
+                bounds.Extend(triangles[order[i]].bounds);
+                centroids.Extend(triangles[order[i]].centroid);
+            }
+
+            Node& node = m_nodes[task.node];
+            for (uint32_t axis = 0; axis < 3; axis++)
+            {
+                node.min[axis] = get_axis(bounds.min, axis);
+                node.max[axis] = get_axis(bounds.max, axis);
+            }
+
+            if (task.count <= packet_size)
+            {
+                node.child_or_packet = static_cast<uint32_t>(triangle_order.size()) / packet_size;
+                node.triangle_count  = task.count;
+                for (uint32_t i = 0; i < packet_size; i++)
+                {
+                    triangle_order.push_back(i < task.count ? order[task.start + i] : triangle_none);
+                }
+                continue;
+            }
+
+            const uint32_t count_left = split_sah(triangles, order, task, centroids);
+            const uint32_t child      = static_cast<uint32_t>(m_nodes.size());
+            node.child_or_packet      = child;
+            node.triangle_count       = 0;
+
+            // The reference above is invalidated from here on
+            m_nodes.emplace_back();
+            m_nodes.emplace_back();
+            tasks.push_back({ child,     task.start,              count_left,              task.depth + 1 });
+            tasks.push_back({ child + 1, task.start + count_left, task.count - count_left, task.depth + 1 });
+        }
+
+        BuildPackets(vertices, indices, triangle_order);
+    }
+
+    void MeshBvh::BuildPackets(const RHI_Vertex_PosTexNorTan* vertices, const uint32_t* indices, const vector<uint32_t>& triangle_order)
+    {
+        m_packets.resize(triangle_order.size() / packet_size);
+        for (uint32_t packet_index = 0; packet_index < static_cast<uint32_t>(m_packets.size()); packet_index++)
+        {
+            Packet& packet = m_packets[packet_index];
+            for (uint32_t lane = 0; lane < packet_size; lane++)
+            {
+                const uint32_t triangle = triangle_order[packet_index * packet_size + lane];
+                packet.triangle[lane]   = triangle;
+
+                Vector3 v0 = Vector3::Zero;
+                Vector3 e1 = Vector3::Zero;
+                Vector3 e2 = Vector3::Zero;
+                if (triangle != triangle_none)
+                {
+                    v0 = get_position(vertices, indices[triangle * 3 + 0]);
+                    e1 = get_position(vertices, indices[triangle * 3 + 1]) - v0;
+                    e2 = get_position(vertices, indices[triangle * 3 + 2]) - v0;
+                }
+
+                packet.v0_x[lane] = v0.x; packet.v0_y[lane] = v0.y; packet.v0_z[lane] = v0.z;
+                packet.e1_x[lane] = e1.x; packet.e1_y[lane] = e1.y; packet.e1_z[lane] = e1.z;
+                packet.e2_x[lane] = e2.x; packet.e2_y[lane] = e2.y; packet.e2_z[lane] = e2.z;
+            }
+        }
+    }
+
+    bool MeshBvh::Intersect(const MeshBvhRay& ray, MeshBvhHit* hit) const
+    {
+        SP_ASSERT(hit != nullptr);
+
+        // The hit distance doubles as the current limit
+        *hit          = MeshBvhHit();
+        hit->distance = ray.distance_max;
+        bool is_hit   = false;
+
+        if (m_nodes.empty())
+        {
+            hit->distance = Helper::INFINITY_;
+            return false;
+        }
+
+        const Vector3 direction_inv = Vector3(1.0f / ray.direction.x, 1.0f / ray.direction.y, 1.0f / ray.direction.z);
+
+        uint32_t stack[traversal_depth];
+        uint32_t stack_size = 0;
+        if (hit_box(m_nodes[0].min, m_nodes[0].max, ray.origin, direction_inv, hit->distance) != Helper::INFINITY_)
+        {
+            stack[stack_size++] = 0;
+        }
+
+        while (stack_size != 0)
+        {
+            const Node& node = m_nodes[stack[--stack_size]];
+
+            if (node.triangle_count != 0)
+            {
+                const float distance = hit->distance;
+                IntersectPacket(m_packets[node.child_or_packet], node.triangle_count, ray, hit);
+                is_hit |= hit->distance < distance;
+                continue;
+            }
+
+            // Nearest child goes on top of the stack
+            const uint32_t child_near = node.child_or_packet;
+            const uint32_t child_far  = node.child_or_packet + 1;
+            float distance_near       = hit_box(m_nodes[child_near].min, m_nodes[child_near].max, ray.origin, direction_inv, hit->distance);
+            float distance_far        = hit_box(m_nodes[child_far].min,  m_nodes[child_far].max,  ray.origin, direction_inv, hit->distance);
+            const bool swap           = distance_far < distance_near;
+            if (swap)
+            {
+                std::swap(distance_near, distance_far);
+            }
+
+            SP_ASSERT_MSG(stack_size + 2 <= traversal_depth, "BVH is deeper than the traversal stack");
+            if (distance_far != Helper::INFINITY_)
+            {
+                stack[stack_size++] = swap ? child_near : child_far;
+            }
+            if (distance_near != Helper::INFINITY_)
+            {
+                stack[stack_size++] = swap ? child_far : child_near;
+            }
+        }
+
+        if (!is_hit)
+        {
+            *hit = MeshBvhHit();
+        }
+
+        return is_hit;
+    }
+
+    void MeshBvh::Intersect(const MeshBvhRay* rays, MeshBvhHit* hits, const uint32_t count) const
+    {
+        auto intersect = [this, rays, hits](uint32_t work_index_start, uint32_t work_index_end)
+        {
+            for (uint32_t i = work_index_start; i < work_index_end; i++)
+            {
+                Intersect(rays[i], &hits[i]);
+            }
+        };
+
+        if (count < batch_parallel_min)
+        {
+            intersect(0, count);
+        }
+        else
+        {
+            ThreadPool::ParallelFor(intersect, count);
+        }
+    }
+
+    void MeshBvh::IntersectPacket(const Packet& packet, const uint32_t triangle_count, const MeshBvhRay& ray, MeshBvhHit* hit) const
+    {
+        // Möller-Trumbore, for all the triangles of the packet at once
+        float distances[packet_size];
+        float us[packet_size];
+        float vs[packet_size];
+        uint32_t mask = 0;
+
+    #if defined(SP_MESH_BVH_SSE)
+        const __m128 d_x  = _mm_set1_ps(ray.direction.x);
+        const __m128 d_y  = _mm_set1_ps(ray.direction.y);
+        const __m128 d_z  = _mm_set1_ps(ray.direction.z);
+        const __m128 e1_x = _mm_loadu_ps(packet.e1_x);
+        const __m128 e1_y = _mm_loadu_ps(packet.e1_y);
+        const __m128 e1_z = _mm_loadu_ps(packet.e1_z);
+        const __m128 e2_x = _mm_loadu_ps(packet.e2_x);
+        const __m128 e2_y = _mm_loadu_ps(packet.e2_y);
+        const __m128 e2_z = _mm_loadu_ps(packet.e2_z);
+
+        // p = d x e2, det = e1 . p
+        const __m128 p_x = _mm_sub_ps(_mm_mul_ps(d_y, e2_z), _mm_mul_ps(d_z, e2_y));
+        const __m128 p_y = _mm_sub_ps(_mm_mul_ps(d_z, e2_x), _mm_mul_ps(d_x, e2_z));
+        const __m128 p_z = _mm_sub_ps(_mm_mul_ps(d_x, e2_y), _mm_mul_ps(d_y, e2_x));
+        const __m128 det = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1_x, p_x), _mm_mul_ps(e1_y, p_y)), _mm_mul_ps(e1_z, p_z));
+
+        // t = o - v0, u = t . p
+        const __m128 t_x = _mm_sub_ps(_mm_set1_ps(ray.origin.x), _mm_loadu_ps(packet.v0_x));
+        const __m128 t_y = _mm_sub_ps(_mm_set1_ps(ray.origin.y), _mm_loadu_ps(packet.v0_y));
+        const __m128 t_z = _mm_sub_ps(_mm_set1_ps(ray.origin.z), _mm_loadu_ps(packet.v0_z));
+        const __m128 u   = _mm_add_ps(_mm_add_ps(_mm_mul_ps(t_x, p_x), _mm_mul_ps(t_y, p_y)), _mm_mul_ps(t_z, p_z));
+
+        // q = t x e1, v = d . q, distance = e2 . q
+        const __m128 q_x      = _mm_sub_ps(_mm_mul_ps(t_y, e1_z), _mm_mul_ps(t_z, e1_y));
+        const __m128 q_y      = _mm_sub_ps(_mm_mul_ps(t_z, e1_x), _mm_mul_ps(t_x, e1_z));
+        const __m128 q_z      = _mm_sub_ps(_mm_mul_ps(t_x, e1_y), _mm_mul_ps(t_y, e1_x));
+        const __m128 v        = _mm_add_ps(_mm_add_ps(_mm_mul_ps(d_x, q_x), _mm_mul_ps(d_y, q_y)), _mm_mul_ps(d_z, q_z));
+        const __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e2_x, q_x), _mm_mul_ps(e2_y, q_y)), _mm_mul_ps(e2_z, q_z));
+
+        // Degenerate lanes divide by zero, the NaNs fail every comparison below
+        const __m128 det_inv      = _mm_div_ps(_mm_set1_ps(1.0f), det);
+        const __m128 u_normalized = _mm_mul_ps(u, det_inv);
+        const __m128 v_normalized = _mm_mul_ps(v, det_inv);
+        const __m128 t_normalized = _mm_mul_ps(distance, det_inv);
+        const __m128 zero         = _mm_setzero_ps();
+        const __m128 det_test     = ray.cull_back_faces ? det : _mm_andnot_ps(_mm_set1_ps(-0.0f), det);
+
+        __m128 valid = _mm_cmpge_ps(det_test, _mm_set1_ps(Helper::EPSILON));
+        valid        = _mm_and_ps(valid, _mm_cmpge_ps(u_normalized, zero));
+        valid        = _mm_and_ps(valid, _mm_cmpge_ps(v_normalized, zero));
+        valid        = _mm_and_ps(valid, _mm_cmple_ps(_mm_add_ps(u_normalized, v_normalized), _mm_set1_ps(1.0f)));
+        valid        = _mm_and_ps(valid, _mm_cmpge_ps(t_normalized, zero));
+        valid        = _mm_and_ps(valid, _mm_cmplt_ps(t_normalized, _mm_set1_ps(hit->distance)));
+
+        mask = static_cast<uint32_t>(_mm_movemask_ps(valid));
+        if (mask == 0)
+            return;
+
+        _mm_storeu_ps(distances, t_normalized);
+        _mm_storeu_ps(us, u_normalized);
+        _mm_storeu_ps(vs, v_normalized);
+    #else
+        for (uint32_t lane = 0; lane < triangle_count; lane++)
+        {
+            const Vector3 e1 = Vector3(packet.e1_x[lane], packet.e1_y[lane], packet.e1_z[lane]);
+            const Vector3 e2 = Vector3(packet.e2_x[lane], packet.e2_y[lane], packet.e2_z[lane]);
+            const Vector3 t  = ray.origin - Vector3(packet.v0_x[lane], packet.v0_y[lane], packet.v0_z[lane]);
+            const Vector3 p  = ray.direction.Cross(e2);
+            const Vector3 q  = t.Cross(e1);
+            const float det  = e1.Dot(p);
+
+            if ((ray.cull_back_faces ? det : Helper::Abs(det)) < Helper::EPSILON)
+                continue;
+
+            const float det_inv = 1.0f / det;
+            us[lane]            = t.Dot(p) * det_inv;
+            vs[lane]            = ray.direction.Dot(q) * det_inv;
+            distances[lane]     = e2.Dot(q) * det_inv;
+
+            if (us[lane] >= 0.0f && vs[lane] >= 0.0f && us[lane] + vs[lane] <= 1.0f && distances[lane] >= 0.0f && distances[lane] < hit->distance)
+            {
+                mask |= 1 << lane;
+            }
+        }
+    #endif
+
+        for (uint32_t lane = 0; lane < triangle_count; lane++)
+        {
+            if ((mask & (1 << lane)) && distances[lane] < hit->distance)
+            {
+                hit->distance = distances[lane];
+                hit->triangle = packet.triangle[lane];
+                hit->u        = us[lane];
+                hit->v        = vs[lane];
+            }
+        }
+    }
+
+    void MeshBvh::Serialize(FileStream* stream) const
+    {
+        stream->Write(m_triangle_count);
+
+        stream->Write(static_cast<uint32_t>(m_nodes.size()));
+        stream->WriteBytes(m_nodes.data(), m_nodes.size() * sizeof(Node));
+
+        stream->Write(static_cast<uint32_t>(m_packets.size()));
+        for (const Packet& packet : m_packets)
+        {
+            stream->WriteBytes(packet.triangle, sizeof(packet.triangle));
+        }
+    }
+
+    void MeshBvh::Deserialize(FileStream* stream, const RHI_Vertex_PosTexNorTan* vertices, const uint32_t* indices, const uint32_t index_count)
+    {
+        stream->Read(&m_triangle_count);
+
+        m_nodes.resize(stream->ReadAs<uint32_t>());
+        stream->ReadBytes(m_nodes.data(), m_nodes.size() * sizeof(Node));
+
+        vector<uint32_t> triangle_order(stream->ReadAs<uint32_t>() * packet_size);
+        stream->ReadBytes(triangle_order.data(), triangle_order.size() * sizeof(uint32_t));
+
+        // The geometry changed since the file was written
+        if (m_triangle_count != index_count / 3)
+        {
+            SP_LOG_WARNING("Cached BVH doesn't match the geometry, rebuilding");
+            Build(vertices, indices, index_count);
+            return;
+        }
+
+        BuildPackets(vertices, indices, triangle_order);
+    }
+
+    uint64_t MeshBvh::GetMemoryUsage() const
+    {
+        return m_nodes.capacity() * sizeof(Node) + m_packets.capacity() * sizeof(Packet);
+    }
+}
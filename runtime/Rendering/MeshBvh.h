@@ -0,0 +1,106 @@
+/*
+Copyright(c) 2016-2023 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ===================
+#include <vector>
+#include "Definitions.h"
+#include "../Math/MathHelper.h"
+#include "../Math/Vector3.h"
+#include "../RHI/RHI_Vertex.h"
+//==============================
+
+namespace Spartan
+{
+    class FileStream;
+
+    struct MeshBvhRay
+    {
+        Math::Vector3 origin    = Math::Vector3::Zero;
+        Math::Vector3 direction = Math::Vector3::Forward; // doesn't have to be normalised, distances are in units of its length
+        float distance_max      = Math::Helper::INFINITY_;
+        bool cull_back_faces    = true;
+    };
+
+    struct MeshBvhHit
+    {
+        bool IsHit() const { return distance != Math::Helper::INFINITY_; }
+
+        float distance    = Math::Helper::INFINITY_;
+        uint32_t triangle = 0; // within the range, the first index is triangle * 3
+        float u           = 0.0f;
+        float v           = 0.0f;
+    };
+
+    // Bounding volume hierarchy over the triangles of an index range (what a renderable draws), for triangle
+    // accurate ray queries. It's built with a binned SAH and every leaf holds a packet of up to four triangles
+    // which are tested against a ray at once.
+    class SP_CLASS MeshBvh
+    {
+    public:
+        static const uint32_t packet_size = 4;
+
+        // Indices are relative to vertices
+        void Build(const RHI_Vertex_PosTexNorTan* vertices, const uint32_t* indices, const uint32_t index_count);
+
+        // Returns true if the ray hit anything nearer than its distance_max
+        bool Intersect(const MeshBvhRay& ray, MeshBvhHit* hit) const;
+
+        // Batched, large batches are spread across the worker threads
+        void Intersect(const MeshBvhRay* rays, MeshBvhHit* hits, const uint32_t count) const;
+
+        // Only the hierarchy and the triangle order are stored, the packets are rebuilt from the geometry
+        void Serialize(FileStream* stream) const;
+        void Deserialize(FileStream* stream, const RHI_Vertex_PosTexNorTan* vertices, const uint32_t* indices, const uint32_t index_count);
+
+        bool IsBuilt() const              { return !m_nodes.empty(); }
+        uint32_t GetTriangleCount() const { return m_triangle_count; }
+        uint32_t GetNodeCount() const     { return static_cast<uint32_t>(m_nodes.size()); }
+        uint64_t GetMemoryUsage() const;
+
+    private:
+        // A leaf has a triangle count and points to a packet, an inner node points to two consecutive children
+        struct Node
+        {
+            float min[3];
+            uint32_t child_or_packet;
+            float max[3];
+            uint32_t triangle_count;
+        };
+
+        // Structure of arrays, unused lanes are degenerate (zero edges) and never hit
+        struct Packet
+        {
+            float v0_x[packet_size], v0_y[packet_size], v0_z[packet_size];
+            float e1_x[packet_size], e1_y[packet_size], e1_z[packet_size];
+            float e2_x[packet_size], e2_y[packet_size], e2_z[packet_size];
+            uint32_t triangle[packet_size];
+        };
+
+        void BuildPackets(const RHI_Vertex_PosTexNorTan* vertices, const uint32_t* indices, const std::vector<uint32_t>& triangle_order);
+        void IntersectPacket(const Packet& packet, const uint32_t triangle_count, const MeshBvhRay& ray, MeshBvhHit* hit) const;
+
+        std::vector<Node> m_nodes;
+        std::vector<Packet> m_packets;
+        uint32_t m_triangle_count = 0;
+    };
+}
@@ -0,0 +1,338 @@
+/*
+Copyright(c) 2016-2023 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ==================
+#include "pch.h"
+#include "OcclusionBuffer.h"
+#include "../Core/ThreadPool.h"
+//=============================
+
+//= NAMESPACES ================
+using namespace std;
+using namespace Spartan::Math;
+//=============================
+
+namespace Spartan
+{
+    namespace
+    {
+        // Triangles are clipped against the near plane and a guard band (in NDC units), the
+        // guard band keeps screen space coordinates small enough for the edge functions to stay precise
+        const float guard_band               = 2.0f;
+        const uint32_t clip_vertex_count_max = 16;
+
+        float clip_distance(const Vector4& v, const uint32_t plane, const float near_plane)
+        {
+            switch (plane)
+            {
+                case 0:  return v.w - near_plane;
+                case 1:  return guard_band * v.w - v.x;
+                case 2:  return guard_band * v.w + v.x;
+                case 3:  return guard_band * v.w - v.y;
+                default: return guard_band * v.w + v.y;
+            }
+        }
+
+        // Sutherland-Hodgman, every plane adds at most one vertex
+        uint32_t clip_polygon(Vector4* vertices, uint32_t vertex_count, const float near_plane)
+        {
+            Vector4 clipped[clip_vertex_count_max];
+
+            for (uint32_t plane = 0; plane < 5 && vertex_count >= 3; plane++)
+            {
+                uint32_t clipped_count = 0;
+                for (uint32_t i = 0; i < vertex_count; i++)
+                {
+                    const Vector4& a = vertices[i];
+                    const Vector4& b = vertices[(i + 1) % vertex_count];
+                    const float distance_a = clip_distance(a, plane, near_plane);
+                    const float distance_b = clip_distance(b, plane, near_plane);
+
+                    if (distance_a >= 0.0f)
+                    {
+                        clipped[clipped_count++] = a;
+                    }
+
+                    if ((distance_a >= 0.0f) != (distance_b >= 0.0f))
+                    {
+                        const float t = distance_a / (distance_a - distance_b);
+                        clipped[clipped_count++] = Vector4
+                        (
+                            a.x + (b.x - a.x) * t,
+                            a.y + (b.y - a.y) * t,
+                            a.z + (b.z - a.z) * t,
+                            a.w + (b.w - a.w) * t
+                        );
+                    }
+                }
+
+                vertex_count = clipped_count;
+                for (uint32_t i = 0; i < vertex_count; i++)
+                {
+                    vertices[i] = clipped[i];
+                }
+            }
+
+            return vertex_count >= 3 ? vertex_count : 0;
+        }
+
+        Vector3 to_screen(const Vector4& clip)
+        {
+            const float inv_w = 1.0f / clip.w;
+            return Vector3
+            (
+                (clip.x * inv_w * 0.5f + 0.5f) * static_cast<float>(OcclusionBuffer::width),
+                (0.5f - clip.y * inv_w * 0.5f) * static_cast<float>(OcclusionBuffer::height),
+                inv_w
+            );
+        }
+
+        int32_t to_pixel(const float value, const int32_t max)
+        {
+            return static_cast<int32_t>(Helper::Clamp(value, -1.0f, static_cast<float>(max) + 1.0f));
+        }
+    }
+
+    void OcclusionBuffer::Begin(const Matrix& view_projection, const float near_plane)
+    {
+        m_view_projection = view_projection;
+        m_near_plane      = Helper::Max(near_plane, Helper::EPSILON);
+        m_triangle_count  = 0;
+        m_occluders.clear();
+
+        m_depth.assign(width * height, 0.0f); // 1/w of infinity
+    }
+
+    void OcclusionBuffer::AddOccluder(const Matrix& transform, const RHI_Vertex_PosTexNorTan* vertices, const uint32_t* indices, const uint32_t index_count)
+    {
+        m_occluders.push_back({ transform * m_view_projection, vertices, indices, index_count });
+    }
+
+    void OcclusionBuffer::Rasterize()
+    {
+        if (m_occluders.empty())
+            return;
+
+        if (m_triangles.size() < m_occluders.size())
+        {
+            m_triangles.resize(m_occluders.size());
+        }
+
+        ThreadPool::ParallelFor([this](uint32_t work_index_start, uint32_t work_index_end)
+        {
+            for (uint32_t i = work_index_start; i < work_index_end; i++)
+            {
+                SetupOccluder(m_occluders[i], m_triangles[i]);
+            }
+        }, static_cast<uint32_t>(m_occluders.size()));
+
+        for (uint32_t i = 0; i < static_cast<uint32_t>(m_occluders.size()); i++)
+        {
+            m_triangle_count += static_cast<uint32_t>(m_triangles[i].size());
+        }
+
+        // Bands don't overlap, so they are written without synchronisation
+        ThreadPool::ParallelFor([this](uint32_t work_index_start, uint32_t work_index_end)
+        {
+            for (uint32_t i = work_index_start; i < work_index_end; i++)
+            {
+                RasterizeBand(i);
+            }
+        }, height / band_height);
+    }
+
+    void OcclusionBuffer::SetupOccluder(const Occluder& occluder, vector<Triangle>& triangles) const
+    {
+        triangles.clear();
+
+        for (uint32_t i = 0; i + 2 < occluder.index_count; i += 3)
+        {
+            Vector4 polygon[clip_vertex_count_max];
+            for (uint32_t j = 0; j < 3; j++)
+            {
+                const float* pos = occluder.vertices[occluder.indices[i + j]].pos;
+                polygon[j]       = Vector4(pos[0], pos[1], pos[2], 1.0f) * occluder.transform;
+            }
+
+            const uint32_t vertex_count = clip_polygon(polygon, 3, m_near_plane);
+
+            Vector3 screen[clip_vertex_count_max];
+            for (uint32_t j = 0; j < vertex_count; j++)
+            {
+                screen[j] = to_screen(polygon[j]);
+            }
+
+            // Fan
+            for (uint32_t j = 1; j + 1 < vertex_count; j++)
+            {
+                const Vector3& v0 = screen[0];
+                const Vector3& v1 = screen[j];
+                const Vector3& v2 = screen[j + 1];
+
+                const float area = (v1.x - v0.x) * (v2.y - v0.y) - (v2.x - v0.x) * (v1.y - v0.y);
+                if (Helper::Abs(area) < Helper::EPSILON)
+                    continue;
+
+                Triangle& triangle = triangles.emplace_back();
+
+                // Both windings occlude, the edges are flipped so that the inside is positive
+                const float winding = area > 0.0f ? 1.0f : -1.0f;
+                const Vector3* edge_vertices[3][2] = { { &v0, &v1 }, { &v1, &v2 }, { &v2, &v0 } };
+                for (uint32_t edge = 0; edge < 3; edge++)
+                {
+                    const Vector3& a = *edge_vertices[edge][0];
+                    const Vector3& b = *edge_vertices[edge][1];
+                    triangle.edge_a[edge] = (a.y - b.y) * winding;
+                    triangle.edge_b[edge] = (b.x - a.x) * winding;
+                    triangle.edge_c[edge] = (a.x * b.y - b.x * a.y) * winding;
+                }
+
+                // Depth plane, pushed back by its largest change within half a pixel so that it's
+                // never nearer than the occluder anywhere inside a covered pixel
+                triangle.depth_a  = ((v1.z - v0.z) * (v2.y - v0.y) - (v2.z - v0.z) * (v1.y - v0.y)) / area;
+                triangle.depth_b  = ((v1.x - v0.x) * (v2.z - v0.z) - (v2.x - v0.x) * (v1.z - v0.z)) / area;
+                triangle.depth_c  = v0.z - triangle.depth_a * v0.x - triangle.depth_b * v0.y;
+                triangle.depth_c -= 0.5f * (Helper::Abs(triangle.depth_a) + Helper::Abs(triangle.depth_b));
+
+                triangle.x_min = Helper::Max(to_pixel(Helper::Floor(Helper::Min(v0.x, Helper::Min(v1.x, v2.x))), width), 0);
+                triangle.x_max = Helper::Min(to_pixel(Helper::Floor(Helper::Max(v0.x, Helper::Max(v1.x, v2.x))), width), static_cast<int32_t>(width) - 1);
+                triangle.y_min = Helper::Max(to_pixel(Helper::Floor(Helper::Min(v0.y, Helper::Min(v1.y, v2.y))), height), 0);
+                triangle.y_max = Helper::Min(to_pixel(Helper::Floor(Helper::Max(v0.y, Helper::Max(v1.y, v2.y))), height), static_cast<int32_t>(height) - 1);
+
+                if (triangle.x_min > triangle.x_max || triangle.y_min > triangle.y_max)
+                {
+                    triangles.pop_back();
+                }
+            }
+        }
+    }
+
+    void OcclusionBuffer::RasterizeBand(const uint32_t band_index)
+    {
+        const int32_t band_start = static_cast<int32_t>(band_index * band_height);
+        const int32_t band_end   = band_start + static_cast<int32_t>(band_height) - 1;
+
+        for (uint32_t occluder_index = 0; occluder_index < static_cast<uint32_t>(m_occluders.size()); occluder_index++)
+        {
+            for (const Triangle& triangle : m_triangles[occluder_index])
+            {
+                const int32_t y_start = Helper::Max(triangle.y_min, band_start);
+                const int32_t y_end   = Helper::Min(triangle.y_max, band_end);
+
+                for (int32_t y = y_start; y <= y_end; y++)
+                {
+                    const float center_y = static_cast<float>(y) + 0.5f;
+
+                    // The span of pixel centres inside all three edges
+                    float span_start = static_cast<float>(triangle.x_min);
+                    float span_end   = static_cast<float>(triangle.x_max);
+                    for (uint32_t edge = 0; edge < 3; edge++)
+                    {
+                        const float a = triangle.edge_a[edge];
+                        const float v = triangle.edge_b[edge] * center_y + triangle.edge_c[edge];
+
+                        if (a > 0.0f)
+                        {
+                            span_start = Helper::Max(span_start, Helper::Ceil(-v / a - 0.5f));
+                        }
+                        else if (a < 0.0f)
+                        {
+                            span_end = Helper::Min(span_end, Helper::Floor(-v / a - 0.5f));
+                        }
+                        else if (v < 0.0f)
+                        {
+                            span_end = span_start - 1.0f;
+                        }
+                    }
+
+                    if (span_start > span_end)
+                        continue;
+
+                    // Branchless max, this loop vectorises
+                    const int32_t x_start = static_cast<int32_t>(span_start);
+                    const int32_t x_end   = static_cast<int32_t>(span_end);
+                    const float depth_row = triangle.depth_b * center_y + triangle.depth_c + triangle.depth_a * 0.5f;
+                    float* row            = &m_depth[y * width];
+                    for (int32_t x = x_start; x <= x_end; x++)
+                    {
+                        const float depth = triangle.depth_a * static_cast<float>(x) + depth_row;
+                        row[x]            = row[x] > depth ? row[x] : depth;
+                    }
+                }
+            }
+        }
+    }
+
+    bool OcclusionBuffer::IsVisible(const BoundingBox& box) const
+    {
+        if (m_triangle_count == 0)
+            return true;
+
+        const Vector3& min = box.GetMin();
+        const Vector3& max = box.GetMax();
+
+        Vector2 screen_min = Vector2(numeric_limits<float>::max(), numeric_limits<float>::max());
+        Vector2 screen_max = Vector2(numeric_limits<float>::lowest(), numeric_limits<float>::lowest());
+        float w_min        = numeric_limits<float>::max();
+        for (uint32_t i = 0; i < 8; i++)
+        {
+            const Vector4 corner = Vector4(i & 1 ? max.x : min.x, i & 2 ? max.y : min.y, i & 4 ? max.z : min.z, 1.0f) * m_view_projection;
+
+            // Crossing the near plane, the projection can't be bounded
+            if (corner.w < m_near_plane)
+                return true;
+
+            const Vector3 screen = to_screen(corner);
+            screen_min.x = Helper::Min(screen_min.x, screen.x);
+            screen_min.y = Helper::Min(screen_min.y, screen.y);
+            screen_max.x = Helper::Max(screen_max.x, screen.x);
+            screen_max.y = Helper::Max(screen_max.y, screen.y);
+            w_min        = Helper::Min(w_min, corner.w);
+        }
+
+        // Occluders are sampled at pixel centres, so the rectangle grows by a pixel to absorb the coverage error
+        const int32_t x_start = Helper::Max(to_pixel(Helper::Floor(screen_min.x), width) - 1, 0);
+        const int32_t x_end   = Helper::Min(to_pixel(Helper::Floor(screen_max.x), width) + 1, static_cast<int32_t>(width) - 1);
+        const int32_t y_start = Helper::Max(to_pixel(Helper::Floor(screen_min.y), height) - 1, 0);
+        const int32_t y_end   = Helper::Min(to_pixel(Helper::Floor(screen_max.y), height) + 1, static_cast<int32_t>(height) - 1);
+
+        // Off screen, that's for the frustum to decide
+        if (x_start > x_end || y_start > y_end)
+            return true;
+
+        // Visible if the nearest point of the box isn't behind the occluders at any pixel
+        const float depth_nearest = 1.0f / w_min;
+        for (int32_t y = y_start; y <= y_end; y++)
+        {
+            const float* row = &m_depth[y * width];
+            bool visible     = false;
+            for (int32_t x = x_start; x <= x_end; x++)
+            {
+                visible |= row[x] <= depth_nearest;
+            }
+
+            if (visible)
+                return true;
+        }
+
+        return false;
+    }
+}
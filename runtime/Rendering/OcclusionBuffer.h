@@ -0,0 +1,94 @@
+/*
+Copyright(c) 2016-2023 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ===================
+#include <vector>
+#include "Definitions.h"
+#include "../Math/BoundingBox.h"
+#include "../Math/Matrix.h"
+#include "../RHI/RHI_Vertex.h"
+//==============================
+
+namespace Spartan
+{
+    // A small depth buffer which large occluders are rasterised into on the CPU, so that renderables
+    // hidden behind them can be rejected before draw submission. Depth is stored as 1/w (bigger is
+    // nearer) since it's linear in screen space, and it's kept conservative, an occluder never
+    // appears nearer than it really is.
+    class SP_CLASS OcclusionBuffer
+    {
+    public:
+        static const uint32_t width       = 256; // a whole number of SIMD lanes per row
+        static const uint32_t height      = 128;
+        static const uint32_t band_height = 16;  // rows rasterised by a single worker
+
+        // Clears the buffer, occluders and tests are projected with this view
+        void Begin(const Math::Matrix& view_projection, const float near_plane);
+
+        // The vertex and index memory has to outlive Rasterize(), indices are relative to vertices
+        void AddOccluder(const Math::Matrix& transform, const RHI_Vertex_PosTexNorTan* vertices, const uint32_t* indices, const uint32_t index_count);
+
+        // Transforms and rasterises the occluders on worker threads
+        void Rasterize();
+
+        // False only if the box is behind occluders everywhere it covers
+        bool IsVisible(const Math::BoundingBox& box) const;
+
+        uint32_t GetOccluderCount() const { return static_cast<uint32_t>(m_occluders.size()); }
+        uint32_t GetTriangleCount() const { return m_triangle_count; }
+
+    private:
+        struct Occluder
+        {
+            Math::Matrix transform;
+            const RHI_Vertex_PosTexNorTan* vertices = nullptr;
+            const uint32_t* indices                 = nullptr;
+            uint32_t index_count                    = 0;
+        };
+
+        // Screen space setup, a pixel centre is inside when a * x + b * y + c >= 0 for every edge
+        struct Triangle
+        {
+            float edge_a[3];
+            float edge_b[3];
+            float edge_c[3];
+            float depth_a;
+            float depth_b;
+            float depth_c;
+            int32_t x_min;
+            int32_t x_max;
+            int32_t y_min;
+            int32_t y_max;
+        };
+
+        void SetupOccluder(const Occluder& occluder, std::vector<Triangle>& triangles) const;
+        void RasterizeBand(const uint32_t band_index);
+
+        Math::Matrix m_view_projection = Math::Matrix::Identity;
+        float m_near_plane             = 0.0f;
+        uint32_t m_triangle_count      = 0;
+        std::vector<Occluder> m_occluders;
+        std::vector<std::vector<Triangle>> m_triangles; // one list per occluder, they are set up in parallel
+        std::vector<float> m_depth;
+    };
+}
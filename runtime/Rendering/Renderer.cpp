@@ -23,9 +23,11 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "pch.h"                                
 #include "Renderer.h"                           
 #include "../World/Entity.h"                    
+#include "../World/World.h"                     
 #include "../World/Components/Camera.h"         
 #include "../World/Components/Light.h"          
 #include "../World/Components/ReflectionProbe.h"
+#include "../World/Components/Renderable.h"     
 #include "../RHI/RHI_ConstantBuffer.h"          
 #include "../RHI/RHI_StructuredBuffer.h"        
 #include "../RHI/RHI_Implementation.h"          
@@ -37,6 +39,9 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../World/Components/Environment.h"    
 #include "../RHI/RHI_SwapChain.h"
 #include "../Display/Display.h"
+#include "../Profiling/Profiler.h"
+#include "../Core/ThreadPool.h"
+#include "OcclusionBuffer.h"
 //==============================================
 
 //= NAMESPACES ===============
@@ -49,7 +54,8 @@ namespace Spartan
     namespace
     {
         // sync objects
-        static thread::id m_render_thread_id;
+        static atomic<thread::id> m_render_thread_id;
+        static recursive_mutex m_mutex_frame;
         static mutex m_mutex_entity_addition;
         static mutex m_mutex_mip_generation;
         static mutex m_mutex_environment_texture;
@@ -60,11 +66,26 @@ namespace Spartan
         static bool m_dirty_orthographic_projection = true;
 
         // options
-        static array<float, 34> m_options;
+        static array<float, 41> m_options;
 
         // frame
-        static uint64_t m_frame_num = 0;
-        static bool m_is_odd_frame  = false;
+        static atomic<uint64_t> m_frame_num        = 0;
+        static bool m_is_odd_frame                 = false;
+        static bool m_first_frame_event_fired      = false;
+        static atomic<bool> m_swap_chain_has_frame = false;
+
+        // render thread
+        static const uint32_t m_frames_in_flight_max = 3;
+        static array<Renderer_Snapshot, m_frames_in_flight_max + 1> m_snapshots; // ring, reused so that the vectors keep their memory
+        static uint64_t m_snapshots_produced = 0;
+        static uint64_t m_snapshots_consumed = 0;
+        static uint64_t m_snapshots_dropped  = 0;     // the snapshots before this one are handed back without being rendered
+        static bool m_snapshot_building      = false; // the simulation has taken a snapshot but not published it yet
+        static uint32_t m_frames_in_flight   = 0;
+        static bool m_render_thread_running  = false;
+        static thread m_render_thread;
+        static mutex m_mutex_snapshots;
+        static condition_variable m_condition_snapshots;
 
         // Resolution & Viewport
         static Math::Vector2 m_resolution_render = Math::Vector2::Zero;
@@ -84,45 +105,607 @@ namespace Spartan
         static RHI_CommandList* m_cmd_current = nullptr;
 
         // misc
-        static vector<shared_ptr<Entity>> m_renderables_pending;
+        static WorldChangeLog m_renderables_pending;
         static vector<weak_ptr<RHI_Texture>> m_textures_mip_generation;
         static shared_ptr<Camera> m_camera;
         static Math::Vector2 m_jitter_offset          = Math::Vector2::Zero;
         static Environment* m_environment             = nullptr;
-        static bool m_add_new_entities                = false;
         static const uint32_t m_resolution_shadow_min = 128;
         static float m_near_plane                     = 0.0f;
         static float m_far_plane                      = 1.0f;
+        static uint32_t m_shadow_lights_dropped       = 0; // the last snapshot's, so that it's only logged when it grows
+
+        // Snapshot geometry bounds and the views they are culled against
+        static Math::FrustumCullBoxes m_cull_boxes_opaque;
+        static Math::FrustumCullBoxes m_cull_boxes_transparent;
+        static vector<Math::FrustumCullView> m_cull_views_opaque;
+        static vector<Math::FrustumCullView> m_cull_views_transparent;
+
+        // Occlusion, occluders are picked by bounding radius over distance until a budget is reached
+        static OcclusionBuffer m_occlusion_buffer;
+        static vector<pair<float, uint32_t>> m_occluder_candidates;
+        static const uint32_t m_occluder_count_max       = 64;
+        static const uint32_t m_occluder_triangle_budget = 32768;
+        static const float m_occluder_size_min           = 0.1f;
+
+        // Draw lists, one per view and per opaque/transparent, built in parallel
+        struct DrawListJob
+        {
+            const vector<uint64_t>* visible                        = nullptr;
+            const vector<Renderer_SnapshotRenderable>* renderables = nullptr;
+            vector<Renderer_DrawRecord>* draws                     = nullptr;
+            vector<uint32_t>* instances                            = nullptr;
+            Math::Vector3 origin                                   = Math::Vector3::Zero;
+            Math::Vector3 forward                                  = Math::Vector3::Forward;
+            bool is_directional                                    = false; // depth along forward instead of from the origin
+            bool is_transparent                                    = false;
+            bool shadow_casters_only                               = false;
+            bool is_instanced                                      = false; // the pass reads transforms from the instance buffer
+            uint64_t* static_casters                               = nullptr; // point and spot light opaques, their static casters are cached
+            array<Renderer_SnapshotVisibility, 6>* faces           = nullptr; // cubes, the faces are merged into one list and each draw knows which of them see it
+            const Math::Frustum* cluster_frustum                   = nullptr; // the camera's opaques, large meshes are culled per cluster
+            vector<Renderer_DrawRange>* clusters                   = nullptr;
+        };
+        static vector<DrawListJob> m_draw_list_jobs;
+
+        // Material table, a material gets an index the first time it's captured and keeps it until the world is cleared.
+        // Entries are refreshed once per snapshot and the version only changes when one of them actually did.
+        static unordered_map<uint64_t, uint32_t> m_material_indices;
+        static vector<Sb_Material> m_materials;
+        static vector<uint64_t> m_materials_refreshed; // the snapshot in which each entry was last refreshed
+        static uint64_t m_materials_version  = 0;
+        static uint64_t m_materials_snapshot = 0;
+
+        static Sb_Material material_to_entry(Material* material)
+        {
+            Sb_Material entry = {};
+
+            entry.color.x              = material->GetProperty(MaterialProperty::ColorR);
+            entry.color.y              = material->GetProperty(MaterialProperty::ColorG);
+            entry.color.z              = material->GetProperty(MaterialProperty::ColorB);
+            entry.color.w              = material->GetProperty(MaterialProperty::ColorA);
+            entry.tiling_uv.x          = material->GetProperty(MaterialProperty::UvTilingX);
+            entry.tiling_uv.y          = material->GetProperty(MaterialProperty::UvTilingY);
+            entry.offset_uv.x          = material->GetProperty(MaterialProperty::UvOffsetX);
+            entry.offset_uv.y          = material->GetProperty(MaterialProperty::UvOffsetY);
+            entry.roughness_mul        = material->GetProperty(MaterialProperty::RoughnessMultiplier);
+            entry.metallic_mul         = material->GetProperty(MaterialProperty::MetalnessMultiplier);
+            entry.normal_mul           = material->GetProperty(MaterialProperty::NormalMultiplier);
+            entry.height_mul           = material->GetProperty(MaterialProperty::HeightMultiplier);
+            entry.anisotropic          = material->GetProperty(MaterialProperty::Anisotropic);
+            entry.anisitropic_rotation = material->GetProperty(MaterialProperty::AnisotropicRotation);
+            entry.clearcoat            = material->GetProperty(MaterialProperty::Clearcoat);
+            entry.clearcoat_roughness  = material->GetProperty(MaterialProperty::Clearcoat_Roughness);
+            entry.sheen                = material->GetProperty(MaterialProperty::Sheen);
+            entry.sheen_tint           = material->GetProperty(MaterialProperty::SheenTint);
+            entry.properties           = 0;
+            entry.properties          |= material->GetProperty(MaterialProperty::SingleTextureRoughnessMetalness) ? (1U << 0) : 0;
+            entry.properties          |= material->HasTexture(MaterialTexture::Height)                            ? (1U << 1) : 0;
+            entry.properties          |= material->HasTexture(MaterialTexture::Normal)                            ? (1U << 2) : 0;
+            entry.properties          |= material->HasTexture(MaterialTexture::Color)                             ? (1U << 3) : 0;
+            entry.properties          |= material->HasTexture(MaterialTexture::Roughness)                         ? (1U << 4) : 0;
+            entry.properties          |= material->HasTexture(MaterialTexture::Metalness)                         ? (1U << 5) : 0;
+            entry.properties          |= material->HasTexture(MaterialTexture::AlphaMask)                         ? (1U << 6) : 0;
+            entry.properties          |= material->HasTexture(MaterialTexture::Emission)                          ? (1U << 7) : 0;
+            entry.properties          |= material->HasTexture(MaterialTexture::Occlusion)                         ? (1U << 8) : 0;
+
+            return entry;
+        }
+
+        static uint32_t capture_material(Material* material)
+        {
+            if (!material)
+                return 0;
+
+            auto it = m_material_indices.find(material->GetObjectId());
+            if (it == m_material_indices.end())
+            {
+                const uint32_t index = static_cast<uint32_t>(m_materials.size());
+                m_material_indices[material->GetObjectId()] = index;
+                m_materials.emplace_back(material_to_entry(material));
+                m_materials_refreshed.emplace_back(m_materials_snapshot);
+                m_materials_version++;
+
+                return index;
+            }
+
+            // Shared materials are only looked at once per snapshot
+            const uint32_t index = it->second;
+            if (m_materials_refreshed[index] != m_materials_snapshot)
+            {
+                m_materials_refreshed[index] = m_materials_snapshot;
+
+                const Sb_Material entry = material_to_entry(material);
+                if (entry != m_materials[index])
+                {
+                    m_materials[index] = entry;
+                    m_materials_version++;
+                }
+            }
+
+            return index;
+        }
+
+        // Indirect drawing, candidates sorted by material and mesh so that every batch is a contiguous run
+        static vector<pair<uint64_t, uint32_t>> m_indirect_keys;
+        static vector<pair<uint64_t, uint32_t>> m_indirect_scratch;
+
+        // Parallel recording, a chunk has to have at least this many draws to be worth a secondary command list
+        static const uint32_t m_secondary_draws_min = 128;
+
+        // Positive floats keep their order when their bits are compared as integers, so no depth range is needed
+        static uint64_t quantize_depth(const float depth)
+        {
+            return static_cast<uint64_t>(bit_cast<uint32_t>(Math::Helper::Max(depth, 0.0f)) >> 8); // 24 bits
+        }
+
+        // The layout is documented next to Renderer_DrawRecord
+        static uint64_t compute_draw_key(const bool is_transparent, const bool is_alpha_tested, const bool is_dynamic, const uint64_t material_id, const uint64_t mesh_id, const float depth)
+        {
+            const uint64_t pass     = is_transparent ? 1 : 0;
+            const uint64_t pipeline = (is_dynamic ? 2 : 0) | (is_alpha_tested ? 1 : 0);
+            const uint64_t material = material_id & 0xFFFF;
+            const uint64_t mesh     = mesh_id & 0xFFFF;
+            const uint64_t depth_q  = quantize_depth(depth);
+
+            if (is_transparent)
+                return (pass << 60) | ((0xFFFFFF - depth_q) << 36) | (pipeline << 32) | (material << 16) | mesh;
 
-        static void sort_renderables(vector<shared_ptr<Entity>>* renderables, const bool are_transparent)
+            return (pass << 60) | (pipeline << 56) | (material << 40) | (mesh << 24) | depth_q;
+        }
+
+        // LSD radix sort with 8 bit digits, digits which are the same for every key are skipped
+        static void radix_sort(vector<pair<uint64_t, uint32_t>>& keys, vector<pair<uint64_t, uint32_t>>& scratch)
         {
-            if (!m_camera || renderables->size() <= 2)
+            if (keys.size() <= 1)
                 return;
 
-            auto comparison_op = [](shared_ptr<Entity> entity)
+            scratch.resize(keys.size());
+            for (uint32_t shift = 0; shift < 64; shift += 8)
             {
-                auto renderable = entity->GetComponent<Renderable>();
-                if (!renderable)
-                    return 0.0f;
+                uint32_t histogram[256] = {};
+                for (const pair<uint64_t, uint32_t>& key : keys)
+                {
+                    histogram[(key.first >> shift) & 0xFF]++;
+                }
 
-                return (renderable->GetAabb().GetCenter() - m_camera->GetTransform()->GetPosition()).LengthSquared();
-            };
+                if (histogram[(keys[0].first >> shift) & 0xFF] == keys.size())
+                    continue;
+
+                uint32_t offset = 0;
+                for (uint32_t& count : histogram)
+                {
+                    const uint32_t digit_count = count;
+                    count                      = offset;
+                    offset                    += digit_count;
+                }
+
+                for (const pair<uint64_t, uint32_t>& key : keys)
+                {
+                    scratch[histogram[(key.first >> shift) & 0xFF]++] = key;
+                }
+
+                keys.swap(scratch);
+            }
+        }
+
+        static bool can_instance(const Renderer_DrawRecord& a, const Renderer_DrawRecord& b)
+        {
+            return
+                a.mesh          == b.mesh          &&
+                a.material      == b.material      &&
+                a.index_count   == b.index_count   &&
+                a.index_offset  == b.index_offset  &&
+                a.vertex_offset == b.vertex_offset &&
+                a.is_dynamic    == b.is_dynamic    &&
+                a.face_mask     == b.face_mask     &&
+                a.cluster_count == 0               &&
+                b.cluster_count == 0;
+        }
+
+        // Appends the index ranges of the clusters which are in the frustum and don't face away from the origin, neighbours are merged.
+        // Returns false when none of them survived, if they all did, nothing is appended and the draw keeps its whole range.
+        static bool cull_clusters(const vector<MeshCluster>& clusters, const Math::Matrix& transform, const Math::Frustum& frustum, const Math::Vector3& origin, vector<Renderer_DrawRange>& ranges)
+        {
+            // The rows of the upper 3x3 are the transformed axes
+            const Math::Vector3 axis_x(transform.m00, transform.m01, transform.m02);
+            const Math::Vector3 axis_y(transform.m10, transform.m11, transform.m12);
+            const Math::Vector3 axis_z(transform.m20, transform.m21, transform.m22);
+            const float scale_min    = Math::Helper::Min3(axis_x.Length(), axis_y.Length(), axis_z.Length());
+            const float radius_scale = Math::Helper::Max3(axis_x.Length(), axis_y.Length(), axis_z.Length());
+            const size_t range_start = ranges.size();
+
+            // Normals transform with the inverse-transpose, its rows are the cofactor rows below divided by the
+            // determinant, the axis is normalized so the division is skipped. A cone only holds under a uniform scale,
+            // and a mirrored transform flips the winding, in either case only the sphere test is done.
+            const Math::Vector3 cofactor_x = axis_y.Cross(axis_z);
+            const Math::Vector3 cofactor_y = axis_z.Cross(axis_x);
+            const Math::Vector3 cofactor_z = axis_x.Cross(axis_y);
+            const float determinant        = axis_x.Dot(cofactor_x);
+            const bool cone_test           = determinant > 0.0f && radius_scale - scale_min <= radius_scale * 0.001f;
+
+            uint32_t survivor_count = 0;
+            for (const MeshCluster& cluster : clusters)
+            {
+                const Math::Vector3 center = cluster.center * transform;
+                const float radius         = cluster.radius * radius_scale;
+                if (!frustum.IsVisible(center, Math::Vector3(radius)))
+                    continue;
+
+                // Every triangle of the cluster faces away when the origin is inside of the (negated) normal cone
+                if (cone_test && cluster.cone_cutoff < 1.0f)
+                {
+                    const Math::Vector3 apex = cluster.cone_apex * transform;
+                    const Math::Vector3 axis = (cofactor_x * cluster.cone_axis.x + cofactor_y * cluster.cone_axis.y + cofactor_z * cluster.cone_axis.z).Normalized();
+                    if ((apex - origin).Normalized().Dot(axis) >= cluster.cone_cutoff)
+                        continue;
+                }
+
+                survivor_count++;
+                if (ranges.size() > range_start && ranges.back().index_offset + ranges.back().index_count == cluster.index_offset)
+                {
+                    ranges.back().index_count += cluster.index_count;
+                }
+                else
+                {
+                    ranges.push_back({ cluster.index_offset, cluster.index_count });
+                }
+            }
+
+            if (survivor_count == clusters.size())
+            {
+                ranges.resize(range_start);
+            }
+
+            return survivor_count != 0;
+        }
+
+        static void build_draw_list(const DrawListJob& job)
+        {
+            // Per worker, so the memory is reused across frames
+            thread_local vector<Renderer_DrawRecord> draws;
+            thread_local vector<pair<uint64_t, uint32_t>> keys;
+            thread_local vector<pair<uint64_t, uint32_t>> scratch;
+            thread_local vector<uint64_t> visible_faces;
+            thread_local vector<Renderer_DrawRange> clusters;
+            draws.clear();
+            keys.clear();
+            clusters.clear();
+            uint64_t static_casters = 0;
+            array<uint64_t, 6> static_casters_faces = {};
+
+            // Cubes, a renderable is drawn once if any of the faces sees it
+            const vector<uint64_t>* visible = job.visible;
+            if (job.faces)
+            {
+                visible_faces.clear();
+                for (const Renderer_SnapshotVisibility& face : *job.faces)
+                {
+                    const vector<uint64_t>& words = job.is_transparent ? face.transparent : face.opaque;
+                    visible_faces.resize(words.size(), 0);
+                    for (uint32_t i = 0; i < static_cast<uint32_t>(words.size()); i++)
+                    {
+                        visible_faces[i] |= words[i];
+                    }
+                }
+                visible = &visible_faces;
+            }
+
+            for (const uint32_t index : Renderer_VisibleIndices(*visible))
+            {
+                const Renderer_SnapshotRenderable& entity = (*job.renderables)[index];
+                const Renderable* renderable              = entity.renderable.get();
+                Mesh* mesh                                = renderable->GetMesh();
+                Material* material                        = renderable->GetMaterial();
+
+                if (!material || !mesh || !mesh->GetVertexBuffer() || !mesh->GetIndexBuffer())
+                    continue;
+
+                if (job.shadow_casters_only && !renderable->GetCastShadows())
+                    continue;
+
+                // Clusters only exist for the full range, not for its LODs
+                const uint32_t cluster_offset = static_cast<uint32_t>(clusters.size());
+                if (job.cluster_frustum && entity.index_offset == renderable->GetIndexOffset())
+                {
+                    if (const vector<MeshCluster>* mesh_clusters = mesh->GetClusters(entity.index_offset))
+                    {
+                        if (!cull_clusters(*mesh_clusters, entity.transform, *job.cluster_frustum, job.origin, clusters))
+                            continue;
+                    }
+                }
+
+                // Renderables can share a mesh but draw different parts of it, the part is folded
+                // into the mesh bits so that instances of the same part end up next to each other
+                const uint64_t mesh_id = mesh->GetObjectId() ^ (static_cast<uint64_t>(entity.index_offset) * 0x9E3779B1);
+
+                const Math::Vector3 to_center = entity.aabb.GetCenter() - job.origin;
+                const float depth             = job.is_directional ? to_center.Dot(job.forward) : to_center.Length();
+                const bool is_dynamic         = job.static_casters && !entity.is_static;
+
+                uint8_t face_mask = 0;
+                if (job.faces)
+                {
+                    for (uint32_t face = 0; face < 6; face++)
+                    {
+                        const vector<uint64_t>& words = job.is_transparent ? (*job.faces)[face].transparent : (*job.faces)[face].opaque;
+                        if (words[index / 64] & (1ull << (index % 64)))
+                        {
+                            face_mask |= 1 << face;
+                        }
+                    }
+                }
+
+                // Order independent, so it only changes when a static caster enters or leaves the view, or switches LOD
+                if (job.static_casters && !is_dynamic)
+                {
+                    const uint64_t hash = (entity.entity->GetObjectId() + 1 + static_cast<uint64_t>(entity.index_offset) * 0x9E3779B1) * 0x9E3779B97F4A7C15;
+                    static_casters += hash;
+
+                    for (uint32_t face = 0; face < 6; face++)
+                    {
+                        static_casters_faces[face] += (face_mask & (1 << face)) ? hash : 0;
+                    }
+                }
+
+                Renderer_DrawRecord& draw = draws.emplace_back();
+                draw.key                  = compute_draw_key(job.is_transparent, material->HasTexture(MaterialTexture::AlphaMask), is_dynamic, material->GetObjectId(), mesh_id, depth);
+                draw.renderable_index     = index;
+                draw.index_count          = entity.index_count;
+                draw.index_offset         = entity.index_offset;
+                draw.vertex_offset        = renderable->GetVertexOffset();
+                draw.material_index       = entity.material_index;
+                draw.mesh                 = mesh;
+                draw.material             = material;
+                draw.cluster_offset       = cluster_offset;
+                draw.cluster_count        = static_cast<uint32_t>(clusters.size()) - cluster_offset;
+                draw.is_dynamic           = is_dynamic;
+                draw.face_mask            = face_mask;
+
+                keys.emplace_back(draw.key, static_cast<uint32_t>(draws.size() - 1));
+            }
+
+            radix_sort(keys, scratch);
+
+            if (job.static_casters)
+            {
+                *job.static_casters = static_casters;
+            }
 
-            // sort by depth
-            sort(renderables->begin(), renderables->end(), [&comparison_op, &are_transparent](shared_ptr<Entity> a, shared_ptr<Entity> b)
+            if (job.faces && job.static_casters)
             {
-                bool front_to_back = comparison_op(a) <= comparison_op(b);
-                bool back_to_front = !front_to_back;
-                return are_transparent ? back_to_front : front_to_back;
+                for (uint32_t face = 0; face < 6; face++)
+                {
+                    (*job.faces)[face].static_casters = static_casters_faces[face];
+                }
+            }
+
+            job.draws->clear();
+            job.instances->clear();
+            if (job.clusters)
+            {
+                job.clusters->clear();
+            }
+            for (const pair<uint64_t, uint32_t>& key : keys)
+            {
+                const Renderer_DrawRecord& draw = draws[key.second];
+
+                // Opaques with the same mesh, sub-range and material are next to each other (see the key), so they
+                // can be merged as they come, transparents have to stay in depth order so they are never merged
+                if (job.is_instanced && !job.is_transparent && !job.draws->empty() && can_instance(job.draws->back(), draw))
+                {
+                    job.draws->back().instance_count++;
+                }
+                else
+                {
+                    Renderer_DrawRecord& draw_new = job.draws->emplace_back(draw);
+                    draw_new.instance_offset      = static_cast<uint32_t>(job.instances->size());
+
+                    // The surviving clusters move to the view, in draw order
+                    if (draw.cluster_count != 0)
+                    {
+                        draw_new.cluster_offset = static_cast<uint32_t>(job.clusters->size());
+                        job.clusters->insert(job.clusters->end(), clusters.begin() + draw.cluster_offset, clusters.begin() + draw.cluster_offset + draw.cluster_count);
+                    }
+                }
+
+                job.instances->emplace_back(draw.renderable_index);
+            }
+        }
+
+        // Every opaque becomes a candidate, the gpu does the culling, so this doesn't depend on the camera's visibility.
+        // The candidate's instance is appended to the instance indices, so the pass can leave the instance offset at 0.
+        static void build_indirect_draws(Renderer_Snapshot& snapshot)
+        {
+            snapshot.indirect_draws.clear();
+            snapshot.indirect_batches.clear();
+            m_indirect_keys.clear();
+
+            for (uint32_t index = 0; index < static_cast<uint32_t>(snapshot.geometry_opaque.size()); index++)
+            {
+                const Renderable* renderable = snapshot.geometry_opaque[index].renderable.get();
+                Mesh* mesh                   = renderable->GetMesh();
+                Material* material           = renderable->GetMaterial();
+
+                if (!material || !mesh || !mesh->GetVertexBuffer() || !mesh->GetIndexBuffer())
+                    continue;
+
+                const uint64_t key = (material->GetObjectId() << 32) | (mesh->GetObjectId() & 0xFFFFFFFF);
+                m_indirect_keys.emplace_back(key, index);
+            }
+
+            radix_sort(m_indirect_keys, m_indirect_scratch);
+
+            const uint32_t instance_base = static_cast<uint32_t>(snapshot.instance_indices.size());
+            for (uint32_t i = 0; i < static_cast<uint32_t>(m_indirect_keys.size()); i++)
+            {
+                const Renderer_SnapshotRenderable& entity = snapshot.geometry_opaque[m_indirect_keys[i].second];
+                const Renderable* renderable              = entity.renderable.get();
+                Mesh* mesh                                = renderable->GetMesh();
+                Material* material                        = renderable->GetMaterial();
+
+                // A new batch starts whenever the mesh or the material changes, sub-ranges can differ within a batch
+                if (snapshot.indirect_batches.empty() || snapshot.indirect_batches.back().mesh != mesh || snapshot.indirect_batches.back().material != material)
+                {
+                    Renderer_IndirectBatch& batch = snapshot.indirect_batches.emplace_back();
+                    batch.mesh                    = mesh;
+                    batch.material                = material;
+                    batch.material_index          = entity.material_index;
+                    batch.args_offset             = i;
+                }
+                snapshot.indirect_batches.back().draw_count_max++;
+
+                Sb_IndirectDraw& draw = snapshot.indirect_draws.emplace_back();
+                draw.aabb_min         = entity.aabb.GetMin();
+                draw.aabb_max         = entity.aabb.GetMax();
+                draw.index_count      = entity.index_count;
+                draw.index_offset     = entity.index_offset;
+                draw.vertex_offset    = static_cast<int32_t>(renderable->GetVertexOffset());
+                draw.instance         = instance_base + i;
+                draw.batch            = static_cast<uint32_t>(snapshot.indirect_batches.size() - 1);
+                draw.args_offset      = snapshot.indirect_batches.back().args_offset;
+
+                snapshot.instance_indices.emplace_back(m_indirect_keys[i].second);
+            }
+        }
+
+        // Returns how many of the camera's visible renderables ended up occluded
+        static uint32_t occlusion_cull(Renderer_Snapshot& snapshot)
+        {
+            Renderer_SnapshotCamera& camera = snapshot.camera;
+
+            // Occluders come from what the camera sees, the mesh has to be fully loaded (the passes have
+            // the same requirement) and alpha tested surfaces are skipped since they have holes in them
+            m_occluder_candidates.clear();
+            for (const uint32_t index : Renderer_VisibleIndices(camera.visible.opaque))
+            {
+                const Renderer_SnapshotRenderable& entity = snapshot.geometry_opaque[index];
+                const Renderable* renderable              = entity.renderable.get();
+                Mesh* mesh                                = renderable->GetMesh();
+                const Material* material                  = renderable->GetMaterial();
+
+                if (!mesh || !mesh->GetVertexBuffer() || !mesh->GetIndexBuffer())
+                    continue;
+
+                if (material && material->HasTexture(MaterialTexture::AlphaMask))
+                    continue;
+
+                if (renderable->GetIndexCount() / 3 > m_occluder_triangle_budget)
+                    continue;
+
+                const float radius   = entity.aabb.GetExtents().Length();
+                const float distance = Math::Helper::Max((entity.aabb.GetCenter() - camera.position).Length(), Math::Helper::EPSILON);
+                const float size     = radius / distance;
+                if (size >= m_occluder_size_min)
+                {
+                    m_occluder_candidates.emplace_back(size, index);
+                }
+            }
+
+            if (m_occluder_candidates.empty())
+                return 0;
+
+            sort(m_occluder_candidates.begin(), m_occluder_candidates.end(), [](const pair<float, uint32_t>& a, const pair<float, uint32_t>& b)
+            {
+                return a.first > b.first;
             });
+
+            m_occlusion_buffer.Begin(camera.view * camera.projection, camera.near_plane);
+            uint32_t triangle_count = 0;
+            for (const pair<float, uint32_t>& candidate : m_occluder_candidates)
+            {
+                if (m_occlusion_buffer.GetOccluderCount() == m_occluder_count_max)
+                    break;
+
+                const Renderer_SnapshotRenderable& entity = snapshot.geometry_opaque[candidate.second];
+                const Renderable* renderable              = entity.renderable.get();
+                Mesh* mesh                                = renderable->GetMesh();
+
+                const uint32_t triangles = renderable->GetIndexCount() / 3;
+                if (triangle_count + triangles > m_occluder_triangle_budget)
+                    continue;
+                triangle_count += triangles;
+
+                m_occlusion_buffer.AddOccluder
+                (
+                    entity.transform,
+                    mesh->GetVertices().data() + renderable->GetVertexOffset(),
+                    mesh->GetIndices().data()  + renderable->GetIndexOffset(),
+                    renderable->GetIndexCount()
+                );
+            }
+            m_occlusion_buffer.Rasterize();
+
+            // Each mask word is owned by a single work item
+            auto cull = [](const vector<Renderer_SnapshotRenderable>& renderables, vector<uint64_t>& mask)
+            {
+                atomic<uint32_t> occluded_count = 0;
+
+                ThreadPool::ParallelFor([&renderables, &mask, &occluded_count](uint32_t work_index_start, uint32_t work_index_end)
+                {
+                    uint32_t occluded = 0;
+                    for (uint32_t word_index = work_index_start; word_index < work_index_end; word_index++)
+                    {
+                        for (uint64_t bits = mask[word_index]; bits != 0; bits &= bits - 1)
+                        {
+                            const uint32_t bit = static_cast<uint32_t>(countr_zero(bits));
+                            if (!m_occlusion_buffer.IsVisible(renderables[word_index * 64 + bit].aabb))
+                            {
+                                mask[word_index] &= ~(uint64_t(1) << bit);
+                                occluded++;
+                            }
+                        }
+                    }
+                    occluded_count += occluded;
+                }, static_cast<uint32_t>(mask.size()));
+
+                return occluded_count.load();
+            };
+
+            return cull(snapshot.geometry_opaque, camera.visible.opaque) + cull(snapshot.geometry_transparent, camera.visible.transparent);
+        }
+
+        static void add_renderable(unordered_map<Renderer_Entity, vector<shared_ptr<Entity>>>& renderables, const shared_ptr<Entity>& entity)
+        {
+            if (shared_ptr<Renderable> renderable = entity->GetComponent<Renderable>())
+            {
+                bool is_transparent = false;
+                bool is_visible     = true;
+
+                if (const Material* material = renderable->GetMaterial())
+                {
+                    is_transparent = material->GetProperty(MaterialProperty::ColorA) < 1.0f;
+                    is_visible     = material->GetProperty(MaterialProperty::ColorA) != 0.0f;
+                }
+
+                if (is_visible)
+                {
+                    renderables[is_transparent ? Renderer_Entity::Geometry_transparent : Renderer_Entity::Geometry_opaque].emplace_back(entity);
+                }
+            }
+
+            if (shared_ptr<Light> light = entity->GetComponent<Light>())
+            {
+                renderables[Renderer_Entity::Light].emplace_back(entity);
+            }
+
+            if (shared_ptr<Camera> camera = entity->GetComponent<Camera>())
+            {
+                renderables[Renderer_Entity::Camera].emplace_back(entity);
+                m_camera = camera;
+            }
+
+            if (shared_ptr<ReflectionProbe> reflection_probe = entity->GetComponent<ReflectionProbe>())
+            {
+                renderables[Renderer_Entity::Reflection_probe].emplace_back(entity);
+            }
         }
     }
 
     unordered_map<Renderer_Entity, vector<shared_ptr<Entity>>> Renderer::m_renderables;
+    const Renderer_Snapshot* Renderer::m_snapshot = nullptr;
     Cb_Frame Renderer::m_cb_frame_cpu;
     Cb_Pass Renderer::m_cb_pass_cpu;
-    Cb_Light Renderer::m_cb_light_cpu;
-    Cb_Material Renderer::m_cb_material_cpu;
     shared_ptr<RHI_VertexBuffer> Renderer::m_vertex_buffer_lines;
     unique_ptr<Font> Renderer::m_font;
     unique_ptr<Grid> Renderer::m_world_grid;
@@ -131,6 +714,7 @@ namespace Spartan
     uint32_t Renderer::m_lines_index_depth_off;
     uint32_t Renderer::m_lines_index_depth_on;
     bool Renderer::m_brdf_specular_lut_rendered;
+    uint32_t Renderer::m_indirect_stats_index = 0;
 
     void Renderer::Initialize()
     {
@@ -183,6 +767,7 @@ namespace Spartan
         // Create command pool
         m_cmd_pool = RHI_Device::AllocateCommandPool("renderer", m_swap_chain->GetObjectId());
         m_cmd_pool->AllocateCommandLists(RHI_Queue_Type::Graphics, 2, 2);
+        m_cmd_pool->AllocateSecondaryCommandLists(renderer_max_secondary_cmd_lists);
 
         // Adjust render option to reflect whether the swapchain is HDR or not
         SetOption(Renderer_Option::Hdr, m_swap_chain->IsHdr());
@@ -196,6 +781,8 @@ namespace Spartan
         SetOption(Renderer_Option::ScreenSpaceReflections, 1.0f);
         SetOption(Renderer_Option::Anisotropy,             16.0f);
         SetOption(Renderer_Option::ShadowResolution,       2048.0f);
+        SetOption(Renderer_Option::ShadowResolutionLocal,  1024.0f);
+        SetOption(Renderer_Option::ShadowSlicesLocal,      48.0f); // Eight point lights.
         SetOption(Renderer_Option::Tonemapping,            static_cast<float>(Renderer_Tonemapping::Disabled));
         SetOption(Renderer_Option::Gamma,                  2.2f);
         SetOption(Renderer_Option::Exposure,               1.0f);
@@ -213,77 +800,640 @@ namespace Spartan
         SetOption(Renderer_Option::Debug_Physics,            0.0f);
         SetOption(Renderer_Option::Debug_PerformanceMetrics, 1.0f);
         SetOption(Renderer_Option::Vsync,                    0.0f);
+        SetOption(Renderer_Option::FramesInFlight,           0.0f); // Opt-in, the render thread adds a frame of latency.
+        SetOption(Renderer_Option::OcclusionCulling,         1.0f);
+        SetOption(Renderer_Option::ParallelRecording,        1.0f);
+        SetOption(Renderer_Option::ShadowFacesPerFrame,      12.0f); // Two point lights at full rate.
+        SetOption(Renderer_Option::ClusterCulling,           1.0f);
         //SetOption(RendererOption::DepthOfField,        1.0f); // This is depth of field from ALDI, so until I improve it, it should be disabled by default.
         //SetOption(RendererOption::Render_DepthPrepass, 1.0f); // Depth-pre-pass is not always faster, so by default, it's disabled.
         //SetOption(RendererOption::Debanding,           1.0f); // Disable debanding as we shouldn't be seeing banding to begin with.
         //SetOption(RendererOption::VolumetricFog,       1.0f); // Disable by default because it's not that great, I need to do it with a voxelised approach.
 
-        // Create all the resources
-        CreateConstantBuffers();
-        CreateShaders();
-        CreateDepthStencilStates();
-        CreateRasterizerStates();
-        CreateBlendStates();
-        CreateRenderTextures(true, true, true, true);
-        CreateFonts();
-        CreateSamplers(false);
-        CreateStructuredBuffers();
-        CreateStandardTextures();
-        CreateStandardMeshes();
+        // Create all the resources
+        CreateConstantBuffers();
+        CreateShaders();
+        CreateDepthStencilStates();
+        CreateRasterizerStates();
+        CreateBlendStates();
+        CreateRenderTextures(true, true, true, true);
+        CreateFonts();
+        CreateSamplers(false);
+        CreateStructuredBuffers();
+        CreateStandardTextures();
+        CreateStandardMeshes();
+
+        // Subscribe to events
+        SP_SUBSCRIBE_TO_EVENT(EventType::WorldResolved,             SP_EVENT_HANDLER_VARIANT_STATIC(OnWorldResolved));
+        SP_SUBSCRIBE_TO_EVENT(EventType::WorldClear,                SP_EVENT_HANDLER_STATIC(OnClear));
+        SP_SUBSCRIBE_TO_EVENT(EventType::WindowFullscreenWindowedToggled, SP_EVENT_HANDLER_STATIC(OnFullScreenToggled));
+
+        // Fire event
+        SP_FIRE_EVENT(EventType::RendererOnInitialized);
+    }
+
+    void Renderer::Shutdown()
+    {
+        // Finish any frames which are still in flight
+        StopRenderThread();
+
+        // console doesn't render anymore, log to file
+        Log::SetLogToFile(true); 
+
+        // Fire event
+        SP_FIRE_EVENT(EventType::RendererOnShutdown);
+
+        // Manually invoke the deconstructors so that ParseDeletionQueue(), releases their RHI resources.
+        {
+            DestroyResources();
+
+            m_renderables_pending.Clear();
+            m_renderables.clear();
+            for (Renderer_Snapshot& snapshot : m_snapshots)
+            {
+                snapshot.Clear();
+            }
+            m_textures_mip_generation.clear();
+            m_world_grid.reset();
+            m_font.reset();
+            m_swap_chain          = nullptr;
+            m_vertex_buffer_lines = nullptr;
+            m_environment_texture = nullptr;
+        }
+
+        // Delete all remaining RHI resources
+        RHI_Device::ParseDeletionQueue();
+
+        RHI_RenderDoc::Shutdown();
+        RHI_FSR2::Destroy();
+        RHI_Device::Destroy();
+    }
+
+    void Renderer::Tick()
+    {
+        // Start or stop the render thread, if the option has changed
+        uint32_t frames_in_flight = GetOption<uint32_t>(Renderer_Option::FramesInFlight);
+        if (frames_in_flight != m_frames_in_flight)
+        {
+            StopRenderThread();
+            m_frames_in_flight = frames_in_flight;
+            if (m_frames_in_flight != 0)
+            {
+                StartRenderThread();
+            }
+        }
+
+        // Don't bother producing frames if the window is minimized
+        if (Window::IsMinimised())
+            return;
+
+        // After the first frame has completed, we know the renderer is working.
+        // We stop logging to a file and we start logging to the on-screen console.
+        if (m_frame_num >= 1 && !m_first_frame_event_fired)
+        {
+            Log::SetLogToFile(false);
+            SP_FIRE_EVENT(EventType::RendererOnFirstFrameCompleted);
+            m_first_frame_event_fired = true;
+        }
+
+        AcquireRenderables();
+
+        if (!m_render_thread_running)
+        {
+            // Rotate through the snapshots anyway, they keep the entities of the frames that the GPU is still working on alive
+            Renderer_Snapshot& snapshot = m_snapshots[m_frame_num % m_snapshots.size()];
+            BuildSnapshot(snapshot);
+            Render(snapshot);
+            return;
+        }
+
+        // Wait for a free snapshot, this is what keeps the simulation from running more than m_frames_in_flight frames ahead
+        Renderer_Snapshot* snapshot = nullptr;
+        {
+            unique_lock<mutex> lock(m_mutex_snapshots);
+            m_condition_snapshots.wait(lock, []() { return (m_snapshots_produced - m_snapshots_consumed) < m_frames_in_flight; });
+            snapshot            = &m_snapshots[m_snapshots_produced % m_snapshots.size()];
+            m_snapshot_building = true;
+        }
+
+        // The render thread won't touch this snapshot until it's published
+        BuildSnapshot(*snapshot);
+
+        // Publish
+        {
+            lock_guard<mutex> lock(m_mutex_snapshots);
+            m_snapshots_produced++;
+            m_snapshot_building = false;
+        }
+        m_condition_snapshots.notify_all();
+    }
+
+    void Renderer::AcquireRenderables()
+    {
+        lock_guard lock(m_mutex_entity_addition);
+
+        if (m_renderables_pending.IsEmpty())
+            return;
+
+        // Start over
+        if (m_renderables_pending.full)
+        {
+            m_renderables.clear();
+            m_camera = nullptr;
+        }
+
+        // Modified and removed entities leave their buckets, the modified ones get classified again below
+        unordered_set<Entity*> entities_leaving;
+        for (const shared_ptr<Entity>& entity : m_renderables_pending.modified)
+        {
+            entities_leaving.insert(entity.get());
+        }
+        for (const shared_ptr<Entity>& entity : m_renderables_pending.removed)
+        {
+            entities_leaving.insert(entity.get());
+        }
+
+        if (!entities_leaving.empty())
+        {
+            for (auto& [type, renderables] : m_renderables)
+            {
+                renderables.erase(remove_if(renderables.begin(), renderables.end(), [&entities_leaving](const shared_ptr<Entity>& entity)
+                {
+                    return entities_leaving.count(entity.get()) != 0;
+                }), renderables.end());
+            }
+
+            if (m_camera && entities_leaving.count(m_camera->GetEntityPtr()) != 0)
+            {
+                m_camera = nullptr;
+            }
+        }
+
+        // Classify added and modified entities, an entity can be in both lists or no longer be part of the world
+        unordered_set<Entity*> entities_classified;
+        auto classify = [&entities_classified](const shared_ptr<Entity>& entity)
+        {
+            if (!entity->IsInWorld() || !entity->IsActiveRecursively())
+                return;
+
+            if (entities_classified.insert(entity.get()).second)
+            {
+                add_renderable(m_renderables, entity);
+            }
+        };
+
+        for (const shared_ptr<Entity>& entity : m_renderables_pending.added)
+        {
+            classify(entity);
+        }
+        for (const shared_ptr<Entity>& entity : m_renderables_pending.modified)
+        {
+            classify(entity);
+        }
+
+        // If the camera went away, fall back to any other
+        if (!m_camera && !m_renderables[Renderer_Entity::Camera].empty())
+        {
+            m_camera = m_renderables[Renderer_Entity::Camera].front()->GetComponent<Camera>();
+        }
+
+        m_renderables_pending.Clear();
+    }
+
+    void Renderer::BuildSnapshot(Renderer_Snapshot& snapshot)
+    {
+        SP_PROFILE_FUNCTION();
+
+        snapshot.Clear();
+        snapshot.delta_time    = static_cast<float>(Timer::GetDeltaTimeSmoothedSec());
+        snapshot.time          = static_cast<float>(Timer::GetTimeSec());
+        snapshot.is_fullscreen = Window::IsFullScreen();
+
+        // Camera
+        if (m_camera)
+        {
+            Renderer_SnapshotCamera& camera = snapshot.camera;
+            camera.camera        = m_camera;
+            camera.view          = m_camera->GetViewMatrix();
+            camera.projection    = m_camera->GetProjectionMatrix();
+            camera.position      = m_camera->GetTransform()->GetPosition();
+            camera.forward       = m_camera->GetTransform()->GetForward();
+            camera.near_plane    = m_camera->GetNearPlane();
+            camera.far_plane     = m_camera->GetFarPlane();
+            camera.aperture      = m_camera->GetAperture();
+            camera.shutter_speed = m_camera->GetShutterSpeed();
+            camera.iso           = m_camera->GetIso();
+            camera.clear_color   = m_camera->GetClearColor();
+            camera.frustum       = m_camera->GetFrustum();
+            snapshot.has_camera  = true;
+
+            snapshot.grid_transform = m_world_grid->ComputeWorldMatrix(m_camera->GetTransform());
+
+            if (shared_ptr<Entity> entity_selected = m_camera->GetSelectedEntity())
+            {
+                if (shared_ptr<Renderable> renderable = entity_selected->GetComponent<Renderable>())
+                {
+                    snapshot.selected.entity     = entity_selected;
+                    snapshot.selected.renderable = renderable;
+                    snapshot.selected.transform  = entity_selected->GetTransform()->GetMatrix();
+                    snapshot.selected.aabb       = renderable->GetAabb();
+                }
+            }
+        }
+
+        // Geometry, LODs are picked by how many pixels a world unit covers at a distance of one, from the camera
+        m_materials_snapshot++;
+        const float lod_pixels_per_unit = snapshot.has_camera ? m_resolution_render.y / (2.0f * tan(m_camera->GetFovVerticalRad() * 0.5f)) : 0.0f;
+        auto capture_geometry = [&snapshot, lod_pixels_per_unit](const vector<shared_ptr<Entity>>& entities, vector<Renderer_SnapshotRenderable>& renderables)
+        {
+            renderables.reserve(entities.size());
+
+            for (const shared_ptr<Entity>& entity : entities)
+            {
+                shared_ptr<Renderable> renderable = entity->GetComponent<Renderable>();
+                if (!renderable)
+                    continue;
+
+                Transform* transform = entity->GetTransform().get();
+
+                Renderer_SnapshotRenderable& snapshot_renderable = renderables.emplace_back();
+                snapshot_renderable.entity             = entity;
+                snapshot_renderable.renderable         = renderable;
+                snapshot_renderable.transform          = transform->GetMatrix();
+                snapshot_renderable.transform_previous = transform->GetMatrixPrevious();
+                snapshot_renderable.aabb               = renderable->GetAabb();
+                snapshot_renderable.material_index     = capture_material(renderable->GetMaterial());
+                snapshot_renderable.is_static          = transform->IsStatic();
+
+                if (snapshot.has_camera)
+                {
+                    renderable->UpdateLod(snapshot.camera.position, lod_pixels_per_unit);
+                }
+                snapshot_renderable.index_offset = renderable->GetLodIndexOffset();
+                snapshot_renderable.index_count  = renderable->GetLodIndexCount();
+
+                // Save matrix for velocity computation
+                transform->SetMatrixPrevious(snapshot_renderable.transform);
+            }
+        };
+        capture_geometry(m_renderables[Renderer_Entity::Geometry_opaque],      snapshot.geometry_opaque);
+        capture_geometry(m_renderables[Renderer_Entity::Geometry_transparent], snapshot.geometry_transparent);
+        snapshot.materials         = m_materials;
+        snapshot.materials_version = m_materials_version;
+
+        // Lights, the ones from the snapshot's last use are reused
+        uint32_t light_count = 0;
+        for (const shared_ptr<Entity>& entity : m_renderables[Renderer_Entity::Light])
+        {
+            shared_ptr<Light> light = entity->GetComponent<Light>();
+            if (!light)
+                continue;
+
+            if (light_count == snapshot.lights.size())
+            {
+                snapshot.lights.emplace_back();
+            }
+
+            Renderer_SnapshotLight& snapshot_light = snapshot.lights[light_count++];
+            snapshot_light.entity      = entity;
+            snapshot_light.light       = light;
+            snapshot_light.position    = light->GetTransform()->GetPosition();
+            snapshot_light.forward     = light->GetTransform()->GetForward();
+            snapshot_light.slice_count = Math::Helper::Min<uint32_t>(light->GetShadowArraySize(), 6);
+
+            Cb_Light& cb = snapshot_light.cb;
+            for (uint32_t i = 0; i < snapshot_light.slice_count; i++)
+            {
+                cb.view_projection[i]        = light->GetViewMatrix(i) * light->GetProjectionMatrix(i);
+                snapshot_light.frustums[i] = light->GetFrustum(i);
+            }
+
+            cb.intensity_range_angle_bias = Vector4
+            (
+                light->GetIntensityForShader(m_camera.get()),
+                light->GetRange(), light->GetAngle(),
+                light->GetBias()
+            );
+
+            cb.color       = light->GetColor();
+            cb.normal_bias = light->GetNormalBias();
+            cb.position    = snapshot_light.position;
+            cb.direction   = snapshot_light.forward;
+            cb.options     = 0;
+            cb.options     |= light->GetLightType() == LightType::Directional ? (1 << 0) : 0;
+            cb.options     |= light->GetLightType() == LightType::Point       ? (1 << 1) : 0;
+            cb.options     |= light->GetLightType() == LightType::Spot        ? (1 << 2) : 0;
+            cb.options     |= light->GetShadowsEnabled()                      ? (1 << 3) : 0;
+            cb.options     |= light->GetShadowsTransparentEnabled()           ? (1 << 4) : 0;
+            cb.options     |= light->GetShadowsScreenSpaceEnabled()           ? (1 << 5) : 0;
+            cb.options     |= light->GetVolumetricEnabled()                   ? (1 << 6) : 0;
+        }
+        snapshot.lights.resize(light_count);
+
+        // Shadows, lights take slices of the shadow maps, which grow to fit them. The directional lights always fit, the point and spot
+        // lights are given slices nearest first, within the ShadowSlicesLocal budget, and the ones which don't fit lose their shadows.
+        {
+            static vector<Renderer_SnapshotLight*> lights_local;
+            lights_local.clear();
+
+            for (Renderer_SnapshotLight& light : snapshot.lights)
+            {
+                if (!light.GetShadowsEnabled())
+                    continue;
+
+                if (light.GetIntensity() == 0.0f)
+                {
+                    light.cb.options  &= ~((1 << 3) | (1 << 4));
+                    light.slice_count  = 0;
+                }
+                else if (light.IsDirectional())
+                {
+                    light.cb.shadow_slice               = snapshot.shadow_slices_directional;
+                    snapshot.shadow_slices_directional += light.slice_count;
+                }
+                else
+                {
+                    lights_local.push_back(&light);
+                }
+            }
+
+            const Vector3 camera_position = snapshot.camera.position;
+            sort(lights_local.begin(), lights_local.end(), [&camera_position](const Renderer_SnapshotLight* a, const Renderer_SnapshotLight* b)
+            {
+                return Vector3::DistanceSquared(a->position, camera_position) < Vector3::DistanceSquared(b->position, camera_position);
+            });
+
+            const uint32_t budget_local = GetOption<uint32_t>(Renderer_Option::ShadowSlicesLocal);
+            for (Renderer_SnapshotLight* light : lights_local)
+            {
+                if (snapshot.shadow_slices_local + light->slice_count <= budget_local)
+                {
+                    light->cb.shadow_slice        = snapshot.shadow_slices_local;
+                    snapshot.shadow_slices_local += light->slice_count;
+                }
+                else
+                {
+                    light->cb.options  &= ~((1 << 3) | (1 << 4));
+                    light->slice_count  = 0;
+                    snapshot.shadow_lights_dropped++;
+                }
+            }
+
+            // Say so when lights start losing their shadows (or more of them do), rather than every frame
+            if (snapshot.shadow_lights_dropped > m_shadow_lights_dropped)
+            {
+                SP_LOG_WARNING("%u point/spot lights have no shadows, they don't fit in the shadow slice budget (%u), increase it or reduce the number of shadowed lights", snapshot.shadow_lights_dropped, budget_local);
+            }
+            m_shadow_lights_dropped = snapshot.shadow_lights_dropped;
+
+            // The faces of a point light are rendered in a single pass, so their view projections go into the view buffer
+            for (Renderer_SnapshotLight& light : snapshot.lights)
+            {
+                if (!light.IsCube())
+                    continue;
+
+                light.view_offset = static_cast<uint32_t>(snapshot.views.size());
+                snapshot.views.insert(snapshot.views.end(), light.cb.view_projection, light.cb.view_projection + 6);
+            }
+        }
+
+        // Reflection probes, the ones from the snapshot's last use are reused
+        uint32_t probe_count = 0;
+        for (const shared_ptr<Entity>& entity : m_renderables[Renderer_Entity::Reflection_probe])
+        {
+            shared_ptr<ReflectionProbe> probe = entity->GetComponent<ReflectionProbe>();
+            if (!probe)
+                continue;
+
+            if (probe_count == snapshot.reflection_probes.size())
+            {
+                snapshot.reflection_probes.emplace_back();
+            }
+
+            Renderer_SnapshotReflectionProbe& snapshot_probe = snapshot.reflection_probes[probe_count++];
+            snapshot_probe.entity                  = entity;
+            snapshot_probe.probe                   = probe;
+            snapshot_probe.transform               = probe->GetTransform()->GetMatrix();
+            snapshot_probe.position                = probe->GetTransform()->GetPosition();
+            snapshot_probe.extents                 = probe->GetExtents();
+            snapshot_probe.needs_to_update         = probe->GetNeedsToUpdate();
+            snapshot_probe.update_face_start_index = probe->GetUpdateFaceStartIndex();
+            snapshot_probe.update_face_count       = probe->GetUpdateFaceCount();
+
+            for (uint32_t i = 0; i < 6; i++)
+            {
+                snapshot_probe.view_projection[i] = probe->GetViewMatrix(i) * probe->GetProjectionMatrix();
+                snapshot_probe.frustums[i]        = probe->GetFrustum(i);
+            }
+
+            if (snapshot_probe.needs_to_update)
+            {
+                snapshot_probe.view_offset = static_cast<uint32_t>(snapshot.views.size());
+                snapshot.views.insert(snapshot.views.end(), snapshot_probe.view_projection.begin(), snapshot_probe.view_projection.end());
+            }
+        }
+        snapshot.reflection_probes.resize(probe_count);
+
+        // Visibility, every renderable is tested against every view in one pass
+        {
+            m_cull_boxes_opaque.Clear();
+            m_cull_boxes_transparent.Clear();
+            for (const Renderer_SnapshotRenderable& renderable : snapshot.geometry_opaque)
+            {
+                m_cull_boxes_opaque.Add(renderable.aabb);
+            }
+            for (const Renderer_SnapshotRenderable& renderable : snapshot.geometry_transparent)
+            {
+                m_cull_boxes_transparent.Add(renderable.aabb);
+            }
+
+            m_cull_views_opaque.clear();
+            m_cull_views_transparent.clear();
+            auto add_view = [](const Math::Frustum& frustum, const bool ignore_near_plane, Renderer_SnapshotVisibility& visible)
+            {
+                visible.opaque.resize(m_cull_boxes_opaque.GetWordCount());
+                visible.transparent.resize(m_cull_boxes_transparent.GetWordCount());
+                m_cull_views_opaque.push_back({ &frustum, ignore_near_plane, visible.opaque.data() });
+                m_cull_views_transparent.push_back({ &frustum, ignore_near_plane, visible.transparent.data() });
+            };
+
+            if (snapshot.has_camera)
+            {
+                add_view(snapshot.camera.frustum, false, snapshot.camera.visible);
+            }
+
+            // Potential shadow casters behind the near plane of a directional light are kept
+            for (Renderer_SnapshotLight& light : snapshot.lights)
+            {
+                for (uint32_t i = 0; i < light.slice_count; i++)
+                {
+                    add_view(light.frustums[i], light.IsDirectional(), light.visible[i]);
+                }
+            }
+
+            for (Renderer_SnapshotReflectionProbe& probe : snapshot.reflection_probes)
+            {
+                if (!probe.needs_to_update)
+                    continue;
 
-        // Subscribe to events
-        SP_SUBSCRIBE_TO_EVENT(EventType::WorldResolved,             SP_EVENT_HANDLER_VARIANT_STATIC(OnWorldResolved));
-        SP_SUBSCRIBE_TO_EVENT(EventType::WorldClear,                SP_EVENT_HANDLER_STATIC(OnClear));
-        SP_SUBSCRIBE_TO_EVENT(EventType::WindowFullscreenWindowedToggled, SP_EVENT_HANDLER_STATIC(OnFullScreenToggled));
+                for (uint32_t i = 0; i < 6; i++)
+                {
+                    add_view(probe.frustums[i], false, probe.visible[i]);
+                }
+            }
 
-        // Fire event
-        SP_FIRE_EVENT(EventType::RendererOnInitialized);
-    }
+            // Chunks of 64 boxes (one mask word) are culled in parallel
+            auto cull = [](const Math::FrustumCullBoxes& boxes, const vector<Math::FrustumCullView>& views)
+            {
+                if (views.empty())
+                    return;
 
-    void Renderer::Shutdown()
-    {
-        // console doesn't render anymore, log to file
-        Log::SetLogToFile(true); 
+                ThreadPool::ParallelFor([&boxes, &views](uint32_t work_index_start, uint32_t work_index_end)
+                {
+                    Math::Frustum::CullBoxes(boxes, views.data(), static_cast<uint32_t>(views.size()), work_index_start, work_index_end);
+                }, boxes.GetWordCount());
+            };
+            cull(m_cull_boxes_opaque,      m_cull_views_opaque);
+            cull(m_cull_boxes_transparent, m_cull_views_transparent);
+        }
 
-        // Fire event
-        SP_FIRE_EVENT(EventType::RendererOnShutdown);
+        // Occlusion, only the camera's masks are touched, something hidden from the camera can still cast a shadow into view
+        if (snapshot.has_camera && GetOption<bool>(Renderer_Option::OcclusionCulling))
+        {
+            snapshot.camera.occluded_count = occlusion_cull(snapshot);
+        }
 
-        // Manually invoke the deconstructors so that ParseDeletionQueue(), releases their RHI resources.
+        // Draw lists, rebuilt every frame so that the depth order follows the views as they move
         {
-            DestroyResources();
+            m_draw_list_jobs.clear();
+            auto add_jobs = [&snapshot](Renderer_SnapshotVisibility& visible, const Math::Vector3& origin, const Math::Vector3& forward, const bool is_directional, const bool shadow_casters_only, const bool has_transparent, const bool is_instanced, array<Renderer_SnapshotVisibility, 6>* faces = nullptr)
+            {
+                DrawListJob job;
+                job.faces               = faces;
+                job.origin              = origin;
+                job.forward             = forward;
+                job.is_directional      = is_directional;
+                job.shadow_casters_only = shadow_casters_only;
+                job.is_instanced        = is_instanced;
+
+                job.visible     = &visible.opaque;
+                job.renderables = &snapshot.geometry_opaque;
+                job.draws       = &visible.draws_opaque;
+                job.instances   = &visible.instances_opaque;
+                if (shadow_casters_only && !is_directional)
+                {
+                    job.static_casters = &visible.static_casters;
+                }
+                m_draw_list_jobs.push_back(job);
 
-            m_renderables_pending.clear();
-            m_renderables.clear();
-            m_textures_mip_generation.clear();
-            m_world_grid.reset();
-            m_font.reset();
-            m_swap_chain          = nullptr;
-            m_vertex_buffer_lines = nullptr;
-            m_environment_texture = nullptr;
-        }
+                if (has_transparent)
+                {
+                    job.visible        = &visible.transparent;
+                    job.renderables    = &snapshot.geometry_transparent;
+                    job.draws          = &visible.draws_transparent;
+                    job.instances      = &visible.instances_transparent;
+                    job.is_transparent = true;
+                    job.static_casters = nullptr;
+                    m_draw_list_jobs.push_back(job);
+                }
+            };
 
-        // Delete all remaining RHI resources
-        RHI_Device::ParseDeletionQueue();
+            if (snapshot.has_camera)
+            {
+                add_jobs(snapshot.camera.visible, snapshot.camera.position, snapshot.camera.forward, false, false, true, true);
 
-        RHI_RenderDoc::Shutdown();
-        RHI_FSR2::Destroy();
-        RHI_Device::Destroy();
-    }
+                // The camera's opaques are the first job, large meshes are culled per cluster
+                if (GetOption<bool>(Renderer_Option::ClusterCulling))
+                {
+                    m_draw_list_jobs[0].cluster_frustum = &snapshot.camera.frustum;
+                    m_draw_list_jobs[0].clusters        = &snapshot.camera.visible.clusters;
+                }
+            }
 
-    void Renderer::Tick()
-    {
-        // Don't bother producing frames if the window is minimized
-        if (Window::IsMinimised())
-            return;
+            // Point lights get a single list for all the faces of the cube
+            for (Renderer_SnapshotLight& light : snapshot.lights)
+            {
+                if (light.IsCube())
+                {
+                    add_jobs(light.visible_cube, light.position, light.forward, false, true, true, true, &light.visible);
+                    continue;
+                }
 
-        // After the first frame has completed, we know the renderer is working.
-        // We stop logging to a file and we start logging to the on-screen console.
-        if (m_frame_num == 1)
+                for (uint32_t i = 0; i < light.slice_count; i++)
+                {
+                    add_jobs(light.visible[i], light.position, light.forward, light.IsDirectional(), true, true, true);
+                }
+            }
+
+            // Probes only render opaques, and their shader takes the transform from the pass buffer
+            for (Renderer_SnapshotReflectionProbe& probe : snapshot.reflection_probes)
+            {
+                if (!probe.needs_to_update)
+                    continue;
+
+                add_jobs(probe.visible_cube, probe.position, Math::Vector3::Forward, false, false, false, false, &probe.visible);
+            }
+
+            ThreadPool::ParallelFor([](uint32_t work_index_start, uint32_t work_index_end)
+            {
+                for (uint32_t i = work_index_start; i < work_index_end; i++)
+                {
+                    build_draw_list(m_draw_list_jobs[i]);
+                }
+            }, static_cast<uint32_t>(m_draw_list_jobs.size()));
+        }
+
+        // Instancing, the transforms are written once and every instanced draw list appends its instances
         {
-            Log::SetLogToFile(false);
-            SP_FIRE_EVENT(EventType::RendererOnFirstFrameCompleted);
+            snapshot.instance_transforms.clear();
+            for (const vector<Renderer_SnapshotRenderable>* renderables : { &snapshot.geometry_opaque, &snapshot.geometry_transparent })
+            {
+                for (const Renderer_SnapshotRenderable& entity : *renderables)
+                {
+                    snapshot.instance_transforms.push_back({ entity.transform, entity.transform_previous });
+                }
+            }
+
+            const uint32_t transparent_start = static_cast<uint32_t>(snapshot.geometry_opaque.size());
+            snapshot.instance_indices.clear();
+            for (const DrawListJob& job : m_draw_list_jobs)
+            {
+                if (!job.is_instanced)
+                    continue;
+
+                const uint32_t offset = static_cast<uint32_t>(snapshot.instance_indices.size());
+                for (const uint32_t renderable_index : *job.instances)
+                {
+                    snapshot.instance_indices.emplace_back(job.is_transparent ? transparent_start + renderable_index : renderable_index);
+                }
+
+                for (Renderer_DrawRecord& draw : *job.draws)
+                {
+                    draw.instance_offset += offset;
+                }
+            }
+
+            // Indirect drawing replaces the camera's opaque draws, the transforms above are shared
+            snapshot.indirect_draws.clear();
+            snapshot.indirect_batches.clear();
+            if (snapshot.has_camera && GetOption<bool>(Renderer_Option::IndirectDrawing) && RHI_Device::IsDrawIndirectCountSupported())
+            {
+                build_indirect_draws(snapshot);
+            }
         }
 
+        // Debug lines, the copy reuses the snapshot's memory once the line buffer stops growing
+        Lines_PreMain();
+        snapshot.lines_index_depth_off = m_lines_index_depth_off;
+        snapshot.lines_index_depth_on  = m_lines_index_depth_on;
+        snapshot.line_vertices         = m_line_vertices;
+        Lines_PostMain();
+    }
+
+    void Renderer::Render(const Renderer_Snapshot& snapshot)
+    {
+        lock_guard<recursive_mutex> lock(m_mutex_frame);
+
         // Happens when core resources are created/destroyed
         if (m_flush_requested)
         {
@@ -293,6 +1443,10 @@ namespace Spartan
         if (!m_is_rendering_allowed)
             return;
 
+        m_snapshot = &snapshot;
+        Profiler::m_renderer_meshes_occluded = snapshot.camera.occluded_count;
+        Profiler::m_renderer_shadows_dropped = snapshot.shadow_lights_dropped;
+
         RHI_Device::Tick(m_frame_num);
 
         // Tick command pool
@@ -309,27 +1463,53 @@ namespace Spartan
             {
                 constant_buffer->ResetOffset();
             }
-            GetStructuredBuffer()->ResetOffset();
+            for (uint32_t slot = 0; slot < renderer_max_secondary_cmd_lists; slot++)
+            {
+                for (shared_ptr<RHI_ConstantBuffer>& constant_buffer : GetConstantBuffersSecondary(slot))
+                {
+                    if (constant_buffer)
+                    {
+                        constant_buffer->ResetOffset();
+                    }
+                }
+            }
+            GetStructuredBuffer(Renderer_StructuredBuffer::SpdCounter)->ResetOffset();
+            GetStructuredBuffer(Renderer_StructuredBuffer::Instances)->ResetOffset();
+            GetStructuredBuffer(Renderer_StructuredBuffer::InstanceIndices)->ResetOffset();
+            GetStructuredBuffer(Renderer_StructuredBuffer::IndirectDraws)->ResetOffset();
+            GetStructuredBuffer(Renderer_StructuredBuffer::IndirectCounts)->ResetOffset();
+            GetStructuredBuffer(Renderer_StructuredBuffer::Lights)->ResetOffset();
+            GetStructuredBuffer(Renderer_StructuredBuffer::Views)->ResetOffset();
 
             // Perform operations which might modify, create or destroy resources
             OnResourceSafe(m_cmd_current);
         }
 
+        // Update instance, indirect, material, light and view buffers
+        UpdateInstanceBuffers(snapshot);
+        UpdateIndirectBuffers(snapshot, m_cmd_pool->GetCommandListIndex());
+        UpdateMaterialBuffer(snapshot);
+        UpdateLightBuffer(snapshot);
+        UpdateViewBuffer(snapshot);
+        UpdateShadowMaps(snapshot);
+
         // Update frame buffer
         {
+            const Renderer_SnapshotCamera& camera = snapshot.camera;
+
             // Matrices
             {
-                if (m_camera)
+                if (snapshot.has_camera)
                 {
-                    if (m_near_plane != m_camera->GetNearPlane() || m_far_plane != m_camera->GetFarPlane())
+                    if (m_near_plane != camera.near_plane || m_far_plane != camera.far_plane)
                     {
-                        m_near_plane                    = m_camera->GetNearPlane();
-                        m_far_plane                     = m_camera->GetFarPlane();
+                        m_near_plane                    = camera.near_plane;
+                        m_far_plane                     = camera.far_plane;
                         m_dirty_orthographic_projection = true;
                     }
 
-                    m_cb_frame_cpu.view                = m_camera->GetViewMatrix();
-                    m_cb_frame_cpu.projection          = m_camera->GetProjectionMatrix();
+                    m_cb_frame_cpu.view                = camera.view;
+                    m_cb_frame_cpu.projection          = camera.projection;
                     m_cb_frame_cpu.projection_inverted = Matrix::Invert(m_cb_frame_cpu.projection);
                 }
 
@@ -360,35 +1540,36 @@ namespace Spartan
             m_cb_frame_cpu.view_projection_previous = m_cb_frame_cpu.view_projection;
             m_cb_frame_cpu.view_projection          = m_cb_frame_cpu.view * m_cb_frame_cpu.projection;
             m_cb_frame_cpu.view_projection_inv      = Matrix::Invert(m_cb_frame_cpu.view_projection);
-            if (m_camera)
-            {
-                m_cb_frame_cpu.view_projection_unjittered = m_cb_frame_cpu.view * m_camera->GetProjectionMatrix();
-                m_cb_frame_cpu.camera_aperture            = m_camera->GetAperture();
-                m_cb_frame_cpu.camera_shutter_speed       = m_camera->GetShutterSpeed();
-                m_cb_frame_cpu.camera_iso                 = m_camera->GetIso();
-                m_cb_frame_cpu.camera_near                = m_camera->GetNearPlane();
-                m_cb_frame_cpu.camera_far                 = m_camera->GetFarPlane();
-                m_cb_frame_cpu.camera_position            = m_camera->GetTransform()->GetPosition();
-                m_cb_frame_cpu.camera_direction           = m_camera->GetTransform()->GetForward();
-            }
-            m_cb_frame_cpu.resolution_output      = m_resolution_output;
-            m_cb_frame_cpu.resolution_render      = m_resolution_render;
-            m_cb_frame_cpu.taa_jitter_previous    = m_cb_frame_cpu.taa_jitter_current;
-            m_cb_frame_cpu.taa_jitter_current     = m_jitter_offset;
-            m_cb_frame_cpu.delta_time             = static_cast<float>(Timer::GetDeltaTimeSmoothedSec());
-            m_cb_frame_cpu.time                   = static_cast<float>(Timer::GetTimeSec());
-            m_cb_frame_cpu.bloom_intensity        = GetOption<float>(Renderer_Option::Bloom);
-            m_cb_frame_cpu.sharpness              = GetOption<float>(Renderer_Option::Sharpness);
-            m_cb_frame_cpu.fog                    = GetOption<float>(Renderer_Option::Fog);
-            m_cb_frame_cpu.tonemapping            = GetOption<float>(Renderer_Option::Tonemapping);
-            m_cb_frame_cpu.gamma                  = GetOption<float>(Renderer_Option::Gamma);
-            m_cb_frame_cpu.exposure               = GetOption<float>(Renderer_Option::Exposure);
-            m_cb_frame_cpu.luminance_max          = Display::GetLuminanceMax();
-            m_cb_frame_cpu.shadow_resolution      = GetOption<float>(Renderer_Option::ShadowResolution);
-            m_cb_frame_cpu.frame                  = static_cast<uint32_t>(m_frame_num);
-            m_cb_frame_cpu.frame_mip_count        = GetRenderTarget(Renderer_RenderTexture::frame_render)->GetMipCount();
-            m_cb_frame_cpu.ssr_mip_count          = GetRenderTarget(Renderer_RenderTexture::ssr)->GetMipCount();
-            m_cb_frame_cpu.resolution_environment = Vector2(GetEnvironmentTexture()->GetWidth(), GetEnvironmentTexture()->GetHeight());
+            if (snapshot.has_camera)
+            {
+                m_cb_frame_cpu.view_projection_unjittered = m_cb_frame_cpu.view * camera.projection;
+                m_cb_frame_cpu.camera_aperture            = camera.aperture;
+                m_cb_frame_cpu.camera_shutter_speed       = camera.shutter_speed;
+                m_cb_frame_cpu.camera_iso                 = camera.iso;
+                m_cb_frame_cpu.camera_near                = camera.near_plane;
+                m_cb_frame_cpu.camera_far                 = camera.far_plane;
+                m_cb_frame_cpu.camera_position            = camera.position;
+                m_cb_frame_cpu.camera_direction           = camera.forward;
+            }
+            m_cb_frame_cpu.resolution_output       = m_resolution_output;
+            m_cb_frame_cpu.resolution_render       = m_resolution_render;
+            m_cb_frame_cpu.taa_jitter_previous     = m_cb_frame_cpu.taa_jitter_current;
+            m_cb_frame_cpu.taa_jitter_current      = m_jitter_offset;
+            m_cb_frame_cpu.delta_time              = snapshot.delta_time;
+            m_cb_frame_cpu.time                    = snapshot.time;
+            m_cb_frame_cpu.bloom_intensity         = GetOption<float>(Renderer_Option::Bloom);
+            m_cb_frame_cpu.sharpness               = GetOption<float>(Renderer_Option::Sharpness);
+            m_cb_frame_cpu.fog                     = GetOption<float>(Renderer_Option::Fog);
+            m_cb_frame_cpu.tonemapping             = GetOption<float>(Renderer_Option::Tonemapping);
+            m_cb_frame_cpu.gamma                   = GetOption<float>(Renderer_Option::Gamma);
+            m_cb_frame_cpu.exposure                = GetOption<float>(Renderer_Option::Exposure);
+            m_cb_frame_cpu.luminance_max           = Display::GetLuminanceMax();
+            m_cb_frame_cpu.shadow_resolution       = GetOption<float>(Renderer_Option::ShadowResolution);
+            m_cb_frame_cpu.shadow_resolution_local = GetOption<float>(Renderer_Option::ShadowResolutionLocal);
+            m_cb_frame_cpu.frame                   = static_cast<uint32_t>(m_frame_num);
+            m_cb_frame_cpu.frame_mip_count         = GetRenderTarget(Renderer_RenderTexture::frame_render)->GetMipCount();
+            m_cb_frame_cpu.ssr_mip_count           = GetRenderTarget(Renderer_RenderTexture::ssr)->GetMipCount();
+            m_cb_frame_cpu.resolution_environment  = Vector2(GetEnvironmentTexture()->GetWidth(), GetEnvironmentTexture()->GetHeight());
 
             // These must match what Common_Buffer.hlsl is reading
             m_cb_frame_cpu.set_bit(GetOption<bool>(Renderer_Option::ScreenSpaceReflections), 1 << 0);
@@ -397,11 +1578,9 @@ namespace Spartan
             m_cb_frame_cpu.set_bit(GetOption<bool>(Renderer_Option::ScreenSpaceShadows),     1 << 3);
         }
 
-        Lines_PreMain();
         Pass_Main(m_cmd_current);
-        Lines_PostMain();
 
-        if (Window::IsFullScreen())
+        if (snapshot.is_fullscreen)
         {
             m_cmd_current->BeginMarker("copy_to_back_buffer");
             m_cmd_current->Blit(GetRenderTarget(Renderer_RenderTexture::frame_output).get(), m_swap_chain.get(), RHI_Filter::Nearest);
@@ -412,12 +1591,91 @@ namespace Spartan
         // Submit
         m_cmd_current->End();
         m_cmd_current->Submit();
+        m_swap_chain_has_frame = snapshot.is_fullscreen;
+
+        m_snapshot = nullptr;
 
         // Update frame tracking
         m_frame_num++;
         m_is_odd_frame = (m_frame_num % 2) == 1;
     }
-    
+
+    void Renderer::StartRenderThread()
+    {
+        SP_ASSERT(!m_render_thread_running);
+
+        m_frames_in_flight     = Helper::Min(m_frames_in_flight, m_frames_in_flight_max);
+        m_render_thread_running = true;
+        m_render_thread         = thread(&Renderer::RenderThreadLoop);
+
+        SP_LOG_INFO("Render thread started, %d frame(s) in flight", m_frames_in_flight);
+    }
+
+    void Renderer::StopRenderThread()
+    {
+        if (!m_render_thread_running)
+            return;
+
+        // The render thread finishes any queued frames before exiting
+        {
+            lock_guard<mutex> lock(m_mutex_snapshots);
+            m_render_thread_running = false;
+        }
+        m_condition_snapshots.notify_all();
+        m_render_thread.join();
+
+        m_render_thread_id   = this_thread::get_id();
+        m_snapshots_produced = 0;
+        m_snapshots_consumed = 0;
+        m_snapshots_dropped  = 0;
+    }
+
+    void Renderer::RenderThreadLoop()
+    {
+        m_render_thread_id = this_thread::get_id();
+
+        while (true)
+        {
+            const Renderer_Snapshot* snapshot = nullptr;
+            bool dropped                      = false;
+            {
+                unique_lock<mutex> lock(m_mutex_snapshots);
+                m_condition_snapshots.wait(lock, []() { return m_snapshots_consumed < m_snapshots_produced || m_flush_requested || !m_render_thread_running; });
+
+                if (m_snapshots_consumed < m_snapshots_produced)
+                {
+                    snapshot = &m_snapshots[m_snapshots_consumed % m_snapshots.size()];
+                    dropped  = m_snapshots_consumed < m_snapshots_dropped;
+                }
+                else if (!m_render_thread_running)
+                {
+                    break;
+                }
+            }
+
+            // Other threads can be waiting for a flush while there is nothing to render
+            if (!snapshot)
+            {
+                lock_guard<recursive_mutex> lock(m_mutex_frame);
+                Flush();
+                continue;
+            }
+
+            // Snapshots of a cleared world reference meshes and materials which are freed
+            if (!dropped)
+            {
+                Render(*snapshot);
+            }
+
+            // Hand the snapshot back to the simulation
+            {
+                lock_guard<mutex> lock(m_mutex_snapshots);
+                m_snapshots_consumed++;
+            }
+            m_condition_snapshots.notify_all();
+        }
+    }
+
     const RHI_Viewport& Renderer::GetViewport()
     {
         return m_viewport;
@@ -460,6 +1718,8 @@ namespace Spartan
 
         if (recreate_resources)
         {
+            lock_guard<recursive_mutex> lock(m_mutex_frame);
+
             // Re-create render textures
             CreateRenderTextures(true, false, false, true);
 
@@ -498,6 +1758,8 @@ namespace Spartan
 
         if (recreate_resources)
         {
+            lock_guard<recursive_mutex> lock(m_mutex_frame);
+
             // Re-create render textures
             CreateRenderTextures(false, true, false, true);
 
@@ -519,113 +1781,126 @@ namespace Spartan
 
     void Renderer::UpdateConstantBufferPass(RHI_CommandList* cmd_list)
     {
-        GetConstantBuffer(Renderer_ConstantBuffer::Pass)->Update(&m_cb_pass_cpu);
+        UpdateConstantBufferPass(cmd_list, m_cb_pass_cpu);
+    }
+
+    void Renderer::UpdateConstantBufferPass(RHI_CommandList* cmd_list, Cb_Pass& cb_pass)
+    {
+        RHI_ConstantBuffer* constant_buffer = GetConstantBuffer(Renderer_ConstantBuffer::Pass, cmd_list);
+        constant_buffer->Update(&cb_pass);
 
         // Bind because the offset just changed
-        cmd_list->SetConstantBuffer(Renderer_BindingsCb::uber, RHI_Shader_Vertex | RHI_Shader_Pixel | RHI_Shader_Compute, GetConstantBuffer(Renderer_ConstantBuffer::Pass));
+        cmd_list->SetConstantBuffer(static_cast<uint32_t>(Renderer_BindingsCb::uber), RHI_Shader_Vertex | RHI_Shader_Pixel | RHI_Shader_Compute, constant_buffer);
     }
 
-    void Renderer::UpdateConstantBufferLight(RHI_CommandList* cmd_list, shared_ptr<Light> light, const RHI_Shader_Type scope)
+    void Renderer::RecordRenderPass(RHI_CommandList* cmd_list, const RHI_PipelineState& pso, const uint32_t draw_count,
+        const function<void(RHI_CommandList* cmd_list, Cb_Pass& cb_pass, uint32_t draw_start, uint32_t draw_end)>& record)
     {
-        for (uint32_t i = 0; i < light->GetShadowArraySize(); i++)
+        uint32_t chunk_count = 1;
+        if (GetOption<bool>(Renderer_Option::ParallelRecording))
         {
-            m_cb_light_cpu.view_projection[i] = light->GetViewMatrix(i) * light->GetProjectionMatrix(i);
+            chunk_count = Math::Helper::Min(draw_count / m_secondary_draws_min, m_cmd_pool->GetSecondarySlotCount());
         }
 
-        m_cb_light_cpu.intensity_range_angle_bias = Vector4
-        (
-            light->GetIntensityForShader(m_camera.get()),
-            light->GetRange(), light->GetAngle(),
-            light->GetBias()
-        );
+        // Not enough draws (or no secondary command list support), record on this thread
+        if (chunk_count <= 1)
+        {
+            cmd_list->BeginRenderPass();
+            record(cmd_list, m_cb_pass_cpu, 0, draw_count);
+            cmd_list->EndRenderPass();
+            return;
+        }
+
+        // A chunk is recorded by a single thread, into a list from the slot of the same index, so the slots need no locking
+        array<RHI_CommandList*, renderer_max_secondary_cmd_lists> cmd_lists_secondary;
+        ThreadPool::ParallelFor([&](uint32_t chunk_start, uint32_t chunk_end)
+        {
+            for (uint32_t chunk = chunk_start; chunk < chunk_end; chunk++)
+            {
+                RHI_CommandList* cmd_list_secondary = m_cmd_pool->GetSecondaryCommandList(chunk);
+                cmd_list_secondary->BeginSecondary(pso);
 
-        m_cb_light_cpu.color       = light->GetColor();
-        m_cb_light_cpu.normal_bias = light->GetNormalBias();
-        m_cb_light_cpu.position    = light->GetTransform()->GetPosition();
-        m_cb_light_cpu.direction   = light->GetTransform()->GetForward();
-        m_cb_light_cpu.options     = 0;
-        m_cb_light_cpu.options     |= light->GetLightType() == LightType::Directional ? (1 << 0) : 0;
-        m_cb_light_cpu.options     |= light->GetLightType() == LightType::Point       ? (1 << 1) : 0;
-        m_cb_light_cpu.options     |= light->GetLightType() == LightType::Spot        ? (1 << 2) : 0;
-        m_cb_light_cpu.options     |= light->GetShadowsEnabled()                      ? (1 << 3) : 0;
-        m_cb_light_cpu.options     |= light->GetShadowsTransparentEnabled()           ? (1 << 4) : 0;
-        m_cb_light_cpu.options     |= light->GetShadowsScreenSpaceEnabled()           ? (1 << 5) : 0;
-        m_cb_light_cpu.options     |= light->GetVolumetricEnabled()                   ? (1 << 6) : 0;
-
-        GetConstantBuffer(Renderer_ConstantBuffer::Light)->Update(&m_cb_light_cpu);
+                // Start from whatever the pass has set so far
+                Cb_Pass cb_pass = m_cb_pass_cpu;
 
-        // Bind because the offset just changed
-        cmd_list->SetConstantBuffer(Renderer_BindingsCb::light, scope, GetConstantBuffer(Renderer_ConstantBuffer::Light));
-    }
-
-    void Renderer::UpdateConstantBufferMaterial(RHI_CommandList* cmd_list, Material* material)
-    {
-        // Set
-        m_cb_material_cpu.color.x              = material->GetProperty(MaterialProperty::ColorR);
-        m_cb_material_cpu.color.y              = material->GetProperty(MaterialProperty::ColorG);
-        m_cb_material_cpu.color.z              = material->GetProperty(MaterialProperty::ColorB);
-        m_cb_material_cpu.color.w              = material->GetProperty(MaterialProperty::ColorA);
-        m_cb_material_cpu.tiling_uv.x          = material->GetProperty(MaterialProperty::UvTilingX);
-        m_cb_material_cpu.tiling_uv.y          = material->GetProperty(MaterialProperty::UvTilingY);
-        m_cb_material_cpu.offset_uv.x          = material->GetProperty(MaterialProperty::UvOffsetX);
-        m_cb_material_cpu.offset_uv.y          = material->GetProperty(MaterialProperty::UvOffsetY);
-        m_cb_material_cpu.roughness_mul        = material->GetProperty(MaterialProperty::RoughnessMultiplier);
-        m_cb_material_cpu.metallic_mul         = material->GetProperty(MaterialProperty::MetalnessMultiplier);
-        m_cb_material_cpu.normal_mul           = material->GetProperty(MaterialProperty::NormalMultiplier);
-        m_cb_material_cpu.height_mul           = material->GetProperty(MaterialProperty::HeightMultiplier);
-        m_cb_material_cpu.anisotropic          = material->GetProperty(MaterialProperty::Anisotropic);
-        m_cb_material_cpu.anisitropic_rotation = material->GetProperty(MaterialProperty::AnisotropicRotation);
-        m_cb_material_cpu.clearcoat            = material->GetProperty(MaterialProperty::Clearcoat);
-        m_cb_material_cpu.clearcoat_roughness  = material->GetProperty(MaterialProperty::Clearcoat_Roughness);
-        m_cb_material_cpu.sheen                = material->GetProperty(MaterialProperty::Sheen);
-        m_cb_material_cpu.sheen_tint           = material->GetProperty(MaterialProperty::SheenTint);
-        m_cb_material_cpu.properties           = 0;
-        m_cb_material_cpu.properties          |= material->GetProperty(MaterialProperty::SingleTextureRoughnessMetalness) ? (1U << 0) : 0;
-        m_cb_material_cpu.properties          |= material->HasTexture(MaterialTexture::Height)                            ? (1U << 1) : 0;
-        m_cb_material_cpu.properties          |= material->HasTexture(MaterialTexture::Normal)                            ? (1U << 2) : 0;
-        m_cb_material_cpu.properties          |= material->HasTexture(MaterialTexture::Color)                             ? (1U << 3) : 0;
-        m_cb_material_cpu.properties          |= material->HasTexture(MaterialTexture::Roughness)                         ? (1U << 4) : 0;
-        m_cb_material_cpu.properties          |= material->HasTexture(MaterialTexture::Metalness)                        ? (1U << 5) : 0;
-        m_cb_material_cpu.properties          |= material->HasTexture(MaterialTexture::AlphaMask)                         ? (1U << 6) : 0;
-        m_cb_material_cpu.properties          |= material->HasTexture(MaterialTexture::Emission)                          ? (1U << 7) : 0;
-        m_cb_material_cpu.properties          |= material->HasTexture(MaterialTexture::Occlusion)                         ? (1U << 8) : 0;
-
-        // Update
-        GetConstantBuffer(Renderer_ConstantBuffer::Material)->Update(&m_cb_material_cpu);
+                const uint32_t draw_start = static_cast<uint32_t>(static_cast<uint64_t>(draw_count) * chunk / chunk_count);
+                const uint32_t draw_end   = static_cast<uint32_t>(static_cast<uint64_t>(draw_count) * (chunk + 1) / chunk_count);
+                record(cmd_list_secondary, cb_pass, draw_start, draw_end);
+
+                cmd_list_secondary->End();
+                cmd_lists_secondary[chunk] = cmd_list_secondary;
+            }
+        }, chunk_count);
+
+        // Execute in chunk order, so the draws keep the order of the sorted draw list
+        cmd_list->BeginRenderPass(true);
+        cmd_list->ExecuteCommands(cmd_lists_secondary.data(), chunk_count);
+        cmd_list->EndRenderPass();
+    }
+
+    void Renderer::UpdateConstantBufferLight(RHI_CommandList* cmd_list, const Renderer_SnapshotLight& light, const RHI_Shader_Type scope)
+    {
+        // The buffer was already filled in when the snapshot was built
+        Cb_Light cb_light = light.cb;
+
+        RHI_ConstantBuffer* constant_buffer = GetConstantBuffer(Renderer_ConstantBuffer::Light, cmd_list);
+        constant_buffer->Update(&cb_light);
 
         // Bind because the offset just changed
-        cmd_list->SetConstantBuffer(Renderer_BindingsCb::material, RHI_Shader_Pixel | RHI_Shader_Compute, GetConstantBuffer(Renderer_ConstantBuffer::Material));
+        cmd_list->SetConstantBuffer(static_cast<uint32_t>(Renderer_BindingsCb::light), scope, constant_buffer);
     }
 
-    void Renderer::OnWorldResolved(sp_variant data)
+    void Renderer::OnWorldResolved(const sp_variant& data)
     {
         // note: m_renderables is a vector of shared pointers.
         // this ensures that if any entities are deallocated by the world.
-        // we'll still have some valid pointers until the are overridden by m_renderables_world.
+        // we'll still have some valid pointers until the changes are applied in AcquireRenderables().
 
         lock_guard lock(m_mutex_entity_addition);
 
-        m_renderables_pending.clear();
+        const WorldChangeLog* changes = static_cast<const WorldChangeLog*>(get<void*>(data));
+        SP_ASSERT_MSG(changes != nullptr, "Change log is null");
 
-        vector<shared_ptr<Entity>> entities = get<vector<shared_ptr<Entity>>>(data);
-        for (shared_ptr<Entity> entity : entities)
+        // A full resolve supersedes anything which is still pending
+        if (changes->full)
         {
-            SP_ASSERT_MSG(entity != nullptr, "Entity is null");
-
-            if (entity->IsActiveRecursively())
-            {
-                m_renderables_pending.emplace_back(entity);
-            }
+            m_renderables_pending.Clear();
+            m_renderables_pending.full = true;
         }
 
-        m_add_new_entities = true;
+        // Only the deltas are copied, they get applied on the next tick
+        m_renderables_pending.added.insert(m_renderables_pending.added.end(), changes->added.begin(), changes->added.end());
+        m_renderables_pending.modified.insert(m_renderables_pending.modified.end(), changes->modified.begin(), changes->modified.end());
+        m_renderables_pending.removed.insert(m_renderables_pending.removed.end(), changes->removed.begin(), changes->removed.end());
     }
 
     void Renderer::OnClear()
     {
+        {
+            lock_guard lock(m_mutex_entity_addition);
+            m_renderables_pending.Clear();
+            m_renderables.clear();
+            m_camera = nullptr;
+
+            // The materials of the world are gone, the indices start over and the table gets uploaded again
+            m_material_indices.clear();
+            m_materials.clear();
+            m_materials_refreshed.clear();
+            m_materials_version++;
+        }
+
+        // Drop the snapshots which were built from the world, including one that's being built, and wait
+        // for the render thread to hand them back, as well as the one it's rendering. World::Clear() frees
+        // the resources once this returns, and the snapshots only hold raw pointers to meshes and materials.
+        if (m_render_thread_running)
+        {
+            unique_lock<mutex> lock(m_mutex_snapshots);
+            m_snapshots_dropped = m_snapshots_produced + (m_snapshot_building ? 1 : 0);
+            m_condition_snapshots.wait(lock, []() { return m_snapshots_consumed >= m_snapshots_dropped; });
+        }
+
         // Flush to remove references to entity resources that will be deallocated
         Flush();
-        m_renderables.clear();
     }
 
     void Renderer::OnFullScreenToggled()
@@ -659,57 +1934,6 @@ namespace Spartan
 
     void Renderer::OnResourceSafe(RHI_CommandList* cmd_list)
     {
-        // Acquire renderables
-        if (m_add_new_entities)
-        {
-            // Clear previous state
-            m_renderables.clear();
-            m_camera = nullptr;
-
-            for (shared_ptr<Entity> entity : m_renderables_pending)
-            {
-                if (shared_ptr<Renderable> renderable = entity->GetComponent<Renderable>())
-                {
-                    bool is_transparent = false;
-                    bool is_visible     = true;
-
-                    if (const Material* material = renderable->GetMaterial())
-                    {
-                        is_transparent = material->GetProperty(MaterialProperty::ColorA) < 1.0f;
-                        is_visible     = material->GetProperty(MaterialProperty::ColorA) != 0.0f;
-                    }
-
-                    if (is_visible)
-                    {
-                        m_renderables[is_transparent ? Renderer_Entity::Geometry_transparent : Renderer_Entity::Geometry_opaque].emplace_back(entity);
-                    }
-                }
-
-                if (shared_ptr<Light> light = entity->GetComponent<Light>())
-                {
-                    m_renderables[Renderer_Entity::Light].emplace_back(entity);
-                }
-
-                if (shared_ptr<Camera> camera = entity->GetComponent<Camera>())
-                {
-                    m_renderables[Renderer_Entity::Camera].emplace_back(entity);
-                    m_camera = camera;
-                }
-
-                if (shared_ptr<ReflectionProbe> reflection_probe = entity->GetComponent<ReflectionProbe>())
-                {
-                    m_renderables[Renderer_Entity::Reflection_probe].emplace_back(entity);
-                }
-            }
-
-            // Sort them by distance
-            sort_renderables(&m_renderables[Renderer_Entity::Geometry_opaque], false);
-            sort_renderables(&m_renderables[Renderer_Entity::Geometry_transparent], true);
-
-            m_renderables_pending.clear();
-            m_add_new_entities = false;
-        }
-
         // Handle environment texture assignment requests
         if (m_environment_texture_dirty)
         {
@@ -762,6 +1986,16 @@ namespace Spartan
         return m_render_thread_id != this_thread::get_id();
     }
 
+    bool Renderer::IsRenderThreadActive()
+    {
+        return m_render_thread_running;
+    }
+
+    recursive_mutex& Renderer::GetFrameMutex()
+    {
+        return m_mutex_frame;
+    }
+
     const shared_ptr<RHI_Texture> Renderer::GetEnvironmentTexture()
     {
         return m_environment_texture ? m_environment_texture : GetStandardTexture(Renderer_StandardTexture::Black);
@@ -785,10 +2019,25 @@ namespace Spartan
                 value = Helper::Clamp(value, 0.0f, 16.0f);
             }
             // Shadow resolution
-            else if (option == Renderer_Option::ShadowResolution)
+            else if (option == Renderer_Option::ShadowResolution || option == Renderer_Option::ShadowResolutionLocal)
             {
                 value = Helper::Clamp(value, static_cast<float>(m_resolution_shadow_min), static_cast<float>(RHI_Device::GetMaxTexture2dDimension()));
             }
+            // Shadow slice budget of the point and spot lights
+            else if (option == Renderer_Option::ShadowSlicesLocal)
+            {
+                value = Helper::Clamp(value, static_cast<float>(renderer_shadow_slices_local_min), static_cast<float>(RHI_Device::GetMaxTextureArrayLayers()));
+            }
+            // Frames in flight
+            else if (option == Renderer_Option::FramesInFlight)
+            {
+                value = Helper::Clamp(value, 0.0f, static_cast<float>(m_frames_in_flight_max));
+            }
+            // Point light faces per frame
+            else if (option == Renderer_Option::ShadowFacesPerFrame)
+            {
+                value = Helper::Max(value, 1.0f);
+            }
         }
 
         // Early exit if the value is already set
@@ -805,13 +2054,23 @@ namespace Spartan
                     return;
                 }
             }
+            else if (option == Renderer_Option::IndirectDrawing)
+            {
+                if (value == 1.0f && !RHI_Device::IsDrawIndirectCountSupported())
+                {
+                    SP_LOG_INFO("This device doesn't support draw indirect count");
+                    return;
+                }
+            }
         }
 
         // Set new value
         m_options[static_cast<uint32_t>(option)] = value;
 
-        // Handle cascading changes
+        // Handle cascading changes, some of them re-create resources that a frame in flight could be using
         {
+            lock_guard<recursive_mutex> lock(m_mutex_frame);
+
             // Antialiasing
             if (option == Renderer_Option::Antialiasing)
             {
@@ -866,14 +2125,18 @@ namespace Spartan
             // Shadow resolution
             else if (option == Renderer_Option::ShadowResolution)
             {
-                const auto& light_entities = m_renderables[Renderer_Entity::Light];
-                for (const auto& light_entity : light_entities)
+                // The directional shadow maps are sized after the shadow resolution
+                if (GetRenderTarget(Renderer_RenderTexture::shadow_local_depth))
                 {
-                    auto light = light_entity->GetComponent<Light>();
-                    if (light->GetShadowsEnabled())
-                    {
-                        light->CreateShadowMap();
-                    }
+                    CreateRenderTextures(false, false, true, false);
+                }
+            }
+            // Local shadow resolution
+            else if (option == Renderer_Option::ShadowResolutionLocal)
+            {
+                if (GetRenderTarget(Renderer_RenderTexture::shadow_local_depth))
+                {
+                    CreateRenderTextures(false, false, true, false);
                 }
             }
             else if (option == Renderer_Option::Hdr)
@@ -887,12 +2150,12 @@ namespace Spartan
         }
     }
 
-    array<float, 34>& Renderer::GetOptions()
+    array<float, 41>& Renderer::GetOptions()
     {
         return m_options;
     }
 
-    void Renderer::SetOptions(array<float, 34> options)
+    void Renderer::SetOptions(array<float, 41> options)
     {
         m_options = options;
     }
@@ -904,13 +2167,20 @@ namespace Spartan
     
     void Renderer::Present()
     {
+        lock_guard<recursive_mutex> lock(m_mutex_frame);
+
         if (!m_is_rendering_allowed)
             return;
 
+        // Nothing was blitted to the swapchain since the last present (the render thread is still recording)
+        if (Window::IsFullScreen() && !m_swap_chain_has_frame)
+            return;
+
         SP_ASSERT_MSG(!Window::IsMinimised(), "Don't call present if the window is minimized");
         SP_ASSERT(m_swap_chain->GetLayout() == RHI_Image_Layout::Present_Src);
 
         m_swap_chain->Present();
+        m_swap_chain_has_frame = false;
 
         SP_FIRE_EVENT(EventType::RendererPostPresent);
     }
@@ -923,6 +2193,12 @@ namespace Spartan
             m_is_rendering_allowed = false;
             m_flush_requested      = true;
 
+            // Wake up the render thread, in case it's waiting for a snapshot
+            {
+                lock_guard<mutex> lock(m_mutex_snapshots);
+            }
+            m_condition_snapshots.notify_all();
+
             while (m_flush_requested)
             {
                 SP_LOG_INFO("External thread is waiting for the renderer thread to flush...");
@@ -937,6 +2213,7 @@ namespace Spartan
         {
             SP_LOG_INFO("Renderer thread is flushing...");
             RHI_Device::QueueWaitAll();
+            m_is_rendering_allowed = true;
         }
 
         m_flush_requested = false;
@@ -29,9 +29,12 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../Math/Vector4.h"
 #include "../Math/Plane.h"
 #include <unordered_map>
+#include <mutex>
+#include <functional>
 #include "Event.h"
 #include "Mesh.h"
 #include "Renderer_ConstantBuffers.h"
+#include "Renderer_Snapshot.h"
 #include "Font/Font.h"
 #include "Grid.h"
 //===================================
@@ -71,13 +74,17 @@ namespace Spartan
         template<typename T>
         static T GetOption(const Renderer_Option option) { return static_cast<T>(GetOptions()[static_cast<uint32_t>(option)]); }
         static void SetOption(Renderer_Option option, float value);
-        static std::array<float, 34>& GetOptions();
-        static void SetOptions(std::array<float, 34> options);
+        static std::array<float, 41>& GetOptions();
+        static void SetOptions(std::array<float, 41> options);
 
         // Swapchain
         static RHI_SwapChain* GetSwapChain();
         static void Present();
 
+        // Render thread (enabled via Renderer_Option::FramesInFlight)
+        static bool IsRenderThreadActive();
+        static std::recursive_mutex& GetFrameMutex(); // held while a frame is recorded, lock it before touching gpu state from another thread
+
         // Misc
         static void Flush();
         static void SetGlobalShaderResources(RHI_CommandList* cmd_list);
@@ -114,9 +121,9 @@ namespace Spartan
         static std::unordered_map<Renderer_Entity, std::vector<std::shared_ptr<Entity>>>& GetEntities();
 
         // Get all
-        static std::array<std::shared_ptr<RHI_Texture>, 26>& GetRenderTargets();
-        static std::array<std::shared_ptr<RHI_Shader>, 44>& GetShaders();
-        static std::array<std::shared_ptr<RHI_ConstantBuffer>, 4>& GetConstantBuffers();
+        static std::array<std::shared_ptr<RHI_Texture>, 31>& GetRenderTargets();
+        static std::array<std::shared_ptr<RHI_Shader>, 46>& GetShaders();
+        static std::array<std::shared_ptr<RHI_ConstantBuffer>, 3>& GetConstantBuffers();
 
         // Get individual
         static std::shared_ptr<RHI_RasterizerState> GetRasterizerState(const Renderer_RasterizerState type);
@@ -126,21 +133,46 @@ namespace Spartan
         static std::shared_ptr<RHI_Shader> GetShader(const Renderer_Shader type);
         static std::shared_ptr<RHI_Sampler> GetSampler(const Renderer_Sampler type);
         static std::shared_ptr<RHI_ConstantBuffer> GetConstantBuffer(const Renderer_ConstantBuffer type);
-        static std::shared_ptr<RHI_StructuredBuffer> GetStructuredBuffer();
+        static std::shared_ptr<RHI_StructuredBuffer> GetStructuredBuffer(const Renderer_StructuredBuffer type);
         static std::shared_ptr<RHI_Texture> GetStandardTexture(const Renderer_StandardTexture type);
         static std::shared_ptr<Mesh> GetStandardMesh(const Renderer_StandardMesh type);
         //=======================================================================================================
 
     private:
-        // Constant buffers
+        // Constant buffers, secondary command lists get the ones of their slot
+        static RHI_ConstantBuffer* GetConstantBuffer(const Renderer_ConstantBuffer type, const RHI_CommandList* cmd_list);
+        static std::array<std::shared_ptr<RHI_ConstantBuffer>, 3>& GetConstantBuffersSecondary(const uint32_t slot);
         static void UpdateConstantBufferFrame(RHI_CommandList* cmd_list);
         static void UpdateConstantBufferPass(RHI_CommandList* cmd_list);
-        static void UpdateConstantBufferLight(RHI_CommandList* cmd_list, const std::shared_ptr<Light> light, const RHI_Shader_Type scope);
-        static void UpdateConstantBufferMaterial(RHI_CommandList* cmd_list, Material* material);
+        static void UpdateConstantBufferPass(RHI_CommandList* cmd_list, Cb_Pass& cb_pass);
+        static void UpdateConstantBufferLight(RHI_CommandList* cmd_list, const Renderer_SnapshotLight& light, const RHI_Shader_Type scope);
+
+        // Instancing
+        static void UpdateInstanceBuffers(const Renderer_Snapshot& snapshot);
+
+        // Material table
+        static void UpdateMaterialBuffer(const Renderer_Snapshot& snapshot);
+
+        // Indirect drawing, stats_index is the slot of the command list that's being recorded
+        static void UpdateIndirectBuffers(const Renderer_Snapshot& snapshot, const uint32_t stats_index);
+
+        // Lights, the light culling pass bins them into clusters
+        static void UpdateLightBuffer(const Renderer_Snapshot& snapshot);
+
+        // Views of the cubes which are rendered in a single pass (multiview)
+        static void UpdateViewBuffer(const Renderer_Snapshot& snapshot);
+
+        // Shadow maps, the texture arrays grow to the slices which the snapshot's lights were given
+        static void UpdateShadowMaps(const Renderer_Snapshot& snapshot);
 
         // Resource creation
         static void CreateConstantBuffers();
         static void CreateStructuredBuffers();
+        static void CreateInstanceBuffers(const uint32_t instance_count, const uint32_t index_count);
+        static void CreateIndirectBuffers(const uint32_t draw_count, const uint32_t batch_count);
+        static void CreateMaterialBuffer(const uint32_t material_count);
+        static void CreateLightBuffer(const uint32_t light_count);
+        static void CreateViewBuffer(const uint32_t view_count);
         static void CreateDepthStencilStates();
         static void CreateRasterizerStates();
         static void CreateBlendStates();
@@ -150,16 +182,22 @@ namespace Spartan
         static void CreateShaders();
         static void CreateSamplers(const bool create_only_anisotropic = false);
         static void CreateRenderTextures(const bool create_render, const bool create_output, const bool create_fixed, const bool create_dynamic);
+        static void CreateShadowMaps(const uint32_t slice_count_directional, const uint32_t slice_count_local);
 
         // Passes - Core
         static void Pass_Main(RHI_CommandList* cmd_list);
         static void Pass_ShadowMaps(RHI_CommandList* cmd_list, const bool is_transparent_pass);
         static void Pass_ReflectionProbes(RHI_CommandList* cmd_list);
+        static void Pass_CullIndirect(RHI_CommandList* cmd_list);
         static void Pass_Depth_Prepass(RHI_CommandList* cmd_list);
         static void Pass_GBuffer(RHI_CommandList* cmd_list, const bool is_transparent_pass);
         static void Pass_Ssgi(RHI_CommandList* cmd_list);
         static void Pass_Ssr(RHI_CommandList* cmd_list, RHI_Texture* tex_in);
         static void Pass_BrdfSpecularLut(RHI_CommandList* cmd_list);
+        // Records a render pass of draw_count draws, when there are enough of them the draws are split into chunks
+        // which are recorded in parallel into secondary command lists, each with its own copy of the pass buffer.
+        static void RecordRenderPass(RHI_CommandList* cmd_list, const RHI_PipelineState& pso, const uint32_t draw_count,
+            const std::function<void(RHI_CommandList* cmd_list, Cb_Pass& cb_pass, uint32_t draw_start, uint32_t draw_end)>& record);
         // Passes - Debug/Editor
         static void Pass_Blur_Gaussian(RHI_CommandList* cmd_list, RHI_Texture* tex_in, const bool depth_aware, const float radius, const float sigma, const uint32_t mip = rhi_all_mips);
         static void Pass_Lines(RHI_CommandList* cmd_list, RHI_Texture* tex_out);
@@ -178,6 +216,7 @@ namespace Spartan
         static void Pass_Debanding(RHI_CommandList* cmd_list, RHI_Texture* tex_in, RHI_Texture* tex_out);
         static void Pass_Bloom(RHI_CommandList* cmd_list, RHI_Texture* tex_in, RHI_Texture* tex_out);
         // Passes - Lighting
+        static void Pass_Light_Cull(RHI_CommandList* cmd_list);
         static void Pass_Light(RHI_CommandList* cmd_list, const bool is_transparent_pass);
         static void Pass_Light_Composition(RHI_CommandList* cmd_list, RHI_Texture* tex_out, const bool is_transparent_pass);
         static void Pass_Light_ImageBased(RHI_CommandList* cmd_list, RHI_Texture* tex_out, const bool is_transparent_pass);
@@ -187,7 +226,7 @@ namespace Spartan
         static void Pass_Ffx_Fsr2(RHI_CommandList* cmd_list, RHI_Texture* tex_in, RHI_Texture* tex_out);
 
         // Event handlers
-        static void OnWorldResolved(sp_variant data);
+        static void OnWorldResolved(const sp_variant& data);
         static void OnClear();
         static void OnFullScreenToggled();
 
@@ -195,6 +234,16 @@ namespace Spartan
         static void Lines_PreMain();
         static void Lines_PostMain();
 
+        // Frame
+        static void AcquireRenderables();
+        static void BuildSnapshot(Renderer_Snapshot& snapshot);
+        static void Render(const Renderer_Snapshot& snapshot);
+
+        // Render thread
+        static void StartRenderThread();
+        static void StopRenderThread();
+        static void RenderThreadLoop();
+
         // Misc
         static bool IsCallingFromOtherThread();
         static void OnResourceSafe(RHI_CommandList* cmd_list);
@@ -202,14 +251,14 @@ namespace Spartan
 
         // misc
         static std::unordered_map<Renderer_Entity, std::vector<std::shared_ptr<Entity>>> m_renderables;
+        static const Renderer_Snapshot* m_snapshot; // the frame that's being recorded
         static Cb_Frame m_cb_frame_cpu;
         static Cb_Pass m_cb_pass_cpu;
-        static Cb_Light m_cb_light_cpu;
-        static Cb_Material m_cb_material_cpu;
         static std::shared_ptr<RHI_VertexBuffer> m_vertex_buffer_lines;
         static std::unique_ptr<Font> m_font;
         static std::unique_ptr<Grid> m_world_grid;
         static bool m_brdf_specular_lut_rendered;
+        static uint32_t m_indirect_stats_index;
         static std::vector<RHI_Vertex_PosCol> m_line_vertices;
         static std::vector<float> m_lines_duration;
         static uint32_t m_lines_index_depth_off;
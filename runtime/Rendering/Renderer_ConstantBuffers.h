@@ -77,7 +77,7 @@ namespace Spartan
 
         Math::Vector2 resolution_environment;
         float luminance_max;
-        float padding;
+        float shadow_resolution_local;
 
         void set_bit(const bool set, const uint32_t bit)
         {
@@ -110,6 +110,7 @@ namespace Spartan
                 gamma                       == rhs.gamma                      &&
                 tonemapping                 == rhs.tonemapping                &&
                 shadow_resolution           == rhs.shadow_resolution          &&
+                shadow_resolution_local     == rhs.shadow_resolution_local    &&
                 fog                         == rhs.fog                        &&
                 resolution_output           == rhs.resolution_output          &&
                 resolution_render           == rhs.resolution_render          &&
@@ -150,6 +151,16 @@ namespace Spartan
         uint32_t reflection_proble_available = 0;
         Math::Vector3 position               = Math::Vector3::Zero;
 
+        uint32_t instance_offset      = 0; // into the instance indices, see Sb_Instance
+        uint32_t indirect_draw_count  = 0; // candidates the indirect culling pass goes through
+        uint32_t indirect_stats_index = 0; // where the indirect culling pass counts what it culled and emitted
+        uint32_t material_index       = 0; // into the material table, see Sb_Material
+
+        uint32_t light_count = 0; // lights the light culling pass bins into clusters
+        uint32_t view_offset = 0; // into the view buffer, multiview passes add SV_ViewID
+        uint32_t face_mask   = 0; // the views which see the draw, every draw of a multiview pass has one
+        float padding        = 0.0f;
+
         bool operator==(const Cb_Pass& rhs) const
         {
             return
@@ -167,13 +178,20 @@ namespace Spartan
                 extents                     == rhs.extents                     &&
                 work_group_count            == rhs.work_group_count            &&
                 reflection_proble_available == rhs.reflection_proble_available &&
-                position                    == rhs.position;
+                position                    == rhs.position                    &&
+                instance_offset             == rhs.instance_offset             &&
+                indirect_draw_count         == rhs.indirect_draw_count         &&
+                indirect_stats_index        == rhs.indirect_stats_index        &&
+                material_index              == rhs.material_index              &&
+                light_count                 == rhs.light_count                 &&
+                view_offset                 == rhs.view_offset                 &&
+                face_mask                   == rhs.face_mask;
         }
 
         bool operator!=(const Cb_Pass& rhs) const { return !(*this == rhs); }
     };
     
-    // Medium frequency - Updates per light
+    // Medium frequency - Updates per light, also the entries of the light buffer which the light pass goes through
     struct Cb_Light
     {
         Math::Matrix view_projection[6];
@@ -183,7 +201,8 @@ namespace Spartan
         Math::Vector4 direction;
         float normal_bias;
         uint32_t options;
-        Math::Vector2 padding;
+        uint32_t shadow_slice; // the first slice of a point or spot light in the local shadow array
+        float padding;
     
         bool operator==(const Cb_Light& rhs)
         {
@@ -199,12 +218,14 @@ namespace Spartan
                 color                      == rhs.color                      &&
                 position                   == rhs.position                   &&
                 direction                  == rhs.direction                  &&
-                options                    == rhs.options;
+                options                    == rhs.options                    &&
+                shadow_slice               == rhs.shadow_slice;
         }
     };
 
-    // Medium to high frequency - Updates per light
-    struct Cb_Material
+    // An entry of the material table, every material keeps its index until the world is cleared
+    // and the table is only uploaded when one of the entries changes, see Cb_Pass::material_index.
+    struct Sb_Material
     {
         Math::Vector4 color = Math::Vector4::Zero;
 
@@ -216,17 +237,17 @@ namespace Spartan
         float normal_mul    = 0.0f;
         float height_mul    = 0.0f;
 
-        uint32_t properties = 0;
-        float clearcoat;
-        float clearcoat_roughness;
-        float anisotropic;
+        uint32_t properties       = 0;
+        float clearcoat           = 0.0f;
+        float clearcoat_roughness = 0.0f;
+        float anisotropic         = 0.0f;
 
-        float anisitropic_rotation;
-        float sheen;
-        float sheen_tint;
-        float padding;
+        float anisitropic_rotation = 0.0f;
+        float sheen                = 0.0f;
+        float sheen_tint           = 0.0f;
+        float padding              = 0.0f;
 
-        bool operator==(const Cb_Material& rhs) const
+        bool operator==(const Sb_Material& rhs) const
         {
             return
                 color                == rhs.color                &&
@@ -244,6 +265,30 @@ namespace Spartan
                 sheen                == rhs.sheen                &&
                 sheen_tint           == rhs.sheen_tint;
         }
+
+        bool operator!=(const Sb_Material& rhs) const { return !(*this == rhs); }
+    };
+
+    // Per instance data, written once per frame. A draw reads its instances through a list
+    // of indices, starting at Cb_Pass::instance_offset and indexed by SV_InstanceID.
+    struct Sb_Instance
+    {
+        Math::Matrix transform;
+        Math::Matrix transform_previous;
+    };
+
+    // A candidate for indirect drawing, the culling pass tests its bounding box against the frustum and
+    // if it's visible, appends its arguments (first instance being the instance) to the region of its batch
+    struct Sb_IndirectDraw
+    {
+        Math::Vector3 aabb_min;
+        uint32_t index_count  = 0;
+        Math::Vector3 aabb_max;
+        uint32_t index_offset = 0;
+        int32_t vertex_offset = 0;
+        uint32_t instance     = 0; // into the instance indices, see get_instance()
+        uint32_t batch        = 0;
+        uint32_t args_offset  = 0; // the first argument slot of the batch
     };
 
     // High frequency   - Update multiply times per frame
@@ -29,6 +29,18 @@ namespace Spartan
 {
     #define DEBUG_COLOR Math::Vector4(0.41f, 0.86f, 1.0f, 1.0f)
 
+    // The most chunks a geometry pass is split into when it's recorded in parallel, each chunk records into a secondary command list
+    const uint32_t renderer_max_secondary_cmd_lists = 8;
+
+    // Lights are culled into clusters, 16x9 screen tiles by 24 exponential depth slices, plus a slice per tile which spans
+    // the whole depth (for volumetric lighting). The slices and the lookup are mirrored in common_buffers.hlsl.
+    const uint32_t renderer_light_cluster_count    = 16 * 9 * (24 + 1);
+    const uint32_t renderer_light_cluster_capacity = 64; // the most lights a cluster holds
+
+    // Lights render their shadows into slices of shared texture arrays, which grow with the number of shadowed lights.
+    // A directional light takes a slice per cascade, a point light takes six and a spot light takes one.
+    const uint32_t renderer_shadow_slices_local_min = 6;
+
     enum class Renderer_Option : uint32_t
     {
         Debug_Aabb,
@@ -63,7 +75,15 @@ namespace Spartan
         Upsampling,
         Sharpness,
         Hdr,
-        Vsync
+        Vsync,
+        FramesInFlight, // 0 renders on the calling thread, otherwise frames are recorded on a render thread while the simulation runs up to this many frames ahead
+        OcclusionCulling, // large occluders are rasterised on the CPU and the renderables behind them are skipped
+        ParallelRecording, // geometry passes with enough draws are recorded into secondary command lists on worker threads
+        IndirectDrawing,   // the camera's opaques are culled on the GPU and drawn with indirect arguments (needs draw indirect count)
+        ShadowFacesPerFrame, // how many point light faces re-render their dynamic casters per frame, the rest keep the last update
+        ClusterCulling,      // the camera culls the clusters of large meshes against its frustum and for facing away, and draws the rest
+        ShadowResolutionLocal, // the resolution of point and spot light shadows
+        ShadowSlicesLocal      // the most slices the point and spot light shadows grow to, the lights furthest from the camera lose their shadows past it
     };
 
     enum class Renderer_Antialiasing : uint32_t
@@ -92,11 +112,10 @@ namespace Spartan
 
     enum class Renderer_BindingsCb
     {
-        frame    = 0,
-        uber     = 1,
-        light    = 2,
-        material = 3,
-        imgui    = 4
+        frame = 0,
+        uber  = 1,
+        light = 2,
+        imgui = 4
     };
     
     enum class Renderer_BindingsSrv
@@ -127,13 +146,15 @@ namespace Spartan
         light_specular_transparent = 18,
         light_volumetric           = 19,
     
-        // Light depth/color maps
+        // Light depth/color maps, the point and spot lights share theirs
         light_directional_depth = 20,
         light_directional_color = 21,
-        light_point_depth       = 22,
-        light_point_color       = 23,
-        light_spot_depth        = 24,
-        light_spot_color        = 25,
+        light_local_depth       = 22,
+        light_local_color       = 23,
+
+        // Light clusters
+        light_cluster_counts  = 24,
+        light_cluster_indices = 25,
     
         // Noise
         noise_normal = 26,
@@ -148,16 +169,41 @@ namespace Spartan
         tex              = 33,
         tex2             = 34,
         font_atlas       = 35,
-        reflection_probe = 36
+        reflection_probe = 36,
+
+        // Instancing
+        instances        = 37,
+        instance_indices = 38,
+
+        // Indirect drawing
+        indirect_draws   = 39,
+
+        // Material table
+        materials        = 40,
+
+        // Lights
+        lights           = 41,
+
+        // Multiview, the view projections of the cubes which are rendered in a single pass
+        views            = 42
     };
 
     enum class Renderer_BindingsUav
     {
-        tex            = 0,
-        tex2           = 1,
-        tex3           = 2,
-        atomic_counter = 3,
-        tex_array      = 4
+        tex             = 0,
+        tex2            = 1,
+        tex3            = 2,
+        atomic_counter  = 3,
+        tex_array       = 4, // an array of 12, up to u15
+
+        // Indirect drawing
+        indirect_args   = 16,
+        indirect_counts = 17,
+        indirect_stats  = 18,
+
+        // Light clusters
+        light_cluster_counts  = 19,
+        light_cluster_indices = 20
     };
 
     enum class Renderer_Shader : uint8_t
@@ -189,6 +235,7 @@ namespace Spartan
         debug_reflection_probe_p,
         brdf_specular_lut_c,
         light_c,
+        light_cull_c,
         light_composition_c,
         light_image_based_p,
         line_v,
@@ -205,7 +252,8 @@ namespace Spartan
         reflection_probe_v,
         reflection_probe_p,
         ffx_cas_c,
-        ffx_spd_c
+        ffx_spd_c,
+        cull_indirect_c
     };
     
     enum class Renderer_RenderTexture : uint8_t
@@ -223,6 +271,11 @@ namespace Spartan
         light_specular,
         light_specular_transparent,
         light_volumetric,
+        shadow_directional_depth,
+        shadow_directional_color,
+        shadow_local_depth,
+        shadow_local_static_depth,
+        shadow_local_color,
         frame_render,
         frame_render_2,
         frame_output,
@@ -262,8 +315,23 @@ namespace Spartan
     {
         Frame,
         Pass,
-        Light,
-        Material
+        Light
+    };
+
+    enum class Renderer_StructuredBuffer
+    {
+        SpdCounter,
+        Instances,
+        InstanceIndices,
+        IndirectDraws,
+        IndirectArgs,
+        IndirectCounts,
+        IndirectStats,
+        Materials,
+        Lights,
+        LightClusterCounts,
+        LightClusterIndices,
+        Views
     };
 
     enum class Renderer_StandardTexture
@@ -50,15 +50,61 @@ namespace Spartan
     namespace
     {
         static const float thread_group_count = 8.0f;
+
+        // Set by Pass_CullIndirect(), the camera's opaques are drawn from the indirect arguments when true
+        static bool m_indirect_culled = false;
+
+        // Slices of the local shadow array, see Pass_ShadowMaps()
+        enum class ShadowSliceUpdate
+        {
+            None,    // keeps what it has
+            Dynamic, // copies the cache and renders the dynamic casters
+            Static   // renders the static casters into the cache first
+        };
+
+        struct ShadowSliceCache
+        {
+            uint64_t light_id        = 0;
+            Matrix view_projection   = Matrix::Identity;
+            uint64_t static_casters  = 0;
+            bool is_cached           = false;
+            bool has_dynamic         = false;
+            bool is_updated          = false; // this frame
+            ShadowSliceUpdate update = ShadowSliceUpdate::None;
+        };
+
+        static vector<ShadowSliceCache> m_shadow_slices; // one per slice of the local shadow array
+        static uint64_t m_shadow_slices_texture_id = 0;
+        static uint32_t m_shadow_face_cursor       = 0;
+
+        // Draws the whole index range, or the clusters which survived culling (a draw with clusters has a single instance)
+        static void draw_indexed(RHI_CommandList* cmd_list, const Renderer_DrawRecord& draw, const vector<Renderer_DrawRange>& clusters)
+        {
+            if (draw.cluster_count == 0)
+            {
+                cmd_list->DrawIndexed(draw.index_count, draw.index_offset, draw.vertex_offset, draw.instance_count);
+                return;
+            }
+
+            for (uint32_t i = draw.cluster_offset; i < draw.cluster_offset + draw.cluster_count; i++)
+            {
+                cmd_list->DrawIndexed(clusters[i].index_count, clusters[i].index_offset, draw.vertex_offset);
+            }
+        }
     }
 
     void Renderer::SetGlobalShaderResources(RHI_CommandList* cmd_list)
     {
         // Constant buffers
-        cmd_list->SetConstantBuffer(Renderer_BindingsCb::frame,    RHI_Shader_Vertex | RHI_Shader_Pixel | RHI_Shader_Compute, GetConstantBuffer(Renderer_ConstantBuffer::Frame));
-        cmd_list->SetConstantBuffer(Renderer_BindingsCb::uber,     RHI_Shader_Vertex | RHI_Shader_Pixel | RHI_Shader_Compute, GetConstantBuffer(Renderer_ConstantBuffer::Pass));
-        cmd_list->SetConstantBuffer(Renderer_BindingsCb::light,    RHI_Shader_Compute,                                        GetConstantBuffer(Renderer_ConstantBuffer::Light));
-        cmd_list->SetConstantBuffer(Renderer_BindingsCb::material, RHI_Shader_Pixel | RHI_Shader_Compute,                     GetConstantBuffer(Renderer_ConstantBuffer::Material));
+        cmd_list->SetConstantBuffer(static_cast<uint32_t>(Renderer_BindingsCb::frame),    RHI_Shader_Vertex | RHI_Shader_Pixel | RHI_Shader_Compute, GetConstantBuffer(Renderer_ConstantBuffer::Frame,    cmd_list));
+        cmd_list->SetConstantBuffer(static_cast<uint32_t>(Renderer_BindingsCb::uber),     RHI_Shader_Vertex | RHI_Shader_Pixel | RHI_Shader_Compute, GetConstantBuffer(Renderer_ConstantBuffer::Pass,     cmd_list));
+        cmd_list->SetConstantBuffer(static_cast<uint32_t>(Renderer_BindingsCb::light),    RHI_Shader_Compute,                                        GetConstantBuffer(Renderer_ConstantBuffer::Light,    cmd_list));
+
+        // Structured buffers
+        cmd_list->SetStructuredBuffer(Renderer_BindingsSrv::instances,        GetStructuredBuffer(Renderer_StructuredBuffer::Instances));
+        cmd_list->SetStructuredBuffer(Renderer_BindingsSrv::instance_indices, GetStructuredBuffer(Renderer_StructuredBuffer::InstanceIndices));
+        cmd_list->SetStructuredBuffer(Renderer_BindingsSrv::materials,        GetStructuredBuffer(Renderer_StructuredBuffer::Materials));
+        cmd_list->SetStructuredBuffer(Renderer_BindingsSrv::views,            GetStructuredBuffer(Renderer_StructuredBuffer::Views));
 
         // Textures
         cmd_list->SetTexture(Renderer_BindingsSrv::noise_normal, GetStandardTexture(Renderer_StandardTexture::Noise_normal));
@@ -81,12 +127,13 @@ namespace Spartan
         // Update frame constant buffer
         UpdateConstantBufferFrame(cmd_list);
 
-        if (shared_ptr<Camera> camera = GetCamera())
+        const Renderer_Snapshot& snapshot = *m_snapshot;
+        if (snapshot.has_camera)
         { 
             // If there are no entities, clear to the camera's color
-            if (GetEntities()[Renderer_Entity::Geometry_opaque].empty() && GetEntities()[Renderer_Entity::Geometry_transparent].empty() && GetEntities()[Renderer_Entity::Light].empty())
+            if (snapshot.geometry_opaque.empty() && snapshot.geometry_transparent.empty() && snapshot.lights.empty())
             {
-                GetCmdList()->ClearRenderTarget(rt_output, 0, 0, false, camera->GetClearColor());
+                GetCmdList()->ClearRenderTarget(rt_output, 0, 0, false, snapshot.camera.clear_color);
             }
             else // Render frame
             {
@@ -98,7 +145,7 @@ namespace Spartan
                 }
 
                 // Determine if a transparent pass is required
-                const bool do_transparent_pass = !GetEntities()[Renderer_Entity::Geometry_transparent].empty();
+                const bool do_transparent_pass = !snapshot.geometry_transparent.empty();
 
                 // Shadow maps
                 {
@@ -115,10 +162,12 @@ namespace Spartan
                 {
                     bool is_transparent_pass = false;
 
+                    Pass_CullIndirect(cmd_list);
                     Pass_Depth_Prepass(cmd_list);
                     Pass_GBuffer(cmd_list, is_transparent_pass);
                     Pass_Ssgi(cmd_list);
                     Pass_Ssr(cmd_list, rt1);
+                    Pass_Light_Cull(cmd_list);                                  // bin the lights into clusters, for both passes
                     Pass_Light(cmd_list, is_transparent_pass);                  // compute diffuse and specular buffers
                     Pass_Light_Composition(cmd_list, rt1, is_transparent_pass); // compose diffuse, specular, ssgi, volumetric etc.
                     Pass_Light_ImageBased(cmd_list, rt1, is_transparent_pass);  // apply IBL and SSR
@@ -175,6 +224,7 @@ namespace Spartan
         // All objects are rendered from the lights point of view.
         // Opaque objects write their depth information to a depth buffer, using just a vertex shader.
         // Transparent objects read the opaque depth but don't write their own, instead, they write their color information using a pixel shader.
+        // Point and spot lights keep the depth of their static casters in a cache, which is copied into their slices before the dynamic casters are rendered.
 
         // Acquire shaders
         RHI_Shader* shader_v = GetShader(Renderer_Shader::depth_light_V).get();
@@ -182,134 +232,279 @@ namespace Spartan
         if (!shader_v->IsCompiled() || !shader_p->IsCompiled())
             return;
 
+        RHI_Texture* tex_directional_depth  = GetRenderTarget(Renderer_RenderTexture::shadow_directional_depth).get();
+        RHI_Texture* tex_directional_color  = GetRenderTarget(Renderer_RenderTexture::shadow_directional_color).get();
+        RHI_Texture* tex_local_depth        = GetRenderTarget(Renderer_RenderTexture::shadow_local_depth).get();
+        RHI_Texture* tex_local_static_depth = GetRenderTarget(Renderer_RenderTexture::shadow_local_static_depth).get();
+        RHI_Texture* tex_local_color        = GetRenderTarget(Renderer_RenderTexture::shadow_local_color).get();
+        const uint32_t slice_count_local    = tex_local_depth->GetArrayLength();
+
+        // Re-created (or grown) shadow maps hold nothing
+        if (m_shadow_slices_texture_id != tex_local_static_depth->GetObjectId())
+        {
+            m_shadow_slices_texture_id = tex_local_static_depth->GetObjectId();
+            m_shadow_slices.assign(slice_count_local, ShadowSliceCache());
+        }
+
         // Get entities
-        vector<shared_ptr<Entity>>& entities = m_renderables[is_transparent_pass ? Renderer_Entity::Geometry_transparent : Renderer_Entity::Geometry_opaque];
+        const vector<Renderer_SnapshotRenderable>& entities = is_transparent_pass ? m_snapshot->geometry_transparent : m_snapshot->geometry_opaque;
         if (entities.empty())
             return;
 
+        // Decide what every slice of the local shadow array needs
+        if (!is_transparent_pass)
+        {
+            static vector<uint32_t> cubes_dynamic; // the first slice of each
+            cubes_dynamic.resize(slice_count_local / 6 + 1);
+            uint32_t cube_dynamic_count = 0;
+            for (const Renderer_SnapshotLight& light : m_snapshot->lights)
+            {
+                if (light.IsDirectional() || !light.GetShadowsEnabled() || light.GetIntensity() == 0.0f)
+                    continue;
+
+                // The faces of a cube are rendered together, so they share a single draw list and update
+                const Renderer_SnapshotVisibility& visible_cube = light.visible_cube;
+                const uint32_t slice_count                      = light.cb.shadow_slice < slice_count_local ? Math::Helper::Min(slice_count_local - light.cb.shadow_slice, light.slice_count) : 0;
+                ShadowSliceUpdate update_cube                   = ShadowSliceUpdate::None;
+                for (uint32_t array_index = 0; array_index < slice_count; array_index++)
+                {
+                    ShadowSliceCache& slice                    = m_shadow_slices[light.cb.shadow_slice + array_index];
+                    const Renderer_SnapshotVisibility& visible = light.visible[array_index];
+                    const vector<Renderer_DrawRecord>& draws   = light.IsCube() ? visible_cube.draws_opaque : visible.draws_opaque;
+                    const bool has_dynamic                     = !draws.empty() && draws.back().is_dynamic; // dynamic casters sort last
+
+                    const bool is_cached =
+                        slice.is_cached                                                &&
+                        slice.light_id        == light.entity->GetObjectId()           &&
+                        slice.view_projection == light.cb.view_projection[array_index] &&
+                        slice.static_casters  == visible.static_casters;
+
+                    // Dynamic casters are re-rendered every frame, and once more after they left, so they don't linger
+                    if (!is_cached)
+                    {
+                        slice.update = ShadowSliceUpdate::Static;
+                    }
+                    else if (has_dynamic || slice.has_dynamic)
+                    {
+                        slice.update = ShadowSliceUpdate::Dynamic;
+                    }
+                    else
+                    {
+                        slice.update = ShadowSliceUpdate::None;
+                    }
+
+                    update_cube = Math::Helper::Max(update_cube, slice.update);
+                }
+
+                if (light.IsCube())
+                {
+                    for (uint32_t array_index = 0; array_index < slice_count; array_index++)
+                    {
+                        m_shadow_slices[light.cb.shadow_slice + array_index].update = update_cube;
+                    }
+
+                    if (update_cube == ShadowSliceUpdate::Dynamic)
+                    {
+                        cubes_dynamic[cube_dynamic_count++] = light.cb.shadow_slice;
+                    }
+                }
+            }
+
+            // Point lights which only have to update their dynamic casters take turns, within a budget of faces
+            const uint32_t cube_budget = Math::Helper::Max<uint32_t>(GetOption<uint32_t>(Renderer_Option::ShadowFacesPerFrame) / 6, 1);
+            if (cube_dynamic_count > cube_budget)
+            {
+                for (uint32_t i = 0; i < cube_dynamic_count; i++)
+                {
+                    const uint32_t turn = (i + cube_dynamic_count - m_shadow_face_cursor % cube_dynamic_count) % cube_dynamic_count;
+                    if (turn >= cube_budget)
+                    {
+                        for (uint32_t face = 0; face < 6; face++)
+                        {
+                            m_shadow_slices[cubes_dynamic[i] + face].update = ShadowSliceUpdate::None;
+                        }
+                    }
+                }
+
+                m_shadow_face_cursor += cube_budget;
+            }
+        }
+
         cmd_list->BeginTimeblock(is_transparent_pass ? "shadow_maps_color" : "shadow_maps_depth");
 
+        // A pipeline state keeps the hash of the first configuration it was used with, so every configuration gets its own
+        static array<RHI_PipelineState, 8> psos;        // transparent, directional and cube bits
+        static array<RHI_PipelineState, 2> psos_static; // the static cache of a slice or a cube
+
         // Go through all of the lights
-        const auto& entities_light = GetEntities()[Renderer_Entity::Light];
-        for (uint32_t light_index = 0; light_index < entities_light.size(); light_index++)
+        for (const Renderer_SnapshotLight& light : m_snapshot->lights)
         {
-            shared_ptr<Light> light = entities_light[light_index]->GetComponent<Light>();
-
-            // Can happen when loading a new scene and the lights get deleted
-            if (!light)
-                continue;
-
             // Skip lights which don't cast shadows or have an intensity of zero
-            if (!light->GetShadowsEnabled() || light->GetIntensityForShader(GetCamera().get()) == 0.0f)
+            if (!light.GetShadowsEnabled() || light.GetIntensity() == 0.0f)
                 continue;
 
             // Skip lights that don't cast transparent shadows (if this is a transparent pass)
-            if (is_transparent_pass && !light->GetShadowsTransparentEnabled())
+            if (is_transparent_pass && !light.GetShadowsTransparentEnabled())
                 continue;
 
-            // Acquire light's shadow maps
-            RHI_Texture* tex_depth = light->GetDepthTexture();
-            RHI_Texture* tex_color = light->GetColorTexture();
-            if (!tex_depth)
+            // Acquire the shadow maps, every light renders into its slices of them
+            RHI_Texture* tex_depth    = light.IsDirectional() ? tex_directional_depth : tex_local_depth;
+            RHI_Texture* tex_color    = light.IsDirectional() ? tex_directional_color : tex_local_color;
+            const uint32_t slice_base = light.cb.shadow_slice;
+            if (!tex_depth || slice_base >= tex_depth->GetArrayLength())
                 continue;
 
+            // Point lights render the six faces in a single pass (multiview), each face takes the view projection of its slice
+            const bool is_cube       = light.IsCube() && slice_base + 6 <= tex_depth->GetArrayLength();
+            const uint32_t view_mask = is_cube ? 0x3F : 0;
+
             // Define pipeline state
-            static RHI_PipelineState pso;
+            RHI_PipelineState& pso = psos[(is_transparent_pass ? 1 : 0) | (light.IsDirectional() ? 2 : 0) | (is_cube ? 4 : 0)];
             pso.shader_vertex                   = shader_v;
             pso.shader_pixel                    = is_transparent_pass ? shader_p : nullptr;
             pso.blend_state                     = is_transparent_pass ? GetBlendState(Renderer_BlendState::Alpha).get() : GetBlendState(Renderer_BlendState::Disabled).get();
             pso.depth_stencil_state             = is_transparent_pass ? GetDepthStencilState(Renderer_DepthStencilState::Depth_read).get() : GetDepthStencilState(Renderer_DepthStencilState::Depth_read_write_stencil_read).get();
             pso.render_target_color_textures[0] = tex_color; // always bind so we can clear to white (in case there are no transparent objects)
             pso.render_target_depth_texture     = tex_depth;
+            pso.render_target_view_mask         = view_mask;
             pso.primitive_topology              = RHI_PrimitiveTopology_Mode::TriangleList;
 
-            for (uint32_t array_index = 0; array_index < tex_depth->GetArrayLength(); array_index++)
+            // "Pancaking" - https://www.gamedev.net/forums/topic/639036-shadow-mapping-and-high-up-objects/
+            // It's basically a way to capture the silhouettes of potential shadow casters behind the light's view point.
+            // Of course we also have to make sure that the light doesn't cull them in the first place (this is done automatically by the light)
+            pso.rasterizer_state = GetRasterizerState(light.IsDirectional() ? Renderer_RasterizerState::Light_directional : Renderer_RasterizerState::Light_point_spot).get();
+
+            // The static casters are rendered into the cache, depth only
+            RHI_PipelineState& pso_static = psos_static[is_cube ? 1 : 0];
+            pso_static.shader_vertex               = shader_v;
+            pso_static.blend_state                 = pso.blend_state;
+            pso_static.depth_stencil_state         = pso.depth_stencil_state;
+            pso_static.rasterizer_state            = pso.rasterizer_state;
+            pso_static.render_target_depth_texture = tex_local_static_depth;
+            pso_static.render_target_view_mask     = view_mask;
+            pso_static.primitive_topology          = RHI_PrimitiveTopology_Mode::TriangleList;
+
+            const uint32_t array_length = is_cube ? 1 : Math::Helper::Min(tex_depth->GetArrayLength() - slice_base, light.slice_count);
+            for (uint32_t array_index = 0; array_index < array_length; array_index++)
             {
-                // Set render target texture array index
-                pso.render_target_color_texture_array_index         = array_index;
-                pso.render_target_depth_stencil_texture_array_index = array_index;
+                const uint32_t slice_index    = slice_base + array_index;
+                const Matrix& view_projection = light.cb.view_projection[array_index];
 
-                // Set clear values
-                pso.clear_color[0] = Color::standard_white;
-                pso.clear_depth    = is_transparent_pass ? rhi_depth_load : 0.0f; // reverse-z
+                // Only the shadow casters in the slice's frustum, potential casters behind the near plane of a directional light are kept
+                const Renderer_SnapshotVisibility& visible = is_cube ? light.visible_cube : light.visible[array_index];
+                const vector<Renderer_DrawRecord>& draws   = is_transparent_pass ? visible.draws_transparent : visible.draws_opaque;
 
-                const Matrix& view_projection = light->GetViewMatrix(array_index) * light->GetProjectionMatrix(array_index);
-
-                // Set appropriate rasterizer state
-                if (light->GetLightType() == LightType::Directional)
-                {
-                    // "Pancaking" - https://www.gamedev.net/forums/topic/639036-shadow-mapping-and-high-up-objects/
-                    // It's basically a way to capture the silhouettes of potential shadow casters behind the light's view point.
-                    // Of course we also have to make sure that the light doesn't cull them in the first place (this is done automatically by the light)
-                    pso.rasterizer_state = GetRasterizerState(Renderer_RasterizerState::Light_directional).get();
-                }
-                else
+                auto record_draws = [&](RHI_PipelineState& pso, const uint32_t draw_offset, const uint32_t draw_count)
                 {
-                    pso.rasterizer_state = GetRasterizerState(Renderer_RasterizerState::Light_point_spot).get();
-                }
+                    cmd_list->SetPipelineState(pso);
 
-                // Set pipeline state
-                cmd_list->SetPipelineState(pso);
+                    RecordRenderPass(cmd_list, pso, draw_count, [&](RHI_CommandList* cmd_list, Cb_Pass& cb_pass, uint32_t draw_start, uint32_t draw_end)
+                    {
+                        for (uint32_t i = draw_offset + draw_start; i < draw_offset + draw_end; i++)
+                        {
+                            const Renderer_DrawRecord& draw = draws[i];
+                            Material* material              = draw.material;
 
-                // State tracking
-                bool render_pass_active    = false;
+                            // Bind material (only for transparents)
+                            if (is_transparent_pass)
+                            {
+                                // Bind material textures, the properties come from the material table
+                                RHI_Texture* tex_albedo = material->GetTexture(MaterialTexture::Color);
+                                cmd_list->SetTexture(Renderer_BindingsSrv::tex, tex_albedo ? tex_albedo : GetStandardTexture(Renderer_StandardTexture::White).get());
+                            }
 
-                for (shared_ptr<Entity> entity : entities)
-                {
-                    // Acquire renderable component
-                    shared_ptr<Renderable> renderable = entity->GetComponent<Renderable>();
-                    if (!renderable)
-                        continue;
+                            // Bind geometry
+                            cmd_list->SetBufferIndex(draw.mesh->GetIndexBuffer());
+                            cmd_list->SetBufferVertex(draw.mesh->GetVertexBuffer());
 
-                    // Skip meshes that don't cast shadows
-                    if (!renderable->GetCastShadows())
-                        continue;
+                            // Set uber buffer with the cascade's view projection (or the cube's views), the transforms come from the instances
+                            cb_pass.transform       = view_projection;
+                            cb_pass.instance_offset = draw.instance_offset;
+                            cb_pass.material_index  = draw.material_index;
+                            cb_pass.view_offset     = light.view_offset;
+                            cb_pass.face_mask       = is_cube ? draw.face_mask : 0;
+                            UpdateConstantBufferPass(cmd_list, cb_pass);
 
-                    // Acquire geometry
-                    Mesh* mesh = renderable->GetMesh();
-                    if (!mesh || !mesh->GetVertexBuffer() || !mesh->GetIndexBuffer())
-                        continue;
+                            cmd_list->DrawIndexed(draw.index_count, draw.index_offset, draw.vertex_offset, draw.instance_count);
+                        }
+                    });
+                };
 
-                    // Acquire material
-                    Material* material = renderable->GetMaterial();
-                    if (!material)
-                        continue;
+                // Set render target texture array index
+                pso.render_target_color_texture_array_index         = slice_index;
+                pso.render_target_depth_stencil_texture_array_index = slice_index;
 
-                    // Skip objects outside of the view frustum
-                    if (!light->IsInViewFrustum(renderable, array_index))
-                        continue;
+                // Set clear values
+                pso.clear_color[0] = Color::standard_white;
+                pso.clear_depth    = is_transparent_pass ? rhi_depth_load : 0.0f; // reverse-z
 
-                    if (!render_pass_active)
+                // Directional lights follow the camera, so they render everything, every frame
+                if (light.IsDirectional())
+                {
+                    if (!draws.empty())
                     {
-                        cmd_list->BeginRenderPass();
-                        render_pass_active = true;
+                        record_draws(pso, 0, static_cast<uint32_t>(draws.size()));
                     }
 
-                    // Bind material (only for transparents)
-                    if (is_transparent_pass)
-                    {
-                        // Bind material textures
-                        RHI_Texture* tex_albedo = material->GetTexture(MaterialTexture::Color);
-                        cmd_list->SetTexture(Renderer_BindingsSrv::tex, tex_albedo ? tex_albedo : GetStandardTexture(Renderer_StandardTexture::White).get());
+                    continue;
+                }
+
+                // The faces of a cube are updated together, so the first one speaks for all of them
+                const uint32_t slice_count = is_cube ? 6 : 1;
+                ShadowSliceCache& slice    = m_shadow_slices[slice_index];
 
-                        // Set uber buffer with material properties
-                        UpdateConstantBufferMaterial(cmd_list, material);
+                // A slice which wasn't updated keeps the colors that go with its depth
+                if (is_transparent_pass)
+                {
+                    if (slice.is_updated && !draws.empty())
+                    {
+                        record_draws(pso, 0, static_cast<uint32_t>(draws.size()));
                     }
 
-                    // Bind geometry
-                    cmd_list->SetBufferIndex(mesh->GetIndexBuffer());
-                    cmd_list->SetBufferVertex(mesh->GetVertexBuffer());
+                    continue;
+                }
 
-                    // Set uber buffer with cascade transform
-                    m_cb_pass_cpu.transform = entity->GetTransform()->GetMatrix() * view_projection;
-                    UpdateConstantBufferPass(cmd_list);
+                const ShadowSliceUpdate update = slice.update;
+                for (uint32_t i = 0; i < slice_count; i++)
+                {
+                    m_shadow_slices[slice_index + i].is_updated = update != ShadowSliceUpdate::None;
+                }
+
+                if (update == ShadowSliceUpdate::None)
+                    continue;
 
-                    cmd_list->DrawIndexed(renderable->GetIndexCount(), renderable->GetIndexOffset(), renderable->GetVertexOffset());
+                // Dynamic casters sort last
+                uint32_t static_count = static_cast<uint32_t>(draws.size());
+                while (static_count > 0 && draws[static_count - 1].is_dynamic)
+                {
+                    static_count--;
                 }
 
-                if (render_pass_active)
+                // Render the static casters into the cache
+                if (update == ShadowSliceUpdate::Static)
                 {
-                    cmd_list->EndRenderPass();
+                    pso_static.render_target_depth_stencil_texture_array_index = slice_index;
+                    pso_static.clear_depth                                     = 0.0f; // reverse-z
+                    record_draws(pso_static, 0, static_count);
+
+                    for (uint32_t i = 0; i < slice_count; i++)
+                    {
+                        ShadowSliceCache& slice_cached = m_shadow_slices[slice_index + i];
+                        slice_cached.light_id          = light.entity->GetObjectId();
+                        slice_cached.view_projection   = light.cb.view_projection[array_index + i];
+                        slice_cached.static_casters    = light.visible[array_index + i].static_casters;
+                        slice_cached.is_cached         = true;
+                    }
+                }
+
+                // Start from the cache and render the dynamic casters on top
+                cmd_list->Copy(tex_local_static_depth, tex_depth, slice_index, slice_count);
+                pso.clear_depth = rhi_depth_load;
+                record_draws(pso, static_count, static_cast<uint32_t>(draws.size()) - static_count);
+
+                for (uint32_t i = 0; i < slice_count; i++)
+                {
+                    m_shadow_slices[slice_index + i].has_dynamic = static_count < draws.size();
                 }
             }
         }
@@ -326,119 +521,156 @@ namespace Spartan
             return;
 
         // Acquire reflections probes
-        const vector<shared_ptr<Entity>>& probes = m_renderables[Renderer_Entity::Reflection_probe];
+        const vector<Renderer_SnapshotReflectionProbe>& probes = m_snapshot->reflection_probes;
         if (probes.empty())
             return;
 
         // Acquire renderables
-        const vector<shared_ptr<Entity>>& renderables = m_renderables[Renderer_Entity::Geometry_opaque];
+        const vector<Renderer_SnapshotRenderable>& renderables = m_snapshot->geometry_opaque;
         if (renderables.empty())
             return;
 
         // Acquire lights
-        const vector<shared_ptr<Entity>>& lights = m_renderables[Renderer_Entity::Light];
+        const vector<Renderer_SnapshotLight>& lights = m_snapshot->lights;
         if (lights.empty())
             return;
 
         cmd_list->BeginTimeblock("reflection_probes");
 
         // For each reflection probe
-        for (uint32_t probe_index = 0; probe_index < static_cast<uint32_t>(probes.size()); probe_index++)
+        for (const Renderer_SnapshotReflectionProbe& probe_snapshot : probes)
         {
-            shared_ptr<ReflectionProbe> probe = probes[probe_index]->GetComponent<ReflectionProbe>();
-            if (!probe || !probe->GetNeedsToUpdate())
+            if (!probe_snapshot.needs_to_update)
                 continue;
 
-            // Define pipeline state
-            static RHI_PipelineState pso;
-            pso.shader_vertex                   = shader_v;
-            pso.shader_pixel                    = shader_p;
-            pso.rasterizer_state                = GetRasterizerState(Renderer_RasterizerState::Solid_cull_back).get();
-            pso.blend_state                     = GetBlendState(Renderer_BlendState::Additive).get();
-            pso.depth_stencil_state             = GetDepthStencilState(Renderer_DepthStencilState::Depth_read_write_stencil_read).get();
-            pso.render_target_color_textures[0] = probe->GetColorTexture();
-            pso.render_target_depth_texture     = probe->GetDepthTexture();
-            pso.clear_color[0]                  = Color::standard_black;
-            pso.clear_depth                     = 0.0f; // reverse-z
-            pso.clear_stencil                   = rhi_stencil_dont_care;
-            pso.primitive_topology              = RHI_PrimitiveTopology_Mode::TriangleList;
+            ReflectionProbe* probe = probe_snapshot.probe.get();
+
+            // The faces which update this time are rendered in a single pass (multiview), the views start at the first face of the cube
+            const uint32_t face_mask = ((1u << probe_snapshot.update_face_count) - 1) << probe_snapshot.update_face_start_index;
+
+            // Define pipeline state, one per view mask since a pipeline state keeps the hash of its first configuration
+            static array<RHI_PipelineState, 1 << 6> psos;
+            RHI_PipelineState& pso = psos[face_mask];
+            pso.shader_vertex                                   = shader_v;
+            pso.shader_pixel                                    = shader_p;
+            pso.rasterizer_state                                = GetRasterizerState(Renderer_RasterizerState::Solid_cull_back).get();
+            pso.blend_state                                     = GetBlendState(Renderer_BlendState::Additive).get();
+            pso.depth_stencil_state                             = GetDepthStencilState(Renderer_DepthStencilState::Depth_read_write_stencil_read).get();
+            pso.render_target_color_textures[0]                 = probe->GetColorTexture();
+            pso.render_target_depth_texture                     = probe->GetDepthTexture();
+            pso.render_target_color_texture_array_index         = 0;
+            pso.render_target_depth_stencil_texture_array_index = 0;
+            pso.render_target_view_mask                         = face_mask;
+            pso.clear_color[0]                                  = Color::standard_black;
+            pso.clear_depth                                     = 0.0f; // reverse-z
+            pso.clear_stencil                                   = rhi_stencil_dont_care;
+            pso.primitive_topology                              = RHI_PrimitiveTopology_Mode::TriangleList;
 
-            // Update cube faces
-            uint32_t index_start = probe->GetUpdateFaceStartIndex();
-            uint32_t index_end   = (index_start + probe->GetUpdateFaceCount()) % 7;
-            for (uint32_t face_index = index_start; face_index < index_end; face_index++)
-            {
-                // Set render target texture array index
-                pso.render_target_color_texture_array_index = face_index;
-
-                // Set pipeline state
-                cmd_list->SetPipelineState(pso);
-
-                // Begin render pass
-                cmd_list->BeginRenderPass();
-
-                // Compute view projection matrix
-                Matrix view_projection = probe->GetViewMatrix(face_index) * probe->GetProjectionMatrix();
+            // Set pipeline state
+            cmd_list->SetPipelineState(pso);
 
-                // For each renderable entity
-                for (uint32_t index_renderable = 0; index_renderable < static_cast<uint32_t>(renderables.size()); index_renderable++)
+            // For each draw in any of the faces' frustums
+            const vector<Renderer_DrawRecord>& draws = probe_snapshot.visible_cube.draws_opaque;
+            RecordRenderPass(cmd_list, pso, static_cast<uint32_t>(draws.size()), [&](RHI_CommandList* cmd_list, Cb_Pass& cb_pass, uint32_t draw_start, uint32_t draw_end)
+            {
+                for (uint32_t i = draw_start; i < draw_end; i++)
                 {
-                    shared_ptr<Entity> entity = renderables[index_renderable];
+                    const Renderer_DrawRecord& draw           = draws[i];
+                    const Renderer_SnapshotRenderable& entity = renderables[draw.renderable_index];
+                    Material* material                        = draw.material;
+
+                    // Faces which don't update this time are not rendered, so a draw which only they see can be skipped
+                    if ((draw.face_mask & face_mask) == 0)
+                        continue;
 
                     // For each light entity
-                    for (uint32_t index_light = 0; index_light < static_cast<uint32_t>(lights.size()); index_light++)
+                    for (const Renderer_SnapshotLight& light : lights)
                     {
-                        if (shared_ptr<Light> light = lights[index_light]->GetComponent<Light>())
+                        if (light.GetIntensity() != 0)
                         {
-                            if (light->GetIntensityForShader(GetCamera().get()) != 0)
-                            {
-                                // Get renderable
-                                shared_ptr<Renderable> renderable = entity->GetComponent<Renderable>();
-                                if (!renderable)
-                                    continue;
-
-                                // Get material
-                                Material* material = renderable->GetMaterial();
-                                if (!material)
-                                    continue;
-
-                                // Get geometry
-                                Mesh* mesh = renderable->GetMesh();
-                                if (!mesh || !mesh->GetVertexBuffer() || !mesh->GetIndexBuffer())
-                                    continue;
-
-                                // Skip objects outside of the view frustum
-                                if (!probe->IsInViewFrustum(renderable, face_index))
-                                    continue;
-
-                                // Set geometry (will only happen if not already set)
-                                cmd_list->SetBufferIndex(mesh->GetIndexBuffer());
-                                cmd_list->SetBufferVertex(mesh->GetVertexBuffer());
-
-                                // Bind material textures
-                                cmd_list->SetTexture(Renderer_BindingsSrv::material_albedo,    material->GetTexture(MaterialTexture::Color));
-                                cmd_list->SetTexture(Renderer_BindingsSrv::material_roughness, material->GetTexture(MaterialTexture::Roughness));
-                                cmd_list->SetTexture(Renderer_BindingsSrv::material_metallic,  material->GetTexture(MaterialTexture::Metalness));
-
-                                // Set uber buffer with cascade transform
-                                m_cb_pass_cpu.transform = entity->GetTransform()->GetMatrix() * view_projection;
-                                UpdateConstantBufferPass(cmd_list);
+                            // Set geometry (will only happen if not already set)
+                            cmd_list->SetBufferIndex(draw.mesh->GetIndexBuffer());
+                            cmd_list->SetBufferVertex(draw.mesh->GetVertexBuffer());
 
-                                // Update light buffer
-                                UpdateConstantBufferLight(cmd_list, light, RHI_Shader_Pixel);
+                            // Bind material textures
+                            cmd_list->SetTexture(Renderer_BindingsSrv::material_albedo,    material->GetTexture(MaterialTexture::Color));
+                            cmd_list->SetTexture(Renderer_BindingsSrv::material_roughness, material->GetTexture(MaterialTexture::Roughness));
+                            cmd_list->SetTexture(Renderer_BindingsSrv::material_metallic,  material->GetTexture(MaterialTexture::Metalness));
 
-                                cmd_list->DrawIndexed(renderable->GetIndexCount(), renderable->GetIndexOffset(), renderable->GetVertexOffset());
-                            }
+                            // Set uber buffer with the entity's transform, the faces' view projections come from the view buffer
+                            cb_pass.transform   = entity.transform;
+                            cb_pass.view_offset = probe_snapshot.view_offset;
+                            cb_pass.face_mask   = draw.face_mask;
+                            UpdateConstantBufferPass(cmd_list, cb_pass);
+
+                            // Update light buffer
+                            UpdateConstantBufferLight(cmd_list, light, RHI_Shader_Pixel);
+
+                            cmd_list->DrawIndexed(draw.index_count, draw.index_offset, draw.vertex_offset);
                         }
                     }
                 }
-                cmd_list->EndRenderPass();
-            }
+            });
         }
 
         cmd_list->EndTimeblock();
     }
 
+    void Renderer::Pass_CullIndirect(RHI_CommandList* cmd_list)
+    {
+        m_indirect_culled = false;
+
+        const Renderer_Snapshot& snapshot = *m_snapshot;
+        if (snapshot.indirect_batches.empty())
+            return;
+
+        // Acquire shader
+        RHI_Shader* shader_c = GetShader(Renderer_Shader::cull_indirect_c).get();
+        if (!shader_c->IsCompiled())
+            return;
+
+        cmd_list->BeginTimeblock("cull_indirect");
+
+        RHI_StructuredBuffer* args   = GetStructuredBuffer(Renderer_StructuredBuffer::IndirectArgs).get();
+        RHI_StructuredBuffer* counts = GetStructuredBuffer(Renderer_StructuredBuffer::IndirectCounts).get();
+        RHI_StructuredBuffer* stats  = GetStructuredBuffer(Renderer_StructuredBuffer::IndirectStats).get();
+
+        // The arguments could still be read by the previous frame's draws
+        cmd_list->InsertBarrierStructuredBuffer(args);
+
+        // Define pipeline state
+        static RHI_PipelineState pso;
+        pso.shader_compute = shader_c;
+
+        // Set pipeline state
+        cmd_list->SetPipelineState(pso);
+
+        // Set structured buffers
+        cmd_list->SetStructuredBuffer(Renderer_BindingsSrv::indirect_draws,  GetStructuredBuffer(Renderer_StructuredBuffer::IndirectDraws));
+        cmd_list->SetStructuredBuffer(Renderer_BindingsUav::indirect_args,   GetStructuredBuffer(Renderer_StructuredBuffer::IndirectArgs));
+        cmd_list->SetStructuredBuffer(Renderer_BindingsUav::indirect_counts, GetStructuredBuffer(Renderer_StructuredBuffer::IndirectCounts));
+        cmd_list->SetStructuredBuffer(Renderer_BindingsUav::indirect_stats,  GetStructuredBuffer(Renderer_StructuredBuffer::IndirectStats));
+
+        // Set uber buffer, the frustum is extracted from the transform
+        const uint32_t draw_count          = static_cast<uint32_t>(snapshot.indirect_draws.size());
+        m_cb_pass_cpu.transform            = m_cb_frame_cpu.view_projection_unjittered;
+        m_cb_pass_cpu.indirect_draw_count  = draw_count;
+        m_cb_pass_cpu.indirect_stats_index = m_indirect_stats_index;
+        UpdateConstantBufferPass(cmd_list);
+
+        // Render
+        cmd_list->Dispatch((draw_count + 63) / 64, 1); // 64 threads per group, see cull_indirect.hlsl
+
+        // The draws read the arguments and counts, the cpu reads the stats back
+        cmd_list->InsertBarrierStructuredBuffer(args);
+        cmd_list->InsertBarrierStructuredBuffer(counts);
+        cmd_list->InsertBarrierStructuredBuffer(stats);
+
+        cmd_list->EndTimeblock();
+
+        m_indirect_culled = true;
+    }
+
     void Renderer::Pass_Depth_Prepass(RHI_CommandList* cmd_list)
     {
         if (!GetOption<bool>(Renderer_Option::DepthPrepass))
@@ -453,7 +685,6 @@ namespace Spartan
         cmd_list->BeginTimeblock("depth_prepass");
 
         RHI_Texture* tex_depth = GetRenderTarget(Renderer_RenderTexture::gbuffer_depth).get();
-        const vector<shared_ptr<Entity>> entities = m_renderables[Renderer_Entity::Geometry_opaque];
 
         // Define pipeline state
         static RHI_PipelineState pso;
@@ -469,62 +700,79 @@ namespace Spartan
         // Set pipeline state
         cmd_list->SetPipelineState(pso);
 
-        // Render
-        cmd_list->BeginRenderPass();
-        { 
-            // Variables that help reduce state changes
-            uint64_t currently_bound_geometry = 0;
-            
-            // Draw opaque
-            for (shared_ptr<Entity> entity : entities)
+        // Render, from the arguments of the culling pass
+        if (m_indirect_culled)
+        {
+            const vector<Renderer_IndirectBatch>& batches = m_snapshot->indirect_batches;
+            RHI_StructuredBuffer* args                    = GetStructuredBuffer(Renderer_StructuredBuffer::IndirectArgs).get();
+            RHI_StructuredBuffer* counts                  = GetStructuredBuffer(Renderer_StructuredBuffer::IndirectCounts).get();
+            RecordRenderPass(cmd_list, pso, static_cast<uint32_t>(batches.size()), [&](RHI_CommandList* cmd_list, Cb_Pass& cb_pass, uint32_t draw_start, uint32_t draw_end)
             {
-                // Get renderable
-                shared_ptr<Renderable> renderable = entity->GetComponent<Renderable>();
-                if (!renderable)
-                    continue;
+                for (uint32_t i = draw_start; i < draw_end; i++)
+                {
+                    const Renderer_IndirectBatch& batch = batches[i];
+                    Material* material                  = batch.material;
 
-                // Get material
-                Material* material = renderable->GetMaterial();
-                if (!material)
-                    continue;
+                    // Bind geometry
+                    cmd_list->SetBufferIndex(batch.mesh->GetIndexBuffer());
+                    cmd_list->SetBufferVertex(batch.mesh->GetVertexBuffer());
 
-                // Get geometry
-                Mesh* mesh = renderable->GetMesh();
-                if (!mesh || !mesh->GetVertexBuffer() || !mesh->GetIndexBuffer())
-                    continue;
+                    // Bind alpha testing textures
+                    cmd_list->SetTexture(Renderer_BindingsSrv::material_albedo,  material->GetTexture(MaterialTexture::Color));
+                    cmd_list->SetTexture(Renderer_BindingsSrv::material_mask,    material->GetTexture(MaterialTexture::AlphaMask));
 
-                // Get transform
-                shared_ptr<Transform> transform = entity->GetTransform();
-                if (!transform)
-                    continue;
+                    // Set uber buffer, the first instance of every draw points at its instance
+                    cb_pass.instance_offset     = 0;
+                    cb_pass.alpha               = material->HasTexture(MaterialTexture::Color) ? 1.0f : 0.0f;
+                    cb_pass.is_transparent_pass = material->HasTexture(MaterialTexture::AlphaMask);
+                    UpdateConstantBufferPass(cmd_list, cb_pass);
 
-                // Skip objects outside of the view frustum
-                if (!GetCamera()->IsInViewFrustum(renderable))
-                    continue;
-            
-                // Bind geometry
-                if (currently_bound_geometry != mesh->GetObjectId())
-                {
-                    cmd_list->SetBufferIndex(mesh->GetIndexBuffer());
-                    cmd_list->SetBufferVertex(mesh->GetVertexBuffer());
-                    currently_bound_geometry = mesh->GetObjectId();
+                    // Draw
+                    cmd_list->DrawIndexedIndirectCount(args, batch.args_offset * rhi_draw_indexed_indirect_stride, counts, counts->GetOffset() + i * static_cast<uint32_t>(sizeof(uint32_t)), batch.draw_count_max);
                 }
+            });
+        }
+        else // Render, only what the camera sees
+        {
+            const vector<Renderer_DrawRecord>& draws = m_snapshot->camera.visible.draws_opaque;
+            RecordRenderPass(cmd_list, pso, static_cast<uint32_t>(draws.size()), [&](RHI_CommandList* cmd_list, Cb_Pass& cb_pass, uint32_t draw_start, uint32_t draw_end)
+            {
+                // Variables that help reduce state changes
+                uint64_t currently_bound_geometry = 0;
+                uint64_t currently_bound_material = 0;
 
-                // Bind alpha testing textures
-                cmd_list->SetTexture(Renderer_BindingsSrv::material_albedo,  material->GetTexture(MaterialTexture::Color));
-                cmd_list->SetTexture(Renderer_BindingsSrv::material_mask,    material->GetTexture(MaterialTexture::AlphaMask));
+                for (uint32_t i = draw_start; i < draw_end; i++)
+                {
+                    const Renderer_DrawRecord& draw = draws[i];
+                    Material* material              = draw.material;
+                    Mesh* mesh                      = draw.mesh;
 
-                // Set uber buffer
-                m_cb_pass_cpu.transform           = transform->GetMatrix();
-                m_cb_pass_cpu.alpha               = material->HasTexture(MaterialTexture::Color) ? 1.0f : 0.0f;
-                m_cb_pass_cpu.is_transparent_pass = material->HasTexture(MaterialTexture::AlphaMask);
-                UpdateConstantBufferPass(cmd_list);
-            
-                // Draw
-                cmd_list->DrawIndexed(renderable->GetIndexCount(), renderable->GetIndexOffset(), renderable->GetVertexOffset());
-            }
+                    // Bind geometry
+                    if (currently_bound_geometry != mesh->GetObjectId())
+                    {
+                        cmd_list->SetBufferIndex(mesh->GetIndexBuffer());
+                        cmd_list->SetBufferVertex(mesh->GetVertexBuffer());
+                        currently_bound_geometry = mesh->GetObjectId();
+                    }
 
-            cmd_list->EndRenderPass();
+                    // Bind alpha testing textures, opaques are sorted by material so they rarely change
+                    if (currently_bound_material != material->GetObjectId())
+                    {
+                        cmd_list->SetTexture(Renderer_BindingsSrv::material_albedo,  material->GetTexture(MaterialTexture::Color));
+                        cmd_list->SetTexture(Renderer_BindingsSrv::material_mask,    material->GetTexture(MaterialTexture::AlphaMask));
+                        currently_bound_material = material->GetObjectId();
+                    }
+
+                    // Set uber buffer
+                    cb_pass.instance_offset     = draw.instance_offset;
+                    cb_pass.alpha               = material->HasTexture(MaterialTexture::Color) ? 1.0f : 0.0f;
+                    cb_pass.is_transparent_pass = material->HasTexture(MaterialTexture::AlphaMask);
+                    UpdateConstantBufferPass(cmd_list, cb_pass);
+
+                    // Draw
+                    draw_indexed(cmd_list, draw, m_snapshot->camera.visible.clusters);
+                }
+            });
         }
 
         cmd_list->EndTimeblock();
@@ -589,80 +837,104 @@ namespace Spartan
         // Set pipeline state
         cmd_list->SetPipelineState(pso);
 
-        auto& entities = m_renderables[is_transparent_pass ? Renderer_Entity::Geometry_transparent : Renderer_Entity::Geometry_opaque];
-
-        // Render
-        cmd_list->BeginRenderPass();
+        // Render, the camera's opaques come from the arguments of the culling pass
+        if (m_indirect_culled && !is_transparent_pass)
         {
-            uint64_t bound_material_id = 0;
-
-            for (shared_ptr<Entity> entity : entities)
+            const vector<Renderer_IndirectBatch>& batches = m_snapshot->indirect_batches;
+            RHI_StructuredBuffer* args                    = GetStructuredBuffer(Renderer_StructuredBuffer::IndirectArgs).get();
+            RHI_StructuredBuffer* counts                  = GetStructuredBuffer(Renderer_StructuredBuffer::IndirectCounts).get();
+            RecordRenderPass(cmd_list, pso, static_cast<uint32_t>(batches.size()), [&](RHI_CommandList* cmd_list, Cb_Pass& cb_pass, uint32_t draw_start, uint32_t draw_end)
             {
-                // Get renderable
-                shared_ptr<Renderable> renderable = entity->GetComponent<Renderable>();
-                if (!renderable)
-                    continue;
+                uint64_t bound_material_id = 0;
 
-                // Get material
-                Material* material = renderable->GetMaterial();
-                if (!material)
-                    continue;
+                for (uint32_t i = draw_start; i < draw_end; i++)
+                {
+                    const Renderer_IndirectBatch& batch = batches[i];
+                    Material* material                  = batch.material;
 
-                // Get geometry
-                Mesh* mesh = renderable->GetMesh();
-                if (!mesh || !mesh->GetVertexBuffer() || !mesh->GetIndexBuffer())
-                    continue;
+                    // Set geometry (will only happen if not already set)
+                    cmd_list->SetBufferIndex(batch.mesh->GetIndexBuffer());
+                    cmd_list->SetBufferVertex(batch.mesh->GetVertexBuffer());
 
-                // Skip objects outside of the view frustum
-                if (!GetCamera()->IsInViewFrustum(renderable))
-                    continue;
+                    // Update material textures, batches are sorted by material so consecutive batches often share them
+                    if (bound_material_id != material->GetObjectId())
+                    {
+                        // Set textures
+                        cmd_list->SetTexture(Renderer_BindingsSrv::material_albedo,    material->GetTexture(MaterialTexture::Color));
+                        cmd_list->SetTexture(Renderer_BindingsSrv::material_roughness, material->GetTexture(MaterialTexture::Roughness));
+                        cmd_list->SetTexture(Renderer_BindingsSrv::material_metallic,  material->GetTexture(MaterialTexture::Metalness));
+                        cmd_list->SetTexture(Renderer_BindingsSrv::material_normal,    material->GetTexture(MaterialTexture::Normal));
+                        cmd_list->SetTexture(Renderer_BindingsSrv::material_height,    material->GetTexture(MaterialTexture::Height));
+                        cmd_list->SetTexture(Renderer_BindingsSrv::material_occlusion, material->GetTexture(MaterialTexture::Occlusion));
+                        cmd_list->SetTexture(Renderer_BindingsSrv::material_emission,  material->GetTexture(MaterialTexture::Emission));
+                        cmd_list->SetTexture(Renderer_BindingsSrv::material_mask,      material->GetTexture(MaterialTexture::AlphaMask));
+
+                        bound_material_id = material->GetObjectId();
+                    }
 
-                // Set geometry (will only happen if not already set)
-                cmd_list->SetBufferIndex(mesh->GetIndexBuffer());
-                cmd_list->SetBufferVertex(mesh->GetVertexBuffer());
+                    // Update uber buffer, the first instance of every draw points at its instance
+                    cb_pass.is_transparent_pass = 0;
+                    cb_pass.instance_offset     = 0;
+                    cb_pass.material_index      = batch.material_index;
+                    UpdateConstantBufferPass(cmd_list, cb_pass);
 
-                // Update material
-                if (bound_material_id != material->GetObjectId())
-                {
-                    // Set textures
-                    cmd_list->SetTexture(Renderer_BindingsSrv::material_albedo,    material->GetTexture(MaterialTexture::Color));
-                    cmd_list->SetTexture(Renderer_BindingsSrv::material_roughness, material->GetTexture(MaterialTexture::Roughness));
-                    cmd_list->SetTexture(Renderer_BindingsSrv::material_metallic,  material->GetTexture(MaterialTexture::Metalness));
-                    cmd_list->SetTexture(Renderer_BindingsSrv::material_normal,    material->GetTexture(MaterialTexture::Normal));
-                    cmd_list->SetTexture(Renderer_BindingsSrv::material_height,    material->GetTexture(MaterialTexture::Height));
-                    cmd_list->SetTexture(Renderer_BindingsSrv::material_occlusion, material->GetTexture(MaterialTexture::Occlusion));
-                    cmd_list->SetTexture(Renderer_BindingsSrv::material_emission,  material->GetTexture(MaterialTexture::Emission));
-                    cmd_list->SetTexture(Renderer_BindingsSrv::material_mask,      material->GetTexture(MaterialTexture::AlphaMask));
-
-                    // Set properties
-                    UpdateConstantBufferMaterial(cmd_list, material);
-
-                    bound_material_id = material->GetObjectId();
+                    // Render, how many meshes survived is only known on the gpu, see Profiler::m_renderer_draws_indirect_emitted
+                    cmd_list->DrawIndexedIndirectCount(args, batch.args_offset * rhi_draw_indexed_indirect_stride, counts, counts->GetOffset() + i * static_cast<uint32_t>(sizeof(uint32_t)), batch.draw_count_max);
                 }
+            });
+        }
+        else
+        {
+            // Render, only what the camera sees, in key order (by material for opaques, back to front for transparents)
+            const Renderer_SnapshotVisibility& visible = m_snapshot->camera.visible;
+            const vector<Renderer_DrawRecord>& draws   = is_transparent_pass ? visible.draws_transparent : visible.draws_opaque;
+            RecordRenderPass(cmd_list, pso, static_cast<uint32_t>(draws.size()), [&](RHI_CommandList* cmd_list, Cb_Pass& cb_pass, uint32_t draw_start, uint32_t draw_end)
+            {
+                uint64_t bound_material_id = 0;
 
-                // Update uber buffer
+                for (uint32_t i = draw_start; i < draw_end; i++)
                 {
-                    m_cb_pass_cpu.is_transparent_pass = is_transparent_pass ? 1 : 0;
+                    const Renderer_DrawRecord& draw = draws[i];
+                    Material* material              = draw.material;
 
-                    // Update transform
-                    if (shared_ptr<Transform> transform = entity->GetTransform())
-                    {
-                        m_cb_pass_cpu.transform = transform->GetMatrix();
-                        m_cb_pass_cpu.transform_previous = transform->GetMatrixPrevious();
+                    // Set geometry (will only happen if not already set)
+                    cmd_list->SetBufferIndex(draw.mesh->GetIndexBuffer());
+                    cmd_list->SetBufferVertex(draw.mesh->GetVertexBuffer());
 
-                        // Save matrix for velocity computation
-                        transform->SetMatrixPrevious(m_cb_pass_cpu.transform);
+                    // Update material textures
+                    if (bound_material_id != material->GetObjectId())
+                    {
+                        // Set textures
+                        cmd_list->SetTexture(Renderer_BindingsSrv::material_albedo,    material->GetTexture(MaterialTexture::Color));
+                        cmd_list->SetTexture(Renderer_BindingsSrv::material_roughness, material->GetTexture(MaterialTexture::Roughness));
+                        cmd_list->SetTexture(Renderer_BindingsSrv::material_metallic,  material->GetTexture(MaterialTexture::Metalness));
+                        cmd_list->SetTexture(Renderer_BindingsSrv::material_normal,    material->GetTexture(MaterialTexture::Normal));
+                        cmd_list->SetTexture(Renderer_BindingsSrv::material_height,    material->GetTexture(MaterialTexture::Height));
+                        cmd_list->SetTexture(Renderer_BindingsSrv::material_occlusion, material->GetTexture(MaterialTexture::Occlusion));
+                        cmd_list->SetTexture(Renderer_BindingsSrv::material_emission,  material->GetTexture(MaterialTexture::Emission));
+                        cmd_list->SetTexture(Renderer_BindingsSrv::material_mask,      material->GetTexture(MaterialTexture::AlphaMask));
+
+                        bound_material_id = material->GetObjectId();
                     }
 
-                    UpdateConstantBufferPass(cmd_list);
-                }
+                    // Update uber buffer
+                    {
+                        cb_pass.is_transparent_pass = is_transparent_pass ? 1 : 0;
 
-                // Render
-                cmd_list->DrawIndexed(renderable->GetIndexCount(), renderable->GetIndexOffset(), renderable->GetVertexOffset());
-                Profiler::m_renderer_meshes_rendered++;
-            }
+                        // The transforms come from the instances (the previous ones are saved when the snapshot is built)
+                        cb_pass.instance_offset = draw.instance_offset;
 
-            cmd_list->EndRenderPass();
+                        // The properties come from the material table
+                        cb_pass.material_index = draw.material_index;
+
+                        UpdateConstantBufferPass(cmd_list, cb_pass);
+                    }
+
+                    // Render
+                    draw_indexed(cmd_list, draw, visible.clusters);
+                    Profiler::m_renderer_meshes_rendered += draw.instance_count;
+                }
+            });
         }
 
         cmd_list->EndTimeblock();
@@ -766,6 +1038,52 @@ namespace Spartan
         cmd_list->EndTimeblock();
     }
 
+    void Renderer::Pass_Light_Cull(RHI_CommandList* cmd_list)
+    {
+        // Acquire shader
+        RHI_Shader* shader_c = GetShader(Renderer_Shader::light_cull_c).get();
+        if (!shader_c->IsCompiled())
+            return;
+
+        const uint32_t light_count = static_cast<uint32_t>(m_snapshot->lights.size());
+        if (light_count == 0)
+            return;
+
+        cmd_list->BeginTimeblock("light_cull");
+
+        RHI_StructuredBuffer* counts  = GetStructuredBuffer(Renderer_StructuredBuffer::LightClusterCounts).get();
+        RHI_StructuredBuffer* indices = GetStructuredBuffer(Renderer_StructuredBuffer::LightClusterIndices).get();
+
+        // The clusters could still be read by the previous frame's light pass
+        cmd_list->InsertBarrierStructuredBuffer(counts);
+        cmd_list->InsertBarrierStructuredBuffer(indices);
+
+        // Define pipeline state
+        static RHI_PipelineState pso;
+        pso.shader_compute = shader_c;
+
+        // Set pipeline state
+        cmd_list->SetPipelineState(pso);
+
+        // Set structured buffers
+        cmd_list->SetStructuredBuffer(Renderer_BindingsSrv::lights,                GetStructuredBuffer(Renderer_StructuredBuffer::Lights));
+        cmd_list->SetStructuredBuffer(Renderer_BindingsUav::light_cluster_counts,  GetStructuredBuffer(Renderer_StructuredBuffer::LightClusterCounts));
+        cmd_list->SetStructuredBuffer(Renderer_BindingsUav::light_cluster_indices, GetStructuredBuffer(Renderer_StructuredBuffer::LightClusterIndices));
+
+        // Set uber buffer, the clusters are built from the frame buffer's camera
+        m_cb_pass_cpu.light_count = light_count;
+        UpdateConstantBufferPass(cmd_list);
+
+        // Render
+        cmd_list->Dispatch((renderer_light_cluster_count + 63) / 64, 1); // 64 threads per group, one per cluster, see light_cull.hlsl
+
+        // The light pass reads the clusters
+        cmd_list->InsertBarrierStructuredBuffer(counts);
+        cmd_list->InsertBarrierStructuredBuffer(indices);
+
+        cmd_list->EndTimeblock();
+    }
+
     void Renderer::Pass_Light(RHI_CommandList* cmd_list, const bool is_transparent_pass)
     {
         // Acquire shaders
@@ -774,8 +1092,8 @@ namespace Spartan
             return;
 
         // Acquire lights
-        const vector<shared_ptr<Entity>>& entities = m_renderables[Renderer_Entity::Light];
-        if (entities.empty())
+        const vector<Renderer_SnapshotLight>& lights = m_snapshot->lights;
+        if (lights.empty())
             return;
 
         cmd_list->BeginTimeblock(is_transparent_pass ? "light_transparent" : "light");
@@ -797,58 +1115,45 @@ namespace Spartan
         // Set pipeline state
         cmd_list->SetPipelineState(pso);
 
-        // Iterate through all the light entities
-        for (shared_ptr<Entity> entity : entities)
+        // Set textures
+        cmd_list->SetTexture(Renderer_BindingsUav::tex,                tex_diffuse);
+        cmd_list->SetTexture(Renderer_BindingsUav::tex2,               tex_specular);
+        cmd_list->SetTexture(Renderer_BindingsUav::tex3,               tex_volumetric);
+        cmd_list->SetTexture(Renderer_BindingsSrv::gbuffer_albedo,     GetRenderTarget(Renderer_RenderTexture::gbuffer_albedo));
+        cmd_list->SetTexture(Renderer_BindingsSrv::gbuffer_normal,     GetRenderTarget(Renderer_RenderTexture::gbuffer_normal));
+        cmd_list->SetTexture(Renderer_BindingsSrv::gbuffer_material,   GetRenderTarget(Renderer_RenderTexture::gbuffer_material));
+        cmd_list->SetTexture(Renderer_BindingsSrv::gbuffer_material_2, GetRenderTarget(Renderer_RenderTexture::gbuffer_material_2));
+        cmd_list->SetTexture(Renderer_BindingsSrv::gbuffer_depth,      GetRenderTarget(Renderer_RenderTexture::gbuffer_depth));
+        cmd_list->SetTexture(Renderer_BindingsSrv::ssgi,               GetRenderTarget(Renderer_RenderTexture::ssgi));
+
+        // Set shadow maps
         {
-            if (shared_ptr<Light> light = entity->GetComponent<Light>())
-            {
-                // Do the lighting even when intensity is zero, since we can have emissive lighting.
-                cmd_list->SetTexture(Renderer_BindingsUav::tex,                tex_diffuse);
-                cmd_list->SetTexture(Renderer_BindingsUav::tex2,               tex_specular);
-                cmd_list->SetTexture(Renderer_BindingsUav::tex3,               tex_volumetric);
-                cmd_list->SetTexture(Renderer_BindingsSrv::gbuffer_albedo,     GetRenderTarget(Renderer_RenderTexture::gbuffer_albedo));
-                cmd_list->SetTexture(Renderer_BindingsSrv::gbuffer_normal,     GetRenderTarget(Renderer_RenderTexture::gbuffer_normal));
-                cmd_list->SetTexture(Renderer_BindingsSrv::gbuffer_material,   GetRenderTarget(Renderer_RenderTexture::gbuffer_material));
-                cmd_list->SetTexture(Renderer_BindingsSrv::gbuffer_material_2, GetRenderTarget(Renderer_RenderTexture::gbuffer_material_2));
-                cmd_list->SetTexture(Renderer_BindingsSrv::gbuffer_depth,      GetRenderTarget(Renderer_RenderTexture::gbuffer_depth));
-                cmd_list->SetTexture(Renderer_BindingsSrv::ssgi,               GetRenderTarget(Renderer_RenderTexture::ssgi));
-                
-                // Set shadow maps
-                {
-                    // We always bind all the shadow maps, regardless of the light type or if shadows are enabled.
-                    // This is because we are using an uber shader and APIs like Vulkan, expect all texture slots to be bound with something.
+            // We always bind all the shadow maps, regardless of whether there are lights which use them.
+            // This is because we are using an uber shader and APIs like Vulkan, expect all texture slots to be bound with something.
+
+            // The directional shadow maps only exist once a directional light has shadows
+            RHI_Texture* tex_directional_depth = GetRenderTarget(Renderer_RenderTexture::shadow_directional_depth).get();
+            RHI_Texture* tex_directional_color = GetRenderTarget(Renderer_RenderTexture::shadow_directional_color).get();
+            tex_directional_color              = tex_directional_color ? tex_directional_color : GetStandardTexture(Renderer_StandardTexture::White).get();
+
+            cmd_list->SetTexture(Renderer_BindingsSrv::light_directional_depth, tex_directional_depth);
+            cmd_list->SetTexture(Renderer_BindingsSrv::light_directional_color, tex_directional_color);
+            cmd_list->SetTexture(Renderer_BindingsSrv::light_local_depth,       GetRenderTarget(Renderer_RenderTexture::shadow_local_depth));
+            cmd_list->SetTexture(Renderer_BindingsSrv::light_local_color,       GetRenderTarget(Renderer_RenderTexture::shadow_local_color));
+        }
 
-                    RHI_Texture* tex_depth = light->GetDepthTexture();
-                    RHI_Texture* tex_color = light->GetShadowsTransparentEnabled() ? light->GetColorTexture() : GetStandardTexture(Renderer_StandardTexture::White).get();
+        // Set structured buffers, every pixel goes through the lights of its cluster
+        cmd_list->SetStructuredBuffer(Renderer_BindingsSrv::lights,                GetStructuredBuffer(Renderer_StructuredBuffer::Lights));
+        cmd_list->SetStructuredBuffer(Renderer_BindingsSrv::light_cluster_counts,  GetStructuredBuffer(Renderer_StructuredBuffer::LightClusterCounts));
+        cmd_list->SetStructuredBuffer(Renderer_BindingsSrv::light_cluster_indices, GetStructuredBuffer(Renderer_StructuredBuffer::LightClusterIndices));
 
-                    if (light->GetLightType() == LightType::Directional)
-                    {
-                        cmd_list->SetTexture(Renderer_BindingsSrv::light_directional_depth, tex_depth);
-                        cmd_list->SetTexture(Renderer_BindingsSrv::light_directional_color, tex_color);
-                    }
-                    else if (light->GetLightType() == LightType::Point)
-                    {
-                        cmd_list->SetTexture(Renderer_BindingsSrv::light_point_depth, tex_depth);
-                        cmd_list->SetTexture(Renderer_BindingsSrv::light_point_color, tex_color);
-                    }
-                    else if (light->GetLightType() == LightType::Spot)
-                    {
-                        cmd_list->SetTexture(Renderer_BindingsSrv::light_spot_depth, tex_depth);
-                        cmd_list->SetTexture(Renderer_BindingsSrv::light_spot_color, tex_color);
-                    }
-                }
-                
-                // Update light buffer
-                UpdateConstantBufferLight(cmd_list, light, RHI_Shader_Compute);
-                
-                // Set uber buffer
-                m_cb_pass_cpu.resolution_rt       = Vector2(static_cast<float>(tex_diffuse->GetWidth()), static_cast<float>(tex_diffuse->GetHeight()));
-                m_cb_pass_cpu.is_transparent_pass = is_transparent_pass;
-                UpdateConstantBufferPass(cmd_list);
-                
-                cmd_list->Dispatch(thread_group_count_x(tex_diffuse), thread_group_count_y(tex_diffuse));
-            }
-        }
+        // Set uber buffer
+        m_cb_pass_cpu.resolution_rt       = Vector2(static_cast<float>(tex_diffuse->GetWidth()), static_cast<float>(tex_diffuse->GetHeight()));
+        m_cb_pass_cpu.is_transparent_pass = is_transparent_pass;
+        UpdateConstantBufferPass(cmd_list);
+
+        // Do the lighting even when the lights have an intensity of zero, since we can have emissive lighting.
+        cmd_list->Dispatch(thread_group_count_x(tex_diffuse), thread_group_count_y(tex_diffuse));
 
         cmd_list->EndTimeblock();
     }
@@ -876,12 +1181,11 @@ namespace Spartan
 
         // Update light buffer with the directional light
         {
-            const vector<shared_ptr<Entity>>& entities = m_renderables[Renderer_Entity::Light];
-            for (shared_ptr<Entity> entity : entities)
+            for (const Renderer_SnapshotLight& light : m_snapshot->lights)
             {
-                if (entity->GetComponent<Light>()->GetLightType() == LightType::Directional)
+                if (light.IsDirectional())
                 {
-                    UpdateConstantBufferLight(cmd_list, entity->GetComponent<Light>(), RHI_Shader_Compute);
+                    UpdateConstantBufferLight(cmd_list, light, RHI_Shader_Compute);
                     break;
                 }
             }
@@ -917,7 +1221,7 @@ namespace Spartan
         cmd_list->BeginTimeblock(is_transparent_pass ? "light_image_based_transparent" : "light_image_based");
 
         // Get reflection probe entities
-        const vector<shared_ptr<Entity>>& probes = m_renderables[Renderer_Entity::Reflection_probe];
+        const vector<Renderer_SnapshotReflectionProbe>& probes = m_snapshot->reflection_probes;
 
         // Define pipeline state
         static RHI_PipelineState pso;
@@ -947,11 +1251,11 @@ namespace Spartan
         // Set probe textures and data
         if (!probes.empty())
         {
-            shared_ptr<ReflectionProbe> probe = probes[0]->GetComponent<ReflectionProbe>();
+            const Renderer_SnapshotReflectionProbe& probe = probes[0];
 
-            cmd_list->SetTexture(Renderer_BindingsSrv::reflection_probe, probe->GetColorTexture());
-            m_cb_pass_cpu.extents  = probe->GetExtents();
-            m_cb_pass_cpu.position = probe->GetTransform()->GetPosition();
+            cmd_list->SetTexture(Renderer_BindingsSrv::reflection_probe, probe.probe->GetColorTexture());
+            m_cb_pass_cpu.extents  = probe.extents;
+            m_cb_pass_cpu.position = probe.position;
         }
 
         // Set uber buffer
@@ -962,12 +1266,11 @@ namespace Spartan
 
         // Update light buffer with the directional light
         {
-            const vector<shared_ptr<Entity>>& entities = m_renderables[Renderer_Entity::Light];
-            for (shared_ptr<Entity> entity : entities)
+            for (const Renderer_SnapshotLight& light : m_snapshot->lights)
             {
-                if (entity->GetComponent<Light>()->GetLightType() == LightType::Directional)
+                if (light.IsDirectional())
                 {
-                    UpdateConstantBufferLight(cmd_list, entity->GetComponent<Light>(), RHI_Shader_Pixel);
+                    UpdateConstantBufferLight(cmd_list, light, RHI_Shader_Pixel);
                     break;
                 }
             }
@@ -1677,8 +1980,8 @@ namespace Spartan
 
         // Update counter
         uint32_t counter_value = 0;
-        GetStructuredBuffer()->Update(&counter_value);
-        cmd_list->SetStructuredBuffer(Renderer_BindingsUav::atomic_counter, GetStructuredBuffer());
+        GetStructuredBuffer(Renderer_StructuredBuffer::SpdCounter)->Update(&counter_value);
+        cmd_list->SetStructuredBuffer(Renderer_BindingsUav::atomic_counter, GetStructuredBuffer(Renderer_StructuredBuffer::SpdCounter));
 
         // Set textures
         cmd_list->SetTexture(Renderer_BindingsSrv::tex, tex, 0, 1);                            // top mip
@@ -1702,7 +2005,7 @@ namespace Spartan
             GetRenderTarget(Renderer_RenderTexture::fsr2_mask_reactive).get(),
             GetRenderTarget(Renderer_RenderTexture::fsr2_mask_transparency).get(),
             tex_out,
-            GetCamera().get(),
+            m_snapshot->camera.camera.get(),
             m_cb_frame_cpu.delta_time,
             GetOption<float>(Renderer_Option::Sharpness)
         );
@@ -1722,8 +2025,8 @@ namespace Spartan
             return;
 
         // Acquire entities
-        auto& lights = m_renderables[Renderer_Entity::Light];
-        if (lights.empty() || !GetCamera())
+        const vector<Renderer_SnapshotLight>& lights = m_snapshot->lights;
+        if (lights.empty() || !m_snapshot->has_camera)
             return;
 
         cmd_list->BeginTimeblock("icons");
@@ -1744,56 +2047,52 @@ namespace Spartan
         bool render_pass_started = false;
 
         // For each light
-        for (shared_ptr<Entity> entity : lights)
+        for (const Renderer_SnapshotLight& light : lights)
         {
-            // Light can be null if it just got removed and our buffer doesn't update till the next frame
-            if (shared_ptr<Light> light = entity->GetComponent<Light>())
-            {
-                const Vector3 pos_world        = entity->GetTransform()->GetPosition();
-                const Vector3 pos_world_camera = GetCamera()->GetTransform()->GetPosition();
-                const Vector3 camera_to_light  = (pos_world - pos_world_camera).Normalized();
-                const float v_dot_l            = Vector3::Dot(GetCamera()->GetTransform()->GetForward(), camera_to_light);
+            const Vector3 pos_world        = light.position;
+            const Vector3 pos_world_camera = m_snapshot->camera.position;
+            const Vector3 camera_to_light  = (pos_world - pos_world_camera).Normalized();
+            const float v_dot_l            = Vector3::Dot(m_snapshot->camera.forward, camera_to_light);
 
-                // Only draw if it's inside our view
-                if (v_dot_l > 0.5f)
+            // Only draw if it's inside our view
+            if (v_dot_l > 0.5f)
+            {
+                if (!render_pass_started)
                 {
-                    if (!render_pass_started)
-                    {
-                        cmd_list->BeginRenderPass();
-                        render_pass_started = true;
-                    }
-
-                    // Get the texture
-                    RHI_Texture* texture = nullptr;
-                    if (light->GetLightType() == LightType::Directional) texture = GetStandardTexture(Renderer_StandardTexture::Gizmo_light_directional).get();
-                    else if (light->GetLightType() == LightType::Point)  texture = GetStandardTexture(Renderer_StandardTexture::Gizmo_light_point).get();
-                    else if (light->GetLightType() == LightType::Spot)   texture = GetStandardTexture(Renderer_StandardTexture::Gizmo_light_spot).get();
+                    cmd_list->BeginRenderPass();
+                    render_pass_started = true;
+                }
 
-                    // Compute transform
-                    {
-                        // Use the distance from the camera to scale the icon, this will
-                        // cancel out perspective scaling, hence keeping the icon scale constant.
-                        const float distance = (pos_world_camera - pos_world).Length();
-                        const float scale    = distance * 0.04f;
+                // Get the texture
+                RHI_Texture* texture = nullptr;
+                if (light.IsDirectional()) texture = GetStandardTexture(Renderer_StandardTexture::Gizmo_light_directional).get();
+                else if (light.IsPoint())  texture = GetStandardTexture(Renderer_StandardTexture::Gizmo_light_point).get();
+                else if (light.IsSpot())   texture = GetStandardTexture(Renderer_StandardTexture::Gizmo_light_spot).get();
 
-                        // 1st rotation: The quad's normal is parallel to the world's Y axis, so we rotate to make it camera facing.
-                        Quaternion rotation_reorient_quad = Quaternion::FromEulerAngles(-90.0f, 0.0f, 0.0f);
-                        // 2nd rotation: Rotate the camera facing quad with the camera, so that it remains a camera facing quad.
-                        Quaternion rotation_camera_billboard = Quaternion::FromLookRotation(pos_world - pos_world_camera);
+                // Compute transform
+                {
+                    // Use the distance from the camera to scale the icon, this will
+                    // cancel out perspective scaling, hence keeping the icon scale constant.
+                    const float distance = (pos_world_camera - pos_world).Length();
+                    const float scale    = distance * 0.04f;
 
-                        Matrix transform = Matrix(pos_world, rotation_camera_billboard * rotation_reorient_quad, scale);
+                    // 1st rotation: The quad's normal is parallel to the world's Y axis, so we rotate to make it camera facing.
+                    Quaternion rotation_reorient_quad = Quaternion::FromEulerAngles(-90.0f, 0.0f, 0.0f);
+                    // 2nd rotation: Rotate the camera facing quad with the camera, so that it remains a camera facing quad.
+                    Quaternion rotation_camera_billboard = Quaternion::FromLookRotation(pos_world - pos_world_camera);
 
-                        // Update transform
-                        m_cb_pass_cpu.transform = transform * m_cb_frame_cpu.view_projection;
-                        UpdateConstantBufferPass(cmd_list);
-                    }
+                    Matrix transform = Matrix(pos_world, rotation_camera_billboard * rotation_reorient_quad, scale);
 
-                    // Draw rectangle
-                    cmd_list->SetTexture(Renderer_BindingsSrv::tex, texture);
-                    cmd_list->SetBufferVertex(GetStandardMesh(Renderer_StandardMesh::Quad)->GetVertexBuffer());
-                    cmd_list->SetBufferIndex(GetStandardMesh(Renderer_StandardMesh::Quad)->GetIndexBuffer());
-                    cmd_list->DrawIndexed(6);
+                    // Update transform
+                    m_cb_pass_cpu.transform = transform * m_cb_frame_cpu.view_projection;
+                    UpdateConstantBufferPass(cmd_list);
                 }
+
+                // Draw rectangle
+                cmd_list->SetTexture(Renderer_BindingsSrv::tex, texture);
+                cmd_list->SetBufferVertex(GetStandardMesh(Renderer_StandardMesh::Quad)->GetVertexBuffer());
+                cmd_list->SetBufferIndex(GetStandardMesh(Renderer_StandardMesh::Quad)->GetIndexBuffer());
+                cmd_list->DrawIndexed(6);
             }
         }
 
@@ -1848,9 +2147,9 @@ namespace Spartan
             {
                 // Set uber buffer
                 m_cb_pass_cpu.resolution_rt = GetResolutionRender();
-                if (GetCamera())
+                if (m_snapshot->has_camera)
                 {
-                    m_cb_pass_cpu.transform = m_world_grid->ComputeWorldMatrix(GetCamera()->GetTransform()) * m_cb_frame_cpu.view_projection_unjittered;
+                    m_cb_pass_cpu.transform = m_snapshot->grid_transform * m_cb_frame_cpu.view_projection_unjittered;
                 }
                 UpdateConstantBufferPass(cmd_list);
 
@@ -1863,12 +2162,15 @@ namespace Spartan
         }
 
         // Draw lines
-        const bool draw_lines_depth_off = m_lines_index_depth_off != numeric_limits<uint32_t>::max();
-        const bool draw_lines_depth_on  = m_lines_index_depth_on > ((m_line_vertices.size() / 2) - 1);
+        const vector<RHI_Vertex_PosCol>& line_vertices = m_snapshot->line_vertices;
+        const uint32_t lines_index_depth_off           = m_snapshot->lines_index_depth_off;
+        const uint32_t lines_index_depth_on            = m_snapshot->lines_index_depth_on;
+        const bool draw_lines_depth_off                = lines_index_depth_off != numeric_limits<uint32_t>::max();
+        const bool draw_lines_depth_on                 = lines_index_depth_on > ((line_vertices.size() / 2) - 1);
         if (draw_lines_depth_off || draw_lines_depth_on)
         {
             // Grow vertex buffer (if needed)
-            uint32_t vertex_count = static_cast<uint32_t>(m_line_vertices.size());
+            uint32_t vertex_count = static_cast<uint32_t>(line_vertices.size());
             if (vertex_count > m_vertex_buffer_lines->GetVertexCount())
             {
                 m_vertex_buffer_lines->CreateDynamic<RHI_Vertex_PosCol>(vertex_count);
@@ -1879,7 +2181,7 @@ namespace Spartan
             {
                 // Update vertex buffer
                 RHI_Vertex_PosCol* buffer = static_cast<RHI_Vertex_PosCol*>(m_vertex_buffer_lines->Map());
-                copy(m_line_vertices.begin(), m_line_vertices.end(), buffer);
+                copy(line_vertices.begin(), line_vertices.end(), buffer);
                 m_vertex_buffer_lines->Unmap();
 
                 // Define pipeline state
@@ -1908,7 +2210,7 @@ namespace Spartan
                     cmd_list->BeginRenderPass();
                     {
                         cmd_list->SetBufferVertex(m_vertex_buffer_lines.get());
-                        cmd_list->Draw(m_lines_index_depth_off + 1); 
+                        cmd_list->Draw(lines_index_depth_off + 1); 
                     }
                     cmd_list->EndRenderPass();
 
@@ -1916,7 +2218,7 @@ namespace Spartan
                 }
 
                 // Depth on
-                if (m_lines_index_depth_on > (vertex_count / 2) - 1)
+                if (lines_index_depth_on > (vertex_count / 2) - 1)
                 {
                     cmd_list->BeginMarker("depth_on");
 
@@ -1932,7 +2234,7 @@ namespace Spartan
                     cmd_list->BeginRenderPass();
                     {
                         cmd_list->SetBufferVertex(m_vertex_buffer_lines.get());
-                        cmd_list->Draw((m_lines_index_depth_on - (vertex_count / 2)) + 1, vertex_count / 2);
+                        cmd_list->Draw((lines_index_depth_on - (vertex_count / 2)) + 1, vertex_count / 2);
                     }
                     cmd_list->EndRenderPass();
 
@@ -1961,7 +2263,7 @@ namespace Spartan
             return;
 
         // Get reflection probe entities
-        const vector<shared_ptr<Entity>>& probes = m_renderables[Renderer_Entity::Reflection_probe];
+        const vector<Renderer_SnapshotReflectionProbe>& probes = m_snapshot->reflection_probes;
         if (probes.empty())
             return;
 
@@ -1987,21 +2289,14 @@ namespace Spartan
             cmd_list->SetBufferVertex(GetStandardMesh(Renderer_StandardMesh::Sphere)->GetVertexBuffer());
             cmd_list->SetBufferIndex(GetStandardMesh(Renderer_StandardMesh::Sphere)->GetIndexBuffer());
 
-            for (uint32_t probe_index = 0; probe_index < static_cast<uint32_t>(probes.size()); probe_index++)
+            for (const Renderer_SnapshotReflectionProbe& probe : probes)
             {
-                if (shared_ptr<ReflectionProbe> probe = probes[probe_index]->GetComponent<ReflectionProbe>())
-                {
-                    // Set uber buffer
-                    m_cb_pass_cpu.transform = probe->GetTransform()->GetMatrix();
-                    UpdateConstantBufferPass(cmd_list);
-
-                    cmd_list->SetTexture(Renderer_BindingsSrv::reflection_probe, probe->GetColorTexture());
-                    cmd_list->DrawIndexed(GetStandardMesh(Renderer_StandardMesh::Sphere)->GetIndexCount());
+                // Set uber buffer
+                m_cb_pass_cpu.transform = probe.transform;
+                UpdateConstantBufferPass(cmd_list);
 
-                    // Draw a box which represents the extents of the reflection probe (which is used as a geometry proxy for parallax corrected cubemap reflections)
-                    BoundingBox extents = BoundingBox(probe->GetTransform()->GetPosition() - probe->GetExtents(), probe->GetTransform()->GetPosition() + probe->GetExtents());
-                    DrawBox(extents);
-                }
+                cmd_list->SetTexture(Renderer_BindingsSrv::reflection_probe, probe.probe->GetColorTexture());
+                cmd_list->DrawIndexed(GetStandardMesh(Renderer_StandardMesh::Sphere)->GetIndexCount());
             }
         }
         cmd_list->EndRenderPass();
@@ -2021,87 +2316,85 @@ namespace Spartan
         if (!shader_v->IsCompiled() || !shader_p->IsCompiled() || !shader_c->IsCompiled())
             return;
 
-        if (shared_ptr<Camera> camera = Renderer::GetCamera())
+        const Renderer_SnapshotRenderable& selected = m_snapshot->selected;
+        if (selected.entity)
         {
-            if (shared_ptr<Entity> entity_selected = camera->GetSelectedEntity())
+            cmd_list->BeginTimeblock("outline");
             {
-                cmd_list->BeginTimeblock("outline");
-                {
-                    RHI_Texture* tex_outline = GetRenderTarget(Renderer_RenderTexture::outline).get();
-                    static const Color clear_color = Color(0.0f, 0.0f, 0.0f, 0.0f);
+                RHI_Texture* tex_outline = GetRenderTarget(Renderer_RenderTexture::outline).get();
+                static const Color clear_color = Color(0.0f, 0.0f, 0.0f, 0.0f);
 
-                    if (shared_ptr<Renderable> renderable = entity_selected->GetComponent<Renderable>())
+                if (Renderable* renderable = selected.renderable.get())
+                {
+                    if (Mesh* mesh = renderable->GetMesh())
                     {
-                        if (Mesh* mesh = renderable->GetMesh())
+                        if (mesh->GetVertexBuffer() && mesh->GetIndexBuffer())
                         {
-                            if (mesh->GetVertexBuffer() && mesh->GetIndexBuffer())
+                            cmd_list->BeginMarker("color_silhouette");
                             {
-                                cmd_list->BeginMarker("color_silhouette");
+                                // Define render state
+                                static RHI_PipelineState pso;
+                                pso.shader_vertex                   = shader_v;
+                                pso.shader_pixel                    = shader_p;
+                                pso.rasterizer_state                = GetRasterizerState(Renderer_RasterizerState::Solid_cull_back).get();
+                                pso.blend_state                     = GetBlendState(Renderer_BlendState::Disabled).get();
+                                pso.depth_stencil_state             = GetDepthStencilState(Renderer_DepthStencilState::Off).get();
+                                pso.render_target_color_textures[0] = tex_outline;
+                                pso.clear_color[0]                  = clear_color;
+                                pso.primitive_topology              = RHI_PrimitiveTopology_Mode::TriangleList;
+
+                                // Set pipeline state
+                                cmd_list->SetPipelineState(pso);
+
+                                // Render
+                                cmd_list->BeginRenderPass();
                                 {
-                                    // Define render state
-                                    static RHI_PipelineState pso;
-                                    pso.shader_vertex                   = shader_v;
-                                    pso.shader_pixel                    = shader_p;
-                                    pso.rasterizer_state                = GetRasterizerState(Renderer_RasterizerState::Solid_cull_back).get();
-                                    pso.blend_state                     = GetBlendState(Renderer_BlendState::Disabled).get();
-                                    pso.depth_stencil_state             = GetDepthStencilState(Renderer_DepthStencilState::Off).get();
-                                    pso.render_target_color_textures[0] = tex_outline;
-                                    pso.clear_color[0]                  = clear_color;
-                                    pso.primitive_topology              = RHI_PrimitiveTopology_Mode::TriangleList;
-
-                                    // Set pipeline state
-                                    cmd_list->SetPipelineState(pso);
-
-                                    // Render
-                                    cmd_list->BeginRenderPass();
-                                    {
-                                        // Set uber buffer with entity transform
-                                        m_cb_pass_cpu.transform = entity_selected->GetTransform()->GetMatrix() * m_cb_frame_cpu.view_projection_unjittered;
-                                        UpdateConstantBufferPass(cmd_list);
-
-                                        cmd_list->SetBufferVertex(mesh->GetVertexBuffer());
-                                        cmd_list->SetBufferIndex(mesh->GetIndexBuffer());
-                                        cmd_list->DrawIndexed(renderable->GetIndexCount(), renderable->GetIndexOffset(), renderable->GetVertexOffset());
-                                        cmd_list->EndRenderPass();
-                                    }
-                                }
-                                cmd_list->EndMarker();
+                                    // Set uber buffer with entity transform
+                                    m_cb_pass_cpu.transform = selected.transform * m_cb_frame_cpu.view_projection_unjittered;
+                                    UpdateConstantBufferPass(cmd_list);
 
-                                // Blur the color silhouette
-                                {
-                                    const bool depth_aware = false;
-                                    const float radius     = 30.0f;
-                                    const float sigma      = 32.0f;
-                                    Pass_Blur_Gaussian(cmd_list, tex_outline, depth_aware, radius, sigma);
+                                    cmd_list->SetBufferVertex(mesh->GetVertexBuffer());
+                                    cmd_list->SetBufferIndex(mesh->GetIndexBuffer());
+                                    cmd_list->DrawIndexed(renderable->GetIndexCount(), renderable->GetIndexOffset(), renderable->GetVertexOffset());
+                                    cmd_list->EndRenderPass();
                                 }
+                            }
+                            cmd_list->EndMarker();
 
-                                // Combine color silhouette with frame
-                                cmd_list->BeginMarker("composition");
-                                {
-                                    static RHI_PipelineState pso;
-                                    pso.shader_compute = shader_c;
+                            // Blur the color silhouette
+                            {
+                                const bool depth_aware = false;
+                                const float radius     = 30.0f;
+                                const float sigma      = 32.0f;
+                                Pass_Blur_Gaussian(cmd_list, tex_outline, depth_aware, radius, sigma);
+                            }
 
-                                    // Set pipeline state
-                                    cmd_list->SetPipelineState(pso);
+                            // Combine color silhouette with frame
+                            cmd_list->BeginMarker("composition");
+                            {
+                                static RHI_PipelineState pso;
+                                pso.shader_compute = shader_c;
 
-                                    // Set uber buffer
-                                    m_cb_pass_cpu.resolution_rt = Vector2(static_cast<float>(tex_out->GetWidth()), static_cast<float>(tex_out->GetHeight()));
-                                    UpdateConstantBufferPass(cmd_list);
+                                // Set pipeline state
+                                cmd_list->SetPipelineState(pso);
+
+                                // Set uber buffer
+                                m_cb_pass_cpu.resolution_rt = Vector2(static_cast<float>(tex_out->GetWidth()), static_cast<float>(tex_out->GetHeight()));
+                                UpdateConstantBufferPass(cmd_list);
 
-                                    // Set textures
-                                    cmd_list->SetTexture(Renderer_BindingsUav::tex, tex_out);
-                                    cmd_list->SetTexture(Renderer_BindingsSrv::tex, tex_outline);
+                                // Set textures
+                                cmd_list->SetTexture(Renderer_BindingsUav::tex, tex_out);
+                                cmd_list->SetTexture(Renderer_BindingsSrv::tex, tex_outline);
 
-                                    // Render
-                                    cmd_list->Dispatch(thread_group_count_x(tex_out), thread_group_count_y(tex_out));
-                                }
-                                cmd_list->EndMarker();
+                                // Render
+                                cmd_list->Dispatch(thread_group_count_x(tex_out), thread_group_count_y(tex_out));
                             }
+                            cmd_list->EndMarker();
                         }
                     }
                 }
-                cmd_list->EndTimeblock();
             }
+            cmd_list->EndTimeblock();
         }
     }
 
@@ -19,7 +19,7 @@ IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
 CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
-//= INCLUDES ==============================
+//= INCLUDES ===================================
 #include "pch.h"
 #include "Renderer.h"
 #include "../World/Components/Camera.h"
@@ -27,8 +27,9 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../World/Components/Light.h"
 #include "../World/Entity.h"
 #include "../World/Components/Renderable.h"
+#include "../World/Components/ReflectionProbe.h"
 #include "../RHI/RHI_Vertex.h"
-//=========================================
+//==============================================
 
 //= NAMESPACES ===============
 using namespace std;
@@ -341,6 +342,19 @@ namespace Spartan
             }
         }
         
+        // Reflection probe extents (used as a geometry proxy for parallax corrected cubemap reflections)
+        if (GetOption<bool>(Renderer_Option::Debug_ReflectionProbes))
+        {
+            for (const auto& entity : GetEntities()[Renderer_Entity::Reflection_probe])
+            {
+                if (shared_ptr<ReflectionProbe> probe = entity->GetComponent<ReflectionProbe>())
+                {
+                    const Vector3 position = probe->GetTransform()->GetPosition();
+                    DrawBox(BoundingBox(position - probe->GetExtents(), position + probe->GetExtents()));
+                }
+            }
+        }
+
         // AABBs
         if (GetOption<bool>(Renderer_Option::Debug_Aabb))
         {
@@ -37,6 +37,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../RHI/RHI_VertexBuffer.h"
 #include "../RHI/RHI_FSR2.h"
 #include "../RHI/RHI_Device.h"
+#include "../RHI/RHI_CommandList.h"
+#include "../Profiling/Profiler.h"
 //=======================================
 
 //= NAMESPACES ===============
@@ -54,11 +56,19 @@ namespace Spartan
         static array<shared_ptr<RHI_BlendState>, 3>        m_blend_states;
 
         // renderer resources
-        static array<shared_ptr<RHI_Texture>, 26>       m_render_targets;
-        static array<shared_ptr<RHI_Shader>, 44>        m_shaders;
+        static array<shared_ptr<RHI_Texture>, 31>       m_render_targets;
+        static array<shared_ptr<RHI_Shader>, 46>        m_shaders;
         static array<shared_ptr<RHI_Sampler>, 7>        m_samplers;
-        static array<shared_ptr<RHI_ConstantBuffer>, 4> m_constant_buffers;
-        static shared_ptr<RHI_StructuredBuffer>         m_sb_spd_counter;
+        static array<shared_ptr<RHI_ConstantBuffer>, 3> m_constant_buffers;
+        static array<array<shared_ptr<RHI_ConstantBuffer>, 3>, renderer_max_secondary_cmd_lists> m_constant_buffers_secondary;
+        static array<shared_ptr<RHI_StructuredBuffer>, 12> m_structured_buffers;
+
+        // Indirect drawing stats, enough for every primary command list of the pool
+        static const uint32_t m_indirect_stats_count = 8;
+
+        // Material table, more copies than there can be frames in flight, and the version of the uploaded one
+        static const uint32_t m_material_table_copies = 8;
+        static uint64_t m_material_table_version      = 0;
 
         // asset resources
         static array<shared_ptr<RHI_Texture>, 9> m_standard_textures;
@@ -78,14 +88,209 @@ namespace Spartan
         constant_buffer(Renderer_ConstantBuffer::Light) = make_shared<RHI_ConstantBuffer>("light");
         constant_buffer(Renderer_ConstantBuffer::Light)->Create<Cb_Light>(8000);
 
-        constant_buffer(Renderer_ConstantBuffer::Material) = make_shared<RHI_ConstantBuffer>("material");
-        constant_buffer(Renderer_ConstantBuffer::Material)->Create<Cb_Material>(30000);
+        // Secondary command lists record in parallel, so every slot updates its own buffers.
+        // The frame buffer is only updated before they start recording, so they all share it.
+        for (uint32_t slot = 0; slot < renderer_max_secondary_cmd_lists; slot++)
+        {
+            array<shared_ptr<RHI_ConstantBuffer>, 3>& constant_buffers = m_constant_buffers_secondary[slot];
+            const string suffix = "_secondary_" + to_string(slot);
+
+            constant_buffers[static_cast<uint8_t>(Renderer_ConstantBuffer::Pass)] = make_shared<RHI_ConstantBuffer>("pass" + suffix);
+            constant_buffers[static_cast<uint8_t>(Renderer_ConstantBuffer::Pass)]->Create<Cb_Pass>(8000);
+
+            constant_buffers[static_cast<uint8_t>(Renderer_ConstantBuffer::Light)] = make_shared<RHI_ConstantBuffer>("light" + suffix);
+            constant_buffers[static_cast<uint8_t>(Renderer_ConstantBuffer::Light)]->Create<Cb_Light>(2000);
+        }
     }
 
     void Renderer::CreateStructuredBuffers()
     {
         const uint32_t offset_count = 32;
-        m_sb_spd_counter = make_shared<RHI_StructuredBuffer>(static_cast<uint32_t>(sizeof(uint32_t)), offset_count, "spd_counter");
+        m_structured_buffers[static_cast<uint8_t>(Renderer_StructuredBuffer::SpdCounter)] = make_shared<RHI_StructuredBuffer>(static_cast<uint32_t>(sizeof(uint32_t)), offset_count, "spd_counter");
+
+        // The instance buffers are written once per frame, they grow when a frame needs more
+        CreateInstanceBuffers(4096, 16384);
+        CreateIndirectBuffers(4096, 1024);
+
+        CreateMaterialBuffer(1024);
+        CreateLightBuffer(256);
+        CreateViewBuffer(256);
+
+        // The clusters are written by the light culling pass and read by the light pass, so there is only one copy of them
+        m_structured_buffers[static_cast<uint8_t>(Renderer_StructuredBuffer::LightClusterCounts)]  = make_shared<RHI_StructuredBuffer>(static_cast<uint32_t>(sizeof(uint32_t)) * renderer_light_cluster_count, 1, "light_cluster_counts");
+        m_structured_buffers[static_cast<uint8_t>(Renderer_StructuredBuffer::LightClusterIndices)] = make_shared<RHI_StructuredBuffer>(static_cast<uint32_t>(sizeof(uint32_t)) * renderer_light_cluster_count * renderer_light_cluster_capacity, 1, "light_cluster_indices");
+
+        // Emitted and culled draws, one pair per primary command list, the gpu writes them and the cpu reads them back
+        m_structured_buffers[static_cast<uint8_t>(Renderer_StructuredBuffer::IndirectStats)] = make_shared<RHI_StructuredBuffer>(static_cast<uint32_t>(sizeof(uint32_t)) * 2 * m_indirect_stats_count, 1, "indirect_stats");
+    }
+
+    void Renderer::CreateInstanceBuffers(const uint32_t instance_count, const uint32_t index_count)
+    {
+        // A few frames can be written between two offset resets
+        const uint32_t offset_count = 4;
+
+        // A grown buffer has a larger stride, so descriptor sets of the old one are never matched
+        m_structured_buffers[static_cast<uint8_t>(Renderer_StructuredBuffer::Instances)]       = make_shared<RHI_StructuredBuffer>(static_cast<uint32_t>(sizeof(Sb_Instance)) * instance_count, offset_count, "instances");
+        m_structured_buffers[static_cast<uint8_t>(Renderer_StructuredBuffer::InstanceIndices)] = make_shared<RHI_StructuredBuffer>(static_cast<uint32_t>(sizeof(uint32_t)) * index_count, offset_count, "instance_indices");
+    }
+
+    void Renderer::CreateIndirectBuffers(const uint32_t draw_count, const uint32_t batch_count)
+    {
+        const uint32_t offset_count = 4;
+
+        // The arguments are written by the culling pass, so there is only one copy of them
+        m_structured_buffers[static_cast<uint8_t>(Renderer_StructuredBuffer::IndirectDraws)]  = make_shared<RHI_StructuredBuffer>(static_cast<uint32_t>(sizeof(Sb_IndirectDraw)) * draw_count, offset_count, "indirect_draws");
+        m_structured_buffers[static_cast<uint8_t>(Renderer_StructuredBuffer::IndirectArgs)]   = make_shared<RHI_StructuredBuffer>(rhi_draw_indexed_indirect_stride * draw_count, 1, "indirect_args");
+        m_structured_buffers[static_cast<uint8_t>(Renderer_StructuredBuffer::IndirectCounts)] = make_shared<RHI_StructuredBuffer>(static_cast<uint32_t>(sizeof(uint32_t)) * batch_count, offset_count, "indirect_counts");
+    }
+
+    void Renderer::UpdateIndirectBuffers(const Renderer_Snapshot& snapshot, const uint32_t stats_index)
+    {
+        SP_ASSERT_MSG(stats_index < m_indirect_stats_count, "Not enough stats slots for the command lists");
+        m_indirect_stats_index = stats_index;
+
+        // Read back what the culling pass counted the last time this command list was recorded, it's
+        // idle by now, then clear the slot for this frame (nothing else touches it in the meantime)
+        {
+            RHI_StructuredBuffer* stats = GetStructuredBuffer(Renderer_StructuredBuffer::IndirectStats).get();
+            const uint32_t offset       = stats_index * 2 * static_cast<uint32_t>(sizeof(uint32_t));
+            const uint32_t size         = 2 * static_cast<uint32_t>(sizeof(uint32_t));
+            uint32_t* data              = reinterpret_cast<uint32_t*>(reinterpret_cast<std::byte*>(stats->GetMappedData()) + offset);
+
+            RHI_Device::InvalidateAllocation(stats->GetRhiResource(), offset, size);
+            Profiler::m_renderer_draws_indirect_emitted = data[0];
+            Profiler::m_renderer_draws_indirect_culled  = data[1];
+            data[0] = 0;
+            data[1] = 0;
+            RHI_Device::FlushAllocation(stats->GetRhiResource(), offset, size);
+        }
+
+        const uint32_t draw_count  = static_cast<uint32_t>(snapshot.indirect_draws.size());
+        const uint32_t batch_count = static_cast<uint32_t>(snapshot.indirect_batches.size());
+        if (draw_count == 0)
+            return;
+
+        // Grow like the instance buffers
+        RHI_StructuredBuffer* draws  = GetStructuredBuffer(Renderer_StructuredBuffer::IndirectDraws).get();
+        RHI_StructuredBuffer* counts = GetStructuredBuffer(Renderer_StructuredBuffer::IndirectCounts).get();
+        const uint32_t draw_count_max  = draws->GetStride() / static_cast<uint32_t>(sizeof(Sb_IndirectDraw));
+        const uint32_t batch_count_max = counts->GetStride() / static_cast<uint32_t>(sizeof(uint32_t));
+        if (draw_count > draw_count_max || batch_count > batch_count_max)
+        {
+            CreateIndirectBuffers(Math::Helper::Max(bit_ceil(draw_count), draw_count_max), Math::Helper::Max(bit_ceil(batch_count), batch_count_max));
+        }
+
+        // The draw counts start at zero, the culling pass increments them
+        static vector<uint32_t> counts_zero;
+        counts_zero.assign(batch_count, 0);
+
+        GetStructuredBuffer(Renderer_StructuredBuffer::IndirectDraws)->Update(const_cast<Sb_IndirectDraw*>(snapshot.indirect_draws.data()), draw_count * static_cast<uint32_t>(sizeof(Sb_IndirectDraw)));
+        GetStructuredBuffer(Renderer_StructuredBuffer::IndirectCounts)->Update(counts_zero.data(), batch_count * static_cast<uint32_t>(sizeof(uint32_t)));
+    }
+
+    void Renderer::CreateMaterialBuffer(const uint32_t material_count)
+    {
+        m_structured_buffers[static_cast<uint8_t>(Renderer_StructuredBuffer::Materials)] = make_shared<RHI_StructuredBuffer>(static_cast<uint32_t>(sizeof(Sb_Material)) * material_count, m_material_table_copies, "materials");
+        m_material_table_version = 0;
+    }
+
+    void Renderer::UpdateMaterialBuffer(const Renderer_Snapshot& snapshot)
+    {
+        // Only uploaded when the table changed, the buffer otherwise keeps its offset and contents across frames
+        const uint32_t material_count = static_cast<uint32_t>(snapshot.materials.size());
+        if (material_count == 0 || snapshot.materials_version == m_material_table_version)
+            return;
+
+        RHI_StructuredBuffer* materials   = GetStructuredBuffer(Renderer_StructuredBuffer::Materials).get();
+        const uint32_t material_count_max = materials->GetStride() / static_cast<uint32_t>(sizeof(Sb_Material));
+        if (material_count > material_count_max)
+        {
+            CreateMaterialBuffer(Math::Helper::Max(bit_ceil(material_count), material_count_max));
+            materials = GetStructuredBuffer(Renderer_StructuredBuffer::Materials).get();
+        }
+
+        // A copy is written at most once per frame, so when the ring wraps, the copy it lands
+        // on is older than any frame that can still be in flight and it can be overwritten
+        if (materials->GetOffset() + 2 * materials->GetStride() > materials->GetStride() * m_material_table_copies)
+        {
+            materials->ResetOffset();
+        }
+
+        materials->Update(const_cast<Sb_Material*>(snapshot.materials.data()), material_count * static_cast<uint32_t>(sizeof(Sb_Material)));
+        m_material_table_version = snapshot.materials_version;
+    }
+
+    void Renderer::CreateLightBuffer(const uint32_t light_count)
+    {
+        const uint32_t offset_count = 4;
+        m_structured_buffers[static_cast<uint8_t>(Renderer_StructuredBuffer::Lights)] = make_shared<RHI_StructuredBuffer>(static_cast<uint32_t>(sizeof(Cb_Light)) * light_count, offset_count, "lights");
+    }
+
+    void Renderer::UpdateLightBuffer(const Renderer_Snapshot& snapshot)
+    {
+        const uint32_t light_count = static_cast<uint32_t>(snapshot.lights.size());
+        if (light_count == 0)
+            return;
+
+        // Grow like the instance buffers
+        const uint32_t light_count_max = GetStructuredBuffer(Renderer_StructuredBuffer::Lights)->GetStride() / static_cast<uint32_t>(sizeof(Cb_Light));
+        if (light_count > light_count_max)
+        {
+            CreateLightBuffer(Math::Helper::Max(bit_ceil(light_count), light_count_max));
+        }
+
+        // In the order of the snapshot, which is what the clusters index
+        static vector<Cb_Light> lights;
+        lights.clear();
+        for (const Renderer_SnapshotLight& light : snapshot.lights)
+        {
+            lights.push_back(light.cb);
+        }
+
+        GetStructuredBuffer(Renderer_StructuredBuffer::Lights)->Update(lights.data(), light_count * static_cast<uint32_t>(sizeof(Cb_Light)));
+    }
+
+    void Renderer::CreateViewBuffer(const uint32_t view_count)
+    {
+        const uint32_t offset_count = 4;
+        m_structured_buffers[static_cast<uint8_t>(Renderer_StructuredBuffer::Views)] = make_shared<RHI_StructuredBuffer>(static_cast<uint32_t>(sizeof(Matrix)) * view_count, offset_count, "views");
+    }
+
+    void Renderer::UpdateViewBuffer(const Renderer_Snapshot& snapshot)
+    {
+        const uint32_t view_count = static_cast<uint32_t>(snapshot.views.size());
+        if (view_count == 0)
+            return;
+
+        // Grow like the instance buffers
+        const uint32_t view_count_max = GetStructuredBuffer(Renderer_StructuredBuffer::Views)->GetStride() / static_cast<uint32_t>(sizeof(Matrix));
+        if (view_count > view_count_max)
+        {
+            CreateViewBuffer(Math::Helper::Max(bit_ceil(view_count), view_count_max));
+        }
+
+        GetStructuredBuffer(Renderer_StructuredBuffer::Views)->Update(const_cast<Matrix*>(snapshot.views.data()), view_count * static_cast<uint32_t>(sizeof(Matrix)));
+    }
+
+    void Renderer::UpdateInstanceBuffers(const Renderer_Snapshot& snapshot)
+    {
+        const uint32_t instance_count = static_cast<uint32_t>(snapshot.instance_transforms.size());
+        const uint32_t index_count    = static_cast<uint32_t>(snapshot.instance_indices.size());
+        if (instance_count == 0 || index_count == 0)
+            return;
+
+        // Grow to the next power of two, the buffers are recreated at most a handful of times
+        RHI_StructuredBuffer* instances        = GetStructuredBuffer(Renderer_StructuredBuffer::Instances).get();
+        RHI_StructuredBuffer* instance_indices = GetStructuredBuffer(Renderer_StructuredBuffer::InstanceIndices).get();
+        const uint32_t instance_count_max      = instances->GetStride() / static_cast<uint32_t>(sizeof(Sb_Instance));
+        const uint32_t index_count_max         = instance_indices->GetStride() / static_cast<uint32_t>(sizeof(uint32_t));
+        if (instance_count > instance_count_max || index_count > index_count_max)
+        {
+            CreateInstanceBuffers(Math::Helper::Max(bit_ceil(instance_count), instance_count_max), Math::Helper::Max(bit_ceil(index_count), index_count_max));
+        }
+
+        GetStructuredBuffer(Renderer_StructuredBuffer::Instances)->Update(const_cast<Sb_Instance*>(snapshot.instance_transforms.data()), instance_count * static_cast<uint32_t>(sizeof(Sb_Instance)));
+        GetStructuredBuffer(Renderer_StructuredBuffer::InstanceIndices)->Update(const_cast<uint32_t*>(snapshot.instance_indices.data()), index_count * static_cast<uint32_t>(sizeof(uint32_t)));
     }
 
     void Renderer::CreateDepthStencilStates()
@@ -238,6 +443,11 @@ namespace Spartan
         {
             render_target(Renderer_RenderTexture::brdf_specular_lut) = make_unique<RHI_Texture2D>(400, 400, 1, RHI_Format::R8G8_Unorm, RHI_Texture_Uav | RHI_Texture_Srv, "rt_brdf_specular_lut");
             m_brdf_specular_lut_rendered = false;
+
+            // Shadow maps, re-created at the current resolutions and keeping the slices they grew to
+            RHI_Texture* tex_directional = render_target(Renderer_RenderTexture::shadow_directional_depth).get();
+            RHI_Texture* tex_local       = render_target(Renderer_RenderTexture::shadow_local_depth).get();
+            CreateShadowMaps(tex_directional ? tex_directional->GetArrayLength() : 0, tex_local ? tex_local->GetArrayLength() : renderer_shadow_slices_local_min);
         }
 
         // Dynamic resolution
@@ -253,6 +463,55 @@ namespace Spartan
         RHI_FSR2::OnDisplayModeChanged(GetResolutionRender(), GetResolutionOutput());
     }
 
+    void Renderer::CreateShadowMaps(const uint32_t slice_count_directional, const uint32_t slice_count_local)
+    {
+        // Directional lights, a slice per cascade, they are only created once a directional light has shadows
+        const uint32_t resolution_directional = GetOption<uint32_t>(Renderer_Option::ShadowResolution);
+        RHI_Texture* tex_directional          = render_target(Renderer_RenderTexture::shadow_directional_depth).get();
+        if (slice_count_directional == 0)
+        {
+            render_target(Renderer_RenderTexture::shadow_directional_depth) = nullptr;
+            render_target(Renderer_RenderTexture::shadow_directional_color) = nullptr;
+        }
+        else if (!tex_directional || tex_directional->GetWidth() != resolution_directional || tex_directional->GetArrayLength() != slice_count_directional)
+        {
+            render_target(Renderer_RenderTexture::shadow_directional_depth) = make_shared<RHI_Texture2DArray>(resolution_directional, resolution_directional, RHI_Format::D32_Float,      slice_count_directional, RHI_Texture_RenderTarget | RHI_Texture_Srv, "rt_shadow_directional_depth");
+            render_target(Renderer_RenderTexture::shadow_directional_color) = make_shared<RHI_Texture2DArray>(resolution_directional, resolution_directional, RHI_Format::R8G8B8A8_Unorm, slice_count_directional, RHI_Texture_RenderTarget | RHI_Texture_Srv, "rt_shadow_directional_color");
+        }
+
+        // Point and spot lights, the static casters are cached in their own array and copied into the shadow map before the dynamic ones, see Pass_ShadowMaps()
+        const uint32_t resolution_local = GetOption<uint32_t>(Renderer_Option::ShadowResolutionLocal);
+        RHI_Texture* tex_local          = render_target(Renderer_RenderTexture::shadow_local_depth).get();
+        if (!tex_local || tex_local->GetWidth() != resolution_local || tex_local->GetArrayLength() != slice_count_local)
+        {
+            render_target(Renderer_RenderTexture::shadow_local_depth)        = make_shared<RHI_Texture2DArray>(resolution_local, resolution_local, RHI_Format::D32_Float,      slice_count_local, RHI_Texture_RenderTarget | RHI_Texture_Srv | RHI_Texture_ClearOrBlit, "rt_shadow_local_depth");
+            render_target(Renderer_RenderTexture::shadow_local_static_depth) = make_shared<RHI_Texture2DArray>(resolution_local, resolution_local, RHI_Format::D32_Float,      slice_count_local, RHI_Texture_RenderTarget | RHI_Texture_Srv | RHI_Texture_ClearOrBlit, "rt_shadow_local_static_depth");
+            render_target(Renderer_RenderTexture::shadow_local_color)        = make_shared<RHI_Texture2DArray>(resolution_local, resolution_local, RHI_Format::R8G8B8A8_Unorm, slice_count_local, RHI_Texture_RenderTarget | RHI_Texture_Srv, "rt_shadow_local_color");
+        }
+    }
+
+    void Renderer::UpdateShadowMaps(const Renderer_Snapshot& snapshot)
+    {
+        RHI_Texture* tex_directional = GetRenderTarget(Renderer_RenderTexture::shadow_directional_depth).get();
+        RHI_Texture* tex_local       = GetRenderTarget(Renderer_RenderTexture::shadow_local_depth).get();
+        const uint32_t length_directional = tex_directional ? tex_directional->GetArrayLength() : 0;
+        const uint32_t length_local       = tex_local ? tex_local->GetArrayLength() : 0;
+
+        // Grow like the instance buffers, the local slices up to the budget, which BuildSnapshot() hands them out within
+        const uint32_t budget_local            = GetOption<uint32_t>(Renderer_Option::ShadowSlicesLocal);
+        const uint32_t slice_count_directional = Math::Helper::Max(snapshot.shadow_slices_directional, length_directional);
+        uint32_t slice_count_local             = Math::Helper::Min(length_local, budget_local);
+        if (snapshot.shadow_slices_local > slice_count_local)
+        {
+            slice_count_local = Math::Helper::Min(Math::Helper::Max(bit_ceil(snapshot.shadow_slices_local), slice_count_local), budget_local);
+        }
+
+        if (slice_count_directional != length_directional || slice_count_local != length_local)
+        {
+            CreateShadowMaps(slice_count_directional, slice_count_local);
+        }
+    }
+
     void Renderer::CreateShaders()
     {
         const bool async        = true;
@@ -268,6 +527,8 @@ namespace Spartan
         // Light
         shader(Renderer_Shader::light_c) = make_shared<RHI_Shader>();
         shader(Renderer_Shader::light_c)->Compile(RHI_Shader_Compute, shader_dir + "light.hlsl", async);
+        shader(Renderer_Shader::light_cull_c) = make_shared<RHI_Shader>();
+        shader(Renderer_Shader::light_cull_c)->Compile(RHI_Shader_Compute, shader_dir + "light_cull.hlsl", async);
 
         // Triangle & Quad
         {
@@ -429,6 +690,10 @@ namespace Spartan
         shader(Renderer_Shader::ffx_cas_c) = make_shared<RHI_Shader>();
         shader(Renderer_Shader::ffx_cas_c)->Compile(RHI_Shader_Compute, shader_dir + "amd_fidelity_fx\\cas.hlsl", async);
 
+        // Indirect drawing - Culling
+        shader(Renderer_Shader::cull_indirect_c) = make_shared<RHI_Shader>();
+        shader(Renderer_Shader::cull_indirect_c)->Compile(RHI_Shader_Compute, shader_dir + "cull_indirect.hlsl", async);
+
         // Compiled immediately, they are needed the moment the engine starts.
         {
             // AMD FidelityFX SPD - Single Pass Downsample
@@ -554,20 +819,20 @@ namespace Spartan
         m_samplers.fill(nullptr);
         m_standard_textures.fill(nullptr);
         m_standard_meshes.fill(nullptr);
-        m_sb_spd_counter = nullptr;
+        m_structured_buffers.fill(nullptr);
     }
 
-    array<shared_ptr<RHI_Texture>, 26>& Renderer::GetRenderTargets()
+    array<shared_ptr<RHI_Texture>, 31>& Renderer::GetRenderTargets()
     {
         return m_render_targets;
     }
 
-    array<shared_ptr<RHI_Shader>, 44>& Renderer::GetShaders()
+    array<shared_ptr<RHI_Shader>, 46>& Renderer::GetShaders()
     {
         return m_shaders;
     }
 
-    array<shared_ptr<RHI_ConstantBuffer>, 4>& Renderer::GetConstantBuffers()
+    array<shared_ptr<RHI_ConstantBuffer>, 3>& Renderer::GetConstantBuffers()
     {
         return m_constant_buffers;
     }
@@ -607,9 +872,22 @@ namespace Spartan
         return m_constant_buffers[static_cast<uint8_t>(type)];
     }
 
-    shared_ptr<RHI_StructuredBuffer> Renderer::GetStructuredBuffer()
+    RHI_ConstantBuffer* Renderer::GetConstantBuffer(const Renderer_ConstantBuffer type, const RHI_CommandList* cmd_list)
+    {
+        if (cmd_list->IsSecondary() && type != Renderer_ConstantBuffer::Frame)
+            return m_constant_buffers_secondary[cmd_list->GetIndex()][static_cast<uint8_t>(type)].get();
+
+        return m_constant_buffers[static_cast<uint8_t>(type)].get();
+    }
+
+    array<shared_ptr<RHI_ConstantBuffer>, 3>& Renderer::GetConstantBuffersSecondary(const uint32_t slot)
+    {
+        return m_constant_buffers_secondary[slot];
+    }
+
+    shared_ptr<RHI_StructuredBuffer> Renderer::GetStructuredBuffer(const Renderer_StructuredBuffer type)
     {
-        return m_sb_spd_counter;
+        return m_structured_buffers[static_cast<uint8_t>(type)];
     }
 
     shared_ptr<RHI_Texture> Renderer::GetStandardTexture(const Renderer_StandardTexture type)
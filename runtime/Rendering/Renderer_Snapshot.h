@@ -0,0 +1,365 @@
+/*
+Copyright(c) 2016-2023 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ========================
+#include <array>
+#include <bit>
+#include <memory>
+#include <vector>
+#include "Color.h"
+#include "Renderer_ConstantBuffers.h"
+#include "../Math/BoundingBox.h"
+#include "../Math/Frustum.h"
+#include "../RHI/RHI_Vertex.h"
+//===================================
+
+namespace Spartan
+{
+    //= FWD DECLARATIONS =
+    class Entity;
+    class Camera;
+    class Light;
+    class Renderable;
+    class ReflectionProbe;
+    class Mesh;
+    class Material;
+    //====================
+
+    // Everything the renderer reads from the world in order to produce a frame.
+    // It's captured on the simulation thread, so a frame can be recorded (on the
+    // render thread) while the simulation is already working on the next one.
+
+    // A draw with everything the passes need resolved up front, draws are recorded in key order.
+    // Opaque keys:      pass (4) | pipeline (4) | material (16) | mesh (16) | depth, front to back (24)
+    // Transparent keys: pass (4) | depth, back to front (24) | pipeline (4) | material (16) | mesh (16)
+    // The pipeline bits of the point and spot light casters also mark dynamic casters, so they follow the static ones.
+    // Consecutive opaques with the same mesh, sub-range, material and faces become one instanced draw.
+    struct Renderer_DrawRecord
+    {
+        uint64_t key              = 0;
+        uint32_t renderable_index = 0; // into geometry_opaque or geometry_transparent, the first instance
+        uint32_t index_count      = 0;
+        uint32_t index_offset     = 0;
+        uint32_t vertex_offset    = 0;
+        uint32_t instance_offset  = 0; // into the snapshot's instance_indices
+        uint32_t instance_count   = 1;
+        uint32_t material_index   = 0; // into the snapshot's materials
+        Mesh* mesh                = nullptr;
+        Material* material        = nullptr;
+        uint32_t cluster_offset   = 0;     // into the view's clusters, when the draw was culled per cluster
+        uint32_t cluster_count    = 0;     // 0 draws the whole index range
+        bool is_dynamic           = false; // a point or spot light caster which isn't static, see Transform::IsStatic()
+        uint8_t face_mask         = 0;     // cubes, the faces which see every instance of the draw
+    };
+
+    // A part of a draw's index range, what's left after the clusters of a mesh were culled (neighbours are merged)
+    struct Renderer_DrawRange
+    {
+        uint32_t index_offset = 0;
+        uint32_t index_count  = 0;
+    };
+
+    // What a view can see, one bit per renderable in geometry_opaque and geometry_transparent,
+    // and the sorted draws built from those bits
+    struct Renderer_SnapshotVisibility
+    {
+        std::vector<uint64_t> opaque;
+        std::vector<uint64_t> transparent;
+        std::vector<Renderer_DrawRecord> draws_opaque;
+        std::vector<Renderer_DrawRecord> draws_transparent;
+        std::vector<uint32_t> instances_opaque;      // the renderables of each draw, in draw order
+        std::vector<uint32_t> instances_transparent;
+        std::vector<Renderer_DrawRange> clusters; // the camera's opaques, the index ranges of the clusters which survived culling
+        uint64_t static_casters = 0; // identifies the static opaques of the draws, see Pass_ShadowMaps()
+
+        // the vectors keep their memory
+        void Clear()
+        {
+            opaque.clear();
+            transparent.clear();
+            draws_opaque.clear();
+            draws_transparent.clear();
+            instances_opaque.clear();
+            instances_transparent.clear();
+            clusters.clear();
+            static_casters = 0;
+        }
+    };
+
+    // Iterates the indices of the set bits of a visibility mask, in ascending (draw) order
+    class Renderer_VisibleIndices
+    {
+    public:
+        class Iterator
+        {
+        public:
+            Iterator(const std::vector<uint64_t>& mask, const uint32_t word_index) : m_mask(mask), m_word_index(word_index)
+            {
+                m_bits = m_word_index < m_mask.size() ? m_mask[m_word_index] : 0;
+                SkipEmptyWords();
+            }
+
+            uint32_t operator*() const { return m_word_index * 64 + static_cast<uint32_t>(std::countr_zero(m_bits)); }
+            bool operator!=(const Iterator& other) const { return m_word_index != other.m_word_index || m_bits != other.m_bits; }
+
+            Iterator& operator++()
+            {
+                m_bits &= m_bits - 1; // clear the lowest bit
+                SkipEmptyWords();
+                return *this;
+            }
+
+        private:
+            void SkipEmptyWords()
+            {
+                while (m_bits == 0 && m_word_index < m_mask.size())
+                {
+                    m_word_index++;
+                    m_bits = m_word_index < m_mask.size() ? m_mask[m_word_index] : 0;
+                }
+            }
+
+            const std::vector<uint64_t>& m_mask;
+            uint32_t m_word_index = 0;
+            uint64_t m_bits       = 0;
+        };
+
+        Renderer_VisibleIndices(const std::vector<uint64_t>& mask) : m_mask(mask) {}
+
+        Iterator begin() const { return Iterator(m_mask, 0); }
+        Iterator end() const   { return Iterator(m_mask, static_cast<uint32_t>(m_mask.size())); }
+
+    private:
+        const std::vector<uint64_t>& m_mask;
+    };
+
+    // The candidates of an indirect batch share a mesh and a material, their arguments are appended (by the
+    // culling pass) to a region of args_offset to args_offset + draw_count_max, and drawn with one indirect call
+    struct Renderer_IndirectBatch
+    {
+        Mesh* mesh              = nullptr;
+        Material* material      = nullptr;
+        uint32_t material_index = 0;
+        uint32_t args_offset    = 0;
+        uint32_t draw_count_max = 0;
+    };
+
+    struct Renderer_SnapshotCamera
+    {
+        std::shared_ptr<Camera> camera;
+        Math::Matrix view       = Math::Matrix::Identity;
+        Math::Matrix projection = Math::Matrix::Identity;
+        Math::Vector3 position  = Math::Vector3::Zero;
+        Math::Vector3 forward   = Math::Vector3::Forward;
+        float near_plane        = 0.0f;
+        float far_plane         = 1.0f;
+        float aperture          = 0.0f;
+        float shutter_speed     = 0.0f;
+        float iso               = 0.0f;
+        Color clear_color       = Color::standard_black;
+        Math::Frustum frustum;
+        Renderer_SnapshotVisibility visible;
+        uint32_t occluded_count = 0; // renderables removed from visible by the occlusion buffer
+
+        void Clear()
+        {
+            camera.reset();
+            view           = Math::Matrix::Identity;
+            projection     = Math::Matrix::Identity;
+            position       = Math::Vector3::Zero;
+            forward        = Math::Vector3::Forward;
+            near_plane     = 0.0f;
+            far_plane      = 1.0f;
+            aperture       = 0.0f;
+            shutter_speed  = 0.0f;
+            iso            = 0.0f;
+            clear_color    = Color::standard_black;
+            frustum        = Math::Frustum();
+            occluded_count = 0;
+            visible.Clear();
+        }
+    };
+
+    struct Renderer_SnapshotRenderable
+    {
+        std::shared_ptr<Entity> entity;
+        std::shared_ptr<Renderable> renderable;
+        Math::Matrix transform          = Math::Matrix::Identity;
+        Math::Matrix transform_previous = Math::Matrix::Identity;
+        Math::BoundingBox aabb;
+        uint32_t material_index = 0; // into the snapshot's materials
+        uint32_t index_offset   = 0; // the LOD picked for the camera, every view draws it
+        uint32_t index_count    = 0;
+        bool is_static          = false;
+    };
+
+    struct Renderer_SnapshotLight
+    {
+        std::shared_ptr<Entity> entity;
+        std::shared_ptr<Light> light;
+        Cb_Light cb;                           // ready to upload
+        std::array<Math::Frustum, 6> frustums; // one per shadow slice
+        std::array<Renderer_SnapshotVisibility, 6> visible;
+        Renderer_SnapshotVisibility visible_cube; // point lights, the draws of all faces, rendered in a single pass
+        uint32_t view_offset   = 0;               // point lights, into the snapshot's views
+        uint32_t slice_count   = 0;
+        Math::Vector3 position = Math::Vector3::Zero;
+        Math::Vector3 forward  = Math::Vector3::Forward;
+
+        // the frustums are written up to slice_count by BuildSnapshot(), so they are left as they are
+        void Clear()
+        {
+            entity.reset();
+            light.reset();
+            cb          = Cb_Light();
+            view_offset = 0;
+            slice_count = 0;
+            position    = Math::Vector3::Zero;
+            forward     = Math::Vector3::Forward;
+            for (Renderer_SnapshotVisibility& visibility : visible)
+            {
+                visibility.Clear();
+            }
+            visible_cube.Clear();
+        }
+
+        // these read the option bits, see BuildSnapshot()
+        float GetIntensity() const                { return cb.intensity_range_angle_bias.x; }
+        bool IsDirectional() const                { return cb.options & (1 << 0); }
+        bool IsPoint() const                      { return cb.options & (1 << 1); }
+        bool IsSpot() const                       { return cb.options & (1 << 2); }
+        bool GetShadowsEnabled() const            { return cb.options & (1 << 3); }
+        bool GetShadowsTransparentEnabled() const { return cb.options & (1 << 4); }
+        bool IsCube() const                       { return IsPoint() && slice_count == 6; } // the faces are rendered in a single pass
+    };
+
+    struct Renderer_SnapshotReflectionProbe
+    {
+        std::shared_ptr<Entity> entity;
+        std::shared_ptr<ReflectionProbe> probe;
+        Math::Matrix transform = Math::Matrix::Identity;
+        std::array<Math::Matrix, 6> view_projection;
+        std::array<Math::Frustum, 6> frustums;
+        std::array<Renderer_SnapshotVisibility, 6> visible;
+        Renderer_SnapshotVisibility visible_cube; // the draws of all faces, rendered in a single pass
+        uint32_t view_offset             = 0;     // into the snapshot's views
+        Math::Vector3 position           = Math::Vector3::Zero;
+        Math::Vector3 extents            = Math::Vector3::Zero;
+        bool needs_to_update             = false;
+        uint32_t update_face_start_index = 0;
+        uint32_t update_face_count       = 0;
+
+        // the view projections and frustums of all faces are written by BuildSnapshot(), so they are left as they are
+        void Clear()
+        {
+            entity.reset();
+            probe.reset();
+            transform               = Math::Matrix::Identity;
+            view_offset             = 0;
+            position                = Math::Vector3::Zero;
+            extents                 = Math::Vector3::Zero;
+            needs_to_update         = false;
+            update_face_start_index = 0;
+            update_face_count       = 0;
+            for (Renderer_SnapshotVisibility& visibility : visible)
+            {
+                visibility.Clear();
+            }
+            visible_cube.Clear();
+        }
+    };
+
+    struct Renderer_Snapshot
+    {
+        // Lights and probes are cleared in place rather than removed, so that their visibility keeps its
+        // memory, BuildSnapshot() reuses them and resizes the vectors to the number it captured
+        void Clear()
+        {
+            has_camera = false;
+            camera.Clear();
+            geometry_opaque.clear();
+            geometry_transparent.clear();
+            for (Renderer_SnapshotLight& light : lights)
+            {
+                light.Clear();
+            }
+            for (Renderer_SnapshotReflectionProbe& probe : reflection_probes)
+            {
+                probe.Clear();
+            }
+            instance_transforms.clear();
+            instance_indices.clear();
+            indirect_draws.clear();
+            indirect_batches.clear();
+            materials.clear();
+            views.clear();
+            shadow_slices_directional = 0;
+            shadow_slices_local       = 0;
+            shadow_lights_dropped     = 0;
+            selected = Renderer_SnapshotRenderable();
+        }
+
+        bool has_camera = false;
+        Renderer_SnapshotCamera camera;
+        std::vector<Renderer_SnapshotRenderable> geometry_opaque;
+        std::vector<Renderer_SnapshotRenderable> geometry_transparent;
+        std::vector<Renderer_SnapshotLight> lights;
+        std::vector<Renderer_SnapshotReflectionProbe> reflection_probes;
+        Renderer_SnapshotRenderable selected; // the entity selected in the editor (if it's renderable)
+        Math::Matrix grid_transform = Math::Matrix::Identity;
+
+        // instancing, the transforms of geometry_opaque followed by geometry_transparent,
+        // and the instances of every instanced draw list as indices into them
+        std::vector<Sb_Instance> instance_transforms;
+        std::vector<uint32_t> instance_indices;
+
+        // indirect drawing, every opaque is a candidate which the gpu culls against the camera, see Pass_CullIndirect()
+        std::vector<Sb_IndirectDraw> indirect_draws;
+        std::vector<Renderer_IndirectBatch> indirect_batches;
+
+        // the material table, a material keeps its index until the world is cleared, the render
+        // thread only uploads the table when the version differs from the one it uploaded last
+        std::vector<Sb_Material> materials;
+        uint64_t materials_version = 0;
+
+        // multiview, the view projections of the cubes which are rendered in a single pass (point light shadows and reflection probes)
+        std::vector<Math::Matrix> views;
+
+        // shadows, the slices which the lights were given, the shadow maps grow to fit them, see UpdateShadowMaps()
+        uint32_t shadow_slices_directional = 0;
+        uint32_t shadow_slices_local       = 0;
+        uint32_t shadow_lights_dropped     = 0; // point and spot lights which didn't fit in the ShadowSlicesLocal budget
+
+        // time
+        float delta_time = 0.0f;
+        float time       = 0.0f;
+
+        // debug lines
+        std::vector<RHI_Vertex_PosCol> line_vertices;
+        uint32_t lines_index_depth_off = 0;
+        uint32_t lines_index_depth_on  = 0;
+
+        // when true, the frame is copied to the swapchain so it can be presented directly (no editor)
+        bool is_fullscreen = false;
+    };
+}
@@ -423,23 +423,18 @@ namespace Spartan
 
             model_has_animation = scene->mNumAnimations != 0;
 
-            // Recursively parse nodes
+            // Recursively parse nodes, this is synchronous so all the geometry is there once it returns
             ParseNode(scene->mRootNode);
 
             // Update model geometry
             {
-                while (ProgressTracker::GetProgress(ProgressType::ModelImporter).GetFraction() != 1.0f)
-                {
-                    SP_LOG_INFO("Waiting for node processing threads to finish before creating GPU buffers...");
-                    this_thread::sleep_for(std::chrono::milliseconds(16));
-                }
-
                 //mesh->Optimize();
                 mesh->ComputeAabb();
                 if ((mesh->GetFlags() & (1U << static_cast<uint32_t>(MeshProcessingOptions::NormalizeScale))) != 0)
                 {
                     mesh->ComputeNormalizedScale();
                 }
+                mesh->BuildBvhs();
                 mesh->CreateGpuBuffers();
             }
 
@@ -653,11 +648,24 @@ namespace Spartan
         // Compute AABB (before doing move operation on vertices)
         const BoundingBox aabb = BoundingBox(vertices.data(), static_cast<uint32_t>(vertices.size()));
 
+        // Clusters, this reorders the triangles so it has to happen before the indices are added
+        vector<MeshCluster> clusters;
+        if ((mesh->GetFlags() & (1U << static_cast<uint32_t>(MeshProcessingOptions::GenerateClusters))) != 0)
+        {
+            clusters = Mesh::BuildClusters(indices, vertices);
+        }
+
         // Add the mesh to the model
         uint32_t index_offset  = 0;
         uint32_t vertex_offset = 0;
         mesh->AddIndices(indices, &index_offset);
         mesh->AddVertices(vertices, &vertex_offset);
+        mesh->AddBvhRange(index_offset, static_cast<uint32_t>(indices.size()), vertex_offset);
+        mesh->AddClusters(index_offset, clusters);
+        if ((mesh->GetFlags() & (1U << static_cast<uint32_t>(MeshProcessingOptions::GenerateLods))) != 0)
+        {
+            mesh->AddLods(index_offset, indices, vertices);
+        }
 
         // Add a renderable component to this entity
         shared_ptr<Renderable> renderable = entity_parent->AddComponent<Renderable>();
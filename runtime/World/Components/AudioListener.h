@@ -34,5 +34,8 @@ namespace Spartan
         ~AudioListener() = default;
 
         void OnTick() override;
+
+        // Tick access
+        static constexpr ComponentTickAccess tick_access = { TickAccess(ComponentType::Transform), TickAccess(TickResource::Audio) };
     };
 }
@@ -46,6 +46,9 @@ namespace Spartan
         void Serialize(FileStream* stream) override;
         void Deserialize(FileStream* stream) override;
 
+        // Tick access
+        static constexpr ComponentTickAccess tick_access = { TickAccess(ComponentType::Transform), TickAccess(TickResource::Audio) };
+
         //= PROPERTIES ===================================================================
         void SetAudioClip(const std::string& file_path);
         std::string GetAudioClipName() const;
@@ -26,6 +26,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Renderable.h"
 #include "../Entity.h"
 #include "../World.h"
+#include "../SpatialIndex.h"
 #include "../../Input/Input.h"
 #include "../../IO/FileStream.h"
 #include "../../Rendering/Renderer.h"
@@ -183,33 +184,26 @@ namespace Spartan
 
         m_ray = ComputePickingRay();
 
-        // Traces ray against all AABBs in the world
+        // Traces ray against the renderables in the spatial index, then against their exact AABBs
         vector<RayHit> hits;
         {
-            const vector<shared_ptr<Entity>>& entities = World::GetAllEntities();
-            for (const shared_ptr<Entity> entity : entities)
+            World::GetSpatialIndex().QueryRay(m_ray, SpatialCategory_Renderable, [this, &hits](Entity* entity, float)
             {
-                // Make sure there entity has a renderable
-                if (!entity->GetComponent<Renderable>())
-                    continue;
-
-                // Get object oriented bounding box
-                const BoundingBox& aabb = entity->GetComponent<Renderable>()->GetAabb();
-
                 // Compute hit distance
-                float distance = m_ray.HitDistance(aabb);
+                const BoundingBox& aabb = entity->GetComponent<Renderable>()->GetAabb();
+                float distance          = m_ray.HitDistance(aabb);
 
                 // Don't store hit data if there was no hit
                 if (distance == Helper::INFINITY_)
-                    continue;
+                    return;
 
                 hits.emplace_back(
-                    entity,                                             // Entity
+                    entity->shared_from_this(),                         // Entity
                     m_ray.GetStart() + m_ray.GetDirection() * distance, // Position
                     distance,                                           // Distance
                     distance == 0.0f                                    // Inside
                 );
-            }
+            });
 
             // Sort by distance (ascending)
             sort(hits.begin(), hits.end(), [](const RayHit& a, const RayHit& b) { return a.m_distance < b.m_distance; });
@@ -229,38 +223,19 @@ namespace Spartan
             return;
         }
 
-        // If there are more hits, perform triangle intersection
+        // If there are more hits, perform triangle intersection, the hits are sorted so once a triangle
+        // hit is nearer than the next box, nothing further can win
         float distance_min = numeric_limits<float>::max();
         for (RayHit& hit : hits)
         {
-            // Get entity geometry
-            shared_ptr<Renderable> renderable = hit.m_entity->GetComponent<Renderable>();
-            vector<uint32_t> indicies;
-            vector<RHI_Vertex_PosTexNorTan> vertices;
-            renderable->GetGeometry(&indicies, &vertices);
-            if (indicies.empty()|| vertices.empty())
-            {
-                SP_LOG_ERROR("Failed to get geometry of entity %s, skipping intersection test.");
-                continue;
-            }
-
-            // Compute matrix which can transform vertices to view space
-            Matrix vertex_transform = hit.m_entity->GetTransform()->GetMatrix();
+            if (hit.m_distance > distance_min)
+                break;
 
-            // Go through each face
-            for (uint32_t i = 0; i < indicies.size(); i += 3)
+            const float distance = hit.m_entity->GetComponent<Renderable>()->HitDistance(m_ray);
+            if (distance < distance_min)
             {
-                Vector3 p1_world = Vector3(vertices[indicies[i]].pos) * vertex_transform;
-                Vector3 p2_world = Vector3(vertices[indicies[i + 1]].pos) * vertex_transform;
-                Vector3 p3_world = Vector3(vertices[indicies[i + 2]].pos) * vertex_transform;
-
-                float distance = m_ray.HitDistance(p1_world, p2_world, p3_world);
-
-                if (distance < distance_min)
-                {
-                    m_selected_entity = hit.m_entity;
-                    distance_min      = distance;
-                }
+                m_selected_entity = hit.m_entity;
+                distance_min      = distance;
             }
         }
     }
@@ -64,6 +64,9 @@ namespace Spartan
         void Serialize(FileStream* stream) override;
         void Deserialize(FileStream* stream) override;
 
+        // Tick access
+        static constexpr ComponentTickAccess tick_access = { TickAccess(TickResource::Renderer), TickAccess(ComponentType::Transform, TickResource::Input) };
+
         // Matrices
         const Math::Matrix& GetViewMatrix()           const { return m_view; }
         const Math::Matrix& GetProjectionMatrix()     const { return m_projection; }
@@ -119,6 +122,7 @@ namespace Spartan
         // Frustum
         bool IsInViewFrustum(std::shared_ptr<Renderable> renderable) const;
         bool IsInViewFrustum(const Math::Vector3& center, const Math::Vector3& extents) const;
+        const Math::Frustum& GetFrustum() const { return m_frustum; }
 
         // Bookmarks
         void AddBookmark(camera_bookmark bookmark)               { m_bookmarks.emplace_back(bookmark); };
@@ -54,6 +54,9 @@ namespace Spartan
     template <typename T>
     inline constexpr ComponentType Component::TypeToEnum() { return ComponentType::Undefined; }
 
+    template <typename T>
+    const char* Component::TypeToName() { return "Undefined"; }
+
     shared_ptr<Transform> Component::GetTransform() const
     {
         return GetEntityPtr()->GetComponent<Transform>();
@@ -63,7 +66,9 @@ namespace Spartan
     inline constexpr void validate_component_type() { static_assert(is_base_of<Component, T>::value, "Provided type does not implement IComponent"); }
 
     // Explicit template instantiation
-    #define REGISTER_COMPONENT(T, enumT) template<> SP_CLASS ComponentType Component::TypeToEnum<T>() { validate_component_type<T>(); return enumT; }
+    #define REGISTER_COMPONENT(T, enumT)                                                                                  \
+    template<> SP_CLASS ComponentType Component::TypeToEnum<T>() { validate_component_type<T>(); return enumT; } \
+    template<> SP_CLASS const char* Component::TypeToName<T>() { return #T; }
 
     // To add a new component to the engine, simply register it here
     REGISTER_COMPONENT(AudioListener,   ComponentType::AudioListener)
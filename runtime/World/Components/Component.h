@@ -27,6 +27,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <any>
 #include <vector>
 #include <functional>
+#include <limits>
 #include "../../Core/Object.h"
 //============================
 
@@ -54,6 +55,29 @@ namespace Spartan
         Undefined
     };
 
+    // Shared state, other than components, which a component can touch while ticking
+    enum class TickResource : uint32_t
+    {
+        Physics,
+        Audio,
+        Renderer,
+        Input
+    };
+
+    // What a component type reads and writes while ticking, used by the world to tick non-conflicting types in parallel.
+    // Defaults to everything, so types which don't declare their access tick on their own.
+    struct ComponentTickAccess
+    {
+        uint64_t reads  = std::numeric_limits<uint64_t>::max();
+        uint64_t writes = std::numeric_limits<uint64_t>::max();
+    };
+
+    constexpr uint64_t TickAccessBit(const ComponentType type)     { return 1ull << static_cast<uint32_t>(type); }
+    constexpr uint64_t TickAccessBit(const TickResource resource) { return 1ull << (32 + static_cast<uint32_t>(resource)); }
+
+    template <typename... Types>
+    constexpr uint64_t TickAccess(const Types... items) { return (0ull | ... | TickAccessBit(items)); }
+
     struct Attribute
     {
         std::function<std::any()> getter;
@@ -81,6 +105,9 @@ namespace Spartan
         // Runs every frame
         virtual void OnTick() {}
 
+        // What OnTick() touches, besides the component itself, derived types which tick declare their own
+        static constexpr ComponentTickAccess tick_access = {};
+
         // Runs when the entity is being saved
         virtual void Serialize(FileStream* stream) {}
 
@@ -90,6 +117,9 @@ namespace Spartan
         //= TYPE ===================================
         template <typename T>
         static constexpr ComponentType TypeToEnum();
+
+        template <typename T>
+        static const char* TypeToName();
         //==========================================
 
         //= PROPERTIES ==============================================================
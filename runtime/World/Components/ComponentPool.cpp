@@ -0,0 +1,138 @@
+/*
+Copyright(c) 2016-2023 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ======================
+#include "pch.h"
+#include "ComponentPool.h"
+#include "../Entity.h"
+#include "../../Core/ThreadPool.h"
+//================================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace Spartan
+{
+    namespace
+    {
+        // Pools register themselves on first use, which can happen on any thread
+        static const uint32_t pool_count = static_cast<uint32_t>(ComponentType::Undefined);
+        static array<atomic<ComponentPoolBase*>, pool_count> pools;
+
+        static bool conflicts(const ComponentTickAccess& a, const ComponentTickAccess& b)
+        {
+            return (a.writes & (b.reads | b.writes)) != 0 || (b.writes & a.reads) != 0;
+        }
+    }
+
+    void ComponentPoolBase::TickAll(const bool parallel)
+    {
+        // Gather the pools which have work to do, in ComponentType order
+        array<ComponentPoolBase*, pool_count> systems;
+        uint32_t system_count = 0;
+        for (atomic<ComponentPoolBase*>& pool : pools)
+        {
+            ComponentPoolBase* pool_ptr = pool.load(memory_order_acquire);
+            if (pool_ptr && pool_ptr->HasTick() && pool_ptr->GetCount() != 0)
+            {
+                systems[system_count++] = pool_ptr;
+            }
+        }
+
+        if (!parallel)
+        {
+            for (uint32_t i = 0; i < system_count; i++)
+            {
+                systems[i]->Tick();
+            }
+
+            return;
+        }
+
+        // Build the dependency graph, a system goes into the stage after the
+        // last stage of any earlier system it conflicts with
+        array<uint32_t, pool_count> stages;
+        uint32_t stage_count = 0;
+        for (uint32_t i = 0; i < system_count; i++)
+        {
+            const ComponentTickAccess access = systems[i]->GetTickAccess();
+
+            stages[i] = 0;
+            for (uint32_t j = 0; j < i; j++)
+            {
+                if (conflicts(access, systems[j]->GetTickAccess()))
+                {
+                    stages[i] = max(stages[i], stages[j] + 1);
+                }
+            }
+
+            stage_count = max(stage_count, stages[i] + 1);
+        }
+
+        // Run the stages in order, the systems within a stage in parallel
+        array<ComponentPoolBase*, pool_count> batch;
+        for (uint32_t stage = 0; stage < stage_count; stage++)
+        {
+            uint32_t batch_count = 0;
+            for (uint32_t i = 0; i < system_count; i++)
+            {
+                if (stages[i] == stage)
+                {
+                    batch[batch_count++] = systems[i];
+                }
+            }
+
+            if (batch_count == 1)
+            {
+                batch[0]->Tick();
+                continue;
+            }
+
+            ThreadPool::ParallelFor([&batch](uint32_t work_index_start, uint32_t work_index_end)
+            {
+                for (uint32_t i = work_index_start; i < work_index_end; i++)
+                {
+                    batch[i]->Tick();
+                }
+            }, batch_count);
+        }
+    }
+
+    ComponentPoolBase* ComponentPoolBase::GetPool(const ComponentType type)
+    {
+        if (type == ComponentType::Undefined)
+            return nullptr;
+
+        return pools[static_cast<uint32_t>(type)].load(memory_order_acquire);
+    }
+
+    void ComponentPoolBase::Register(const ComponentType type, ComponentPoolBase* pool)
+    {
+        SP_ASSERT(type != ComponentType::Undefined);
+        pools[static_cast<uint32_t>(type)].store(pool, memory_order_release);
+    }
+
+    bool ComponentPoolBase::IsEntityTickable(Entity* entity)
+    {
+        return entity->IsActive() && entity->IsInWorld();
+    }
+}
@@ -0,0 +1,306 @@
+/*
+Copyright(c) 2016-2023 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ========================
+#include <array>
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+#include "Component.h"
+#include "../../Core/SlabAllocator.h"
+//===================================
+
+namespace Spartan
+{
+    // A stable reference to a component which lives in a pool. The generation is bumped
+    // every time a slot is released, so handles to removed components are detected as stale.
+    struct ComponentHandle
+    {
+        uint32_t index      = std::numeric_limits<uint32_t>::max();
+        uint32_t generation = 0;
+
+        bool IsValid() const { return index != std::numeric_limits<uint32_t>::max(); }
+    };
+
+    // Type-erased access to a pool, used when only the ComponentType is known
+    class SP_CLASS ComponentPoolBase
+    {
+    public:
+        virtual ~ComponentPoolBase() = default;
+
+        virtual std::shared_ptr<Component> GetComponent(const ComponentHandle handle) = 0;
+        virtual void Remove(const ComponentHandle handle) = 0;
+        virtual void Tick() = 0;
+        virtual bool HasTick() const = 0;
+        virtual ComponentTickAccess GetTickAccess() const = 0;
+        virtual uint32_t GetCount() = 0;
+
+        // Ticks every pool whose type does per-frame work. When parallel, pools which don't conflict (based on
+        // their tick access) tick concurrently, otherwise they tick one after the other, in ComponentType order.
+        // Either way, conflicting pools tick in ComponentType order, so the results are the same.
+        static void TickAll(const bool parallel);
+        static ComponentPoolBase* GetPool(const ComponentType type);
+
+    protected:
+        static void Register(const ComponentType type, ComponentPoolBase* pool);
+
+        // Out of line, since Entity is incomplete where the pools are declared
+        static bool IsEntityTickable(Entity* entity);
+    };
+
+    // Dense storage for every component of type T. The components themselves (along with
+    // their shared_ptr control blocks) are allocated from a slab, so there is one allocation
+    // per chunk instead of one per component, and ticking walks a packed list.
+    template <class T>
+    class ComponentPool : public ComponentPoolBase
+    {
+    public:
+        // Pools are never destroyed since components can outlive the static destruction order
+        static ComponentPool<T>& Get()
+        {
+            static ComponentPool<T>* pool = new ComponentPool<T>();
+            return *pool;
+        }
+
+        std::shared_ptr<T> Create(std::weak_ptr<Entity> entity, ComponentHandle* handle)
+        {
+            uint32_t index = AcquireSlot();
+
+            // The object and its control block are constructed in the slot's memory
+            std::shared_ptr<T> component = std::allocate_shared<T>(Allocator<T>(this, index), entity);
+
+            std::lock_guard<std::recursive_mutex> lock(m_mutex);
+            Slot& slot       = GetSlot(index);
+            slot.owner       = component;
+            slot.dense_index = static_cast<uint32_t>(m_dense.size());
+            slot.ptr.store(component.get(), std::memory_order_release); // published last, lookups read the owner after it
+            m_dense.emplace_back(index);
+
+            handle->index      = index;
+            handle->generation = slot.generation.load(std::memory_order_relaxed);
+
+            return component;
+        }
+
+        // Lock-free, like World::IsValid(), the slots never move and the generation tells if the handle is stale
+        const std::shared_ptr<T>& Get(const ComponentHandle handle)
+        {
+            static const std::shared_ptr<T> null;
+
+            Slot* slot = FindSlot(handle);
+            return slot ? slot->owner : null;
+        }
+
+        std::shared_ptr<Component> GetComponent(const ComponentHandle handle) override
+        {
+            return std::static_pointer_cast<Component>(Get(handle));
+        }
+
+        // Stops ticking the component and drops the pool's reference, the memory is reclaimed once every other reference is gone
+        void Remove(const ComponentHandle handle) override
+        {
+            std::shared_ptr<T> owner;
+            {
+                std::lock_guard<std::recursive_mutex> lock(m_mutex);
+
+                Slot* slot = FindSlot(handle);
+                if (!slot)
+                    return;
+
+                // Bumping the generation invalidates every handle to this component
+                slot->ptr.store(nullptr, std::memory_order_relaxed);
+                slot->generation.fetch_add(1, std::memory_order_release);
+                owner = std::move(slot->owner);
+
+                // Swap and pop, keeps the dense list packed
+                uint32_t dense_index            = slot->dense_index;
+                uint32_t index_last             = m_dense.back();
+                m_dense[dense_index]            = index_last;
+                GetSlot(index_last).dense_index = dense_index;
+                m_dense.pop_back();
+            }
+
+            // Released outside of the lock, since destruction can touch other pools
+            owner = nullptr;
+        }
+
+        void Tick() override
+        {
+            if constexpr (has_tick)
+            {
+                // Gathered under the lock and ticked without it, so lookups from other threads don't wait for the tick.
+                // Components added during the tick start ticking on the next one, removed ones fail the handle check.
+                {
+                    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+
+                    m_tick_handles.clear();
+                    for (uint32_t index : m_dense)
+                    {
+                        ComponentHandle& handle = m_tick_handles.emplace_back();
+                        handle.index            = index;
+                        handle.generation       = GetSlot(index).generation.load(std::memory_order_relaxed);
+                    }
+                }
+
+                for (const ComponentHandle& handle : m_tick_handles)
+                {
+                    Slot* slot   = FindSlot(handle);
+                    T* component = slot ? slot->ptr.load(std::memory_order_acquire) : nullptr;
+                    if (component && IsEntityTickable(component->GetEntityPtr()))
+                    {
+                        // Non-virtual, the pool knows the exact type
+                        component->T::OnTick();
+                    }
+                }
+            }
+        }
+
+        bool HasTick() const override { return has_tick; }
+
+        ComponentTickAccess GetTickAccess() const override
+        {
+            // A pool always writes to its own components
+            ComponentTickAccess access = T::tick_access;
+            access.writes             |= TickAccessBit(Component::TypeToEnum<T>());
+            return access;
+        }
+
+        uint32_t GetCount() override
+        {
+            std::lock_guard<std::recursive_mutex> lock(m_mutex);
+            return static_cast<uint32_t>(m_dense.size());
+        }
+
+    private:
+        // Only types which override OnTick() do per-frame work
+        static constexpr bool has_tick = !std::is_same_v<decltype(&T::OnTick), void (Component::*)()>;
+
+        static const uint32_t blocks_per_chunk = 64;
+
+        // Slots, chunks are never moved or freed, so handles can be validated without locking
+        struct Slot
+        {
+            std::shared_ptr<T> owner;
+            std::atomic<T*> ptr              = nullptr;
+            std::atomic<uint32_t> generation = 0;
+            uint32_t dense_index             = 0;
+        };
+        static const uint32_t slots_per_chunk = 4096;
+
+        // Hands the slab's memory to allocate_shared and frees the slot's handle along with it
+        template <class U>
+        struct Allocator
+        {
+            using value_type = U;
+
+            Allocator(ComponentPool<T>* pool, uint32_t index) : pool(pool), index(index) {}
+            template <class V> Allocator(const Allocator<V>& other) : pool(other.pool), index(other.index) {}
+
+            U* allocate(std::size_t count)
+            {
+                SP_ASSERT(count == 1);
+                return static_cast<U*>(pool->m_slab.Allocate(sizeof(U), alignof(U)));
+            }
+
+            void deallocate(U* ptr, std::size_t)
+            {
+                pool->m_slab.Deallocate(ptr);
+                pool->ReleaseSlot(index);
+            }
+
+            template <class V> bool operator==(const Allocator<V>& other) const { return pool == other.pool; }
+            template <class V> bool operator!=(const Allocator<V>& other) const { return pool != other.pool; }
+
+            ComponentPool<T>* pool = nullptr;
+            uint32_t index         = 0;
+        };
+
+        ComponentPool() : m_slab(Component::TypeToName<T>(), blocks_per_chunk)
+        {
+            Register(Component::TypeToEnum<T>(), this);
+        }
+
+        Slot& GetSlot(const uint32_t index)
+        {
+            return m_slot_chunks[index / slots_per_chunk].load(std::memory_order_relaxed)[index % slots_per_chunk];
+        }
+
+        // Returns the slot of a live component, or null if the handle is stale
+        Slot* FindSlot(const ComponentHandle handle)
+        {
+            const uint32_t chunk_index = handle.index / slots_per_chunk;
+            if (chunk_index >= m_slot_chunks.size())
+                return nullptr;
+
+            Slot* chunk = m_slot_chunks[chunk_index].load(std::memory_order_acquire);
+            if (!chunk)
+                return nullptr;
+
+            Slot& slot = chunk[handle.index % slots_per_chunk];
+            if (slot.generation.load(std::memory_order_acquire) != handle.generation || !slot.ptr.load(std::memory_order_acquire))
+                return nullptr;
+
+            return &slot;
+        }
+
+        uint32_t AcquireSlot()
+        {
+            std::lock_guard<std::recursive_mutex> lock(m_mutex);
+
+            if (!m_free.empty())
+            {
+                uint32_t index = m_free.back();
+                m_free.pop_back();
+                return index;
+            }
+
+            uint32_t index = m_slot_count++;
+
+            const uint32_t chunk_index = index / slots_per_chunk;
+            SP_ASSERT_MSG(chunk_index < m_slot_chunks.size(), "Too many components");
+            if (!m_slot_chunks[chunk_index].load(std::memory_order_relaxed))
+            {
+                m_slot_chunks[chunk_index].store(new Slot[slots_per_chunk], std::memory_order_release);
+            }
+
+            return index;
+        }
+
+        void ReleaseSlot(const uint32_t index)
+        {
+            std::lock_guard<std::recursive_mutex> lock(m_mutex);
+            m_free.emplace_back(index);
+        }
+
+        std::recursive_mutex m_mutex; // guards creation and removal, lookups don't take it
+        std::array<std::atomic<Slot*>, 256> m_slot_chunks = {};
+        uint32_t m_slot_count = 0;
+        std::vector<uint32_t> m_dense;              // slot indices of live components, packed
+        std::vector<uint32_t> m_free;               // slot indices which can be reused
+        std::vector<ComponentHandle> m_tick_handles; // the components a tick walks, reused across ticks
+        SlabAllocator m_slab;
+    };
+}
@@ -60,6 +60,9 @@ namespace Spartan
         void Deserialize(FileStream* stream) override;
         //============================================
 
+        // Tick access
+        static constexpr ComponentTickAccess tick_access = { TickAccess(ComponentType::Transform, ComponentType::RigidBody), TickAccess(TickResource::Physics) };
+
         ConstraintType GetConstraintType() const { return m_constraintType; }
         void SetConstraintType(ConstraintType type);
 
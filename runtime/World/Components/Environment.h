@@ -45,6 +45,9 @@ namespace Spartan
         void Serialize(FileStream* stream) override;
         void Deserialize(FileStream* stream) override;
 
+        // Tick access
+        static constexpr ComponentTickAccess tick_access = { 0, TickAccess(TickResource::Renderer) };
+
         // Texture
         const std::shared_ptr<RHI_Texture> GetTexture() const;
         void SetTexture(const std::shared_ptr<RHI_Texture> texture);
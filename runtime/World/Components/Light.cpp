@@ -23,13 +23,12 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "pch.h"
 #include "Light.h"
 #include "Transform.h"
+#include "../Entity.h"
 #include "Camera.h"
 #include "Renderable.h"
 #include "../World.h"
 #include "../../IO/FileStream.h"
 #include "../../Rendering/Renderer.h"
-#include "../../RHI/RHI_Texture2D.h"
-#include "../../RHI/RHI_TextureCube.h"
 #include "../../RHI/RHI_Texture2DArray.h"
 //=======================================
 
@@ -105,6 +104,11 @@ namespace Spartan
                         m_previous_camera_view = camera->GetViewMatrix();
                         m_is_dirty = true;
                     }
+
+                    if (m_cascade_splits_near != camera->GetNearPlane() || m_cascade_splits_far != camera->GetFarPlane())
+                    {
+                        m_is_dirty = true;
+                    }
                 }
             }
         }
@@ -123,13 +127,12 @@ namespace Spartan
             ComputeViewMatrix();
 
             // Compute projection matrix
-            if (m_shadow_map.texture_depth)
+            for (uint32_t i = 0; i < GetShadowArraySize(); i++)
             {
-                for (uint32_t i = 0; i < m_shadow_map.texture_depth->GetArrayLength(); i++)
-                {
-                    ComputeProjectionMatrix(i);
-                }
+                ComputeProjectionMatrix(i);
             }
+
+            m_is_projection_dirty = false;
         }
 
         m_is_dirty = false;
@@ -163,6 +166,9 @@ namespace Spartan
         stream->Read(&m_angle_rad);
         stream->Read(&m_bias);
         stream->Read(&m_normal_bias);
+
+        m_is_dirty            = true;
+        m_is_projection_dirty = true;
     }
 
     void Light::SetLightType(LightType type)
@@ -170,8 +176,9 @@ namespace Spartan
         if (m_light_type == type)
             return;
 
-        m_light_type = type;
-        m_is_dirty   = true;
+        m_light_type          = type;
+        m_is_dirty            = true;
+        m_is_projection_dirty = true;
 
         if (m_shadows_enabled)
         {
@@ -244,14 +251,19 @@ namespace Spartan
 
     void Light::SetRange(float range)
     {
-        m_range = Helper::Clamp(range, 0.0f, std::numeric_limits<float>::max());
-        m_is_dirty = true;
+        m_range               = Helper::Clamp(range, 0.0f, std::numeric_limits<float>::max());
+        m_is_dirty            = true;
+        m_is_projection_dirty = true;
+
+        // Let the world know, the bounds changed
+        SP_ENQUEUE_EVENT_DATA(EventType::WorldResolve, GetEntityPtr()->weak_from_this());
     }
 
     void Light::SetAngle(float angle)
     {
-        m_angle_rad = Helper::Clamp(angle, 0.0f, Math::Helper::PI_2);
-        m_is_dirty  = true;
+        m_angle_rad           = Helper::Clamp(angle, 0.0f, Math::Helper::PI_2);
+        m_is_dirty            = true;
+        m_is_projection_dirty = true;
     }
 
     void Light::ComputeViewMatrix()
@@ -295,7 +307,7 @@ namespace Spartan
 
     void Light::ComputeProjectionMatrix(uint32_t index /*= 0*/)
     {
-        SP_ASSERT(index < m_shadow_map.texture_depth->GetArrayLength());
+        SP_ASSERT(index < GetShadowArraySize());
 
         ShadowSlice& shadow_slice = m_shadow_map.slices[index];
 
@@ -307,12 +319,14 @@ namespace Spartan
         }
         else
         {
-            const uint32_t width       = m_shadow_map.texture_depth->GetWidth();
-            const uint32_t height      = m_shadow_map.texture_depth->GetHeight();
-            const float aspect_ratio   = static_cast<float>(width) / static_cast<float>(height);
-            const float fov            = m_light_type == LightType::Spot ? m_angle_rad * 2.0f : Math::Helper::PI_DIV_2;
-            m_matrix_projection[index] = Matrix::CreatePerspectiveFieldOfViewLH(fov, aspect_ratio, m_range, 0.3f); // reverse-z
-            shadow_slice.frustum       = Frustum(m_matrix_view[index], m_matrix_projection[index], m_range);
+            if (m_is_projection_dirty)
+            {
+                const float aspect_ratio   = 1.0f; // the slices of the local shadow array are square
+                const float fov            = m_light_type == LightType::Spot ? m_angle_rad * 2.0f : Math::Helper::PI_DIV_2;
+                m_matrix_projection[index] = Matrix::CreatePerspectiveFieldOfViewLH(fov, aspect_ratio, m_range, 0.3f); // reverse-z
+            }
+
+            shadow_slice.frustum = Frustum(m_matrix_view[index], m_matrix_projection[index], m_range);
         }
     }
 
@@ -345,23 +359,31 @@ namespace Spartan
         const Matrix projection               = camera->ComputeProjection(clip_near, clip_far); // Non reverse-z matrix
         const Matrix view_projection_inverted = Matrix::Invert(camera->GetViewMatrix() * projection);
 
-        // Calculate split depths based on view camera frustum
-        const float split_lambda = 0.98f;
-        const float clip_range   = clip_far - clip_near;
-        const float min_z        = clip_near;
-        const float max_z        = clip_near + clip_range;
-        const float range        = max_z - min_z;
-        const float ratio        = max_z / min_z;
-        vector<float> splits(m_cascade_count);
-        for (uint32_t i = 0; i < m_cascade_count; i++)
+        // Calculate split depths based on view camera frustum, only when the clipping planes change
+        if (m_cascade_splits.size() != m_cascade_count || m_cascade_splits_near != clip_near || m_cascade_splits_far != clip_far)
         {
-            const float p       = (i + 1) / static_cast<float>(m_cascade_count);
-            const float log     = min_z * Math::Helper::Pow(ratio, p);
-            const float uniform = min_z + range * p;
-            const float d       = split_lambda * (log - uniform) + uniform;
-            splits[i]           = (d - clip_near) / clip_range;
+            const float split_lambda = 0.98f;
+            const float clip_range   = clip_far - clip_near;
+            const float min_z        = clip_near;
+            const float max_z        = clip_near + clip_range;
+            const float range        = max_z - min_z;
+            const float ratio        = max_z / min_z;
+            m_cascade_splits.resize(m_cascade_count);
+            for (uint32_t i = 0; i < m_cascade_count; i++)
+            {
+                const float p       = (i + 1) / static_cast<float>(m_cascade_count);
+                const float log     = min_z * Math::Helper::Pow(ratio, p);
+                const float uniform = min_z + range * p;
+                const float d       = split_lambda * (log - uniform) + uniform;
+                m_cascade_splits[i] = (d - clip_near) / clip_range;
+            }
+
+            m_cascade_splits_near = clip_near;
+            m_cascade_splits_far  = clip_far;
         }
 
+        const vector<float>& splits = m_cascade_splits;
+
         float last_split_distance = 0.0f;
         for (uint32_t i = 0; i < m_cascade_count; i++)
         {
@@ -431,65 +453,26 @@ namespace Spartan
 
     uint32_t Light::GetShadowArraySize() const
     {
-        return m_shadow_map.texture_depth ? m_shadow_map.texture_depth->GetArrayLength() : 0;
+        return m_shadows_enabled ? static_cast<uint32_t>(m_shadow_map.slices.size()) : 0;
     }
 
     void Light::CreateShadowMap()
     {
-        // Early exit if there is no change in shadow map resolution
-        const uint32_t resolution     = Renderer::GetOption<uint32_t>(Renderer_Option::ShadowResolution);
-        const bool resolution_changed = m_shadow_map.texture_depth ? (resolution != m_shadow_map.texture_depth->GetWidth()) : false;
-        if ((!m_is_dirty && !resolution_changed))
+        // Early exit if nothing changed or if this light casts no shadows
+        if (!m_is_dirty || !m_shadows_enabled)
             return;
 
-        // Early exit if this light casts no shadows
-        if (!m_shadows_enabled)
-        {
-            m_shadow_map.texture_depth.reset();
-            return;
-        }
-
-        if (!m_shadows_transparent_enabled)
-        {
-            m_shadow_map.texture_color.reset();
-        }
-
-        RHI_Format format_depth = RHI_Format::D32_Float;
-        RHI_Format format_color = RHI_Format::R8G8B8A8_Unorm;
-
+        // Lights render into slices of the renderer's shadow maps, which are handed out every frame, see Renderer::BuildSnapshot()
         if (GetLightType() == LightType::Directional)
         {
-            m_shadow_map.texture_depth = make_unique<RHI_Texture2DArray>(resolution, resolution, format_depth, m_cascade_count, RHI_Texture_RenderTarget | RHI_Texture_Srv, "shadow_map_directional");
-
-            if (m_shadows_transparent_enabled)
-            {
-                m_shadow_map.texture_color = make_unique<RHI_Texture2DArray>(resolution, resolution, format_color, m_cascade_count, RHI_Texture_RenderTarget | RHI_Texture_Srv, "shadow_map_directional_color");
-            }
-
             m_shadow_map.slices = vector<ShadowSlice>(m_cascade_count);
         }
-        else if (GetLightType() == LightType::Point)
+        else
         {
-            m_shadow_map.texture_depth = make_unique<RHI_TextureCube>(resolution, resolution, format_depth, RHI_Texture_RenderTarget | RHI_Texture_Srv, "shadow_map_point_color");
-
-            if (m_shadows_transparent_enabled)
-            {
-                m_shadow_map.texture_color = make_unique<RHI_TextureCube>(resolution, resolution, format_color, RHI_Texture_RenderTarget | RHI_Texture_Srv, "shadow_map_point_color");
-            }
-
-            m_shadow_map.slices = vector<ShadowSlice>(6);
+            m_shadow_map.slices = vector<ShadowSlice>(GetLightType() == LightType::Point ? 6 : 1);
         }
-        else if (GetLightType() == LightType::Spot)
-        {
-            m_shadow_map.texture_depth  = make_unique<RHI_Texture2D>(resolution, resolution, 1, format_depth, RHI_Texture_RenderTarget | RHI_Texture_Srv, "shadow_map_spot_color");
 
-            if (m_shadows_transparent_enabled)
-            {
-                m_shadow_map.texture_color = make_unique<RHI_Texture2D>(resolution, resolution, 1, format_color, RHI_Texture_RenderTarget | RHI_Texture_Srv, "shadow_map_spot_color");
-            }
-
-            m_shadow_map.slices = vector<ShadowSlice>(1);
-        }
+        m_is_projection_dirty = true;
     }
 
     bool Light::IsInViewFrustum(shared_ptr<Renderable> renderable, uint32_t index) const
@@ -64,8 +64,6 @@ namespace Spartan
 
     struct ShadowMap
     {
-        std::shared_ptr<RHI_Texture> texture_color;
-        std::shared_ptr<RHI_Texture> texture_depth;
         std::vector<ShadowSlice> slices;
     };
 
@@ -83,6 +81,9 @@ namespace Spartan
         void Deserialize(FileStream* stream) override;
         //============================================
 
+        // Tick access
+        static constexpr ComponentTickAccess tick_access = { TickAccess(ComponentType::Transform, ComponentType::Camera), TickAccess(TickResource::Renderer) };
+
         const auto GetLightType() const { return m_light_type; }
         void SetLightType(LightType type);
 
@@ -122,12 +123,11 @@ namespace Spartan
         const Math::Matrix& GetViewMatrix(uint32_t index = 0) const;
         const Math::Matrix& GetProjectionMatrix(uint32_t index = 0) const;
 
-        RHI_Texture* GetDepthTexture() const { return m_shadow_map.texture_depth.get(); }
-        RHI_Texture* GetColorTexture() const { return m_shadow_map.texture_color.get(); }
         uint32_t GetShadowArraySize() const;
         void CreateShadowMap();
 
         bool IsInViewFrustum(std::shared_ptr<Renderable> renderable, uint32_t index) const;
+        const Math::Frustum& GetFrustum(uint32_t index) const { return m_shadow_map.slices[index].frustum; }
 
     private:
         void ComputeViewMatrix();
@@ -158,6 +158,12 @@ namespace Spartan
 
         // Dirty checks
         bool m_is_dirty                     = true;
+        bool m_is_projection_dirty          = true; // point and spot light projections only follow the range and the angle
         Math::Matrix m_previous_camera_view = Math::Matrix::Identity;
+
+        // Cascade splits, as fractions of the camera's depth range, they only follow the camera's clipping planes
+        std::vector<float> m_cascade_splits;
+        float m_cascade_splits_near = 0.0f;
+        float m_cascade_splits_far  = 0.0f;
     };
 }
@@ -23,9 +23,10 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "pch.h"
 #include "ReflectionProbe.h"
 #include "Transform.h"
+#include "../Entity.h"
 #include "Renderable.h"
 #include "../../RHI/RHI_TextureCube.h"
-#include "../../RHI/RHI_Texture2D.h"
+#include "../../RHI/RHI_Texture2DArray.h"
 #include "../../Rendering/Renderer.h"
 #include "../../IO/FileStream.h"
 #include "../../RHI/RHI_Device.h"
@@ -154,6 +155,9 @@ namespace Spartan
     void ReflectionProbe::SetExtents(const Math::Vector3& extents)
     {
         m_extents = extents;
+
+        // Let the world know, the bounds changed
+        SP_ENQUEUE_EVENT_DATA(EventType::WorldResolve, GetEntityPtr()->weak_from_this());
     }
 
     void ReflectionProbe::SetUpdateIntervalFrames(const uint32_t update_interval_frame)
@@ -195,7 +199,7 @@ namespace Spartan
     void ReflectionProbe::CreateTextures()
     {
         m_texture_color = make_unique<RHI_TextureCube>(m_resolution, m_resolution, RHI_Format::R8G8B8A8_Unorm, RHI_Texture_RenderTarget | RHI_Texture_Srv, "reflection_probe_color");
-        m_texture_depth = make_unique<RHI_Texture2D>(m_resolution, m_resolution, 1, RHI_Format::D32_Float, RHI_Texture_RenderTarget | RHI_Texture_Srv, "reflection_probe_depth");
+        m_texture_depth = make_unique<RHI_Texture2DArray>(m_resolution, m_resolution, RHI_Format::D32_Float, 6, RHI_Texture_RenderTarget | RHI_Texture_Srv, "reflection_probe_depth"); // a slice per face, they are rendered at once
     }
 
     void ReflectionProbe::ComputeProjectionMatrix()
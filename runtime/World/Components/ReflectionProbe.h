@@ -41,6 +41,9 @@ namespace Spartan
         void Deserialize(FileStream* stream) override;
         //============================================
 
+        // Tick access
+        static constexpr ComponentTickAccess tick_access = { TickAccess(ComponentType::Transform), 0 };
+
         // Returns true if the entity (renderable) is within the view frustum of a particular face (index) of the probe.
         bool IsInViewFrustum(std::shared_ptr<Renderable> renderable, uint32_t index) const;
 
@@ -49,6 +52,7 @@ namespace Spartan
         RHI_Texture* GetDepthTexture()                    { return m_texture_depth.get(); }
         Math::Matrix& GetViewMatrix(const uint32_t index) { return m_matrix_view[index]; }
         Math::Matrix& GetProjectionMatrix()               { return m_matrix_projection; }
+        const Math::Frustum& GetFrustum(const uint32_t index) const { return m_frustum[index]; }
 
         uint32_t GetResolution() const { return m_resolution; }
         void SetResolution(const uint32_t resolution);
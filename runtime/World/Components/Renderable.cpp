@@ -23,11 +23,13 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "pch.h"
 #include "Renderable.h"
 #include "Transform.h"
+#include "../Entity.h"
 #include "../../IO/FileStream.h"
 #include "../../Resource/ResourceCache.h"
 #include "../../RHI/RHI_Texture2D.h"
 #include "../Rendering/Geometry.h"
 #include "../Rendering/Mesh.h"
+#include "../Rendering/MeshBvh.h"
 #include "../Rendering/Renderer.h"
 //=======================================
 
@@ -38,6 +40,13 @@ using namespace Spartan::Math;
 
 namespace Spartan
 {
+    namespace
+    {
+        // LOD selection, the error of a LOD is projected to the screen and compared against this
+        const float lod_error_pixels = 1.0f;
+        const float lod_hysteresis   = 0.75f; // a coarser LOD has to be this far under the threshold, so LODs don't flicker at the boundary
+    }
+
     Renderable::Renderable(weak_ptr<Entity> entity) : Component(entity)
     {
         SP_REGISTER_ATTRIBUTE_VALUE_VALUE(m_material_default,             bool);
@@ -86,6 +95,8 @@ namespace Spartan
         m_geometry_index_count   = stream->ReadAs<uint32_t>();
         m_geometry_vertex_offset = stream->ReadAs<uint32_t>();
         m_geometry_vertex_count  = stream->ReadAs<uint32_t>();
+        m_lod_index_offset       = m_geometry_index_offset;
+        m_lod_index_count        = m_geometry_index_count;
         stream->Read(&m_bounding_box);
         string model_name;
         stream->Read(&model_name);
@@ -129,6 +140,13 @@ namespace Spartan
         m_geometry_vertex_count  = vertex_count;
         m_bounding_box           = bounding_box;
         m_mesh                   = mesh;
+        m_aabb                   = BoundingBox(); // recomputed on the next GetAabb()
+        m_lod_index              = 0;
+        m_lod_index_offset       = index_offset;
+        m_lod_index_count        = index_count;
+
+        // Let the world know, the bounds changed
+        SP_ENQUEUE_EVENT_DATA(EventType::WorldResolve, GetEntityPtr()->weak_from_this());
     }
 
     void Renderable::SetGeometry(const Renderer_StandardMesh type)
@@ -174,6 +192,65 @@ namespace Spartan
         return m_aabb;
     }
 
+    void Renderable::UpdateLod(const Vector3& camera_position, const float pixels_per_unit)
+    {
+        const vector<MeshLod>* lods = m_mesh ? m_mesh->GetLods(m_geometry_index_offset) : nullptr;
+        if (!lods || lods->empty())
+        {
+            m_lod_index        = 0;
+            m_lod_index_offset = m_geometry_index_offset;
+            m_lod_index_count  = m_geometry_index_count;
+            return;
+        }
+
+        // The errors are in mesh space, the growth of the bounding box brings them to world space
+        const BoundingBox& aabb = GetAabb();
+        const float radius      = aabb.GetExtents().Length();
+        const float scale       = radius / Helper::Max(m_bounding_box.GetExtents().Length(), Helper::EPSILON);
+        const float distance    = Helper::Max(Vector3::Distance(camera_position, aabb.GetCenter()) - radius, Helper::EPSILON);
+        const float to_pixels   = scale * pixels_per_unit / distance;
+
+        // The levels get coarser, so the first one which is too visible ends the search
+        uint32_t lod_index = 0;
+        for (uint32_t i = 1; i <= static_cast<uint32_t>(lods->size()); i++)
+        {
+            const float threshold = i > m_lod_index ? lod_error_pixels * lod_hysteresis : lod_error_pixels;
+            if ((*lods)[i - 1].error * to_pixels > threshold)
+                break;
+
+            lod_index = i;
+        }
+
+        m_lod_index        = lod_index;
+        m_lod_index_offset = lod_index == 0 ? m_geometry_index_offset : (*lods)[lod_index - 1].index_offset;
+        m_lod_index_count  = lod_index == 0 ? m_geometry_index_count  : (*lods)[lod_index - 1].index_count;
+    }
+
+    float Renderable::HitDistance(const Ray& ray, const bool cull_back_faces /*= true*/) const
+    {
+        if (!m_mesh)
+            return Helper::INFINITY_;
+
+        const MeshBvh* bvh = m_mesh->GetBvh(m_geometry_index_offset, m_geometry_index_count, m_geometry_vertex_offset);
+        if (!bvh)
+            return Helper::INFINITY_;
+
+        // The ray is moved to mesh space instead of moving the mesh to world space, its direction isn't
+        // re-normalised so the distance along it stays the same in both spaces
+        const Matrix world_to_mesh   = GetTransform()->GetMatrix().Inverted();
+        const Vector4 direction_mesh = Vector4(ray.GetDirection().x, ray.GetDirection().y, ray.GetDirection().z, 0.0f) * world_to_mesh;
+
+        MeshBvhRay ray_mesh;
+        ray_mesh.origin          = ray.GetStart() * world_to_mesh;
+        ray_mesh.direction       = Vector3(direction_mesh.x, direction_mesh.y, direction_mesh.z);
+        ray_mesh.cull_back_faces = cull_back_faces;
+
+        MeshBvhHit hit;
+        bvh->Intersect(ray_mesh, &hit);
+
+        return hit.distance;
+    }
+
     // All functions (set/load) resolve to this
     shared_ptr<Material> Renderable::SetMaterial(const shared_ptr<Material>& material)
     {
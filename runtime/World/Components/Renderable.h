@@ -26,6 +26,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <vector>
 #include "../../Math/Matrix.h"
 #include "../../Math/BoundingBox.h"
+#include "../../Math/Ray.h"
 #include "../Rendering/Renderer_Definitions.h"
 //============================================
 
@@ -71,6 +72,15 @@ namespace Spartan
         const Math::BoundingBox& GetAabb();
         void Clear();
 
+        // LOD, picked every frame by the renderer, the coarsest one whose error stays under a pixel (with some hysteresis)
+        void UpdateLod(const Math::Vector3& camera_position, const float pixels_per_unit);
+        uint32_t GetLodIndex()       const { return m_lod_index; }
+        uint32_t GetLodIndexOffset() const { return m_lod_index_offset; }
+        uint32_t GetLodIndexCount()  const { return m_lod_index_count; }
+
+        // Triangle accurate, returns the world space hit distance or infinity if there is no hit
+        float HitDistance(const Math::Ray& ray, const bool cull_back_faces = true) const;
+
         //= MATERIAL ====================================================================
         // Sets a material from memory (adds it to the resource cache by default)
         std::shared_ptr<Material> SetMaterial(const std::shared_ptr<Material>& material);
@@ -93,6 +103,9 @@ namespace Spartan
         uint32_t m_geometry_index_count      = 0;
         uint32_t m_geometry_vertex_offset    = 0;
         uint32_t m_geometry_vertex_count     = 0;
+        uint32_t m_lod_index                 = 0;
+        uint32_t m_lod_index_offset          = 0;
+        uint32_t m_lod_index_count           = 0;
         Renderer_StandardMesh m_geometry_type = Renderer_StandardMesh::Custom;
         Math::Matrix m_last_transform        = Math::Matrix::Identity;
         bool m_cast_shadows                  = true;
@@ -58,6 +58,9 @@ namespace Spartan
         void Deserialize(FileStream* stream) override;
         //============================================
 
+        // Tick access
+        static constexpr ComponentTickAccess tick_access = { TickAccess(ComponentType::Transform), TickAccess(TickResource::Physics) };
+
         //= MASS =========================
         float GetMass() const { return m_mass; }
         void SetMass(float mass);
@@ -52,6 +52,9 @@ namespace Spartan
         void Deserialize(FileStream* stream) override;
         //============================================
 
+        // Tick access
+        static constexpr ComponentTickAccess tick_access = { TickAccess(ComponentType::Transform), TickAccess(TickResource::Physics) };
+
         //= POSITION =======================================
         Math::Vector3 GetPosition() const;
         void SetPosition(const Math::Vector3& position) const;
@@ -231,7 +231,7 @@ namespace Spartan
         };
 
         uint32_t vertex_count = static_cast<uint32_t>(vertices.size());
-        ThreadPool::ParallelLoop(compute_vertex_normals_tangents, vertex_count);
+        ThreadPool::ParallelFor(compute_vertex_normals_tangents, vertex_count);
     }
 
     Terrain::Terrain(weak_ptr<Entity> entity) : Component(entity)
@@ -241,6 +241,10 @@ namespace Spartan
 
     Terrain::~Terrain()
     {
+        // The generation touches this component, so stop it at its next suspension point and wait for it
+        m_generation_cancelled = true;
+        m_generation.Wait();
+
         m_height_map = nullptr;
     }
 
@@ -271,7 +275,7 @@ namespace Spartan
 
     void Terrain::GenerateAsync()
     {
-        if (m_is_generating)
+        if (!m_generation.IsDone())
         {
             SP_LOG_WARNING("Terrain is already being generated, please wait...");
             return;
@@ -291,79 +295,87 @@ namespace Spartan
             return;
         }
 
-        ThreadPool::AddTask([this]()
+        m_generation = Generate();
+        m_generation.Start();
+    }
+
+    Async::Task<void> Terrain::Generate()
+    {
+        co_await Async::RunOnWorker();
+        if (m_generation_cancelled)
+            co_return;
+
+        // Get height map data
+        vector<std::byte> height_data;
         {
-            m_is_generating = true;
+            height_data = m_height_map->GetMip(0, 0).bytes;
 
-            // Get height map data
-            vector<std::byte> height_data;
+            // If not the data is not there, load it
+            if (height_data.empty())
             {
-                height_data = m_height_map->GetMip(0, 0).bytes;
-
-                // If not the data is not there, load it
-                if (height_data.empty())
+                if (m_height_map->LoadFromFile(m_height_map->GetResourceFilePath()))
                 {
-                    if (m_height_map->LoadFromFile(m_height_map->GetResourceFilePath()))
+                    height_data = m_height_map->GetMip(0, 0).bytes;
+
+                    if (height_data.empty())
                     {
-                        height_data = m_height_map->GetMip(0, 0).bytes;
-
-                        if (height_data.empty())
-                        {
-                            SP_LOG_ERROR("Failed to load height map");
-                            m_is_generating = false;
-                            return;
-                        }
+                        SP_LOG_ERROR("Failed to load height map");
+                        co_return;
                     }
                 }
             }
+        }
 
-            // Deduce some stuff
-            uint32_t width   = m_height_map->GetWidth();
-            uint32_t height  = m_height_map->GetHeight();
-            m_height_samples = width * height;
-            m_vertex_count   = m_height_samples;
-            m_index_count    = m_vertex_count * 6;
-            m_triangle_count = m_index_count / 3;
-
-            uint32_t job_count =
-                1 +              // 1. generate_positions()
-                1 +              // 2. generate_vertices_and_indices()
-                m_vertex_count + // 3. generate_normals_and_tangents()
-                1;               // 4. create mesh
-
-            // Star progress tracking
-            ProgressTracker::GetProgress(ProgressType::Terrain).Start(job_count, "Generating terrain...");
-
-            // Pre-allocate memory for the calculations that follow
-            vector<Vector3> positions(m_height_samples);
-            positions.reserve(m_height_samples);
-            vector<RHI_Vertex_PosTexNorTan> vertices(m_vertex_count);
-            vertices.reserve(m_vertex_count);
-            vector<uint32_t> indices(m_index_count);
-            indices.reserve(m_index_count);
-
-            // 1. Generate positions by reading the height map
-            ProgressTracker::GetProgress(ProgressType::Terrain).SetText("Generating positions...");
-            generate_positions(positions, height_data, width, height, m_min_y, m_max_y);
-            ProgressTracker::GetProgress(ProgressType::Terrain).JobDone();
-
-            // 2. Compute vertices and indices
-            ProgressTracker::GetProgress(ProgressType::Terrain).SetText("Generating vertices and indices...");
-            generate_vertices_and_indices(vertices, indices, positions, width, height);
-            ProgressTracker::GetProgress(ProgressType::Terrain).JobDone();
-
-            // 3. Compute normals and tangents
-            ProgressTracker::GetProgress(ProgressType::Terrain).SetText("Generating normals and tangents...");
-            generate_normals_and_tangents(indices, vertices);
-            // Jobs done are tracked internally here because this is the most expensive function
-
-            // 4. Create mesh
-            ProgressTracker::GetProgress(ProgressType::Terrain).SetText("Creating mesh...");
-            UpdateFromVertices(indices, vertices);
+        // Deduce some stuff
+        uint32_t width   = m_height_map->GetWidth();
+        uint32_t height  = m_height_map->GetHeight();
+        m_height_samples = width * height;
+        m_vertex_count   = m_height_samples;
+        m_index_count    = m_vertex_count * 6;
+        m_triangle_count = m_index_count / 3;
+
+        uint32_t job_count =
+            1 +              // 1. generate_positions()
+            1 +              // 2. generate_vertices_and_indices()
+            m_vertex_count + // 3. generate_normals_and_tangents()
+            1;               // 4. create mesh
+
+        // Star progress tracking
+        ProgressTracker::GetProgress(ProgressType::Terrain).Start(job_count, "Generating terrain...");
+
+        // Pre-allocate memory for the calculations that follow
+        vector<Vector3> positions(m_height_samples);
+        positions.reserve(m_height_samples);
+        vector<RHI_Vertex_PosTexNorTan> vertices(m_vertex_count);
+        vertices.reserve(m_vertex_count);
+        vector<uint32_t> indices(m_index_count);
+        indices.reserve(m_index_count);
+
+        // 1. Generate positions by reading the height map
+        ProgressTracker::GetProgress(ProgressType::Terrain).SetText("Generating positions...");
+        generate_positions(positions, height_data, width, height, m_min_y, m_max_y);
+        ProgressTracker::GetProgress(ProgressType::Terrain).JobDone();
+
+        // 2. Compute vertices and indices
+        ProgressTracker::GetProgress(ProgressType::Terrain).SetText("Generating vertices and indices...");
+        generate_vertices_and_indices(vertices, indices, positions, width, height);
+        ProgressTracker::GetProgress(ProgressType::Terrain).JobDone();
+
+        // 3. Compute normals and tangents
+        ProgressTracker::GetProgress(ProgressType::Terrain).SetText("Generating normals and tangents...");
+        generate_normals_and_tangents(indices, vertices);
+        // Jobs done are tracked internally here because this is the most expensive function
+
+        // 4. Create mesh, this touches the world (adds a renderable), so do it on the main thread
+        co_await Async::ResumeOnMainThread();
+        if (m_generation_cancelled)
+        {
             ProgressTracker::GetProgress(ProgressType::Terrain).JobDone();
-
-            m_is_generating = false;
-        });
+            co_return;
+        }
+        ProgressTracker::GetProgress(ProgressType::Terrain).SetText("Creating mesh...");
+        UpdateFromVertices(indices, vertices);
+        ProgressTracker::GetProgress(ProgressType::Terrain).JobDone();
     }
 
     void Terrain::UpdateFromMesh(const shared_ptr<Mesh> mesh) const
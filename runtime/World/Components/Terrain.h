@@ -23,7 +23,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 //= INCLUDES ========================
 #include "Component.h"
-#include <atomic>
+#include "../../Core/Async.h"
 #include "../../RHI/RHI_Definition.h"
 //===================================
 
@@ -62,17 +62,19 @@ namespace Spartan
         void GenerateAsync();
 
     private:
+        Async::Task<void> Generate();
         void UpdateFromMesh(const std::shared_ptr<Mesh> mesh) const;
         void UpdateFromVertices(const std::vector<uint32_t>& indices, std::vector<RHI_Vertex_PosTexNorTan>& vertices);
 
-        float m_min_y                     = 0.0f;
-        float m_max_y                     = 30.0f;
-        float m_vertex_density            = 1.0f;
-        std::atomic<bool> m_is_generating = false;
-        uint32_t m_height_samples         = 0;
-        uint32_t m_vertex_count           = 0;
-        uint32_t m_index_count            = 0;
-        uint32_t m_triangle_count         = 0;
+        float m_min_y             = 0.0f;
+        float m_max_y             = 30.0f;
+        float m_vertex_density    = 1.0f;
+        uint32_t m_height_samples = 0;
+        uint32_t m_vertex_count   = 0;
+        uint32_t m_index_count    = 0;
+        uint32_t m_triangle_count = 0;
+        Async::Task<void> m_generation;
+        std::atomic<bool> m_generation_cancelled = false;
         std::shared_ptr<RHI_Texture> m_height_map;
         std::shared_ptr<Mesh> m_mesh;
     };
@@ -25,6 +25,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../World.h"
 #include "../Entity.h"
 #include "../../IO/FileStream.h"
+#include "../../Core/ThreadPool.h"
 //==============================
 
 //= NAMESPACES ================
@@ -34,6 +35,12 @@ using namespace Spartan::Math;
 
 namespace Spartan
 {
+    namespace
+    {
+        // Serializes on-read resolves, the per-frame pass doesn't need it
+        static recursive_mutex resolve_mutex;
+    }
+
     Transform::Transform(weak_ptr<Entity> entity) : Component(entity)
     {
         m_position_local  = Vector3::Zero;
@@ -42,6 +49,9 @@ namespace Spartan
         m_matrix          = Matrix::Identity;
         m_matrix_local    = Matrix::Identity;
         m_matrix_previous = Matrix::Identity;
+        m_position        = Vector3::Zero;
+        m_rotation        = Quaternion(0, 0, 0, 1);
+        m_scale           = Vector3::One;
         m_parent          = nullptr;
         m_is_dirty        = true;
 
@@ -59,19 +69,6 @@ namespace Spartan
         m_is_dirty = true;
     }
 
-    void Transform::OnTick()
-    {
-        if (!m_is_dirty)
-            return;
-
-        UpdateTransform();
-
-        m_is_dirty                    = false;
-        m_position_changed_this_frame = false;
-        m_rotation_changed_this_frame = true;
-        m_scale_changed_this_frame    = true;
-    }
-
     void Transform::Serialize(FileStream* stream)
     {
         // Properties
@@ -101,31 +98,126 @@ namespace Spartan
             }
         }
 
-        UpdateTransform();
+        MakeDirty();
     }
 
-    void Transform::UpdateTransform()
+    void Transform::MakeDirty()
     {
+        // A dirty transform always has dirty descendants, so there is no need to go deeper
+        if (m_is_dirty)
+            return;
+
+        m_is_dirty = true;
+
+        for (Transform* child : m_children)
+        {
+            child->MakeDirty();
+        }
+    }
+
+    void Transform::Resolve() const
+    {
+        lock_guard<recursive_mutex> lock(resolve_mutex);
+
+        // Another thread might have resolved it while this one was waiting
+        if (m_is_dirty.load(memory_order_relaxed))
+        {
+            Resolve_Internal();
+        }
+    }
+
+    void Transform::Resolve_Internal() const
+    {
+        const Vector3 position_previous    = m_position;
+        const Quaternion rotation_previous = m_rotation;
+        const Vector3 scale_previous       = m_scale;
+
         // Compute local transform
         m_matrix_local = Matrix(m_position_local, m_rotation_local, m_scale_local);
 
-        // Compute world transform
+        // Compute world transform, the parent resolves first if it's dirty too
         if (m_parent)
         {
             m_matrix = m_matrix_local * m_parent->GetMatrix();
+            m_matrix.Decompose(m_scale, m_rotation, m_position);
         }
         else
         {
-            m_matrix = m_matrix_local;
+            m_matrix   = m_matrix_local;
+            m_position = m_position_local;
+            m_rotation = m_rotation_local;
+            m_scale    = m_scale_local;
+        }
+
+        m_position_changed = m_position_changed || m_position != position_previous;
+        m_rotation_changed = m_rotation_changed || m_rotation != rotation_previous;
+        m_scale_changed    = m_scale_changed    || m_scale    != scale_previous;
+
+        m_is_dirty.store(false, memory_order_release);
+    }
+
+    void Transform::ResolveHierarchy(vector<Transform*>* changed)
+    {
+        // Depth first, so parents are always resolved before their children, and no locking is
+        // needed since every root hierarchy is resolved by a single thread with nothing else reading it
+        if (m_is_dirty.load(memory_order_relaxed))
+        {
+            Resolve_Internal();
+        }
+
+        m_position_changed_this_frame = m_position_changed;
+        m_rotation_changed_this_frame = m_rotation_changed;
+        m_scale_changed_this_frame    = m_scale_changed;
+        m_position_changed            = false;
+        m_rotation_changed            = false;
+        m_scale_changed               = false;
+
+        const bool has_changed = m_position_changed_this_frame || m_rotation_changed_this_frame || m_scale_changed_this_frame;
+        m_frames_unchanged     = has_changed ? 0 : min(m_frames_unchanged + 1, m_frames_unchanged_static);
+
+        if (changed && has_changed)
+        {
+            changed->emplace_back(this);
         }
 
-        // Update children
         for (Transform* child : m_children)
         {
-            child->UpdateTransform();
+            child->ResolveHierarchy(changed);
         }
     }
 
+    void Transform::ResolveHierarchies(const vector<shared_ptr<Entity>>& entities, vector<Transform*>* changed /*= nullptr*/)
+    {
+        vector<Transform*> roots;
+        roots.reserve(entities.size());
+        for (const shared_ptr<Entity>& entity : entities)
+        {
+            if (shared_ptr<Transform> transform = entity->GetTransform())
+            {
+                if (transform->IsRoot())
+                {
+                    roots.emplace_back(transform.get());
+                }
+            }
+        }
+
+        mutex changed_mutex;
+        ThreadPool::ParallelFor([&roots, changed, &changed_mutex](uint32_t work_index_start, uint32_t work_index_end)
+        {
+            vector<Transform*> changed_local;
+            for (uint32_t i = work_index_start; i < work_index_end; i++)
+            {
+                roots[i]->ResolveHierarchy(changed ? &changed_local : nullptr);
+            }
+
+            if (!changed_local.empty())
+            {
+                lock_guard<mutex> lock(changed_mutex);
+                changed->insert(changed->end(), changed_local.begin(), changed_local.end());
+            }
+        }, static_cast<uint32_t>(roots.size()));
+    }
+
     void Transform::SetPosition(const Vector3& position)
     {
         if (GetPosition() == position)
@@ -140,9 +232,7 @@ namespace Spartan
             return;
 
         m_position_local = position;
-        UpdateTransform();
-
-        m_position_changed_this_frame = true;
+        MakeDirty();
     }
 
     void Transform::SetRotation(const Quaternion& rotation)
@@ -159,9 +249,7 @@ namespace Spartan
             return;
 
         m_rotation_local = rotation;
-        UpdateTransform();
-
-        m_rotation_changed_this_frame = true;
+        MakeDirty();
     }
 
     void Transform::SetScale(const Vector3& scale)
@@ -184,9 +272,7 @@ namespace Spartan
         m_scale_local.y = (m_scale_local.y == 0.0f) ? Helper::EPSILON : m_scale_local.y;
         m_scale_local.z = (m_scale_local.z == 0.0f) ? Helper::EPSILON : m_scale_local.z;
 
-        UpdateTransform();
-
-        m_scale_changed_this_frame = true;
+        MakeDirty();
     }
 
     void Transform::Translate(const Vector3& delta)
@@ -311,12 +397,14 @@ namespace Spartan
         if (new_parent)
         {
             new_parent->AddChild_Internal(this);
-            new_parent->MakeDirty();
         }
 
-        // Assign the new parent.
-        m_parent   = new_parent ? new_parent.get() : nullptr;
-        m_is_dirty = true;
+        // Assign the new parent, the world transform is now relative to it
+        m_parent = new_parent ? new_parent.get() : nullptr;
+        MakeDirty();
+
+        // The new parent might be active or not
+        m_entity_ptr->UpdateActiveRecursively();
     }
 
     void Transform::AddChild(Transform* child)
@@ -354,14 +442,16 @@ namespace Spartan
                 return;
         }
 
-        // Mark as dirty if the parent is about to really change.
-        if ((m_parent && !new_parent) || (!m_parent && new_parent))
+        // Assign the new parent.
+        const bool changed = m_parent != new_parent;
+        m_parent           = new_parent;
+
+        // Mark as dirty if the parent really changed
+        if (changed)
         {
-            m_is_dirty = true;
+            MakeDirty();
+            m_entity_ptr->UpdateActiveRecursively();
         }
-
-        // Assign the new parent.
-        m_parent = new_parent;
     }
 
     void Transform::AddChild_Internal(Transform* child)
@@ -39,27 +39,26 @@ namespace Spartan
 
         //= ICOMPONENT ===============================
         void OnInitialize() override;
-        void OnTick() override;
         void Serialize(FileStream* stream) override;
         void Deserialize(FileStream* stream) override;
         //============================================
 
         //= POSITION ======================================================================
-        Math::Vector3 GetPosition()             const { return m_matrix.GetTranslation(); }
+        Math::Vector3 GetPosition()             const { ResolveIfDirty(); return m_position; }
         const Math::Vector3& GetPositionLocal() const { return m_position_local; }
         void SetPosition(const Math::Vector3& position);
         void SetPositionLocal(const Math::Vector3& position);
         //=================================================================================
 
         //= ROTATION ======================================================================
-        Math::Quaternion GetRotation()             const { return m_matrix.GetRotation(); }
+        Math::Quaternion GetRotation()             const { ResolveIfDirty(); return m_rotation; }
         const Math::Quaternion& GetRotationLocal() const { return m_rotation_local; }
         void SetRotation(const Math::Quaternion& rotation);
         void SetRotationLocal(const Math::Quaternion& rotation);
         //=================================================================================
 
         //= SCALE ================================================================
-        Math::Vector3 GetScale()             const { return m_matrix.GetScale(); }
+        Math::Vector3 GetScale()             const { ResolveIfDirty(); return m_scale; }
         const Math::Vector3& GetScaleLocal() const { return m_scale_local; }
         void SetScale(const Math::Vector3& scale);
         void SetScaleLocal(const Math::Vector3& scale);
@@ -83,6 +82,8 @@ namespace Spartan
         bool HasPositionChangedThisFrame() const { return m_position_changed_this_frame; }
         bool HasRotationChangedThisFrame() const { return m_rotation_changed_this_frame; }
         bool HasScaleChangedThisFrame()    const { return m_scale_changed_this_frame; }
+        // static once it hasn't changed for a while, the renderer caches the shadows of static casters
+        bool IsStatic()                    const { return m_frames_unchanged >= m_frames_unchanged_static; }
         //================================================================================
 
         //= HIERARCHY ======================================================================================
@@ -103,14 +104,19 @@ namespace Spartan
         Transform* GetRoot()                         { return HasParent() ? GetParent()->GetRoot() : this; }
         Transform* GetParent()                 const { return m_parent; }
         std::vector<Transform*>& GetChildren()       { return m_children; }
-        void MakeDirty()                             { m_is_dirty = true; }
+        void MakeDirty();
         //==================================================================================================
 
-        const Math::Matrix& GetMatrix()                    const { return m_matrix; }
-        const Math::Matrix& GetLocalMatrix()               const { return m_matrix_local; }
+        const Math::Matrix& GetMatrix()                    const { ResolveIfDirty(); return m_matrix; }
+        const Math::Matrix& GetLocalMatrix()               const { ResolveIfDirty(); return m_matrix_local; }
         const Math::Matrix& GetMatrixPrevious()            const { return m_matrix_previous; }
         void SetMatrixPrevious(const Math::Matrix& matrix)       { m_matrix_previous = matrix;}
 
+        // Resolves every dirty transform of the given entities in one go, once per frame.
+        // Root hierarchies are independent of each other, so they are resolved in parallel.
+        // Optionally returns the transforms which changed this frame.
+        static void ResolveHierarchies(const std::vector<std::shared_ptr<Entity>>& entities, std::vector<Transform*>* changed = nullptr);
+
     private:
         // Internal functions don't propagate changes throughout the hierarchy.
         // They just make enough changes so that the hierarchy can be resolved later (in one go).
@@ -118,17 +124,27 @@ namespace Spartan
         void AddChild_Internal(Transform* child);
         void RemoveChild_Internal(Transform* child);
 
-        void UpdateTransform();
+        // Setters only mark the transform (and its descendants) as dirty, the world
+        // transform is computed once, either by the per-frame pass or when it's read.
+        // Reads can happen from multiple threads, so resolving on read is serialized.
+        void ResolveIfDirty() const { if (m_is_dirty.load(std::memory_order_acquire)) { Resolve(); } }
+        void Resolve() const;
+        void Resolve_Internal() const;
+        void ResolveHierarchy(std::vector<Transform*>* changed);
         Math::Matrix GetParentTransformMatrix() const;
-        bool m_is_dirty = false;
+        mutable std::atomic<bool> m_is_dirty = false;
 
         // local
         Math::Vector3 m_position_local;
         Math::Quaternion m_rotation_local;
         Math::Vector3 m_scale_local;
 
-        Math::Matrix m_matrix;
-        Math::Matrix m_matrix_local;
+        // world, cached when resolved
+        mutable Math::Matrix m_matrix;
+        mutable Math::Matrix m_matrix_local;
+        mutable Math::Vector3 m_position;
+        mutable Math::Quaternion m_rotation;
+        mutable Math::Vector3 m_scale;
 
         Transform* m_parent; // the parent of this transform
         std::vector<Transform*> m_children; // the children of this transform
@@ -138,6 +154,13 @@ namespace Spartan
         bool m_position_changed_this_frame = false;
         bool m_rotation_changed_this_frame = false;
         bool m_scale_changed_this_frame    = false;
+        uint32_t m_frames_unchanged        = 0;
+        static constexpr uint32_t m_frames_unchanged_static = 60;
+
+        // changes since the last per-frame pass, they become the above once it runs
+        mutable bool m_position_changed = false;
+        mutable bool m_rotation_changed = false;
+        mutable bool m_scale_changed    = false;
 
         // thread safety
         std::mutex m_child_add_remove_mutex;
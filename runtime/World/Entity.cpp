@@ -45,17 +45,30 @@ using namespace std;
 
 namespace Spartan
 {
+    namespace
+    {
+        // These touch the physics world or other entities when deserialized, so when
+        // loading in parallel, they are deserialized later, on the calling thread
+        static bool is_deserialization_thread_safe(const ComponentType type)
+        {
+            return type != ComponentType::Collider   &&
+                   type != ComponentType::Constraint &&
+                   type != ComponentType::RigidBody  &&
+                   type != ComponentType::SoftBody   &&
+                   type != ComponentType::Terrain;
+        }
+    }
+
     Entity::Entity()
     {
         m_object_name          = "Entity";
         m_is_active            = true;
         m_hierarchy_visibility = true;
-        m_components.fill(nullptr);
     }
 
     Entity::~Entity()
     {
-        m_components.fill(nullptr);
+        RemoveAllComponents();
     }
 
     void Entity::Initialize()
@@ -113,50 +126,30 @@ namespace Spartan
 
     void Entity::OnStart()
     {
-        for (shared_ptr<Component> component : m_components)
+        for (shared_ptr<Component>& component : GetAllComponents())
         {
-            if (component)
-            {
-                component->OnStart();
-            }
+            component->OnStart();
         }
     }
 
     void Entity::OnStop()
     {
-        for (shared_ptr<Component> component : m_components)
+        for (shared_ptr<Component>& component : GetAllComponents())
         {
-            if (component)
-            {
-                component->OnStop();
-            }
+            component->OnStop();
         }
     }
 
     void Entity::OnPreTick()
     {
 
-    }
-
-	void Entity::Tick()
-    {
-        if (!m_is_active)
-            return;
-
-        for (shared_ptr<Component> component : m_components)
-        {
-            if (component)
-            {
-                component->OnTick();
-            }
-        }
     }
 
     void Entity::Serialize(FileStream* stream)
     {
         // BASIC DATA
         {
-            stream->Write(m_is_active);
+            stream->Write(IsActive());
             stream->Write(m_hierarchy_visibility);
             stream->Write(GetObjectId());
             stream->Write(m_object_name);
@@ -164,25 +157,20 @@ namespace Spartan
 
         // COMPONENTS
         {
-            for (shared_ptr<Component>& component : m_components)
-            {
-                if (component)
-                {
-                    stream->Write(static_cast<uint32_t>(component->GetType()));
-                    stream->Write(component->GetObjectId());
-                }
-                else
-                {
-                    stream->Write(static_cast<uint32_t>(ComponentType::Undefined));
-                }
-            }
+            vector<shared_ptr<Component>> components = GetAllComponents();
+            stream->Write(static_cast<uint32_t>(components.size()));
 
-            for (shared_ptr<Component>& component : m_components)
+            // Each component is written as a sized block, so that loading can defer it without having to parse it
+            vector<byte> block;
+            for (shared_ptr<Component>& component : components)
             {
-                if (component)
-                {
-                    component->Serialize(stream);
-                }
+                stream->Write(static_cast<uint32_t>(component->GetType()));
+                stream->Write(component->GetObjectId());
+
+                block.clear();
+                FileStream block_stream(&block, FileStream_Write);
+                component->Serialize(&block_stream);
+                stream->Write(block);
             }
         }
 
@@ -196,61 +184,67 @@ namespace Spartan
             // Children IDs
             for (Transform* child : children)
             {
-                stream->Write(child->GetObjectId());
+                stream->Write(child->GetEntityPtr()->GetObjectId());
             }
 
             // Children
             for (Transform* child : children)
             {
-                if (child->GetEntityPtr())
-                {
-                    child->GetEntityPtr()->Serialize(stream);
-                }
+                child->GetEntityPtr()->Serialize(stream);
             }
         }
     }
 
-    void Entity::Deserialize(FileStream* stream, shared_ptr<Transform> parent)
+    void Entity::Deserialize(FileStream* stream, shared_ptr<Transform> parent, vector<ComponentBlock>* deferred)
     {
         // BASIC DATA
         {
-            stream->Read(&m_is_active);
+            SetActive(stream->ReadAs<bool>());
             stream->Read(&m_hierarchy_visibility);
-            stream->Read(&m_object_id);
-            stream->Read(&m_object_name);
+            SetObjectId(stream->ReadAs<uint64_t>());
+            SetObjectName(stream->ReadAs<string>());
         }
 
         // COMPONENTS
         {
-            for (uint32_t i = 0; i < static_cast<uint32_t>(m_components.size()); i++)
+            // Sometimes there are component dependencies, e.g. a collider that needs
+            // to set it's shape to a rigibody. So, it's important to first create all
+            // the components and then deserialize them.
+            const uint32_t component_count = stream->ReadAs<uint32_t>();
+            vector<ComponentBlock> blocks(component_count);
+            for (ComponentBlock& block : blocks)
             {
-                // Type
-                uint32_t component_type = static_cast<uint32_t>(ComponentType::Undefined);
-                stream->Read(&component_type);
+                const ComponentType type = static_cast<ComponentType>(stream->ReadAs<uint32_t>());
+                const uint64_t id        = stream->ReadAs<uint64_t>();
+                block.size               = stream->ReadAs<uint32_t>();
+                block.offset             = stream->GetPosition();
+                stream->Skip(block.size);
 
-                if (component_type == static_cast<uint32_t>(ComponentType::Undefined))
-                {
-                    // Id
-                    uint64_t component_id = 0;
-                    stream->Read(&component_id);
+                if (type == ComponentType::Undefined)
+                    continue;
 
-                    shared_ptr<Component> component = AddComponent(static_cast<ComponentType>(component_type));
-                    component->SetObjectId(component_id);
-                }
+                block.component = AddComponent(type);
+                block.component->SetObjectId(id);
             }
 
-            // Sometimes there are component dependencies, e.g. a collider that needs
-            // to set it's shape to a rigibody. So, it's important to first create all 
-            // the components (like above) and then deserialize them (like here).
-            for (shared_ptr<Component>& component : m_components)
+            const uint64_t position_children = stream->GetPosition();
+            for (ComponentBlock& block : blocks)
             {
-                if (component)
+                if (!block.component)
+                    continue;
+
+                if (deferred && !is_deserialization_thread_safe(block.component->GetType()))
                 {
-                    component->Deserialize(stream);
+                    deferred->emplace_back(block);
+                    continue;
                 }
+
+                stream->SetPosition(block.offset);
+                block.component->Deserialize(stream);
             }
+            stream->SetPosition(position_children);
 
-            // Set the transform's parent
+            // Set the transform's parent, this also adds this entity to the parent's children
             GetTransform()->SetParent(parent);
         }
 
@@ -260,7 +254,7 @@ namespace Spartan
             const uint32_t children_count = stream->ReadAs<uint32_t>();
 
             // Children IDs
-            vector<weak_ptr<Entity>> children;
+            vector<shared_ptr<Entity>> children;
             for (uint32_t i = 0; i < children_count; i++)
             {
                 shared_ptr<Entity> child = World::CreateEntity();
@@ -271,26 +265,47 @@ namespace Spartan
             }
 
             // Children
-            for (const auto& child : children)
+            for (shared_ptr<Entity>& child : children)
             {
-                child.lock()->Deserialize(stream, GetTransform());
+                child->Deserialize(stream, GetTransform(), deferred);
             }
-
-            GetTransform()->AcquireChildren();
         }
 
         // Make the scene resolve
-        SP_FIRE_EVENT(EventType::WorldResolve);
+        SP_ENQUEUE_EVENT_DATA(EventType::WorldResolve, weak_from_this());
+    }
+
+    void Entity::SetActive(const bool active)
+    {
+        if (m_is_active == active)
+            return;
+
+        m_is_active = active;
+        UpdateActiveRecursively();
     }
 
-    bool Entity::IsActiveRecursively()
+    void Entity::UpdateActiveRecursively()
     {
-        if (Transform* parent = GetTransform()->GetParent())
+        shared_ptr<Transform> transform = GetTransform();
+        Transform* parent               = transform ? transform->GetParent() : nullptr;
+        const bool active               = m_is_active && (!parent || parent->GetEntityPtr()->IsActiveRecursively());
+
+        if (m_is_active_recursively == active)
+            return;
+
+        m_is_active_recursively = active;
+
+        // Let the world know, so the renderer can pick up the change
+        SP_ENQUEUE_EVENT_DATA(EventType::WorldResolve, weak_from_this());
+
+        // The descendants depend on this entity
+        if (transform)
         {
-            return m_is_active && parent->GetEntityPtr()->IsActiveRecursively();
+            for (Transform* child : transform->GetChildren())
+            {
+                child->GetEntityPtr()->UpdateActiveRecursively();
+            }
         }
-
-        return m_is_active;
     }
     
     shared_ptr<Component> Entity::AddComponent(const ComponentType type)
@@ -326,21 +341,91 @@ namespace Spartan
 
     void Entity::RemoveComponentById(const uint64_t id)
     {
-        for (shared_ptr<Component>& component : m_components)
+        for (uint32_t i = 0; i < static_cast<uint32_t>(m_components.size()); i++)
         {
-            if (component)
+            ComponentHandle& handle = m_components[i];
+            if (!handle.IsValid())
+                continue;
+
+            ComponentPoolBase* pool = ComponentPoolBase::GetPool(static_cast<ComponentType>(i));
+            if (shared_ptr<Component> component = pool->GetComponent(handle))
             {
                 if (id == component->GetObjectId())
                 {
                     component->OnRemove();
-                    component = nullptr;
+                    pool->Remove(handle);
+                    handle = ComponentHandle();
                     break;
                 }
             }
         }
 
         // Make the scene resolve
-        SP_FIRE_EVENT(EventType::WorldResolve);
+        SP_ENQUEUE_EVENT_DATA(EventType::WorldResolve, weak_from_this());
+    }
+
+    void Entity::SetObjectId(const uint64_t id)
+    {
+        const uint64_t id_previous = m_object_id;
+        m_object_id                = id;
+
+        if (IsInWorld())
+        {
+            World::ReindexEntity(this, id_previous, m_object_name);
+        }
+    }
+
+    void Entity::SetObjectName(const string& name)
+    {
+        const string name_previous = m_object_name;
+        m_object_name              = name;
+
+        if (IsInWorld())
+        {
+            World::ReindexEntity(this, m_object_id, name_previous);
+        }
+    }
+
+    shared_ptr<Component> Entity::GetComponent(const ComponentType type)
+    {
+        const uint32_t index = static_cast<uint32_t>(type);
+        if (index >= static_cast<uint32_t>(m_components.size()) || !m_components[index].IsValid())
+            return nullptr;
+
+        ComponentPoolBase* pool = ComponentPoolBase::GetPool(type);
+        return pool ? pool->GetComponent(m_components[index]) : nullptr;
+    }
+
+    vector<shared_ptr<Component>> Entity::GetAllComponents()
+    {
+        vector<shared_ptr<Component>> components;
+        components.reserve(m_components.size());
+
+        for (uint32_t i = 0; i < static_cast<uint32_t>(m_components.size()); i++)
+        {
+            if (shared_ptr<Component> component = GetComponent(static_cast<ComponentType>(i)))
+            {
+                components.emplace_back(component);
+            }
+        }
+
+        return components;
+    }
+
+    void Entity::RemoveAllComponents()
+    {
+        for (uint32_t i = 0; i < static_cast<uint32_t>(m_components.size()); i++)
+        {
+            if (!m_components[i].IsValid())
+                continue;
+
+            if (ComponentPoolBase* pool = ComponentPoolBase::GetPool(static_cast<ComponentType>(i)))
+            {
+                pool->Remove(m_components[i]);
+            }
+
+            m_components[i] = ComponentHandle();
+        }
     }
 
     shared_ptr<Transform> Entity::GetTransform()
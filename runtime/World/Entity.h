@@ -21,15 +21,34 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #pragma once
 
-//= INCLUDES ====================
+//= INCLUDES ========================
 #include "Components/Component.h"
+#include "Components/ComponentPool.h"
 #include "Event.h"
-//===============================
+//===================================
 
 namespace Spartan
 {
     class Transform;
     class Renderable;
+
+    // Identifies an entity slot in the world, the generation is bumped every time the
+    // entity which occupies the slot is removed, so stale handles can be detected.
+    struct EntityHandle
+    {
+        uint32_t index      = std::numeric_limits<uint32_t>::max();
+        uint32_t generation = 0;
+
+        bool IsValid() const { return index != std::numeric_limits<uint32_t>::max(); }
+    };
+
+    // Where a component's serialized data lives in a stream
+    struct ComponentBlock
+    {
+        std::shared_ptr<Component> component;
+        uint64_t offset = 0;
+        uint32_t size   = 0;
+    };
     
     class SP_CLASS Entity : public Object, public std::enable_shared_from_this<Entity>
     {
@@ -49,16 +68,27 @@ namespace Spartan
         // Runs every frame, before any subsystem or entity ticks.
         void OnPreTick();
 
-        // Runs every frame.
-        void Tick();
-
+        // Components are serialized as sized blocks. When deferred is provided, components which can't be deserialized
+        // off the main thread are only created, their blocks are returned so they can be deserialized later.
         void Serialize(FileStream* stream);
-        void Deserialize(FileStream* stream, std::shared_ptr<Transform> parent);
+        void Deserialize(FileStream* stream, std::shared_ptr<Transform> parent, std::vector<ComponentBlock>* deferred = nullptr);
 
         // Active
         bool IsActive() const             { return m_is_active; }
-        void SetActive(const bool active) { m_is_active = active; }
-        bool IsActiveRecursively();
+        void SetActive(const bool active);
+
+        // Active, taking the ancestors into account, it's cached and kept up to date when the entity or any ancestor changes
+        bool IsActiveRecursively() const { return m_is_active_recursively; }
+        void UpdateActiveRecursively();
+
+        // Id and name, they are indexed by the world so it has to be notified when they change
+        void SetObjectId(const uint64_t id) override;
+        void SetObjectName(const std::string& name) override;
+
+        // Handle, assigned by the world, only the components of entities which are part of the world get ticked
+        const EntityHandle& GetHandle() const          { return m_handle; }
+        void SetHandle(const EntityHandle& handle)     { m_handle = handle; }
+        bool IsInWorld() const                         { return m_handle.IsValid(); }
 
         // Visible
         bool IsVisibleInHierarchy() const                            { return m_hierarchy_visibility; }
@@ -74,18 +104,15 @@ namespace Spartan
             if (std::shared_ptr<T> component = GetComponent<T>())
                 return component;
 
-            // Create a new component
-            std::shared_ptr<T> component = std::make_shared<T>(this->shared_from_this());
-
-            // Save new component
-            m_components[static_cast<uint32_t>(type)] = std::static_pointer_cast<Component>(component);
+            // Create a new component, it lives in the pool of its type
+            std::shared_ptr<T> component = ComponentPool<T>::Get().Create(this->shared_from_this(), &m_components[static_cast<uint32_t>(type)]);
 
             // Initialize component
             component->SetType(type);
             component->OnInitialize();
 
             // Make the scene resolve
-            SP_FIRE_EVENT(EventType::WorldResolve);
+            SP_ENQUEUE_EVENT_DATA(EventType::WorldResolve, weak_from_this());
 
             return component;
         }
@@ -98,26 +125,39 @@ namespace Spartan
         std::shared_ptr<T> GetComponent()
         {
             const ComponentType component_type = Component::TypeToEnum<T>();
-            return std::static_pointer_cast<T>(m_components[static_cast<uint32_t>(component_type)]);
+            const ComponentHandle handle       = m_components[static_cast<uint32_t>(component_type)];
+            return handle.IsValid() ? ComponentPool<T>::Get().Get(handle) : nullptr;
         }
 
+        // Returns a component of ComponentType
+        std::shared_ptr<Component> GetComponent(ComponentType type);
+
         // Removes a component
         template <class T>
         void RemoveComponent()
         {
             const ComponentType component_type = Component::TypeToEnum<T>();
-            m_components[static_cast<uint32_t>(component_type)] = nullptr;
-
-            SP_FIRE_EVENT(EventType::WorldResolve);
+            ComponentHandle& handle            = m_components[static_cast<uint32_t>(component_type)];
+            if (handle.IsValid())
+            {
+                ComponentPool<T>::Get().Remove(handle);
+                handle = ComponentHandle();
+            }
+
+            SP_ENQUEUE_EVENT_DATA(EventType::WorldResolve, weak_from_this());
         }
 
         void RemoveComponentById(uint64_t id);
-        const auto& GetAllComponents() const { return m_components; }
+        std::vector<std::shared_ptr<Component>> GetAllComponents();
         std::shared_ptr<Transform> GetTransform();
 
     private:
-        std::atomic<bool> m_is_active = true;
+        void RemoveAllComponents();
+
+        std::atomic<bool> m_is_active             = true;
+        std::atomic<bool> m_is_active_recursively = true;
         bool m_hierarchy_visibility   = true;
-        std::array<std::shared_ptr<Component>, 14> m_components;
+        EntityHandle m_handle;
+        std::array<ComponentHandle, 14> m_components;
     };
 }
@@ -0,0 +1,344 @@
+/*
+Copyright(c) 2016-2023 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ============
+#include "pch.h"
+#include "SpatialIndex.h"
+//=======================
+
+//= NAMESPACES ===============
+using namespace std;
+using namespace Spartan::Math;
+//============================
+
+namespace Spartan
+{
+    namespace
+    {
+        // How much bigger a leaf's box is than the real one, relative to its size plus a constant, in meters
+        static const float fat_box_ratio  = 0.1f;
+        static const float fat_box_margin = 0.1f;
+
+        static BoundingBox merge(const BoundingBox& a, const BoundingBox& b)
+        {
+            BoundingBox box = a;
+            box.Merge(b);
+            return box;
+        }
+
+        static float surface_area(const BoundingBox& box)
+        {
+            const Vector3 size = box.GetSize();
+            return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+        }
+
+        static bool contains(const BoundingBox& outer, const BoundingBox& inner)
+        {
+            return outer.GetMin().x <= inner.GetMin().x && outer.GetMin().y <= inner.GetMin().y && outer.GetMin().z <= inner.GetMin().z &&
+                   outer.GetMax().x >= inner.GetMax().x && outer.GetMax().y >= inner.GetMax().y && outer.GetMax().z >= inner.GetMax().z;
+        }
+
+        static BoundingBox fatten(const BoundingBox& box)
+        {
+            const Vector3 margin = box.GetExtents() * fat_box_ratio + Vector3(fat_box_margin);
+            return BoundingBox(box.GetMin() - margin, box.GetMax() + margin);
+        }
+    }
+
+    int32_t SpatialIndex::Insert(const BoundingBox& box, Entity* entity, const uint32_t category)
+    {
+        unique_lock lock(m_mutex);
+
+        const int32_t proxy = AllocateNode();
+        Node& node          = m_nodes[proxy];
+        node.box            = fatten(box);
+        node.entity         = entity;
+        node.category       = category;
+        node.height         = 0;
+
+        InsertLeaf(proxy);
+        m_proxy_count++;
+
+        return proxy;
+    }
+
+    void SpatialIndex::Remove(const int32_t proxy)
+    {
+        unique_lock lock(m_mutex);
+
+        SP_ASSERT(proxy >= 0 && proxy < static_cast<int32_t>(m_nodes.size()) && m_nodes[proxy].IsLeaf());
+
+        RemoveLeaf(proxy);
+        FreeNode(proxy);
+        m_proxy_count--;
+    }
+
+    bool SpatialIndex::Move(const int32_t proxy, const BoundingBox& box)
+    {
+        unique_lock lock(m_mutex);
+
+        SP_ASSERT(proxy >= 0 && proxy < static_cast<int32_t>(m_nodes.size()) && m_nodes[proxy].IsLeaf());
+
+        // Still inside of the fat box, nothing to do
+        if (contains(m_nodes[proxy].box, box))
+            return false;
+
+        RemoveLeaf(proxy);
+        m_nodes[proxy].box = fatten(box);
+        InsertLeaf(proxy);
+
+        return true;
+    }
+
+    void SpatialIndex::Clear()
+    {
+        unique_lock lock(m_mutex);
+
+        m_nodes.clear();
+        m_root        = null_node;
+        m_free        = null_node;
+        m_proxy_count = 0;
+    }
+
+    int32_t SpatialIndex::AllocateNode()
+    {
+        if (m_free == null_node)
+        {
+            m_nodes.emplace_back();
+            return static_cast<int32_t>(m_nodes.size() - 1);
+        }
+
+        const int32_t index = m_free;
+        m_free              = m_nodes[index].parent;
+        m_nodes[index]      = Node();
+
+        return index;
+    }
+
+    void SpatialIndex::FreeNode(const int32_t index)
+    {
+        Node& node  = m_nodes[index];
+        node        = Node();
+        node.parent = m_free;
+        m_free      = index;
+    }
+
+    void SpatialIndex::InsertLeaf(const int32_t leaf)
+    {
+        if (m_root == null_node)
+        {
+            m_root               = leaf;
+            m_nodes[leaf].parent = null_node;
+            return;
+        }
+
+        // Find the cheapest sibling, the cost is the surface area added to the tree
+        const BoundingBox box = m_nodes[leaf].box;
+        int32_t index         = m_root;
+        while (!m_nodes[index].IsLeaf())
+        {
+            const Node& node = m_nodes[index];
+
+            const float area          = surface_area(node.box);
+            const float area_combined = surface_area(merge(node.box, box));
+
+            // Cost of making a new parent for this node and the leaf
+            const float cost = 2.0f * area_combined;
+
+            // Minimum cost of pushing the leaf further down, every ancestor grows
+            const float cost_inheritance = 2.0f * (area_combined - area);
+
+            auto cost_descend = [this, &box, cost_inheritance](const int32_t child_index)
+            {
+                const Node& child    = m_nodes[child_index];
+                const float area_new = surface_area(merge(box, child.box));
+                return (child.IsLeaf() ? area_new : area_new - surface_area(child.box)) + cost_inheritance;
+            };
+            const float cost_1 = cost_descend(node.child_1);
+            const float cost_2 = cost_descend(node.child_2);
+
+            if (cost < cost_1 && cost < cost_2)
+                break;
+
+            index = cost_1 < cost_2 ? node.child_1 : node.child_2;
+        }
+        const int32_t sibling = index;
+
+        // Create a new parent for the sibling and the leaf
+        const int32_t parent_old = m_nodes[sibling].parent;
+        const int32_t parent_new = AllocateNode();
+        Node& parent             = m_nodes[parent_new];
+        parent.parent            = parent_old;
+        parent.box               = merge(box, m_nodes[sibling].box);
+        parent.category          = m_nodes[leaf].category | m_nodes[sibling].category;
+        parent.height            = m_nodes[sibling].height + 1;
+        parent.child_1           = sibling;
+        parent.child_2           = leaf;
+        m_nodes[sibling].parent  = parent_new;
+        m_nodes[leaf].parent     = parent_new;
+
+        if (parent_old != null_node)
+        {
+            int32_t& child = m_nodes[parent_old].child_1 == sibling ? m_nodes[parent_old].child_1 : m_nodes[parent_old].child_2;
+            child          = parent_new;
+        }
+        else
+        {
+            m_root = parent_new;
+        }
+
+        // Walk back up, balancing and refitting the ancestors
+        index = m_nodes[leaf].parent;
+        while (index != null_node)
+        {
+            index = Balance(index);
+            Refit(index);
+            index = m_nodes[index].parent;
+        }
+    }
+
+    void SpatialIndex::RemoveLeaf(const int32_t leaf)
+    {
+        if (leaf == m_root)
+        {
+            m_root = null_node;
+            return;
+        }
+
+        const int32_t parent      = m_nodes[leaf].parent;
+        const int32_t grandparent = m_nodes[parent].parent;
+        const int32_t sibling     = m_nodes[parent].child_1 == leaf ? m_nodes[parent].child_2 : m_nodes[parent].child_1;
+
+        // The sibling takes the place of the parent
+        if (grandparent != null_node)
+        {
+            int32_t& child          = m_nodes[grandparent].child_1 == parent ? m_nodes[grandparent].child_1 : m_nodes[grandparent].child_2;
+            child                   = sibling;
+            m_nodes[sibling].parent = grandparent;
+            FreeNode(parent);
+
+            int32_t index = grandparent;
+            while (index != null_node)
+            {
+                index = Balance(index);
+                Refit(index);
+                index = m_nodes[index].parent;
+            }
+        }
+        else
+        {
+            m_root                  = sibling;
+            m_nodes[sibling].parent = null_node;
+            FreeNode(parent);
+        }
+
+        m_nodes[leaf].parent = null_node;
+    }
+
+    int32_t SpatialIndex::Balance(const int32_t index_a)
+    {
+        // Rotates the taller child up when the children's heights differ by more than one
+        Node& a = m_nodes[index_a];
+        if (a.IsLeaf() || a.height < 2)
+            return index_a;
+
+        const int32_t index_b = a.child_1;
+        const int32_t index_c = a.child_2;
+        Node& b               = m_nodes[index_b];
+        Node& c               = m_nodes[index_c];
+        const int32_t balance = c.height - b.height;
+
+        auto replace_in_parent = [this, index_a](const int32_t index_new)
+        {
+            const int32_t parent = m_nodes[index_new].parent;
+            if (parent != null_node)
+            {
+                int32_t& child = m_nodes[parent].child_1 == index_a ? m_nodes[parent].child_1 : m_nodes[parent].child_2;
+                child          = index_new;
+            }
+            else
+            {
+                m_root = index_new;
+            }
+        };
+
+        // Rotate c up
+        if (balance > 1)
+        {
+            const int32_t index_f = c.child_1;
+            const int32_t index_g = c.child_2;
+
+            c.child_1 = index_a;
+            c.parent  = a.parent;
+            a.parent  = index_c;
+            replace_in_parent(index_c);
+
+            // The taller of c's children stays with c
+            const bool f_taller        = m_nodes[index_f].height > m_nodes[index_g].height;
+            const int32_t index_keep   = f_taller ? index_f : index_g;
+            const int32_t index_move   = f_taller ? index_g : index_f;
+            c.child_2                  = index_keep;
+            a.child_2                  = index_move;
+            m_nodes[index_move].parent = index_a;
+
+            Refit(index_a);
+            Refit(index_c);
+
+            return index_c;
+        }
+
+        // Rotate b up
+        if (balance < -1)
+        {
+            const int32_t index_d = b.child_1;
+            const int32_t index_e = b.child_2;
+
+            b.child_1 = index_a;
+            b.parent  = a.parent;
+            a.parent  = index_b;
+            replace_in_parent(index_b);
+
+            const bool d_taller        = m_nodes[index_d].height > m_nodes[index_e].height;
+            const int32_t index_keep   = d_taller ? index_d : index_e;
+            const int32_t index_move   = d_taller ? index_e : index_d;
+            b.child_2                  = index_keep;
+            a.child_1                  = index_move;
+            m_nodes[index_move].parent = index_a;
+
+            Refit(index_a);
+            Refit(index_b);
+
+            return index_b;
+        }
+
+        return index_a;
+    }
+
+    void SpatialIndex::Refit(const int32_t index)
+    {
+        Node& node          = m_nodes[index];
+        const Node& child_1 = m_nodes[node.child_1];
+        const Node& child_2 = m_nodes[node.child_2];
+        node.box            = merge(child_1.box, child_2.box);
+        node.category       = child_1.category | child_2.category;
+        node.height         = 1 + max(child_1.height, child_2.height);
+    }
+}
@@ -0,0 +1,185 @@
+/*
+Copyright(c) 2016-2023 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ====================
+#include <shared_mutex>
+#include <vector>
+#include "Definitions.h"
+#include "../Math/BoundingBox.h"
+#include "../Math/Frustum.h"
+#include "../Math/Ray.h"
+//===============================
+
+namespace Spartan
+{
+    class Entity;
+
+    enum SpatialCategory : uint32_t
+    {
+        SpatialCategory_Renderable      = 1 << 0,
+        SpatialCategory_Light           = 1 << 1,
+        SpatialCategory_ReflectionProbe = 1 << 2,
+        SpatialCategory_All             = 0xFFFFFFFF
+    };
+
+    // Dynamic AABB tree. Leaves hold a "fat" box, slightly bigger than the real one, so small movements
+    // don't touch the tree. Inserting picks the sibling with the cheapest surface area increase and the
+    // tree is kept balanced with rotations, so queries are O(log n) plus the number of hits.
+    // Queries can run concurrently with each other, modifications are exclusive.
+    class SP_CLASS SpatialIndex
+    {
+    public:
+        static const int32_t null_node = -1;
+
+        // Returns the proxy id
+        int32_t Insert(const Math::BoundingBox& box, Entity* entity, const uint32_t category);
+        void Remove(const int32_t proxy);
+
+        // Returns true if the proxy had to be re-inserted (the box left its fat box)
+        bool Move(const int32_t proxy, const Math::BoundingBox& box);
+
+        void Clear();
+
+        uint32_t GetProxyCount() const { return m_proxy_count; }
+        uint32_t GetHeight() const { return m_root == null_node ? 0 : static_cast<uint32_t>(m_nodes[m_root].height); }
+
+        // The callback gets the entity of every proxy (in the category mask) whose fat box passes the test
+        template <typename Callback>
+        void QueryFrustum(const Math::Frustum& frustum, const uint32_t category_mask, Callback&& callback, const bool ignore_near_plane = false) const
+        {
+            Query(category_mask, callback, [&frustum, ignore_near_plane](const Math::BoundingBox& box)
+            {
+                return frustum.IsVisible(box.GetCenter(), box.GetExtents(), ignore_near_plane);
+            });
+        }
+
+        template <typename Callback>
+        void QuerySphere(const Math::Vector3& center, const float radius, const uint32_t category_mask, Callback&& callback) const
+        {
+            Query(category_mask, callback, [&center, radius](const Math::BoundingBox& box)
+            {
+                const Math::Vector3 closest = Math::Vector3
+                (
+                    Math::Helper::Clamp(center.x, box.GetMin().x, box.GetMax().x),
+                    Math::Helper::Clamp(center.y, box.GetMin().y, box.GetMax().y),
+                    Math::Helper::Clamp(center.z, box.GetMin().z, box.GetMax().z)
+                );
+                return (closest - center).LengthSquared() <= radius * radius;
+            });
+        }
+
+        template <typename Callback>
+        void QueryBox(const Math::BoundingBox& box_query, const uint32_t category_mask, Callback&& callback) const
+        {
+            Query(category_mask, callback, [&box_query](const Math::BoundingBox& box)
+            {
+                return box.IsInside(box_query) != Math::Intersection::Outside;
+            });
+        }
+
+        // The callback also gets the distance to the (fat) box
+        template <typename Callback>
+        void QueryRay(const Math::Ray& ray, const uint32_t category_mask, Callback&& callback) const
+        {
+            std::shared_lock lock(m_mutex);
+
+            Traverse(category_mask, [&ray](const Math::BoundingBox& box)
+            {
+                return ray.HitDistance(box) != Math::Helper::INFINITY_;
+            },
+            [&ray, &callback](const Node& node)
+            {
+                callback(node.entity, ray.HitDistance(node.box));
+            });
+        }
+
+    private:
+        struct Node
+        {
+            Math::BoundingBox box;
+            Entity* entity    = nullptr;
+            uint32_t category = 0;         // for internal nodes, the categories found below
+            int32_t parent    = null_node; // doubles as the next free node
+            int32_t child_1   = null_node;
+            int32_t child_2   = null_node;
+            int32_t height    = -1;        // leaves are 0, free nodes are -1
+
+            bool IsLeaf() const { return child_1 == null_node; }
+        };
+
+        template <typename Callback, typename Test>
+        void Query(const uint32_t category_mask, Callback& callback, Test&& test) const
+        {
+            std::shared_lock lock(m_mutex);
+
+            Traverse(category_mask, test, [&callback](const Node& node)
+            {
+                callback(node.entity);
+            });
+        }
+
+        template <typename Test, typename Visit>
+        void Traverse(const uint32_t category_mask, Test&& test, Visit&& visit) const
+        {
+            if (m_root == null_node)
+                return;
+
+            // A balanced tree is far shallower than this
+            int32_t stack[256];
+            uint32_t stack_count = 0;
+            stack[stack_count++] = m_root;
+
+            while (stack_count > 0)
+            {
+                const Node& node = m_nodes[stack[--stack_count]];
+
+                if ((node.category & category_mask) == 0 || !test(node.box))
+                    continue;
+
+                if (node.IsLeaf())
+                {
+                    visit(node);
+                }
+                else
+                {
+                    SP_ASSERT(stack_count + 2 <= 256);
+                    stack[stack_count++] = node.child_1;
+                    stack[stack_count++] = node.child_2;
+                }
+            }
+        }
+
+        int32_t AllocateNode();
+        void FreeNode(const int32_t node);
+        void InsertLeaf(const int32_t leaf);
+        void RemoveLeaf(const int32_t leaf);
+        int32_t Balance(const int32_t node);
+        void Refit(const int32_t node);
+
+        std::vector<Node> m_nodes;
+        int32_t m_root         = null_node;
+        int32_t m_free         = null_node;
+        uint32_t m_proxy_count = 0;
+        mutable std::shared_mutex m_mutex;
+    };
+}
@@ -23,6 +23,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "pch.h"
 #include "World.h"
 #include "Entity.h"
+#include "SpatialIndex.h"
 #include "Components/Transform.h"
 #include "Components/Camera.h"
 #include "Components/Light.h"
@@ -32,9 +33,13 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Components/RigidBody.h"
 #include "Components/Collider.h"
 #include "Components/Terrain.h"
+#include "Components/Renderable.h"
+#include "Components/ReflectionProbe.h"
 #include "../Resource/ResourceCache.h"
 #include "../IO/FileStream.h"
 #include "../Profiling/Profiler.h"
+#include "../Core/ThreadPool.h"
+#include "../Core/SlabAllocator.h"
 #include "../RHI/RHI_Texture2D.h"
 #include "../Rendering/Mesh.h"
 //====================================
@@ -53,6 +58,7 @@ namespace Spartan
         static string m_file_path;
         static bool m_resolve                                   = false;
         static bool m_was_in_editor_mode                        = false;
+        static bool m_tick_parallel                             = true;
         static shared_ptr<Entity> m_default_environment         = nullptr;
         static shared_ptr<Entity> m_default_model_floor         = nullptr;
         static shared_ptr<Mesh> m_default_model_sponza          = nullptr;
@@ -62,6 +68,43 @@ namespace Spartan
         static shared_ptr<Mesh> m_default_model_helmet_damaged  = nullptr;
         static mutex m_entity_access_mutex;
 
+        // Changes since the last resolve, entities can be created and modified from any thread
+        static mutex m_change_log_mutex;
+        static WorldChangeLog m_change_log;
+        static WorldChangeLog m_change_log_published;
+
+        // World file layout: header (magic, version, root count), a table of contents with one entry (id, offset, size)
+        // per root entity, and then the root hierarchies, one block each, so they can be loaded independently.
+        static const uint32_t world_file_magic   = 0x444C5257; // "WRLD"
+        static const uint32_t world_file_version = 1;
+        struct WorldFileTocEntry
+        {
+            uint64_t id     = 0;
+            uint64_t offset = 0;
+            uint64_t size   = 0;
+        };
+
+        // Entity slots, chunks are never moved or freed, so handles can be validated without locking
+        struct EntitySlot
+        {
+            shared_ptr<Entity> entity;
+            atomic<uint32_t> generation = 0;
+        };
+        static const uint32_t entity_slots_per_chunk = 4096;
+        static array<atomic<EntitySlot*>, 1024> m_entity_slot_chunks;
+        static uint32_t m_entity_slot_count = 0;
+        static vector<uint32_t> m_entity_slots_free;
+
+        // Lookups, they map to slot indices
+        static unordered_map<uint64_t, uint32_t> m_entity_index_id;
+        static unordered_multimap<string, uint32_t> m_entity_index_name;
+
+        // Renderables, lights and reflection probes, an entity's proxies are found by its slot index
+        static SpatialIndex m_spatial_index;
+        static vector<array<int32_t, 3>> m_spatial_proxies;
+        static vector<Transform*> m_transforms_changed;
+        static const array<uint32_t, 3> spatial_categories = { SpatialCategory_Renderable, SpatialCategory_Light, SpatialCategory_ReflectionProbe };
+
         static void update_default_scene()
         {
             if (m_default_model_car)
@@ -76,11 +119,203 @@ namespace Spartan
         }
     }
 
+    namespace spatial
+    {
+        // Returns false if the entity doesn't belong in the category
+        static bool get_box(Entity* entity, const uint32_t category, BoundingBox* box)
+        {
+            if (!entity->IsActiveRecursively())
+                return false;
+
+            if (category == SpatialCategory_Renderable)
+            {
+                if (shared_ptr<Renderable> renderable = entity->GetComponent<Renderable>())
+                {
+                    *box = renderable->GetAabb();
+                    return box->Defined();
+                }
+            }
+            else if (category == SpatialCategory_Light)
+            {
+                // Directional lights reach everything, there is no point in indexing them
+                shared_ptr<Light> light = entity->GetComponent<Light>();
+                if (light && light->GetLightType() != LightType::Directional)
+                {
+                    const Vector3 position = entity->GetTransform()->GetPosition();
+                    const Vector3 range    = Vector3(light->GetRange());
+                    *box                   = BoundingBox(position - range, position + range);
+                    return true;
+                }
+            }
+            else if (category == SpatialCategory_ReflectionProbe)
+            {
+                if (shared_ptr<ReflectionProbe> probe = entity->GetComponent<ReflectionProbe>())
+                {
+                    const Vector3 position = entity->GetTransform()->GetPosition();
+                    *box                   = BoundingBox(position - probe->GetExtents(), position + probe->GetExtents());
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        // Expects m_entity_access_mutex to be held, inserts, moves or removes the entity's proxies so they match its components
+        static void update(Entity* entity)
+        {
+            if (!entity->IsInWorld())
+                return;
+
+            const uint32_t index = entity->GetHandle().index;
+            if (index >= m_spatial_proxies.size())
+            {
+                array<int32_t, 3> proxies_none;
+                proxies_none.fill(SpatialIndex::null_node);
+                m_spatial_proxies.resize(index + 1, proxies_none);
+            }
+
+            for (uint32_t i = 0; i < static_cast<uint32_t>(spatial_categories.size()); i++)
+            {
+                int32_t& proxy = m_spatial_proxies[index][i];
+
+                BoundingBox box;
+                if (get_box(entity, spatial_categories[i], &box))
+                {
+                    if (proxy == SpatialIndex::null_node)
+                    {
+                        proxy = m_spatial_index.Insert(box, entity, spatial_categories[i]);
+                    }
+                    else
+                    {
+                        m_spatial_index.Move(proxy, box);
+                    }
+                }
+                else if (proxy != SpatialIndex::null_node)
+                {
+                    m_spatial_index.Remove(proxy);
+                    proxy = SpatialIndex::null_node;
+                }
+            }
+        }
+
+        // Expects m_entity_access_mutex to be held
+        static void remove(const uint32_t index)
+        {
+            if (index >= m_spatial_proxies.size())
+                return;
+
+            for (int32_t& proxy : m_spatial_proxies[index])
+            {
+                if (proxy != SpatialIndex::null_node)
+                {
+                    m_spatial_index.Remove(proxy);
+                    proxy = SpatialIndex::null_node;
+                }
+            }
+        }
+    }
+
+    namespace entity_index
+    {
+        static EntitySlot& get_slot(const uint32_t index)
+        {
+            return m_entity_slot_chunks[index / entity_slots_per_chunk].load(memory_order_relaxed)[index % entity_slots_per_chunk];
+        }
+
+        // Expects m_entity_access_mutex to be held
+        static void add(const shared_ptr<Entity>& entity)
+        {
+            uint32_t index = 0;
+            if (!m_entity_slots_free.empty())
+            {
+                index = m_entity_slots_free.back();
+                m_entity_slots_free.pop_back();
+            }
+            else
+            {
+                index = m_entity_slot_count++;
+
+                const uint32_t chunk_index = index / entity_slots_per_chunk;
+                SP_ASSERT_MSG(chunk_index < m_entity_slot_chunks.size(), "Too many entities");
+                if (!m_entity_slot_chunks[chunk_index].load(memory_order_relaxed))
+                {
+                    m_entity_slot_chunks[chunk_index].store(new EntitySlot[entity_slots_per_chunk], memory_order_release);
+                }
+            }
+
+            EntitySlot& slot = get_slot(index);
+            slot.entity      = entity;
+
+            EntityHandle handle;
+            handle.index      = index;
+            handle.generation = slot.generation.load(memory_order_relaxed);
+            entity->SetHandle(handle);
+
+            m_entity_index_id[entity->GetObjectId()] = index;
+            m_entity_index_name.emplace(entity->GetObjectName(), index);
+        }
+
+        static void remove_id(const uint64_t id, const uint32_t index)
+        {
+            auto it = m_entity_index_id.find(id);
+            if (it != m_entity_index_id.end() && it->second == index)
+            {
+                m_entity_index_id.erase(it);
+            }
+        }
+
+        static void remove_name(const string& name, const uint32_t index)
+        {
+            auto range = m_entity_index_name.equal_range(name);
+            for (auto it = range.first; it != range.second; it++)
+            {
+                if (it->second == index)
+                {
+                    m_entity_index_name.erase(it);
+                    break;
+                }
+            }
+        }
+
+        // Expects m_entity_access_mutex to be held
+        static void remove(Entity* entity)
+        {
+            const uint32_t index = entity->GetHandle().index;
+            remove_id(entity->GetObjectId(), index);
+            remove_name(entity->GetObjectName(), index);
+            spatial::remove(index);
+
+            // Bumping the generation invalidates every handle to this entity
+            EntitySlot& slot = get_slot(index);
+            slot.generation.fetch_add(1, memory_order_release);
+            entity->SetHandle(EntityHandle());
+            m_entity_slots_free.emplace_back(index);
+
+            // Released last, it can be the last reference
+            slot.entity = nullptr;
+        }
+    }
+
     void World::Initialize()
     {
+        // Enqueued with the entity that changed, or without data when everything needs to be re-evaluated
         SP_SUBSCRIBE_TO_EVENT(EventType::WorldResolve, SP_EVENT_HANDLER_EXPRESSION_STATIC
         (
-            m_resolve = true;
+            if (const weak_ptr<Entity>* entity_weak = get_if<weak_ptr<Entity>>(&var))
+            {
+                if (shared_ptr<Entity> entity = entity_weak->lock())
+                {
+                    if (entity->IsInWorld())
+                    {
+                        lock_guard<mutex> lock(m_change_log_mutex);
+                        m_change_log.modified.emplace_back(entity);
+                    }
+                }
+            }
+            else
+            {
+                m_resolve = true;
+            }
         ));
     }
 
@@ -135,18 +370,57 @@ namespace Spartan
                 }
             }
 
-            // Tick
-            for (shared_ptr<Entity>& entity : m_entities)
-            {
-                entity->Tick();
-            }
+            // Tick, skipping component types which don't do per-frame work
+            ComponentPoolBase::TickAll(m_tick_parallel);
+
+            // Resolve all the transforms which were modified during the tick
+            m_transforms_changed.clear();
+            Transform::ResolveHierarchies(m_entities, &m_transforms_changed);
         }
 
-        // Notify Renderer
-        if (m_resolve)
+        // Keep the spatial index up to date with what moved
+        for (Transform* transform : m_transforms_changed)
         {
-            SP_FIRE_EVENT_DATA(EventType::WorldResolved, m_entities);
-            m_resolve = false;
+            spatial::update(transform->GetEntityPtr());
+        }
+
+        // Notify Renderer, it applies the changes to what it already has
+        {
+            {
+                lock_guard<mutex> lock(m_change_log_mutex);
+                swap(m_change_log, m_change_log_published);
+                m_change_log.Clear();
+            }
+
+            if (m_resolve)
+            {
+                m_change_log_published.Clear();
+                m_change_log_published.added = m_entities;
+                m_change_log_published.full  = true;
+                m_resolve                    = false;
+            }
+
+            if (!m_change_log_published.IsEmpty())
+            {
+                // An entity can be modified many times per frame, only report it once
+                vector<shared_ptr<Entity>>& modified = m_change_log_published.modified;
+                sort(modified.begin(), modified.end());
+                modified.erase(unique(modified.begin(), modified.end()), modified.end());
+
+                // And with what was added or changed
+                for (const shared_ptr<Entity>& entity : m_change_log_published.added)
+                {
+                    spatial::update(entity.get());
+                }
+                for (const shared_ptr<Entity>& entity : modified)
+                {
+                    spatial::update(entity.get());
+                }
+
+                SP_FIRE_EVENT_DATA(EventType::WorldResolved, static_cast<void*>(&m_change_log_published));
+            }
+
+            m_change_log_published.Clear();
         }
 
         if (Engine::IsFlagSet(EngineMode::Game))
@@ -155,6 +429,16 @@ namespace Spartan
         }
     }
 
+    void World::SetTickParallel(const bool parallel)
+    {
+        m_tick_parallel = parallel;
+    }
+
+    bool World::IsTickParallel()
+    {
+        return m_tick_parallel;
+    }
+
     void World::New()
     {
         Clear();
@@ -192,20 +476,34 @@ namespace Spartan
         const Stopwatch timer;
         ProgressTracker::GetProgress(ProgressType::World).Start(root_entity_count, "Saving world...");
 
-        // Save root entity count
+        // Serialize each root hierarchy into its own block
+        vector<vector<byte>> blocks(root_entity_count);
+        for (uint32_t i = 0; i < root_entity_count; i++)
+        {
+            FileStream block_stream(&blocks[i], FileStream_Write);
+            root_actors[i]->Serialize(&block_stream);
+            ProgressTracker::GetProgress(ProgressType::World).JobDone();
+        }
+
+        // Header
+        file->Write(world_file_magic);
+        file->Write(world_file_version);
         file->Write(root_entity_count);
 
-        // Save root entity IDs
-        for (shared_ptr<Entity>& root : root_actors)
+        // Table of contents, the blocks start right after it
+        uint64_t offset = sizeof(uint32_t) * 3 + static_cast<uint64_t>(root_entity_count) * sizeof(WorldFileTocEntry);
+        for (uint32_t i = 0; i < root_entity_count; i++)
         {
-            file->Write(root->GetObjectId());
+            file->Write(root_actors[i]->GetObjectId());
+            file->Write(offset);
+            file->Write(static_cast<uint64_t>(blocks[i].size()));
+            offset += blocks[i].size();
         }
 
-        // Save root entities
-        for (shared_ptr<Entity>& root : root_actors)
+        // Blocks
+        for (const vector<byte>& block : blocks)
         {
-            root->Serialize(file.get());
-            ProgressTracker::GetProgress(ProgressType::World).JobDone();
+            file->WriteBytes(block.data(), block.size());
         }
 
         // Report time
@@ -225,14 +523,59 @@ namespace Spartan
             return false;
         }
 
-        // Open file
-        unique_ptr<FileStream> file = make_unique<FileStream>(file_path, FileStream_Read);
-        if (!file->IsOpen())
+        // Read the whole file in one go, everything is deserialized from memory
+        vector<byte> buffer;
+        {
+            FileStream file(file_path, FileStream_Read);
+            if (!file.IsOpen())
+            {
+                SP_LOG_ERROR("Failed to open \"%s\"", file_path.c_str());
+                return false;
+            }
+
+            buffer.resize(static_cast<size_t>(filesystem::file_size(file_path)));
+            file.ReadBytes(buffer.data(), buffer.size());
+        }
+        FileStream stream(&buffer, FileStream_Read);
+
+        // Header
+        if (buffer.size() < sizeof(uint32_t) * 3 || stream.ReadAs<uint32_t>() != world_file_magic)
         {
-            SP_LOG_ERROR("Failed to open \"%s\"", file_path.c_str());
+            SP_LOG_ERROR("\"%s\" is not a world file, or it was saved in an older format", file_path.c_str());
             return false;
         }
 
+        const uint32_t version = stream.ReadAs<uint32_t>();
+        if (version > world_file_version)
+        {
+            SP_LOG_ERROR("\"%s\" has version %d, the newest supported version is %d", file_path.c_str(), version, world_file_version);
+            return false;
+        }
+
+        // Table of contents, validated before anything is cleared, so a corrupted or truncated file leaves the world as it is
+        const uint32_t root_entity_count = stream.ReadAs<uint32_t>();
+        const uint64_t toc_end           = sizeof(uint32_t) * 3 + static_cast<uint64_t>(root_entity_count) * sizeof(WorldFileTocEntry);
+        if (toc_end > buffer.size())
+        {
+            SP_LOG_ERROR("\"%s\" is truncated, its table of contents doesn't fit in the file", file_path.c_str());
+            return false;
+        }
+
+        vector<WorldFileTocEntry> toc(root_entity_count);
+        for (uint32_t i = 0; i < root_entity_count; i++)
+        {
+            stream.Read(&toc[i].id);
+            stream.Read(&toc[i].offset);
+            stream.Read(&toc[i].size);
+
+            // Written so that it can't overflow
+            if (toc[i].offset < toc_end || toc[i].offset > buffer.size() || toc[i].size > buffer.size() - toc[i].offset)
+            {
+                SP_LOG_ERROR("\"%s\" is corrupted, entity %d of its table of contents is out of bounds", file_path.c_str(), i);
+                return false;
+            }
+        }
+
         // Clear current entities
         Clear();
 
@@ -242,26 +585,49 @@ namespace Spartan
         // Notify subsystems that need to load data
         SP_FIRE_EVENT(EventType::WorldLoadStart);
 
-        // Load root entity count
-        const uint32_t root_entity_count = file->ReadAs<uint32_t>();
-
         // Start progress tracking and timing
         ProgressTracker::GetProgress(ProgressType::World).Start(root_entity_count, "Loading world...");
         const Stopwatch timer;
 
-        // Load root entity IDs
+        // Create the root entities upfront
+        vector<shared_ptr<Entity>> roots(root_entity_count);
         for (uint32_t i = 0; i < root_entity_count; i++)
         {
-            shared_ptr<Entity> entity = CreateEntity();
-            entity->SetObjectId(file->ReadAs<uint64_t>());
+            roots[i] = CreateEntity();
+            roots[i]->SetObjectId(toc[i].id);
         }
 
-        // Serialize root entities
-        for (uint32_t i = 0; i < root_entity_count; i++)
+        // Deserialize the root hierarchies in parallel, they are independent of each other
+        vector<vector<ComponentBlock>> deferred(root_entity_count);
+        ThreadPool::ParallelFor([&buffer, &toc, &roots, &deferred](uint32_t work_index_start, uint32_t work_index_end)
         {
-            static shared_ptr<Transform> empty;
-            m_entities[i]->Deserialize(file.get(), empty);
-            ProgressTracker::GetProgress(ProgressType::World).JobDone();
+            FileStream block_stream(&buffer, FileStream_Read);
+            for (uint32_t i = work_index_start; i < work_index_end; i++)
+            {
+                block_stream.SetPosition(toc[i].offset);
+                roots[i]->Deserialize(&block_stream, nullptr, &deferred[i]);
+                ProgressTracker::GetProgress(ProgressType::World).JobDone();
+            }
+        }, root_entity_count);
+
+        // Fix-up, deserialize the components which couldn't be deserialized in parallel.
+        // Constraints go last since they link to bodies which can be part of any hierarchy.
+        {
+            vector<ComponentBlock> blocks;
+            for (vector<ComponentBlock>& root_blocks : deferred)
+            {
+                blocks.insert(blocks.end(), root_blocks.begin(), root_blocks.end());
+            }
+            stable_partition(blocks.begin(), blocks.end(), [](const ComponentBlock& block)
+            {
+                return block.component->GetType() != ComponentType::Constraint;
+            });
+
+            for (ComponentBlock& block : blocks)
+            {
+                stream.SetPosition(block.offset);
+                block.component->Deserialize(&stream);
+            }
         }
 
         // Report time
@@ -272,6 +638,11 @@ namespace Spartan
         return true;
     }
 
+    const SpatialIndex& World::GetSpatialIndex()
+    {
+        return m_spatial_index;
+    }
+
     void World::Resolve()
     {
         m_resolve = true;
@@ -281,17 +652,26 @@ namespace Spartan
     {
         lock_guard lock(m_entity_access_mutex);
 
-        shared_ptr<Entity> entity = make_shared<Entity>();
+        // Entities and their control blocks come from a slab, it's never destroyed since entities can outlive the static destruction order
+        static SlabAllocator* entity_slab = new SlabAllocator("Entity");
+
+        shared_ptr<Entity> entity = allocate_shared<Entity>(SlabAllocatorStl<Entity>(entity_slab));
         entity->Initialize();
+        entity_index::add(entity);
         m_entities.emplace_back(entity);
 
+        {
+            lock_guard<mutex> lock_change_log(m_change_log_mutex);
+            m_change_log.added.emplace_back(entity);
+        }
+
         return entity;
     }
 
     bool World::EntityExists(Entity* entity)
     {
         SP_ASSERT_MSG(entity != nullptr, "Entity is null");
-        return GetEntityById(entity->GetObjectId()) != nullptr;
+        return IsValid(entity->GetHandle());
     }
 
     void World::RemoveEntity(shared_ptr<Entity> entity_to_remove)
@@ -318,7 +698,18 @@ namespace Spartan
             m_entities.erase(remove_if(m_entities.begin(), m_entities.end(),
                 [&](const shared_ptr<Entity>& entity)
                 {
-                    return ids_to_remove.count(entity->GetObjectId()) > 0;
+                    // The renderer can hold on to removed entities for a few frames, removing
+                    // them from the index also invalidates their handle so they no longer tick
+                    const bool remove = ids_to_remove.count(entity->GetObjectId()) > 0;
+                    if (remove)
+                    {
+                        entity_index::remove(entity.get());
+
+                        lock_guard<mutex> lock_change_log(m_change_log_mutex);
+                        m_change_log.removed.emplace_back(entity);
+                    }
+
+                    return remove;
                 }),
                 m_entities.end());
 
@@ -328,8 +719,6 @@ namespace Spartan
                 parent->AcquireChildren();
             }
         }
-
-        m_resolve = true;
     }
 
     vector<shared_ptr<Entity>> World::GetRootEntities()
@@ -352,11 +741,9 @@ namespace Spartan
     {
         lock_guard<mutex> lock(m_entity_access_mutex);
 
-        for (shared_ptr<Entity>& entity : m_entities)
-        {
-            if (entity->GetObjectName() == name)
-                return entity;
-        }
+        auto it = m_entity_index_name.find(name);
+        if (it != m_entity_index_name.end())
+            return entity_index::get_slot(it->second).entity;
 
         static shared_ptr<Entity> empty;
         return empty;
@@ -366,16 +753,62 @@ namespace Spartan
     {
         lock_guard<mutex> lock(m_entity_access_mutex);
 
-        for (const auto& entity : m_entities)
-        {
-            if (entity->GetObjectId() == id)
-                return entity;
-        }
+        auto it = m_entity_index_id.find(id);
+        if (it != m_entity_index_id.end())
+            return entity_index::get_slot(it->second).entity;
+
+        static shared_ptr<Entity> empty;
+        return empty;
+    }
+
+    const shared_ptr<Entity>& World::GetEntityByHandle(const EntityHandle& handle)
+    {
+        lock_guard<mutex> lock(m_entity_access_mutex);
+
+        if (IsValid(handle))
+            return entity_index::get_slot(handle.index).entity;
 
         static shared_ptr<Entity> empty;
         return empty;
     }
 
+    bool World::IsValid(const EntityHandle& handle)
+    {
+        if (!handle.IsValid())
+            return false;
+
+        const uint32_t chunk_index = handle.index / entity_slots_per_chunk;
+        if (chunk_index >= m_entity_slot_chunks.size())
+            return false;
+
+        EntitySlot* chunk = m_entity_slot_chunks[chunk_index].load(memory_order_acquire);
+        if (!chunk)
+            return false;
+
+        return chunk[handle.index % entity_slots_per_chunk].generation.load(memory_order_acquire) == handle.generation;
+    }
+
+    void World::ReindexEntity(Entity* entity, const uint64_t id_previous, const string& name_previous)
+    {
+        SP_ASSERT_MSG(entity != nullptr, "Entity is null");
+
+        lock_guard<mutex> lock(m_entity_access_mutex);
+
+        const uint32_t index = entity->GetHandle().index;
+
+        if (id_previous != entity->GetObjectId())
+        {
+            entity_index::remove_id(id_previous, index);
+            m_entity_index_id[entity->GetObjectId()] = index;
+        }
+
+        if (name_previous != entity->GetObjectName())
+        {
+            entity_index::remove_name(name_previous, index);
+            m_entity_index_name.emplace(entity->GetObjectName(), index);
+        }
+    }
+
     const vector<shared_ptr<Entity>>& World::GetAllEntities()
     {
         return m_entities;
@@ -387,7 +820,22 @@ namespace Spartan
         SP_FIRE_EVENT(EventType::WorldClear);
 
         // Clear
-        m_entities.clear();
+        {
+            lock_guard<mutex> lock(m_entity_access_mutex);
+
+            for (shared_ptr<Entity>& entity : m_entities)
+            {
+                entity_index::remove(entity.get());
+            }
+            m_entities.clear();
+        }
+
+        // Subscribers of WorldClear have already dropped everything, so the resources can go
+        ResourceCache::Shutdown();
+        {
+            lock_guard<mutex> lock(m_change_log_mutex);
+            m_change_log.Clear();
+        }
         m_name.clear();
         m_file_path.clear();
 
@@ -28,6 +28,29 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 namespace Spartan
 {
+    //= FORWARD DECLARATIONS =
+    struct EntityHandle;
+    class SpatialIndex;
+    //========================
+
+    // What changed since the last resolve, published (as a pointer) with EventType::WorldResolved
+    struct WorldChangeLog
+    {
+        std::vector<std::shared_ptr<Entity>> added;
+        std::vector<std::shared_ptr<Entity>> modified; // components or (recursive) active state changed
+        std::vector<std::shared_ptr<Entity>> removed;
+        bool full = false;                              // everything has to be re-evaluated, added has all the entities
+
+        bool IsEmpty() const { return !full && added.empty() && modified.empty() && removed.empty(); }
+        void Clear()
+        {
+            added.clear();
+            modified.clear();
+            removed.clear();
+            full = false;
+        }
+    };
+
     class SP_CLASS World
     {
     public:
@@ -43,6 +66,10 @@ namespace Spartan
         static const std::string GetName();
         static const std::string& GetFilePath();
 
+        // Component types which don't conflict tick in parallel, disable for a deterministic order when debugging
+        static void SetTickParallel(const bool parallel);
+        static bool IsTickParallel();
+
         //= DEFAULT WORLDS=======================================================================
         static void CreateDefaultWorldCommon(
             const bool create_floor,
@@ -65,7 +92,17 @@ namespace Spartan
         static std::vector<std::shared_ptr<Entity>> GetRootEntities();
         static const std::shared_ptr<Entity>& GetEntityByName(const std::string& name);
         static const std::shared_ptr<Entity>& GetEntityById(uint64_t id);
+        static const std::shared_ptr<Entity>& GetEntityByHandle(const EntityHandle& handle);
         static const std::vector<std::shared_ptr<Entity>>& GetAllEntities();
+
+        // Lock free, true as long as the entity the handle was issued for is in the world
+        static bool IsValid(const EntityHandle& handle);
+
+        // Keeps the id and name lookups up to date, called by entities when either changes
+        static void ReindexEntity(Entity* entity, uint64_t id_previous, const std::string& name_previous);
+
+        // Renderables, lights and reflection probes, updated once per frame after the transforms resolve
+        static const SpatialIndex& GetSpatialIndex();
         //=============================================================================
 
     private: